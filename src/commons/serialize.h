@@ -1129,6 +1129,13 @@ public:
             return vch.erase(first, last);
     }
 
+    // exchange the underlying buffer with vchIn, the read position is reset
+    void SwapBuffer(vector_type& vchIn)
+    {
+        vch.swap(vchIn);
+        nReadPos = 0;
+    }
+
     inline void Compact()
     {
         vch.erase(vch.begin(), vch.begin() + nReadPos);
@@ -120,6 +120,26 @@ static const uint32_t MAX_ORPHAN_BLOCKS = 750;
 static const int32_t MAX_BLOCKS_IN_TRANSIT_PER_PEER = 128;
 /** Timeout in seconds before considering a block download peer unresponsive. */
 static const uint32_t BLOCK_DOWNLOAD_TIMEOUT  = 60;
+/** Number of headers sent in one headers message, the same as the getheaders reply limit. */
+static const uint32_t MAX_HEADERS_RESULTS = 2000;
+/** Size of the headers-first download window beyond the tip, kept below the orphan blocks limit. */
+static const int32_t BLOCK_DOWNLOAD_WINDOW = 512;
+/** Number of blocks that can be requested from a single peer before its download rate is known. */
+static const int32_t MIN_BLOCKS_IN_TRANSIT_PER_PEER = 16;
+/** Seconds of blocks requested from a peer at its download rate. */
+static const int32_t BLOCK_DOWNLOAD_TARGET_TIME = 4;
+/** Seconds between the samples of the peer download rate. */
+static const int32_t BLOCK_DOWNLOAD_RATE_SAMPLE_INTERVAL = 2;
+/** Timeout in seconds before the peer holding the first block of the download window is stalling. */
+static const int32_t BLOCK_STALLING_TIMEOUT = 5;
+/** Number of stalls before the peer is disconnected. */
+static const int32_t MAX_BLOCK_DOWNLOAD_STALLS = 3;
+/** Seconds between the getheaders to a peer which has more blocks than its headers we accepted. */
+static const int32_t HEADERS_REQUEST_INTERVAL = 10;
+/** Seconds before the compact block waiting for its blocktxn is dropped. */
+static const int32_t PARTIAL_BLOCK_EXPIRY = 30;
+/** The maximum number of compact blocks waiting for their blocktxn. */
+static const uint32_t MAX_PARTIAL_BLOCKS = 64;
 
 /** Minimum disk space required */
 static const uint64_t MIN_DISK_SPACE = 52428800;
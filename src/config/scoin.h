@@ -170,7 +170,7 @@ public:
     )
 
     friend bool operator<(const CCdpCoinPair& a, const CCdpCoinPair& b) {
-        return a.bcoin_symbol < b.bcoin_symbol || a.scoin_symbol < b.scoin_symbol;
+        return std::tie(a.bcoin_symbol, a.scoin_symbol) < std::tie(b.bcoin_symbol, b.scoin_symbol);
     }
 
     friend bool operator==(const CCdpCoinPair& a , const CCdpCoinPair& b) {
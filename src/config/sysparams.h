@@ -59,6 +59,9 @@ struct SysParamTypeHash {
     }
 };
 
+// the blocks of the price points kept in the memory cache, a larger median price slide window is clamped to it
+static const uint64_t MEDIAN_PRICE_SLIDE_WINDOW_BLOCKCOUNT_MAX = 11;
+
 static const unordered_map<SysParamType, std::tuple< uint64_t,string >, SysParamTypeHash> SysParamTable = {
         { MEDIAN_PRICE_SLIDE_WINDOW_BLOCKCOUNT,     make_tuple( 11,           "MEDIAN_PRICE_SLIDE_WINDOW_BLOCKCOUNT")    },
         { PRICE_FEED_BCOIN_STAKE_AMOUNT_MIN,        make_tuple( 210000,       "PRICE_FEED_BCOIN_STAKE_AMOUNT_MIN")       },  // 1%: min 210K bcoins staked to be a price feeder for miner
@@ -79,7 +82,7 @@ static const unordered_map<SysParamType, std::tuple< uint64_t,string >, SysParam
 };
 
 static const unordered_map<SysParamType, std::pair<uint64_t, uint64_t>, SysParamTypeHash> sysParamScopeTable = {
-        { MEDIAN_PRICE_SLIDE_WINDOW_BLOCKCOUNT,      RANGE(0,0)        },
+        { MEDIAN_PRICE_SLIDE_WINDOW_BLOCKCOUNT,      RANGE(0,0)        },  // clamped when used, see MEDIAN_PRICE_SLIDE_WINDOW_BLOCKCOUNT_MAX
         { PRICE_FEED_BCOIN_STAKE_AMOUNT_MIN,         RANGE(0,0)        },  // 1%: min 210K bcoins staked to be a price feeder for miner
         { PRICE_FEED_CONTINUOUS_DEVIATE_TIMES_MAX,   RANGE(0,0)        },  // after 10 times continuous deviate limit penetration all deposit be deducted
         { PRICE_FEED_DEVIATE_RATIO_MAX,              RANGE(0,0)        },  // must be < 30% * 10000, otherwise penalized
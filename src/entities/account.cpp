@@ -239,8 +239,12 @@ bool CAccount::SetToken(const TokenSymbol &tokenSymbol, const CAccountToken &acc
 }
 
 Object CAccount::ToJsonObj() const {
+    return ToJsonObj(*pCdMan->pDelegateCache, chainActive.Height());
+}
+
+Object CAccount::ToJsonObj(CDelegateDBCache &delegateCache, int32_t height) const {
     vector<CCandidateReceivedVote> candidateVotes;
-    pCdMan->pDelegateCache->GetCandidateVotes(regid, candidateVotes);
+    delegateCache.GetCandidateVotes(regid, candidateVotes);
 
     Array candidateVoteArray;
     for (auto &vote : candidateVotes) {
@@ -272,9 +276,9 @@ Object CAccount::ToJsonObj() const {
     obj.push_back(Pair("address",           keyid.ToAddress()));
     obj.push_back(Pair("keyid",             keyid.ToString()));
     obj.push_back(Pair("nickid",            nickid.ToString()));
-    obj.push_back(Pair("nickid_mature",     nickid.IsMature(chainActive.Height())));
+    obj.push_back(Pair("nickid_mature",     nickid.IsMature(height)));
     obj.push_back(Pair("regid",             regid.ToString()));
-    obj.push_back(Pair("regid_mature",      regid.IsMature(chainActive.Height())));
+    obj.push_back(Pair("regid_mature",      regid.IsMature(height)));
     obj.push_back(Pair("owner_pubkey",      owner_pubkey.ToString()));
     obj.push_back(Pair("miner_pubkey",      miner_pubkey.ToString()));
     obj.push_back(Pair("tokens",            tokenMapObj));
@@ -25,6 +25,7 @@
 using namespace json_spirit;
 
 class CAccountDBCache;
+class CDelegateDBCache;
 
 enum BalanceType : uint8_t {
     NULL_TYPE    = 0,  //!< invalid type
@@ -204,6 +205,7 @@ public:
     void SetEmpty() { keyid.SetEmpty(); }  // TODO: need set other fields to empty()??
     string ToString() const;
     Object ToJsonObj() const;
+    Object ToJsonObj(CDelegateDBCache &delegateCache, int32_t height) const;
 
     void SetRegId(CRegID & regIdIn) { regid = regIdIn; }
 
@@ -10,6 +10,7 @@
 #include "commons/serialize.h"
 #include "config/version.h"
 #include "commons/util/util.h"
+#include "crypto/hash.h"
 
 #include <string>
 
@@ -82,6 +83,9 @@ public:
     string memo;        //!< Contract description
     string abi;         //!< ABI for contract invocation
 
+private:
+    mutable uint256 code_hash;  //!< hash of code, not serialized, computed on first use
+
 public:
     CUniversalContract(): vm_type(NULL_VM) {}
 
@@ -108,6 +112,7 @@ public:
         code.clear();
         memo.clear();
         abi.clear();
+        code_hash.SetNull();
     }
 
     IMPLEMENT_SERIALIZE(
@@ -116,8 +121,18 @@ public:
         READWRITE(code);
         READWRITE(memo);
         READWRITE(abi);
+        if (fRead) {
+            code_hash.SetNull();
+        }
     )
 
+    // the hash is computed lazily, so reading the contracts from db does not hash the code
+    const uint256 &GetCodeHash() const {
+        if (code_hash.IsNull())
+            code_hash = Hash(code.begin(), code.end());
+        return code_hash;
+    }
+
     bool IsValid();
 
     string ToString() const {
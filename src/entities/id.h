@@ -164,6 +164,8 @@ public:
 
 public:
     static std::shared_ptr<CUserID> ParseUserId(const string &idStr);
+    // the nick id is resolved by the account cache
+    static std::shared_ptr<CUserID> ParseUserId(const string &idStr, const CAccountDBCache &accountCache);
     static const CUserID NULL_ID;
     static const EnumTypeMap<VarIndex, string> ID_NAME_MAP;
 public:
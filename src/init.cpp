@@ -12,9 +12,12 @@
 #include "init.h"
 #include "config/configuration.h"
 #include "p2p/addrman.h"
+#include "p2p/txadmission.h"
 
 #include "rpc/core/rpcserver.h"
 #include "vm/luavm/lua/lua.h"
+#include "vm/luavm/luavm.h"
+#include "vm/wasm/wasm_module_cache.hpp"
 #include "wallet/wallet.h"
 #include "wallet/walletdb.h"
 #include "main.h"
@@ -24,6 +27,7 @@
 #include "persistence/accountdb.h"
 #include "persistence/txdb.h"
 #include "persistence/contractdb.h"
+#include "persistence/statesnapshot.h"
 #include "tx/tx.h"
 #include "commons/util/util.h"
 #include "commons/util/time.h"
@@ -141,6 +145,7 @@ void Shutdown() {
 
     StopNode();
     UnregisterNodeSignals(GetNodeSignals());
+    txAdmission.Stop();
 
     {
         LOCK(cs_main);
@@ -152,6 +157,8 @@ void Shutdown() {
 
         if (pCdMan != nullptr) {
             pCdMan->Flush();
+            // the snapshots reference the dbs
+            stateSnapshots.Clear();
             delete pCdMan;
             pCdMan = nullptr;
         }
@@ -162,10 +169,15 @@ void Shutdown() {
 
     delete pWalletMain;
 
+    sigVerifyPool.Stop();
+    parallelExecPool.Stop();
+    luaStatePool.Stop();
+
     // Uninitialize elliptic curve code
     globalVerifyHandle.reset();
     ECC_Stop();
 
+    wasm::wasm_module_cache_dump();
     wasm_code_cache_free();
 
     LogPrint(BCLog::INFO, "Shutdown() : done\n");
@@ -213,9 +225,20 @@ string HelpMessage() {
 #endif
     strUsage += "  -datadir=<dir>         " + _("Specify data directory") + "\n";
     strUsage += "  -dbcache=<n>           " + strprintf(_("Set database cache size in megabytes (%d to %d, default: %d)"), MIN_DB_CACHE, MAX_DB_CACHE, DEFAULT_DB_CACHE) + "\n";
+    strUsage += "  -singledb              " + _("Store the chain state in one database and commit each flush atomically, existing databases are migrated on startup (default: 0)") + "\n";
+    strUsage += "  -dbsyncblocks=<n>      " + strprintf(_("Sync the chain state to disk once every <n> flushed blocks, 0 = no block limit (default: %u)"), DEFAULT_DB_SYNC_BLOCKS) + "\n";
+    strUsage += "  -dbsyncinterval=<n>    " + strprintf(_("Sync the chain state to disk at most <n> milliseconds after a flush, 0 = no time limit (default: %d). -dbsyncblocks=0 and -dbsyncinterval=0 are not allowed together"), DEFAULT_DB_SYNC_INTERVAL_MS) + "\n";
     strUsage += "  -loadblock=<file>      " + _("Imports blocks from external blk000??.dat file") + " " + _("on startup") + "\n";
+    strUsage += "  -maxmempool=<n>        " + strprintf(_("Keep the transaction memory pool below <n> megabytes, the txs with the lowest fee per KB are evicted (default: %d)"), DEFAULT_MAX_MEMPOOL_SIZE) + "\n";
+    strUsage += "  -luacodecachesize=<n>  " + strprintf(_("Limit memory of the compiled lua contract cache used by mempool to <n> megabytes, 0 = disabled (default: %d)"), DEFAULT_LUA_CODE_CACHE_SIZE) + "\n";
+    strUsage += "  -luastatepoolsize=<n>  " + strprintf(_("Number of lua states prepared in advance for mempool, 0 = disabled (default: %d)"), DEFAULT_LUA_STATE_POOL_SIZE) + "\n";
+    strUsage += "  -wasmcachesize=<n>     " + strprintf(_("Limit memory of the instantiated wasm module cache to <n> megabytes (default: %d)"), DEFAULT_WASM_MODULE_CACHE_SIZE) + "\n";
+    strUsage += "  -wasmcacheprewarm=<n>  " + strprintf(_("Instantiate <n> most used wasm modules of last run at startup (default: %d)"), DEFAULT_WASM_MODULE_CACHE_PREWARM) + "\n";
+    strUsage += "  -par=<n>               " + strprintf(_("Set the number of signature verification threads (0 = auto, 1 = no parallel verification, max %d, default: %d)"), MAX_SIG_VERIFY_THREADS, DEFAULT_SIG_VERIFY_THREADS) + "\n";
+    strUsage += "  -parblockexec=<n>      " + strprintf(_("Set the number of threads executing the block txs optimistically in parallel (0 or 1 = serial execution, max %d, default: %d)"), MAX_PAR_BLOCK_EXEC_THREADS, DEFAULT_PAR_BLOCK_EXEC_THREADS) + "\n";
     strUsage += "  -pid=<file>            " + _("Specify pid file (default: coin.pid)") + "\n";
     strUsage += "  -reindex               " + _("Rebuild block chain index from current blk000??.dat files") + " " + _("on startup") + "\n";
+    strUsage += "  -txadmission=<n>       " + strprintf(_("Set the number of threads admitting the txs received from the peers to the mempool (0 = on the message handler thread, max %d, default: %d)"), MAX_TX_ADMISSION_THREADS, DEFAULT_TX_ADMISSION_THREADS) + "\n";
     strUsage += "  -txindex               " + _("Maintain a full transaction index (default: 0)") + "\n";
     strUsage += "  -logfailures           " + _("Log failures into level db in detail (default: 0)") + "\n";
     strUsage += "  -genreceipt               " + _("Whether generate receipt(default: 0)") + "\n";
@@ -230,6 +253,8 @@ string HelpMessage() {
     strUsage += "  -dns                   " + _("Allow DNS lookups for -addnode, -seednode and -connect") + " " + _("(default: 1)") + "\n";
     strUsage += "  -dnsseed               " + _("Query for peer addresses via DNS lookup, if low on addresses (default: 1 unless -connect)") + "\n";
     strUsage += "  -forcednsseed          " + _("Always query for peer addresses via DNS lookup (default: 0)") + "\n";
+    strUsage += "  -headersfirst          " + _("Sync the block headers first, then download the blocks from all peers in parallel (default: 1)") + "\n";
+    strUsage += "  -epoll                 " + _("Use the edge-triggered epoll for the socket events on Linux, otherwise select (default: 1)") + "\n";
     strUsage += "  -externalip=<ip>       " + _("Specify your own public address") + "\n";
     strUsage += "  -listen                " + _("Accept connections from outside (default: 1 if no -proxy or -connect)") + "\n";
     strUsage += "  -maxconnections=<n>    " + _("Maintain at most <n> connections to peers (default: 125)") + "\n";
@@ -256,6 +281,7 @@ string HelpMessage() {
     strUsage += "  -disablewallet         " + _("Do not load the wallet and disable wallet RPC calls") + "\n";
     strUsage += "  -genblock              " + _("Generate blocks (default: 0)") + "\n";
     strUsage += "  -genblocklimit=<n>     " + _("Set the processor limit for when generation is on (-1 = unlimited, default: -1)") + "\n";
+    strUsage += "  -blocktemplate         " + strprintf(_("Pre-pack the next block in background while generating blocks, the txs are packed as they arrive (default: %u)"), DEFAULT_BLOCK_TEMPLATE) + "\n";
     strUsage += "  -keypool=<n>           " + _("Set key pool size to <n> (default: 100)") + "\n";
     strUsage += "  -paytxfee=<amt>        " + _("Fee per kB to add to transactions you send") + "\n";
     strUsage += "  -rescan                " + _("Rescan the block chain for missing wallet transactions") + " " + _("on startup") + "\n";
@@ -284,7 +310,7 @@ string HelpMessage() {
     strUsage += "  -logtimestamps         " + _("Prepend debug output with timestamp (default: 1)") + "\n";
     if (SysCfg().GetBoolArg("-help-debug", false)) {
         strUsage += "  -limitfreerelay=<n>    " + _("Continuously rate-limit free transactions to <n>*1000 bytes per minute (default:15)") + "\n";
-        strUsage += "  -maxsigcachesize=<n>   " + _("Limit size of signature cache to <n> entries (default: 50000)") + "\n";
+        strUsage += "  -maxsigcachesize=<n>   " + strprintf(_("Limit memory of signature cache to <n> megabytes, a larger value than %d is read as the legacy count of entries (default: %d)"), MAX_MAX_SIG_CACHE_SIZE, DEFAULT_MAX_SIG_CACHE_SIZE) + "\n";
     }
     strUsage += "  -logprinttoconsole     " + _("Send trace/debug info to console instead of debug.log file") + "\n";
     if (SysCfg().GetBoolArg("-help-debug", false)) {
@@ -622,6 +648,7 @@ bool AppInit(boost::thread_group &threadGroup) {
     fNoListen   = !SysCfg().GetBoolArg("-listen", true);
     fDiscover   = SysCfg().GetBoolArg("-discover", true);
     fNameLookup = SysCfg().GetBoolArg("-dns", true);
+    fHeadersFirst = SysCfg().GetBoolArg("-headersfirst", true);
 
     bool fBound = false;
     if (!fNoListen) {
@@ -682,6 +709,31 @@ bool AppInit(boost::thread_group &threadGroup) {
         std::cout << "load wallet failed: " << e.what() << std::endl;
     }
 
+    if (SysCfg().GetArg("-dbsyncblocks", DEFAULT_DB_SYNC_BLOCKS) <= 0 &&
+        SysCfg().GetArg("-dbsyncinterval", DEFAULT_DB_SYNC_INTERVAL_MS) <= 0)
+        return InitError(_("-dbsyncblocks=0 and -dbsyncinterval=0 would never sync the chain state to disk, set one of them"));
+
+    int64_t nMaxSigCacheSize  = std::max<int64_t>(0, SysCfg().GetArg("-maxsigcachesize", DEFAULT_MAX_SIG_CACHE_SIZE));
+    uint64_t nMaxSigCacheBytes = 0;
+    if (nMaxSigCacheSize <= MAX_MAX_SIG_CACHE_SIZE) {
+        nMaxSigCacheBytes = nMaxSigCacheSize << 20;
+    } else {
+        // -maxsigcachesize was the max count of entries before, e.g. 50000 of the old default
+        uint64_t nMaxEntries = std::min<uint64_t>(nMaxSigCacheSize, (MAX_MAX_SIG_CACHE_SIZE << 20) / CSignatureCache::ENTRY_MEMORY_SIZE);
+        nMaxSigCacheBytes    = nMaxEntries * CSignatureCache::ENTRY_MEMORY_SIZE;
+        LogPrint(BCLog::ERROR, "Warning: -maxsigcachesize=%d is more than %d megabytes, it is read as the count of entries "
+                 "and limits the signature cache to %d bytes, set it in megabytes instead\n",
+                 nMaxSigCacheSize, MAX_MAX_SIG_CACHE_SIZE, nMaxSigCacheBytes);
+    }
+    signatureCache.SetMaxMemory(nMaxSigCacheBytes);
+    sigVerifyPool.Start(SysCfg().GetArg("-par", DEFAULT_SIG_VERIFY_THREADS));
+    parallelExecPool.Start(SysCfg().GetArg("-parblockexec", DEFAULT_PAR_BLOCK_EXEC_THREADS));
+    txAdmission.Start(SysCfg().GetArg("-txadmission", DEFAULT_TX_ADMISSION_THREADS));
+    mempool.SetMaxMemory(std::max<int64_t>(0, SysCfg().GetArg("-maxmempool", DEFAULT_MAX_MEMPOOL_SIZE)) << 20);
+    luaCodeCache.SetMaxMemory(std::max<int64_t>(0, SysCfg().GetArg("-luacodecachesize", DEFAULT_LUA_CODE_CACHE_SIZE)) << 20);
+    luaStatePool.Start(std::max<int64_t>(0, SysCfg().GetArg("-luastatepoolsize", DEFAULT_LUA_STATE_POOL_SIZE)));
+    wasm::get_wasm_module_cache().set_max_memory(std::max<int64_t>(0, SysCfg().GetArg("-wasmcachesize", DEFAULT_WASM_MODULE_CACHE_SIZE)) << 20);
+
     int64_t nStart = GetTimeMillis();
     bool fLoaded   = false;
     while (!fLoaded) {
@@ -694,7 +746,12 @@ bool AppInit(boost::thread_group &threadGroup) {
                 delete pCdMan;
 
                 bool fReIndex = SysCfg().IsReindex();
-                pCdMan = new CCacheDBManager(fReIndex, false);
+                // once the single db exists, keep using it even without -singledb
+                bool fSingleDb = SysCfg().GetBoolArg("-singledb", false) ||
+                                 boost::filesystem::exists(GetDataDir() / "blocks" / kSingleDbName);
+                pCdMan = new CCacheDBManager(fReIndex, false, fSingleDb);
+                pCdMan->StartFlusher(SysCfg().GetArg("-dbsyncblocks", DEFAULT_DB_SYNC_BLOCKS),
+                                     SysCfg().GetArg("-dbsyncinterval", DEFAULT_DB_SYNC_INTERVAL_MS));
                 if (fReIndex)
                     pCdMan->pBlockCache->WriteReindexing(true);
 
@@ -783,11 +840,30 @@ bool AppInit(boost::thread_group &threadGroup) {
         return false;
     }
 
+    // the order book index of dex is built from the active orders persisted before it
+    nStart = GetTimeMillis();
+    uint32_t orderBookCount = 0;
+    if (!pCdMan->pDexCache->BuildOrderBook(orderBookCount) || !pCdMan->Flush())
+        return InitError("Failed to build the order book index of dex");
+    if (orderBookCount > 0) {
+        LogPrint(BCLog::INFO, "Built the order book index of %u dex active orders (%dms)\n", orderBookCount,
+                 GetTimeMillis() - nStart);
+        LogPrint(BCLog::ERROR, "Warning: the blocks before height %d have no undo data for the order book index "
+                 "of dex, restart with -reindex after a reorg across it\n", chainActive.Height() + 1);
+    }
+
     // scan for better chains in the block chain database, that are not yet connected in the active best chain
     CValidationState state;
     if (!ActivateBestChain(state))
         return InitError("Failed to connect best block");
 
+    int64_t wasmPrewarmCount = SysCfg().GetArg("-wasmcacheprewarm", DEFAULT_WASM_MODULE_CACHE_PREWARM);
+    if (wasmPrewarmCount > 0) {
+        nStart = GetTimeMillis();
+        uint32_t prewarmed = wasm::wasm_module_cache_prewarm(*pCdMan->pContractCache, wasmPrewarmCount);
+        LogPrint(BCLog::INFO, "Prewarmed %u wasm modules (%dms)\n", prewarmed, GetTimeMillis() - nStart);
+    }
+
     nStart                   = GetTimeMillis();
     CBlockIndex *pBlockIndex = chainActive.Tip();
     int32_t nCacheHeight     = SysCfg().GetTxCacheHeight();
@@ -807,26 +883,30 @@ bool AppInit(boost::thread_group &threadGroup) {
 
     nStart       = GetTimeMillis();
     pBlockIndex  = chainActive.Tip();
-    nCacheHeight = 11;  // TODO: parameterize 11.
-    nCount       = 0;
-
-
-    if (pBlockIndex) {
-        if (!ReadBlockFromDisk(pBlockIndex, block))
-            return InitError("Failed to read block from disk");
-    }
-
-    while (pBlockIndex && nCacheHeight-- > 0) {
-        if (!ReadBlockFromDisk(pBlockIndex, block))
-            return InitError("Failed to read block from disk");
-
-        if (!pCdMan->pPpCache->AddPriceByBlock(block))
-            return InitError("Failed to add block to price point memory cache");
-
-        pBlockIndex = pBlockIndex->pprev;
-        ++nCount;
+    // the price points are restored from the snapshot saved with the db state of the same best block
+    CPricePointSnapshot pricePointSnapshot;
+    if (pBlockIndex && pCdMan->pPriceFeedCache->pricePointSnapshotCache.GetData(pricePointSnapshot) &&
+        pricePointSnapshot.block_hash == pBlockIndex->GetBlockHash()) {
+        pCdMan->pPpCache->RestoreSnapshot(pricePointSnapshot);
+        LogPrint(BCLog::INFO, "Restored the price point memory cache of block %d from the snapshot (%dms)\n",
+                 pBlockIndex->height, GetTimeMillis() - nStart);
+    } else {
+        nCacheHeight = PRICE_POINT_CACHE_BLOCK_COUNT;
+        nCount       = 0;
+        while (pBlockIndex && nCacheHeight-- > 0) {
+            if (!ReadBlockFromDisk(pBlockIndex, block))
+                return InitError("Failed to read block from disk");
+
+            if (!pCdMan->pPpCache->AddPriceByBlock(block))
+                return InitError("Failed to add block to price point memory cache");
+
+            pBlockIndex = pBlockIndex->pprev;
+            ++nCount;
+        }
+        pCdMan->pPpCache->SetLoaded();
+        LogPrint(BCLog::INFO, "Added the latest %d blocks to price point memory cache (%dms)\n", nCount,
+                 GetTimeMillis() - nStart);
     }
-    LogPrint(BCLog::INFO, "Added the latest %d blocks to price point memory cache (%dms)\n", nCount, GetTimeMillis() - nStart);
 
     vector<boost::filesystem::path> vImportFiles;
     if (SysCfg().IsArgCount("-loadblock")) {
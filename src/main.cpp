@@ -27,6 +27,7 @@
 #include "p2p/sendmessage.hpp"
 #include "chain/blockdelegates.h"
 #include "persistence/blockundo.h"
+#include "persistence/statesnapshot.h"
 #include "tx/txserializer.h"
 
 #include <sstream>
@@ -55,6 +56,7 @@ CCriticalSection cs_main;
 CTxMemPool mempool;
 map<uint256, CBlockIndex *> mapBlockIndex;
 int32_t nSyncTipHeight = 0;
+bool fHeadersFirst = true;  // sync the headers first, then download the blocks from all of the peers
 string publicIp;
 map<uint256/* blockhash */, std::shared_ptr<CCacheWrapper>> mapForkCache;
 CSignatureCache signatureCache;
@@ -96,6 +98,13 @@ namespace {
         for (const auto &hash : state->vBlocksToDownload)
             mapBlocksToDownload.erase(hash);
 
+        for (auto it = mapPartialBlocks.begin(); it != mapPartialBlocks.end();) {
+            if (it->first.second == nodeid)
+                it = mapPartialBlocks.erase(it);
+            else
+                ++it;
+        }
+
         mapNodeState.erase(nodeid);
     }
 
@@ -181,12 +190,28 @@ void UnregisterAllWallets() {
     g_signals.SyncTransaction.disconnect_all_slots();
 }
 
+void RegisterChainEventListener(CChainEventListener *pListenerIn) {
+    g_signals.SyncTransaction.connect(boost::bind(&CChainEventListener::SyncTransaction, pListenerIn, _1, _2, _3));
+    g_signals.RejectTransaction.connect(boost::bind(&CChainEventListener::RejectTransaction, pListenerIn, _1, _2, _3));
+    g_signals.ForceLiquidateCdps.connect(boost::bind(&CChainEventListener::ForceLiquidateCdps, pListenerIn, _1, _2, _3));
+}
+
+void UnregisterChainEventListener(CChainEventListener *pListenerIn) {
+    g_signals.ForceLiquidateCdps.disconnect(boost::bind(&CChainEventListener::ForceLiquidateCdps, pListenerIn, _1, _2, _3));
+    g_signals.RejectTransaction.disconnect(boost::bind(&CChainEventListener::RejectTransaction, pListenerIn, _1, _2, _3));
+    g_signals.SyncTransaction.disconnect(boost::bind(&CChainEventListener::SyncTransaction, pListenerIn, _1, _2, _3));
+}
+
 void SyncTransaction(const uint256 &hash, CBaseTx *pBaseTx, const CBlock *pBlock) {
     g_signals.SyncTransaction(hash, pBaseTx, pBlock);
 }
 
 void EraseTransaction(const uint256 &hash) { g_signals.EraseTransaction(hash); }
 
+void ForceLiquidateCdps(const uint256 &txid, const vector<CUserCDP> &cdps, uint64_t bcoinMedianPrice) {
+    g_signals.ForceLiquidateCdps(txid, cdps, bcoinMedianPrice);
+}
+
 //////////////////////////////////////////////////////////////////////////////
 //
 // Registration of network node signals.
@@ -199,7 +224,9 @@ bool GetNodeStateStats(NodeId nodeid, CNodeStateStats &stats) {
     if (state == nullptr)
         return false;
 
-    stats.nMisbehavior = state->nMisbehavior;
+    stats.nMisbehavior    = state->nMisbehavior;
+    stats.nBlocksInFlight = state->nBlocksInFlight;
+    stats.downloadRate    = state->downloadRate;
     return true;
 }
 
@@ -250,15 +277,15 @@ bool VerifySignature(const uint256 &sigHash, const std::vector<uint8_t> &signatu
     return true;
 }
 
-bool AcceptToMemoryPool(CTxMemPool &pool, CValidationState &state, CBaseTx *pBaseTx,
-                        bool fLimitFree, bool fRejectInsaneFee) {
+static bool AcceptToMemoryPoolInternal(CTxMemPool &pool, CValidationState &state, CBaseTx *pBaseTx,
+                                       bool fLimitFree, bool fRejectInsaneFee) {
     AssertLockHeld(cs_main);
 
     // is it already in the memory pool?
     uint256 hash = pBaseTx->GetHash();
     if (pool.Exists(hash))
         return state.Invalid(ERRORMSG("AcceptToMemoryPool() : txid: %s already in mempool", hash.GetHex()),
-                            REJECT_INVALID, "tx-already-in-mempool");
+                            REJECT_DUPLICATE, "tx-already-in-mempool");
 
     // is it a miner reward tx or price median tx?
     if (pBaseTx->IsBlockRewardTx() || pBaseTx->IsPriceMedianTx())
@@ -315,6 +342,20 @@ bool AcceptToMemoryPool(CTxMemPool &pool, CValidationState &state, CBaseTx *pBas
     return pool.AddUnchecked(hash, entry, state);
 }
 
+bool AcceptToMemoryPool(CTxMemPool &pool, CValidationState &state, CBaseTx *pBaseTx,
+                        bool fLimitFree, bool fRejectInsaneFee) {
+    if (!AcceptToMemoryPoolInternal(pool, state, pBaseTx, fLimitFree, fRejectInsaneFee)) {
+        // only the invalid txs are published, not the duplicates or the failures without a reason
+        if (state.IsInvalid() && state.GetRejectCode() != REJECT_DUPLICATE && !state.GetRejectReason().empty())
+            g_signals.RejectTransaction(pBaseTx->GetHash(), pBaseTx, state);
+        return false;
+    }
+
+    SyncTransaction(pBaseTx->GetHash(), pBaseTx);
+    NotifyBlockTemplateChanged();
+    return true;
+}
+
 int32_t CMerkleTx::GetDepthInMainChainINTERNAL(CBlockIndex *&pindexRet) const {
     if (blockHash.IsNull() || index == -1)
         return 0;
@@ -1009,6 +1050,42 @@ static bool ComputeVoteStakingInterestAndRevokeVotes(const int32_t currHeight, c
     return true;
 }
 
+// Verify the tx signatures of the block in parallel to fill the signature cache before the serial execution.
+// The pubkeys are resolved from the state before the block, the txs whose account can not be resolved yet
+// (e.g. registered in the same block) are left to the serial execution, and so are the invalid signatures.
+static void PreVerifyBlockSignatures(const CBlock &block, CCacheWrapper &cw) {
+    if (sigVerifyPool.GetThreadCount() <= 1 || block.vptx.size() <= 2)
+        return;
+
+    int64_t nStart = GetTimeMicros();
+    vector<CSigVerifyItem> items;
+    items.reserve(block.vptx.size());
+    for (size_t index = 1; index < block.vptx.size(); ++index) {
+        const std::shared_ptr<CBaseTx> &pBaseTx = block.vptx[index];
+        if (pBaseTx->IsBlockRewardTx() || pBaseTx->IsPriceMedianTx() || pBaseTx->signature.empty())
+            continue;
+
+        CPubKey pubKey;
+        if (pBaseTx->txUid.is<CPubKey>()) {
+            pubKey = pBaseTx->txUid.get<CPubKey>();
+        } else {
+            CAccount account;
+            if (!cw.accountCache.GetAccount(pBaseTx->txUid, account))
+                continue;
+            pubKey = account.owner_pubkey;
+        }
+        if (!pubKey.IsValid())
+            continue;
+
+        items.emplace_back(pBaseTx->GetHash(), &pBaseTx->signature, pubKey);
+    }
+
+    uint32_t validCount = sigVerifyPool.VerifyAndCache(items);
+    if (SysCfg().IsBenchmark())
+        LogPrint(BCLog::INFO, "- Verify %u/%u signatures with %d threads: %.2fms\n", validCount, items.size(),
+                 sigVerifyPool.GetThreadCount(), (GetTimeMicros() - nStart) * 0.001);
+}
+
 bool ConnectBlock(CBlock &block, CCacheWrapper &cw, CBlockIndex *pIndex, CValidationState &state, bool fJustCheck) {
     AssertLockHeld(cs_main);
 
@@ -1080,6 +1157,36 @@ bool ConnectBlock(CBlock &block, CCacheWrapper &cw, CBlockIndex *pIndex, CValida
         uint32_t fuelRate     = block.GetFuelRate();
         uint64_t totalRunStep = 0;
 
+        PreVerifyBlockSignatures(block, cw);
+
+        uint32_t prevBlockTime = pIndex->pprev != nullptr ? pIndex->pprev->GetBlockTime() : pIndex->GetBlockTime();
+        // account the executed tx in block order
+        auto commitTx = [&](int32_t index) -> bool {
+            std::shared_ptr<CBaseTx> &pBaseTx = block.vptx[index];
+            vPos.push_back(make_pair(pBaseTx->GetHash(), pos));
+
+            totalRunStep += pBaseTx->nRunStep;
+            if (totalRunStep > MAX_BLOCK_RUN_STEP)
+                return state.DoS(100, ERRORMSG("ConnectBlock() : total steps(%llu) exceed max steps(%llu)", totalRunStep,
+                                 MAX_BLOCK_RUN_STEP), REJECT_INVALID, "exceed-max-fuel");
+
+            auto fuel = pBaseTx->GetFuel(block.GetHeight(), block.GetFuelRate());
+            totalFuel += fuel;
+
+            auto fees_symbol = std::get<0>(pBaseTx->GetFees());
+            assert(fees_symbol == SYMB::GVC || fees_symbol == SYMB::WUSD);  // Only allow GVC/WUSD as fees type.
+            auto fees = std::get<1>(pBaseTx->GetFees());
+            assert(fees >= fuel);
+            rewards[fees_symbol] += (fees - fuel);
+
+            pos.nTxOffset += ::GetSerializeSize(pBaseTx, SER_DISK, CLIENT_VERSION);
+
+            LogPrint(BCLog::DEBUG, "total fuel fee:%d, tx fuel fee:%d runStep:%d fuelRate:%d txid:%s\n", totalFuel,
+                     fuel, pBaseTx->nRunStep, fuelRate, pBaseTx->GetHash().GetHex());
+            return true;
+        };
+
+        bool fParallel = parallelExecPool.GetThreadCount() > 1 && block.vptx.size() > 2;
         for (int32_t index = 1; index < (int32_t)block.vptx.size(); ++index) {
             std::shared_ptr<CBaseTx> &pBaseTx = block.vptx[index];
             if (cw.txCache.HasTx((pBaseTx->GetHash())))
@@ -1091,9 +1198,11 @@ bool ConnectBlock(CBlock &block, CCacheWrapper &cw, CBlockIndex *pIndex, CValida
                                  pBaseTx->GetHash().GetHex()), REJECT_INVALID, "tx-invalid-height");
 
             pBaseTx->nFuelRate = fuelRate;
+            if (fParallel)
+                continue;
+
             CTxUndoOpLogger opLogger(cw, pBaseTx->GetHash(), blockUndo);
 
-            uint32_t prevBlockTime = pIndex->pprev != nullptr ? pIndex->pprev->GetBlockTime() : pIndex->GetBlockTime();
             CTxExecuteContext context(pIndex->height, index, fuelRate, pIndex->nTime, prevBlockTime, &cw, &state);
             if (!pBaseTx->ExecuteTx(context)) {
                 pCdMan->pLogCache->SetExecuteFail(pIndex->height, pBaseTx->GetHash(), state.GetRejectCode(),
@@ -1102,26 +1211,47 @@ bool ConnectBlock(CBlock &block, CCacheWrapper &cw, CBlockIndex *pIndex, CValida
                                  pBaseTx->GetHash().GetHex(), pBaseTx->ToString(cw.accountCache)), REJECT_INVALID, "tx-execute-failed");
             }
 
-            vPos.push_back(make_pair(pBaseTx->GetHash(), pos));
-
-            totalRunStep += pBaseTx->nRunStep;
-            if (totalRunStep > MAX_BLOCK_RUN_STEP)
-                return state.DoS(100, ERRORMSG("ConnectBlock() : total steps(%llu) exceed max steps(%llu)", totalRunStep,
-                                 MAX_BLOCK_RUN_STEP), REJECT_INVALID, "exceed-max-fuel");
-
-            auto fuel = pBaseTx->GetFuel(block.GetHeight(), block.GetFuelRate());
-            totalFuel += fuel;
+            if (!commitTx(index))
+                return false;
+        }
 
-            auto fees_symbol = std::get<0>(pBaseTx->GetFees());
-            assert(fees_symbol == SYMB::GVC || fees_symbol == SYMB::WUSD);  // Only allow GVC/WUSD as fees type.
-            auto fees = std::get<1>(pBaseTx->GetFees());
-            assert(fees >= fuel);
-            rewards[fees_symbol] += (fees - fuel);
+        if (fParallel) {
+            int64_t nParallelStart = GetTimeMicros();
+            vector<CValidationState> txStates(block.vptx.size());
+            CParallelExecStats stats;
+            size_t failedIndex = 0;
+            bool executed = ExecuteTxsInParallel<CCacheWrapper>(parallelExecPool, cw, block.vptx.size() - 1,
+                [&](size_t i) { return block.vptx[i + 1]->IsParallelExecutable(); },
+                [&](size_t i, CCacheWrapper &txCw) {
+                    txStates[i + 1] = CValidationState();
+                    CTxExecuteContext context(pIndex->height, i + 1, fuelRate, pIndex->nTime, prevBlockTime, &txCw,
+                                              &txStates[i + 1]);
+                    return block.vptx[i + 1]->ExecuteTx(context);
+                },
+                [&](size_t i, CDBOpLogMap &undoLogs) {
+                    CTxUndo txUndo(block.vptx[i + 1]->GetHash());
+                    txUndo.dbOpLogMap = undoLogs;
+                    blockUndo.vtxundo.push_back(txUndo);
+                    return commitTx(i + 1);
+                },
+                failedIndex, stats);
+
+            if (!executed) {
+                if (!state.IsValid())  // failed to account the tx
+                    return false;
 
-            pos.nTxOffset += ::GetSerializeSize(pBaseTx, SER_DISK, CLIENT_VERSION);
+                std::shared_ptr<CBaseTx> &pBaseTx = block.vptx[failedIndex + 1];
+                state = txStates[failedIndex + 1];
+                pCdMan->pLogCache->SetExecuteFail(pIndex->height, pBaseTx->GetHash(), state.GetRejectCode(),
+                                                  state.GetRejectReason());
+                return state.DoS(100, ERRORMSG("ConnectBlock() : txid=%s execute failed, in detail: %s",
+                                 pBaseTx->GetHash().GetHex(), pBaseTx->ToString(cw.accountCache)), REJECT_INVALID, "tx-execute-failed");
+            }
 
-            LogPrint(BCLog::DEBUG, "total fuel fee:%d, tx fuel fee:%d runStep:%d fuelRate:%d txid:%s\n", totalFuel,
-                     fuel, pBaseTx->nRunStep, fuelRate, pBaseTx->GetHash().GetHex());
+            if (SysCfg().IsBenchmark())
+                LogPrint(BCLog::INFO, "- Execute %u txs in parallel with %d threads, %u re-executed, %u serial: %.2fms\n",
+                         stats.parallelCount, parallelExecPool.GetThreadCount(), stats.reexecutedCount,
+                         stats.serialCount, (GetTimeMicros() - nParallelStart) * 0.001);
         }
     }
 
@@ -1297,8 +1427,8 @@ bool ConnectBlock(CBlock &block, CCacheWrapper &cw, CBlockIndex *pIndex, CValida
     return true;
 }
 
-// Update the on-disk chain state.
-bool static WriteChainState(CValidationState &state) {
+// Update the on-disk chain state, pIndexTip is the tip of the state.
+bool static WriteChainState(CValidationState &state, const CBlockIndex *pIndexTip) {
     static int64_t nLastWrite = 0;
     uint32_t cacheSize        =
         pCdMan->pSysParamCache->GetCacheSize() +
@@ -1328,6 +1458,14 @@ bool static WriteChainState(CValidationState &state) {
         pCdMan->Flush();
         mapForkCache.clear();
         nLastWrite = GetTimeMicros();
+
+        // the read-only RPCs read the flushed state of the tip without cs_main
+        if (pIndexTip != nullptr)
+            stateSnapshots.Take(*pCdMan, pIndexTip);
+        else
+            stateSnapshots.Clear();
+    } else {
+        stateSnapshots.Clear();
     }
     return true;
 }
@@ -1337,6 +1475,7 @@ void static UpdateTip(CBlockIndex *pIndexNew, const CBlock &block) {
     chainActive.SetTip(pIndexNew);
 
     SyncTransaction(uint256(), nullptr, &block);
+    NotifyBlockTemplateChanged();
 
     // Update best block in wallet (so we can detect restored wallets)
     bool fIsInitialDownload = IsInitialBlockDownload();
@@ -1398,7 +1537,7 @@ bool static DisconnectTip(CValidationState &state) {
     if (SysCfg().IsBenchmark())
         LogPrint(BCLog::INFO, "- Disconnect: %.2fms\n", (GetTimeMicros() - nStart) * 0.001);
     // Write the chain state to disk, if necessary.
-    if (!WriteChainState(state))
+    if (!WriteChainState(state, pIndexDelete->pprev))
         return false;
     // Update chainActive and related variables.
     UpdateTip(pIndexDelete->pprev, block);
@@ -1444,23 +1583,26 @@ bool static ConnectTip(CValidationState &state, CBlockIndex *pIndexNew) {
             mapBlockSource.erase(inv.hash);
         }
 
-        // Need to re-sync all to global cache layer.
+        // Need to re-sync all to global cache layer, the writes are logged for the mempool rescan.
+        CDbAccessLog blockAccessLog;
+        spCW->SetDbAccessLog(&blockAccessLog);
         spCW->Flush();
+
+        uint256 prevBlockHash = pIndexNew->pprev != nullptr ? pIndexNew->pprev->GetBlockHash() : uint256();
+        mempool.BlockConnected(prevBlockHash, pIndexNew->GetBlockHash(), blockAccessLog);
     }
 
     if (SysCfg().IsBenchmark())
         LogPrint(BCLog::INFO, "- Connect: %.2fms\n", (GetTimeMicros() - nStart) * 0.001);
 
     // Write the chain state to disk, if necessary.
-    if (!WriteChainState(state))
+    if (!WriteChainState(state, pIndexNew))
         return false;
 
     // Update chainActive & related variables.
     UpdateTip(pIndexNew, block);
 
-    for (auto &pTxItem : block.vptx) {
-        mempool.memPoolTxs.erase(pTxItem->GetHash());
-    }
+    mempool.RemoveConfirmed(block);
     return true;
 }
 
@@ -2039,11 +2181,28 @@ bool AcceptBlock(CBlock &block, CValidationState &state, CDiskBlockPos *dbp, boo
     CBlockIndex* pTip = chainActive.Tip() ;
     if (pTip->GetBlockHash() == blockHash) {
         {
+            // the peers supporting the compact blocks reconstruct the new block from their mempools, the messages
+            // are serialized once per send version and shared by the send queues of the peers of the version
+            map<int32_t, CSharedMessage> cmpctBlockMsgs;
+            map<int32_t, CSharedMessage> blockMsgs;
+
             LOCK(cs_vNodes);
             for (auto pNode : vNodes) {
                 //p2p_xiaoyu_20191116
                 if (mining) {
-                    pNode->PushMessage(NetMsgType::BLOCK, block);
+                    int32_t nSendVersion = pNode->GetSendVersion();
+                    if (pNode->fSupportsCompactBlocks) {
+                        CSharedMessage &spCmpctBlockMsg = cmpctBlockMsgs[nSendVersion];
+                        if (!spCmpctBlockMsg)
+                            spCmpctBlockMsg = MakeSharedMessage(NetMsgType::CMPCTBLOCK, CBlockHeaderAndShortTxIDs(block),
+                                                                nSendVersion);
+                        pNode->PushSharedMessage(spCmpctBlockMsg);
+                    } else {
+                        CSharedMessage &spBlockMsg = blockMsgs[nSendVersion];
+                        if (!spBlockMsg)
+                            spBlockMsg = MakeSharedMessage(NetMsgType::BLOCK, block, nSendVersion);
+                        pNode->PushSharedMessage(spBlockMsg);
+                    }
                     continue;
                 }
                 if (chainActive.Height() > (pNode->nStartingHeight != -1 ? pNode->nStartingHeight - 2000 : 0))
@@ -2185,6 +2344,23 @@ void PushGetBlocksOnCondition(CNode *pNode, CBlockIndex *pIndexBegin, uint256 ha
     }
 }
 
+void PushGetHeaders(CNode *pNode) {
+    AssertLockHeld(cs_main);
+    // the peer continues from the best header if it is on its chain, otherwise from our chain
+    CBlockLocator blockLocator = chainActive.GetLocator();
+    uint256 bestHeaderHash     = headersSync.GetBestHash();
+    if (!bestHeaderHash.IsNull())
+        blockLocator.vHave.insert(blockLocator.vHave.begin(), bestHeaderHash);
+
+    pNode->PushMessage(NetMsgType::GETHEADERS, blockLocator, uint256());
+    {
+        LOCK(cs_mapNodeState);
+        State(pNode->GetId())->nLastHeadersRequest = GetTime();
+    }
+    LogPrint(BCLog::NET, "getheaders from peer %s, best header height=%d\n", pNode->addr.ToString(),
+             headersSync.GetBestHeight());
+}
+
 bool ProcessBlock(CValidationState &state, CNode *pFrom, CBlock *pBlock, CDiskBlockPos *dbp) {
     int64_t llBeginTime = GetTimeMillis();
     // LogPrint(BCLog::INFO, "ProcessBlock() enter:%lld\n", llBeginTime);
@@ -2243,7 +2419,9 @@ bool ProcessBlock(CValidationState &state, CNode *pFrom, CBlock *pBlock, CDiskBl
                      pBlock->GetHeight(), pBlock->GetHash().GetHex(), success ? "keep" : "abandon",
                      chainActive.Height(), chainActive.Tip()->GetBlockHash().GetHex(), mapOrphanBlocksByPrev.size());
 
-            PushGetBlocksOnCondition(pFrom, chainActive.Tip(), GetOrphanRoot(blockHash));
+            // the parents of the block in the header chain are being downloaded from the peers already
+            if (!headersSync.HasHeader(blockHash))
+                PushGetBlocksOnCondition(pFrom, chainActive.Tip(), GetOrphanRoot(blockHash));
         }
         return true;
     }
@@ -29,8 +29,10 @@
 #include "chain/merkletree.h"
 #include "net.h"
 #include "p2p/node.h"
+#include "parallelexec.h"
 #include "persistence/cachewrapper.h"
 #include "sigcache.h"
+#include "sigverify.h"
 #include "tx/tx.h"
 #include "tx/txmempool.h"
 //#include "tx/txserializer.h"
@@ -57,6 +59,7 @@ extern CKeyID nodeKeyId;   // first keyId of the node
 
 class CValidationState;
 class CWalletInterface;
+class CChainEventListener;
 
 struct CNodeStateStats;
 
@@ -65,6 +68,10 @@ struct CMainSignals {
     // Notifies listeners of updated transaction data (passing hash, transaction, and optionally the block it is found
     // in.
     boost::signals2::signal<void(const uint256 &, CBaseTx *, const CBlock *)> SyncTransaction;
+    // Notifies listeners of a transaction rejected by the memory pool.
+    boost::signals2::signal<void(const uint256 &, CBaseTx *, const CValidationState &)> RejectTransaction;
+    // Notifies listeners of the cdps force liquidated by the executed price median tx.
+    boost::signals2::signal<void(const uint256 &, const vector<CUserCDP> &, uint64_t)> ForceLiquidateCdps;
     // Notifies listeners of an erased transaction (currently disabled, requires transaction replacement).
     boost::signals2::signal<void(const uint256 &)> EraseTransaction;
     // Notifies listeners of a new active block chain.
@@ -82,10 +89,16 @@ void RegisterWallet(CWalletInterface *pWalletIn);
 void UnregisterWallet(CWalletInterface *pWalletIn);
 /** Unregister all wallets from core */
 void UnregisterAllWallets();
+/** Register a listener of the chain and the mempool events */
+void RegisterChainEventListener(CChainEventListener *pListenerIn);
+/** Unregister a listener of the chain and the mempool events */
+void UnregisterChainEventListener(CChainEventListener *pListenerIn);
 /** Push an updated transaction to all registered wallets */
 void SyncTransaction(const uint256 &hash, CBaseTx *pBaseTx, const CBlock *pBlock = nullptr);
 /** Erase Tx from wallets **/
 void EraseTransaction(const uint256 &hash);
+/** Notify the cdps force liquidated by the price median tx, the tx may be executed again or not connected */
+void ForceLiquidateCdps(const uint256 &txid, const vector<CUserCDP> &cdps, uint64_t bcoinMedianPrice);
 /** Register with a network node to receive its signals */
 void RegisterNodeSignals(CNodeSignals &nodeSignals);
 /** Unregister a network node */
@@ -121,6 +134,8 @@ bool AcceptToMemoryPool(CTxMemPool &pool, CValidationState &state, CBaseTx *pBas
 
 struct CNodeStateStats {
     int32_t nMisbehavior;
+    int32_t nBlocksInFlight;
+    double downloadRate;
 };
 
 /** Check for standard transaction types
@@ -193,6 +208,7 @@ public:
 extern CChain chainMostWork;
 extern CCacheDBManager *pCdMan;
 extern int32_t nSyncTipHeight;
+extern bool fHeadersFirst;
 extern std::tuple<bool, boost::thread *> RunCoin(int32_t argc, char *argv[]);
 extern string publicIp;
 
@@ -209,6 +225,21 @@ protected:
     friend void ::UnregisterAllWallets();
 };
 
+/**
+ * The listener of the chain and the mempool events, e.g. the RPC event subscriptions. The events are notified under
+ * cs_main: SyncTransaction with the block is the block connected to or disconnected from the tip by UpdateTip, and
+ * without the block the tx accepted to the mempool. ForceLiquidateCdps is notified whenever the price median tx is
+ * executed, e.g. by the miner, and the cdps are confirmed by the block connected with the tx.
+ */
+class CChainEventListener {
+protected:
+    virtual void SyncTransaction(const uint256 &hash, CBaseTx *pBaseTx, const CBlock *pBlock)              = 0;
+    virtual void RejectTransaction(const uint256 &hash, CBaseTx *pBaseTx, const CValidationState &state) = 0;
+    virtual void ForceLiquidateCdps(const uint256 &txid, const vector<CUserCDP> &cdps, uint64_t bcoinMedianPrice) = 0;
+    friend void ::RegisterChainEventListener(CChainEventListener *);
+    friend void ::UnregisterChainEventListener(CChainEventListener *);
+};
+
 /** Functions for validating blocks and updating the block tree */
 
 /** Undo the effects of this block (with given index) on the UTXO set represented by coins.
@@ -250,6 +281,8 @@ void UnloadBlockIndex();
 void PushGetBlocks(CNode *pNode, CBlockIndex *pindexBegin, uint256 hashEnd);
 /** Push getblocks request with different filtering strategies */
 void PushGetBlocksOnCondition(CNode *pNode, CBlockIndex *pindexBegin, uint256 hashEnd);
+/** Push getheaders request from the best header of the headers-first sync */
+void PushGetHeaders(CNode *pNode);
 /** Process an incoming block */
 bool ProcessBlock(CValidationState &state, CNode *pFrom, CBlock *pBlock, CDiskBlockPos *dbp = nullptr);
 /** Print the loaded block tree */
@@ -19,6 +19,9 @@
 #include "p2p/protocol.h"
 
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <boost/circular_buffer.hpp>
 
 extern CWallet *pWalletMain;
@@ -34,13 +37,18 @@ boost::circular_buffer<MinedBlockInfo> minedBlocks(MAX_MINED_BLOCK_COUNT);
 CCriticalSection csMinedBlocks;
 
 
+// the limit time (2s) for packing new block
+static int64_t GetPackBlockDeadline(int64_t startMiningMs, int32_t blockHeight) {
+    return startMiningMs + std::max(1000L, (int64_t)GetBlockInterval(blockHeight) * 1000L - 1000L);
+}
+
 // check the time is not exceed the limit time (2s) for packing new block
 static bool CheckPackBlockTime(int64_t startMiningMs, int32_t blockHeight) {
-    int64_t nowMs  = GetTimeMillis();
-    int64_t limitedTimeMs = std::max(1000L, (int64_t)GetBlockInterval(blockHeight) * 1000L - 1000L);
-    if (nowMs - startMiningMs > limitedTimeMs) {
-        LogPrint(BCLog::MINER, "%s() : pack block time use up! height=%d, start_ms=%lld, now_ms=%lld, limited_time_ms=%lld\n",
-            __FUNCTION__, blockHeight, startMiningMs, nowMs, limitedTimeMs);
+    int64_t nowMs      = GetTimeMillis();
+    int64_t deadlineMs = GetPackBlockDeadline(startMiningMs, blockHeight);
+    if (nowMs > deadlineMs) {
+        LogPrint(BCLog::MINER, "%s() : pack block time use up! height=%d, start_ms=%lld, now_ms=%lld, deadline_ms=%lld\n",
+            __FUNCTION__, blockHeight, startMiningMs, nowMs, deadlineMs);
         return false;
     }
     return true;
@@ -82,29 +90,6 @@ uint32_t GetElementForBurn(CBlockIndex *pIndex) {
     return newFuelRate;
 }
 
-// Sort transactions by priority and fee to decide priority orders to process transactions.
-void GetPriorityTx(int32_t height, set<TxPriority> &txPriorities, const int32_t nFuelRate) {
-    static TokenSymbol feeSymbol;
-    static uint64_t fee    = 0;
-    static uint32_t txSize = 0;
-    static double feePerKb = 0;
-    static double priority = 0;
-
-    for (map<uint256, CTxMemPoolEntry>::iterator mi = mempool.memPoolTxs.begin(); mi != mempool.memPoolTxs.end(); ++mi) {
-        CBaseTx *pBaseTx = mi->second.GetTransaction().get();
-        if (!pBaseTx->IsBlockRewardTx() && !pCdMan->pTxCache->HasTx(pBaseTx->GetHash())) {
-            feeSymbol = std::get<0>(mi->second.GetFees());
-            fee       = std::get<1>(mi->second.GetFees());
-            txSize    = mi->second.GetTxSize();
-            feePerKb  = double(fee - pBaseTx->GetFuel(height, nFuelRate)) / txSize * 1000.0;
-            priority  = mi->second.GetPriority();
-
-            txPriorities.emplace(TxPriority(priority, feePerKb, mi->second.GetTransaction()));
-        }
-    }
-}
-
-
 bool GetCurrentDelegate(const int64_t currentTime, const int32_t currHeight, const VoteDelegateVector &delegates,
                                VoteDelegate &delegate) {
 
@@ -176,6 +161,33 @@ void ShuffleDelegates(const int32_t curHeight, const int64_t blockTime, VoteDele
 }
 
 
+bool VerifyDelegateSignature(const CBlockHeader &header, const CAccount &delegateAccount) {
+    const auto &blockSignature = header.GetSignature();
+    if (blockSignature.size() == 0 || blockSignature.size() > MAX_SIGNATURE_SIZE)
+        return false;
+
+    uint256 blockHash = header.GetHash();
+    return VerifySignature(blockHash, blockSignature, delegateAccount.owner_pubkey) ||
+           VerifySignature(blockHash, blockSignature, delegateAccount.miner_pubkey);
+}
+
+bool VerifyBlockHeaderSignature(const CBlockHeader &header, CCacheWrapper &cw) {
+    VoteDelegateVector delegates;
+    if (!cw.delegateCache.GetActiveDelegates(delegates) || delegates.empty())
+        return false;
+
+    VoteDelegate curDelegate;
+    ShuffleDelegates(header.GetHeight(), header.GetTime(), delegates);
+    if (!GetCurrentDelegate(header.GetTime(), header.GetHeight(), delegates, curDelegate))
+        return false;
+
+    CAccount delegateAccount;
+    if (!cw.accountCache.GetAccount(curDelegate.regid, delegateAccount))
+        return false;
+
+    return VerifyDelegateSignature(header, delegateAccount);
+}
+
 bool VerifyRewardTx(const CBlock *pBlock, CCacheWrapper &cwIn, bool bNeedRunTx, VoteDelegate &curDelegateOut, uint32_t& totalDelegateNumOut) {
     uint32_t maxNonce = SysCfg().GetBlockMaxNonce();
 
@@ -234,16 +246,8 @@ bool VerifyRewardTx(const CBlock *pBlock, CCacheWrapper &cwIn, bool bNeedRunTx,
                             delegateAccount.regid.ToString(), account.regid.ToString());
         }
 
-        const auto &blockHash      = pBlock->GetHash();
-        const auto &blockSignature = pBlock->GetSignature();
-
-        if (blockSignature.size() == 0 || blockSignature.size() > MAX_SIGNATURE_SIZE) {
-            return ERRORMSG("VerifyRewardTx() : invalid block signature size, hash=%s", blockHash.ToString());
-        }
-
-        if (!VerifySignature(blockHash, blockSignature, account.owner_pubkey))
-            if (!VerifySignature(blockHash, blockSignature, account.miner_pubkey))
-                return ERRORMSG("VerifyRewardTx() : verify signature error");
+        if (!VerifyDelegateSignature(*pBlock, account))
+            return ERRORMSG("VerifyRewardTx() : verify signature error, hash=%s", pBlock->GetHash().ToString());
     } else {
         return ERRORMSG("VerifyRewardTx() : failed to get account info, regId=%s", pBlock->vptx[0]->txUid.ToString());
     }
@@ -313,9 +317,8 @@ static bool CreateNewBlockPreStableCoinRelease(CCacheWrapper &cwIn, std::unique_
         uint64_t totalFuel      = 0;
         uint64_t reward         = 0;
 
-        // Calculate && sort transactions from memory pool.
-        set<TxPriority> txPriorities;
-        GetPriorityTx(height, txPriorities, fuelRate);
+        // Transactions of memory pool sorted by priority rules.
+        const set<TxPriority> &txPriorities = mempool.GetTxPriorities(height, fuelRate);
 
         LogPrint(BCLog::MINER, "CreateNewBlockPreStableCoinRelease() : got %lu transaction(s) sorted by priority rules\n",
                  txPriorities.size());
@@ -323,6 +326,8 @@ static bool CreateNewBlockPreStableCoinRelease(CCacheWrapper &cwIn, std::unique_
         // Collect transactions into the block.
         for (auto itor = txPriorities.rbegin(); itor != txPriorities.rend(); ++itor) {
             CBaseTx *pBaseTx = itor->baseTx.get();
+            if (pCdMan->pTxCache->HasTx(pBaseTx->GetHash()))
+                continue;
 
             uint32_t txSize = pBaseTx->GetSerializeSize(SER_NETWORK, PROTOCOL_VERSION);
             if (totalBlockSize + txSize >= nBlockMaxSize) {
@@ -422,141 +427,204 @@ static bool CreateStableCoinGenesisBlock(std::unique_ptr<CBlock> &pBlock) {
     return true;
 }
 
-static bool CreateNewBlockStableCoinRelease(int64_t startMiningMs, CCacheWrapper &cwIn, std::unique_ptr<CBlock> &pBlock) {
-    pBlock->vptx.push_back(std::make_shared<CUCoinBlockRewardTx>());
+// the block packed by the mempool txs, the txs are executed on spCW in the packing order
+struct CBlockTemplate {
+    uint256 prevBlockHash;
+    int32_t height         = 0;
+    uint32_t blockTime     = 0;
+    uint32_t prevBlockTime = 0;
+    uint32_t fuelRate      = 0;
+    CRegID minerRegId;                    // the delegate which the background template is built for
+    std::shared_ptr<CCacheWrapper> spCW;  // the writes of the packed txs
+    vector<std::shared_ptr<CBaseTx>> vptx;  // the packed txs, exclude the block reward tx
+    set<uint256> triedTxids;              // the packed txs and the txs failed to pack
+    bool fPriceMedianTxPacked          = false;
+    uint64_t totalBlockSize            = 0;
+    uint64_t totalRunStep              = 0;
+    uint64_t totalFees                 = 0;
+    uint64_t totalFuel                 = 0;
+    map<TokenSymbol, uint64_t> rewards = {{SYMB::GVC, 0}, {SYMB::WUSD, 0}};
+};
+
+static void InitBlockTemplate(CBlockTemplate &tmpl, CBlockIndex *pIndexPrev, uint32_t blockTime,
+                              const std::shared_ptr<CCacheWrapper> &spCW) {
+    CBlock block;
+    block.vptx.push_back(std::make_shared<CUCoinBlockRewardTx>());
+
+    tmpl.prevBlockHash  = pIndexPrev->GetBlockHash();
+    tmpl.height         = pIndexPrev->height + 1;
+    tmpl.blockTime      = blockTime;
+    tmpl.prevBlockTime  = pIndexPrev->GetBlockTime();
+    tmpl.fuelRate       = GetElementForBurn(pIndexPrev);
+    tmpl.spCW           = spCW;
+    tmpl.totalBlockSize = ::GetSerializeSize(block, SER_NETWORK, PROTOCOL_VERSION);
+}
 
+static uint32_t GetBlockMaxSize() {
     // Largest block you're willing to create:
     uint32_t nBlockMaxSize = SysCfg().GetArg("-blockmaxsize", DEFAULT_BLOCK_MAX_SIZE);
     // Limit to between 1K and MAX_BLOCK_SIZE-1K for sanity:
-    nBlockMaxSize = std::max<uint32_t>(1000, std::min<uint32_t>((MAX_BLOCK_SIZE - 1000), nBlockMaxSize));
+    return std::max<uint32_t>(1000, std::min<uint32_t>((MAX_BLOCK_SIZE - 1000), nBlockMaxSize));
+}
 
-    // Collect memory pool transactions into the block
-    {
-        LOCK2(cs_main, mempool.cs);
+// execute the tx on the template and append it to the packed txs, return false if it is not packed
+static bool PackBlockTx(CBlockTemplate &tmpl, const std::shared_ptr<CBaseTx> &spTx, uint32_t nBlockMaxSize) {
+    CBaseTx *pBaseTx = spTx.get();
+    uint32_t txSize  = pBaseTx->GetSerializeSize(SER_NETWORK, PROTOCOL_VERSION);
+    if (tmpl.totalBlockSize + txSize >= nBlockMaxSize) {
+        LogPrint(BCLog::MINER, "PackBlockTx() : exceed max block size, txid: %s\n", pBaseTx->GetHash().GetHex());
+        return false;
+    }
 
-        CBlockIndex *pIndexPrev            = chainActive.Tip();
-        uint32_t blockTime                 = pBlock->GetTime();
-        int32_t height                     = pIndexPrev->height + 1;
-        int32_t index                      = 0; // 0: block reward tx
-        uint32_t fuelRate                  = GetElementForBurn(pIndexPrev);
-        uint64_t totalBlockSize            = ::GetSerializeSize(*pBlock, SER_NETWORK, PROTOCOL_VERSION);
-        uint64_t totalRunStep              = 0;
-        uint64_t totalFees                 = 0;
-        uint64_t totalFuel                 = 0;
-        map<TokenSymbol, uint64_t> rewards = {{SYMB::GVC, 0}, {SYMB::WUSD, 0}};
-
-        // Calculate && sort transactions from memory pool.
-        set<TxPriority> txPriorities;
-        GetPriorityTx(height, txPriorities, fuelRate);
-
-        // Push block price median transaction into queue.
-        txPriorities.emplace(TxPriority(PRICE_MEDIAN_TRANSACTION_PRIORITY, 0, std::make_shared<CBlockPriceMedianTx>(height)));
-
-        LogPrint(BCLog::MINER, "CreateNewBlockStableCoinRelease() : got %lu transaction(s) sorted by priority rules\n",
-                 txPriorities.size());
+    auto spCW = std::make_shared<CCacheWrapper>(tmpl.spCW.get());
 
-        // Collect transactions into the block.
-        for (auto itor = txPriorities.rbegin(); itor != txPriorities.rend(); ++itor) {
+    try {
+        CValidationState state;
 
-            if (!CheckPackBlockTime(startMiningMs, height)) {
-                LogPrint(BCLog::MINER, "%s() : no time left to pack more tx, ignore! height=%d, start_ms=%lld, tx_count=%u\n",
-                    __FUNCTION__, height, startMiningMs, pBlock->vptx.size());
-                break;
-            }
+        pBaseTx->nFuelRate = tmpl.fuelRate;
 
-            CBaseTx *pBaseTx = itor->baseTx.get();
+        LogPrint(BCLog::MINER, "PackBlockTx() : begin to pack transaction: %s\n", pBaseTx->ToString(spCW->accountCache));
 
-            uint32_t txSize = pBaseTx->GetSerializeSize(SER_NETWORK, PROTOCOL_VERSION);
-            if (totalBlockSize + txSize >= nBlockMaxSize) {
-                LogPrint(BCLog::MINER, "CreateNewBlockStableCoinRelease() : exceed max block size, txid: %s\n",
-                         pBaseTx->GetHash().GetHex());
-                continue;
-            }
+        CTxExecuteContext context(tmpl.height, tmpl.vptx.size() + 1, tmpl.fuelRate, tmpl.blockTime, tmpl.prevBlockTime,
+                                  spCW.get(), &state, transaction_status_type::mining);
+        if (!pBaseTx->CheckTx(context) || !pBaseTx->ExecuteTx(context)) {
+            LogPrint(BCLog::MINER, "PackBlockTx() : failed to pack transaction: %s\n",
+                     pBaseTx->ToString(spCW->accountCache));
 
-            auto spCW = std::make_shared<CCacheWrapper>(&cwIn);
+            pCdMan->pLogCache->SetExecuteFail(tmpl.height, pBaseTx->GetHash(), state.GetRejectCode(),
+                                              state.GetRejectReason());
+            return false;
+        }
 
-            try {
-                CValidationState state;
+        // Run step limits
+        if (tmpl.totalRunStep + pBaseTx->nRunStep >= MAX_BLOCK_RUN_STEP) {
+            LogPrint(BCLog::MINER, "PackBlockTx() : exceed max block run steps, txid: %s\n",
+                     pBaseTx->GetHash().GetHex());
+            return false;
+        }
+    } catch (std::exception &e) {
+        LogPrint(BCLog::ERROR, "PackBlockTx() : unexpected exception: %s\n", e.what());
+        return false;
+    }
 
-                pBaseTx->nFuelRate = fuelRate;
+    spCW->Flush();
 
-                // Special case for price median tx,
-                if (pBaseTx->IsPriceMedianTx()) {
-                    CBlockPriceMedianTx *pPriceMedianTx = (CBlockPriceMedianTx *)itor->baseTx.get();
+    auto fuel        = pBaseTx->GetFuel(tmpl.height, tmpl.fuelRate);
+    auto fees_symbol = std::get<0>(pBaseTx->GetFees());
+    auto fees        = std::get<1>(pBaseTx->GetFees());
+    assert(fees_symbol == SYMB::GVC || fees_symbol == SYMB::WUSD);
 
-                    PriceMap medianPrices;
-                    if (!spCW->ppCache.CalcBlockMedianPrices(*spCW, height, medianPrices))
-                        return ERRORMSG("%s(), calculate block median prices error", __func__);
+    tmpl.totalBlockSize += txSize;
+    tmpl.totalRunStep += pBaseTx->nRunStep;
+    tmpl.totalFuel += fuel;
+    tmpl.totalFees += fees;
+    assert(fees >= fuel);
+    tmpl.rewards[fees_symbol] += (fees - fuel);
 
-                    pPriceMedianTx->SetMedianPrices(medianPrices);
-                }
+    tmpl.vptx.push_back(spTx);
 
-                LogPrint(BCLog::MINER, "CreateNewBlockStableCoinRelease() : begin to pack transaction: %s\n",
-                         pBaseTx->ToString(spCW->accountCache));
+    LogPrint(BCLog::DEBUG, "miner total fuel fee:%d, tx fuel fee:%d, fuel:%d, fuelRate:%d, txid:%s\n", tmpl.totalFuel,
+             fuel, pBaseTx->nRunStep, tmpl.fuelRate, pBaseTx->GetHash().GetHex());
+    return true;
+}
 
-                uint32_t prevBlockTime = pIndexPrev->GetBlockTime();
-                CTxExecuteContext context(height, index + 1, fuelRate, blockTime, prevBlockTime, spCW.get(), &state, transaction_status_type::mining);
-                if (!pBaseTx->CheckTx(context) || !pBaseTx->ExecuteTx(context)) {
-                    LogPrint(BCLog::MINER, "CreateNewBlockStableCoinRelease() : failed to pack transaction: %s\n",
-                             pBaseTx->ToString(spCW->accountCache));
+// pack the mempool txs sorted by priority into the template until the deadline, the txs tried by the
+// template before are skipped, so the template can be packed again when new txs arrive
+static bool PackMempoolTxs(CBlockTemplate &tmpl, uint32_t nBlockMaxSize, int64_t deadlineMs) {
+    AssertLockHeld(cs_main);
+    AssertLockHeld(mempool.cs);
+
+    // Transactions of memory pool sorted by priority rules.
+    const set<TxPriority> &txPriorities = mempool.GetTxPriorities(tmpl.height, tmpl.fuelRate);
+
+    // Block price median transaction, it is merged into the sorted transactions by priority.
+    TxPriority priceMedianTxPriority(PRICE_MEDIAN_TRANSACTION_PRIORITY, 0,
+                                     std::make_shared<CBlockPriceMedianTx>(tmpl.height));
+
+    // Collect transactions into the block. The price median tx is marked packed only if it is packed, the
+    // template is packed again by the next call, which tries the price median tx again.
+    bool fPriceMedianTxTried = tmpl.fPriceMedianTxPacked;
+    auto txItor = txPriorities.rbegin();
+    while (!fPriceMedianTxTried || txItor != txPriorities.rend()) {
+        if (GetTimeMillis() > deadlineMs) {
+            LogPrint(BCLog::MINER, "%s() : no time left to pack more tx, ignore! height=%d, deadline_ms=%lld, tx_count=%u\n",
+                __FUNCTION__, tmpl.height, deadlineMs, tmpl.vptx.size() + 1);
+            break;
+        }
 
-                    pCdMan->pLogCache->SetExecuteFail(height, pBaseTx->GetHash(), state.GetRejectCode(),
-                                                      state.GetRejectReason());
-                    continue;
-                }
+        const TxPriority *itor;
+        if (!fPriceMedianTxTried && (txItor == txPriorities.rend() || *txItor < priceMedianTxPriority)) {
+            itor                = &priceMedianTxPriority;
+            fPriceMedianTxTried = true;
+        } else {
+            itor = &*txItor++;
+        }
 
-                // Run step limits
-                if (totalRunStep + pBaseTx->nRunStep >= MAX_BLOCK_RUN_STEP) {
-                    LogPrint(BCLog::MINER, "CreateNewBlockStableCoinRelease() : exceed max block run steps, txid: %s\n",
-                            pBaseTx->GetHash().GetHex());
-                    continue;
-                }
-            } catch (std::exception &e) {
-                LogPrint(BCLog::ERROR, "CreateNewBlockStableCoinRelease() : unexpected exception: %s\n", e.what());
+        CBaseTx *pBaseTx = itor->baseTx.get();
+        if (pBaseTx->IsPriceMedianTx()) {
+            // Special case for price median tx,
+            CBlockPriceMedianTx *pPriceMedianTx = (CBlockPriceMedianTx *)pBaseTx;
 
+            auto spCW = std::make_shared<CCacheWrapper>(tmpl.spCW.get());
+            PriceMap medianPrices;
+            if (!spCW->ppCache.CalcBlockMedianPrices(*spCW, tmpl.height, medianPrices))
+                return ERRORMSG("%s(), calculate block median prices error", __func__);
+
+            pPriceMedianTx->SetMedianPrices(medianPrices);
+        } else {
+            if (!tmpl.triedTxids.insert(pBaseTx->GetHash()).second || pCdMan->pTxCache->HasTx(pBaseTx->GetHash()))
                 continue;
-            }
+        }
 
-            spCW->Flush();
+        bool fPacked = PackBlockTx(tmpl, itor->baseTx, nBlockMaxSize);
+        if (pBaseTx->IsPriceMedianTx())
+            tmpl.fPriceMedianTxPacked = fPacked;
+    }
 
-            auto fuel        = pBaseTx->GetFuel(height, fuelRate);
-            auto fees_symbol = std::get<0>(pBaseTx->GetFees());
-            auto fees        = std::get<1>(pBaseTx->GetFees());
-            assert(fees_symbol == SYMB::GVC || fees_symbol == SYMB::WUSD);
+    return true;
+}
 
-            totalBlockSize += txSize;
-            totalRunStep += pBaseTx->nRunStep;
-            totalFuel += fuel;
-            totalFees += fees;
-            assert(fees >= fuel);
-            rewards[fees_symbol] += (fees - fuel);
+static void FillBlockFromTemplate(const CBlockTemplate &tmpl, std::unique_ptr<CBlock> &pBlock) {
+    pBlock->vptx.insert(pBlock->vptx.end(), tmpl.vptx.begin(), tmpl.vptx.end());
 
-            ++index;
+    nLastBlockTx                   = pBlock->vptx.size();
+    nLastBlockSize                 = tmpl.totalBlockSize;
 
-            pBlock->vptx.push_back(itor->baseTx);
+    ((CUCoinBlockRewardTx *)pBlock->vptx[0].get())->reward_fees = tmpl.rewards;
 
-            LogPrint(BCLog::DEBUG, "miner total fuel fee:%d, tx fuel fee:%d, fuel:%d, fuelRate:%d, txid:%s\n", totalFuel,
-                     pBaseTx->GetFuel(height, fuelRate), pBaseTx->nRunStep, fuelRate, pBaseTx->GetHash().GetHex());
+    // Fill in header
+    pBlock->SetPrevBlockHash(tmpl.prevBlockHash);
+    pBlock->SetNonce(0);
+    pBlock->SetHeight(tmpl.height);
+    pBlock->SetFuel(tmpl.totalFuel);
+    pBlock->SetFuelRate(tmpl.fuelRate);
 
-        }
+    LogPrint(BCLog::INFO, "FillBlockFromTemplate() : height=%d, tx=%d, totalBlockSize=%llu\n", tmpl.height,
+             pBlock->vptx.size(), tmpl.totalBlockSize);
+}
 
-        nLastBlockTx                   = index + 1;
-        nLastBlockSize                 = totalBlockSize;
+// finalise the template with the mempool txs arrived after it was packed
+static bool CreateNewBlockFromTemplate(int64_t startMiningMs, CBlockTemplate &tmpl, std::unique_ptr<CBlock> &pBlock) {
+    pBlock->vptx.push_back(std::make_shared<CUCoinBlockRewardTx>());
+
+    LOCK2(cs_main, mempool.cs);
+    if (!PackMempoolTxs(tmpl, GetBlockMaxSize(), GetPackBlockDeadline(startMiningMs, tmpl.height)))
+        return false;
 
-        ((CUCoinBlockRewardTx *)pBlock->vptx[0].get())->reward_fees = rewards;
+    FillBlockFromTemplate(tmpl, pBlock);
+    return true;
+}
 
-        // Fill in header
-        pBlock->SetPrevBlockHash(pIndexPrev->GetBlockHash());
-        pBlock->SetNonce(0);
-        pBlock->SetHeight(height);
-        pBlock->SetFuel(totalFuel);
-        pBlock->SetFuelRate(fuelRate);
+static bool CreateNewBlockStableCoinRelease(int64_t startMiningMs, CCacheWrapper &cwIn, std::unique_ptr<CBlock> &pBlock) {
+    LOCK2(cs_main, mempool.cs);
 
-        LogPrint(BCLog::INFO, "CreateNewBlockStableCoinRelease() : height=%d, tx=%d, totalBlockSize=%llu\n", height, index + 1,
-                 totalBlockSize);
-    }
+    CBlockTemplate tmpl;
+    InitBlockTemplate(tmpl, chainActive.Tip(), pBlock->GetTime(), std::make_shared<CCacheWrapper>(&cwIn));
 
-    return true;
+    LogPrint(BCLog::MINER, "CreateNewBlockStableCoinRelease() : got %lu transaction(s) sorted by priority rules\n",
+             mempool.memPoolTxs.size() + 1);
+
+    return CreateNewBlockFromTemplate(startMiningMs, tmpl, pBlock);
 }
 
 bool CheckWork(CBlock *pBlock) {
@@ -621,6 +689,142 @@ static bool GetMiner(int64_t startMiningMs, const int32_t blockHeight, Miner &mi
 }
 
 
+static bool IsSameSlot(int64_t time1, int64_t time2, int32_t blockHeight) {
+    int64_t slotTime = GetBlockInterval(blockHeight) * GetContinuousBlockCount(blockHeight);
+    return time1 / slotTime == time2 / slotTime;
+}
+
+// the template pre-packed by the background builder for the next block, guarded by cs_main
+static std::shared_ptr<CBlockTemplate> spBlockTemplate;
+
+// the builder is woken up by the change of mempool or tip
+static std::mutex csBlockTemplateChanged;
+static std::condition_variable cvBlockTemplateChanged;
+static bool fBlockTemplateChanged = false;
+
+void NotifyBlockTemplateChanged() {
+    {
+        std::lock_guard<std::mutex> lock(csBlockTemplateChanged);
+        fBlockTemplateChanged = true;
+    }
+    cvBlockTemplateChanged.notify_one();
+}
+
+// find the earliest slot of the delegates in wallet to produce the next block of tip, the block time
+// is the time which the miner thread will produce the block at
+static bool GetNextMinerSlot(CBlockIndex *pTip, Miner &miner, int64_t &blockTime) {
+    int32_t blockHeight = pTip->height + 1;
+    int64_t slotTime    = GetBlockInterval(blockHeight) * GetContinuousBlockCount(blockHeight);
+    int64_t time        = std::max<int64_t>(pTip->GetBlockTime() + GetBlockInterval(blockHeight), GetTime());
+
+    uint32_t totalDelegateNum = 0;
+    for (uint32_t i = 0; i == 0 || i < totalDelegateNum; i++) {
+        if (GetMiner(time * 1000, blockHeight, miner, totalDelegateNum)) {
+            blockTime = time;
+            return true;
+        }
+        time = (time / slotTime + 1) * slotTime;
+    }
+    return false;
+}
+
+// whether the mempool has the price feed txs not tried by the template, they must be packed before
+// the price median tx, so the template is packed again from the beginning
+static bool HasNewPriceFeedTx(const CBlockTemplate &tmpl) {
+    const set<TxPriority> &txPriorities = mempool.GetTxPriorities(tmpl.height, tmpl.fuelRate);
+    for (auto itor = txPriorities.rbegin(); itor != txPriorities.rend(); ++itor) {
+        if (itor->priority <= PRICE_MEDIAN_TRANSACTION_PRIORITY)
+            break;
+        if (!tmpl.triedTxids.count(itor->baseTx->GetHash()))
+            return true;
+    }
+    return false;
+}
+
+static void UpdateBlockTemplate() {
+    LOCK(cs_main);
+
+    CBlockIndex *pTip = chainActive.Tip();
+    if (pTip == nullptr || SysCfg().IsReindex())
+        return;
+
+    int32_t blockHeight = pTip->height + 1;
+    if (blockHeight == (int32_t)SysCfg().GetStableCoinGenesisHeight() ||
+        GetFeatureForkVersion(blockHeight) == MAJOR_VER_R1) {
+        spBlockTemplate = nullptr;
+        return;
+    }
+
+    // the slot is found before locking mempool, GetMiner() locks the wallet
+    auto spOldTemplate = spBlockTemplate;
+    if (!spOldTemplate || spOldTemplate->prevBlockHash != pTip->GetBlockHash() ||
+        spOldTemplate->fuelRate != GetElementForBurn(pTip) ||
+        (!spOldTemplate->minerRegId.IsEmpty() && spOldTemplate->blockTime < GetTime() &&
+         !IsSameSlot(spOldTemplate->blockTime, GetTime(), blockHeight))) {
+        Miner miner;
+        int64_t blockTime = 0;
+        if (!GetNextMinerSlot(pTip, miner, blockTime))
+            miner.account.regid.SetEmpty();
+
+        spOldTemplate   = nullptr;
+        spBlockTemplate = std::make_shared<CBlockTemplate>();
+        InitBlockTemplate(*spBlockTemplate, pTip, blockTime, std::make_shared<CCacheWrapper>(pCdMan));
+        spBlockTemplate->minerRegId = miner.account.regid;
+        if (!spBlockTemplate->minerRegId.IsEmpty())
+            LogPrint(BCLog::MINER, "UpdateBlockTemplate() : new template, height=%d, block_time=%u, regid=%s\n",
+                     blockHeight, blockTime, spBlockTemplate->minerRegId.ToString());
+    }
+
+    if (spBlockTemplate->minerRegId.IsEmpty())
+        return;  // no delegate in wallet to produce the next block
+
+    // the template of a later slot is dropped by the tip change before the slot, so only the template
+    // of the upcoming slot is packed
+    int64_t slotTime = GetBlockInterval(blockHeight) * GetContinuousBlockCount(blockHeight);
+    if ((int64_t)spBlockTemplate->blockTime > GetTime() + slotTime)
+        return;
+
+    {
+        LOCK(mempool.cs);
+        if (spOldTemplate && spOldTemplate->fPriceMedianTxPacked && HasNewPriceFeedTx(*spOldTemplate)) {
+            spBlockTemplate = std::make_shared<CBlockTemplate>();
+            InitBlockTemplate(*spBlockTemplate, pTip, spOldTemplate->blockTime, std::make_shared<CCacheWrapper>(pCdMan));
+            spBlockTemplate->minerRegId = spOldTemplate->minerRegId;
+        }
+
+        if (!PackMempoolTxs(*spBlockTemplate, GetBlockMaxSize(), GetTimeMillis() + BLOCK_TEMPLATE_PACK_TIME_MS))
+            spBlockTemplate->minerRegId.SetEmpty();  // let the miner create the block by itself
+    }
+}
+
+void static ThreadBuildBlockTemplate() {
+    LogPrint(BCLog::INFO, "ThreadBuildBlockTemplate() : started\n");
+
+    RenameThread("Coin-template");
+
+    try {
+        while (true) {
+            boost::this_thread::interruption_point();
+            {
+                // the timeout follows the slot time and checks the interruption
+                std::unique_lock<std::mutex> lock(csBlockTemplateChanged);
+                cvBlockTemplateChanged.wait_for(lock, std::chrono::milliseconds(BLOCK_TEMPLATE_UPDATE_INTERVAL_MS),
+                                                [] { return fBlockTemplateChanged; });
+                fBlockTemplateChanged = false;
+            }
+
+            UpdateBlockTemplate();
+        }
+    } catch (...) {
+        LogPrint(BCLog::INFO, "ThreadBuildBlockTemplate() : terminated\n");
+        {
+            LOCK(cs_main);
+            spBlockTemplate = nullptr;
+        }
+        throw;
+    }
+}
+
 static bool ProduceBlock(int64_t startMiningMs, CBlockIndex *pPrevIndex, Miner &miner, const uint32_t totalDelegateNum) {
     int64_t lastTime    = 0;
     bool success        = false;
@@ -650,9 +854,21 @@ static bool ProduceBlock(int64_t startMiningMs, CBlockIndex *pPrevIndex, Miner &
         lastTime  = GetTimeMillis();
         auto spCW = std::make_shared<CCacheWrapper>(pCdMan);
 
-        pBlock->SetTime(MillisToSecond(startMiningMs));  // set block time first
-
-        if (blockHeight == (int32_t)SysCfg().GetStableCoinGenesisHeight()) {
+        // the template pre-packed for this slot is used with its block time
+        auto spTemplate   = spBlockTemplate;
+        bool fUseTemplate = spTemplate && spTemplate->prevBlockHash == pPrevIndex->GetBlockHash() &&
+                            spTemplate->minerRegId == miner.account.regid &&
+                            spTemplate->blockTime <= MillisToSecond(startMiningMs) &&
+                            IsSameSlot(spTemplate->blockTime, MillisToSecond(startMiningMs), blockHeight);
+        spBlockTemplate = nullptr;
+
+        pBlock->SetTime(fUseTemplate ? spTemplate->blockTime : MillisToSecond(startMiningMs));  // set block time first
+
+        if (fUseTemplate) {
+            LogPrint(BCLog::MINER, "ProduceBlock() : use block template, height=%d, tx_count=%u\n", blockHeight,
+                     spTemplate->vptx.size() + 1);
+            success = CreateNewBlockFromTemplate(startMiningMs, *spTemplate, pBlock);
+        } else if (blockHeight == (int32_t)SysCfg().GetStableCoinGenesisHeight()) {
             success = CreateStableCoinGenesisBlock(pBlock);  // stable coin genesis
         } else if (GetFeatureForkVersion(blockHeight) == MAJOR_VER_R1) {
             success = CreateNewBlockPreStableCoinRelease(*spCW, pBlock); // pre-stable coin release
@@ -827,6 +1043,8 @@ void GenerateProduceBlockThread(bool fGenerate, CWallet *pWallet, int32_t target
 
     minerThreads = new boost::thread_group();
     minerThreads->create_thread(boost::bind(&ThreadProduceBlocks, pWallet, targetHeight));
+    if (SysCfg().GetBoolArg("-blocktemplate", DEFAULT_BLOCK_TEMPLATE))
+        minerThreads->create_thread(&ThreadBuildBlockTemplate);
 }
 
 void MinedBlockInfo::SetNull() {
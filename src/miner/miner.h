@@ -18,6 +18,7 @@
 #include "tx/tx.h"
 
 class CBlock;
+class CBlockHeader;
 class CBlockIndex;
 class CWallet;
 class CBaseTx;
@@ -33,33 +34,18 @@ using namespace std;
 // ThreadProduceBlocks
 //
 
+static const bool DEFAULT_BLOCK_TEMPLATE                = true;
+// the max wait of the template builder without the change of mempool or tip
+static const int64_t BLOCK_TEMPLATE_UPDATE_INTERVAL_MS = 1000;
+// the max time of holding cs_main to pack the template in each update
+static const int64_t BLOCK_TEMPLATE_PACK_TIME_MS       = 100;
+
 struct Miner {
     VoteDelegate delegate;
     CAccount account;
     CKey key;
 };
 
-struct TxPriority {
-    double priority;
-    double feePerKb;
-    std::shared_ptr<CBaseTx> baseTx;
-
-    TxPriority(const double priorityIn, const double feePerKbIn, const std::shared_ptr<CBaseTx> &baseTxIn)
-        : priority(priorityIn), feePerKb(feePerKbIn), baseTx(baseTxIn) {}
-
-    bool operator<(const TxPriority &other) const {
-        if (fabs(this->priority - other.priority) <= 1000) {
-            if (fabs(this->feePerKb < other.feePerKb) <= 1e-8) {
-                return this->baseTx->GetHash() < other.baseTx->GetHash();
-            } else {
-                return this->feePerKb < other.feePerKb;
-            }
-        } else {
-            return this->priority < other.priority;
-        }
-    }
-};
-
 // mined block info
 class MinedBlockInfo {
 public:
@@ -82,8 +68,15 @@ public:
 // get the info of mined blocks. thread safe.
 vector<MinedBlockInfo> GetMinedBlocks(uint32_t count);
 
-/** Run the miner threads */
+/** Run the miner threads, the block template is pre-packed in background if -blocktemplate */
 void GenerateProduceBlockThread(bool fGenerate, CWallet *pWallet, int32_t nThreads);
+// called when the mempool or the tip is changed, the block template is rebuilt on it
+void NotifyBlockTemplateChanged();
+
+// the block is signed by the owner key or the miner key of the delegate
+bool VerifyDelegateSignature(const CBlockHeader &header, const CAccount &delegateAccount);
+// the block is signed by the delegate of its slot, cw is the state of the prev block
+bool VerifyBlockHeaderSignature(const CBlockHeader &header, CCacheWrapper &cw);
 
 bool VerifyRewardTx(const CBlock *pBlock, CCacheWrapper &cwIn, bool bNeedRunTx, VoteDelegate &curDelegateOut, uint32_t& totalDelegateNumOut);
 
@@ -93,8 +86,6 @@ bool CheckWork(CBlock *pBlock);
 /** Get burn element */
 uint32_t GetElementForBurn(CBlockIndex *pIndex);
 
-void GetPriorityTx(vector<TxPriority> &vecPriority, int32_t nFuelRate);
-
 void ShuffleDelegates(const int32_t nCurHeight, const int64_t blockTime,
         VoteDelegateVector &delegates);
 
@@ -15,6 +15,7 @@
 #include "tx/tx.h"
 #include "commons/util/time.h"
 #include "p2p/node.h"
+#include "p2p/socketevents.h"
 
 #ifdef WIN32
 #include <string.h>
@@ -35,6 +36,7 @@
 
 #include <fstream>
 #include <sstream>
+#include <unordered_map>
 #include <string>
 #include <thread>
 
@@ -78,7 +80,7 @@ CNodeSignals& GetNodeSignals() { return g_node_signals; }
 
 vector<CNode*> vNodes;
 CCriticalSection cs_vNodes;
-map<CInv, CDataStream> mapRelay;
+map<CInv, CSharedMessage> mapRelay;
 deque<pair<int64_t, CInv> > vRelayExpiration;
 CCriticalSection cs_mapRelay;
 
@@ -445,6 +447,13 @@ CNode* ConnectNode(CAddress addrConnect, const char* pszDest) {
                 : ConnectSocket(addrConnect, hSocket)) {
         addrman.Attempt(addrConnect);
 
+        if (!socketEvents.IsSocketSupported(hSocket)) {
+            LogPrint(BCLog::INFO, "connection to %s dropped, socket %d beyond FD_SETSIZE of select\n",
+                     pszDest ? pszDest : addrConnect.ToString(), hSocket);
+            closesocket(hSocket);
+            return nullptr;
+        }
+
         LogPrint(BCLog::NET, "connected %s\n", pszDest ? pszDest : addrConnect.ToString());
 
         // Set to non-blocking
@@ -542,34 +551,35 @@ void ThreadSocketHandler() {
         //
         // Find which sockets have data to receive
         //
-        struct timeval timeout;
-        timeout.tv_sec  = 0;
-        timeout.tv_usec = 50000;  // frequency to poll pNode->vSend
-
-        fd_set fdsetRecv;
-        fd_set fdsetSend;
-        fd_set fdsetError;
-        FD_ZERO(&fdsetRecv);
-        FD_ZERO(&fdsetSend);
-        FD_ZERO(&fdsetError);
-        SOCKET hSocketMax = 0;
-        bool have_fds     = false;
-
-        for (auto hListenSocket : vhListenSocket) {
-            FD_SET(hListenSocket, &fdsetRecv);
-            hSocketMax = max(hSocketMax, hListenSocket);
-            have_fds   = true;
-        }
+        int64_t nTimeoutMs = 50;  // frequency to poll pNode->vSend
+        vector<CSocketEvents::CReadySocket> vWanted;
+        if (socketEvents.IsEpoll()) {
+            // the sockets are registered once, the listening sockets are level triggered for accepting one
+            // connection per loop
+            static bool fListenRegistered = false;
+            if (!fListenRegistered) {
+                for (auto hListenSocket : vhListenSocket)
+                    socketEvents.AddSocket(hListenSocket, false);
+                fListenRegistered = true;
+            }
 
-        {
             LOCK(cs_vNodes);
             for (auto pNode : vNodes) {
-                if (pNode->hSocket == INVALID_SOCKET)
+                if (pNode->hSocket == INVALID_SOCKET || pNode->fSocketRegistered)
                     continue;
 
-                FD_SET(pNode->hSocket, &fdsetError);
-                hSocketMax = max(hSocketMax, pNode->hSocket);
-                have_fds   = true;
+                pNode->fSocketRegistered = socketEvents.AddSocket(pNode->hSocket);
+                if (!pNode->fSocketRegistered)
+                    pNode->CloseSocketDisconnect();
+            }
+        } else {
+            for (auto hListenSocket : vhListenSocket)
+                vWanted.push_back({hListenSocket, CSocketEvents::EVENT_RECV});
+
+            LOCK(cs_vNodes);
+            for (auto pNode : vNodes) {
+                if (pNode->hSocket == INVALID_SOCKET)
+                    continue;
 
                 // Implement the following logic:
                 // * If there is data to send, select() for sending data. As this only
@@ -586,42 +596,69 @@ void ThreadSocketHandler() {
                 // * We send some data.
                 // * We wait for data to be received (and disconnect after timeout).
                 // * We process a message in the buffer (message handler thread).
+                uint32_t events = CSocketEvents::EVENT_ERROR;
                 {
                     TRY_LOCK(pNode->cs_vSend, lockSend);
-                    if (lockSend && !pNode->vSendMsg.empty()) {
-                        FD_SET(pNode->hSocket, &fdsetSend);
-                        continue;
-                    }
+                    if (lockSend && !pNode->vSendMsg.empty())
+                        events |= CSocketEvents::EVENT_SEND;
                 }
-                {
+                if (!(events & CSocketEvents::EVENT_SEND)) {
                     TRY_LOCK(pNode->cs_vRecvMsg, lockRecv);
                     if (lockRecv && (pNode->vRecvMsg.empty() || !pNode->vRecvMsg.front().complete() ||
                                      pNode->GetTotalRecvSize() <= ReceiveFloodSize()))
-                        FD_SET(pNode->hSocket, &fdsetRecv);
+                        events |= CSocketEvents::EVENT_RECV;
                 }
+                vWanted.push_back({pNode->hSocket, events});
+
+                // select() reports the readiness of this loop only
+                pNode->fRecvReady = false;
+                pNode->fSendReady = false;
             }
         }
 
-        int32_t nSelect = select(have_fds ? hSocketMax + 1 : 0, &fdsetRecv, &fdsetSend, &fdsetError, &timeout);
+        vector<CSocketEvents::CReadySocket> vReady;
+        int32_t nReady = socketEvents.Wait(vWanted, nTimeoutMs, vReady);
         boost::this_thread::interruption_point();
 
-        if (nSelect == SOCKET_ERROR) {
-            if (have_fds) {
-                int32_t nErr = WSAGetLastError();
-                LogPrint(BCLog::INFO, "socket select error %s\n", NetworkErrorString(nErr));
-                for (uint32_t i = 0; i <= hSocketMax; i++)
-                    FD_SET(i, &fdsetRecv);
+        if (nReady == SOCKET_ERROR) {
+            int32_t nErr = WSAGetLastError();
+            LogPrint(BCLog::INFO, "socket select error %s\n", NetworkErrorString(nErr));
+            MilliSleep(nTimeoutMs);
+        }
+
+        set<SOCKET> setListenReady;
+        {
+            unordered_map<SOCKET, uint32_t> mapReady;
+            for (const auto &ready : vReady)
+                mapReady[ready.hSocket] |= ready.events;
+
+            for (auto hListenSocket : vhListenSocket) {
+                auto it = mapReady.find(hListenSocket);
+                if (it != mapReady.end() && (it->second & CSocketEvents::EVENT_RECV))
+                    setListenReady.insert(hListenSocket);
+            }
+
+            LOCK(cs_vNodes);
+            for (auto pNode : vNodes) {
+                if (pNode->hSocket == INVALID_SOCKET)
+                    continue;
+
+                auto it = mapReady.find(pNode->hSocket);
+                if (it == mapReady.end())
+                    continue;
+
+                if (it->second & (CSocketEvents::EVENT_RECV | CSocketEvents::EVENT_ERROR))
+                    pNode->fRecvReady = true;
+                if (it->second & CSocketEvents::EVENT_SEND)
+                    pNode->fSendReady = true;
             }
-            FD_ZERO(&fdsetSend);
-            FD_ZERO(&fdsetError);
-            MilliSleep(timeout.tv_usec / 1000);
         }
 
         //
         // Accept new connections
         //
         for (auto hListenSocket : vhListenSocket)
-            if (hListenSocket != INVALID_SOCKET && FD_ISSET(hListenSocket, &fdsetRecv)) {
+            if (hListenSocket != INVALID_SOCKET && setListenReady.count(hListenSocket)) {
                 struct sockaddr_storage sockaddr;
                 socklen_t len  = sizeof(sockaddr);
                 SOCKET hSocket = accept(hListenSocket, (struct sockaddr*)&sockaddr, &len);
@@ -648,6 +685,10 @@ void ThreadSocketHandler() {
                 } else if (CNode::IsBanned(addr)) {
                     LogPrint(BCLog::INFO, "connection from %s dropped (banned)\n", addr.ToString());
                     closesocket(hSocket);
+                } else if (!socketEvents.IsSocketSupported(hSocket)) {
+                    LogPrint(BCLog::INFO, "connection from %s dropped, socket %d beyond FD_SETSIZE of select\n",
+                             addr.ToString(), hSocket);
+                    closesocket(hSocket);
                 } else {
                     LogPrint(BCLog::NET, "accepted connection %s\n", addr.ToString());
                     CNode* pNode = new CNode(hSocket, addr, "", true);
@@ -677,10 +718,17 @@ void ThreadSocketHandler() {
             //
             if (pNode->hSocket == INVALID_SOCKET)
                 continue;
-            if (FD_ISSET(pNode->hSocket, &fdsetRecv) || FD_ISSET(pNode->hSocket, &fdsetError)) {
+            if (pNode->fRecvReady) {
                 TRY_LOCK(pNode->cs_vRecvMsg, lockRecv);
-                if (lockRecv) {
-                    {
+                // the same as the select() logic, don't receive more when a complete message is waiting in the
+                // full receive buffer
+                auto fnWantRecv = [&]() {
+                    return pNode->hSocket != INVALID_SOCKET && (pNode->vRecvMsg.empty() ||
+                           !pNode->vRecvMsg.front().complete() || pNode->GetTotalRecvSize() <= ReceiveFloodSize());
+                };
+                if (lockRecv && fnWantRecv()) {
+                    // the edge-triggered socket is read until it would block, or the receive buffer is full
+                    do {
                         // typical socket buffer is 8K-64K
                         char pchBuf[0x10000];
                         int32_t nBytes = recv(pNode->hSocket, pchBuf, sizeof(pchBuf), MSG_DONTWAIT);
@@ -698,14 +746,16 @@ void ThreadSocketHandler() {
                         } else if (nBytes < 0) {
                             // error
                             int32_t nErr = WSAGetLastError();
-                            if (nErr != WSAEWOULDBLOCK && nErr != WSAEMSGSIZE && nErr != WSAEINTR &&
-                                nErr != WSAEINPROGRESS) {
+                            if (nErr == WSAEWOULDBLOCK) {
+                                pNode->fRecvReady = false;
+                            } else if (nErr != WSAEMSGSIZE && nErr != WSAEINTR && nErr != WSAEINPROGRESS) {
                                 if (!pNode->fDisconnect)
                                     LogPrint(BCLog::INFO, "socket[%s] recv error %s\n", pNode->addr.ToString(), NetworkErrorString(nErr));
                                 pNode->CloseSocketDisconnect();
                             }
+                            break;
                         }
-                    }
+                    } while (socketEvents.IsEpoll() && fnWantRecv());
                 }
             }
 
@@ -714,9 +764,9 @@ void ThreadSocketHandler() {
             //
             if (pNode->hSocket == INVALID_SOCKET)
                 continue;
-            if (FD_ISSET(pNode->hSocket, &fdsetSend)) {
+            if (pNode->fSendReady) {
                 TRY_LOCK(pNode->cs_vSend, lockSend);
-                if (lockSend)
+                if (lockSend && !pNode->vSendMsg.empty())
                     pNode->SocketSendData();
             }
 
@@ -1408,6 +1458,7 @@ void StartNode(boost::thread_group& threadGroup) {
 #endif
 
     // Send and receive from sockets, accept connections
+    socketEvents.Open(SysCfg().GetBoolArg("-epoll", true));
     threadGroup.create_thread(boost::bind(&TraceThread<void (*)()>, "net", &ThreadSocketHandler));
 
     // Initiate outbound connections from -addnode
@@ -1490,8 +1541,9 @@ void RelayTransaction(CBaseTx* pBaseTx, const uint256& hash, const CDataStream&
             vRelayExpiration.pop_front();
         }
 
-        // Save original serialized message so newer versions are preserved
-        mapRelay.insert(make_pair(inv, ss));
+        // Save original serialized message so newer versions are preserved, the framed message is shared by the
+        // getdata responses of the peers of PROTOCOL_VERSION
+        mapRelay.insert(make_pair(inv, MakeSharedMessage(inv.GetCommand(), ss)));
         vRelayExpiration.push_back(make_pair(GetTime() + 15 * 60, inv));
     }
     LOCK(cs_vNodes);
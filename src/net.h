@@ -11,6 +11,7 @@
 #include "crypto/hash.h"
 #include "sync.h"
 #include "netbase.h"
+#include "p2p/netmessage.h"
 
 
 #include <stdint.h>
@@ -80,7 +81,7 @@ extern CAddrMan addrman;
 extern int32_t nMaxConnections;
 extern vector<CNode*> vNodes;
 extern CCriticalSection cs_vNodes;
-extern map<CInv, CDataStream> mapRelay;
+extern map<CInv, CSharedMessage> mapRelay;
 extern deque<pair<int64_t, CInv> > vRelayExpiration;
 extern CCriticalSection cs_mapRelay;
 extern vector<string> vAddedNodes;
@@ -0,0 +1,142 @@
+// Copyright (c) 2017-2019 The GreenVenturesChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "blockencodings.h"
+
+#include "commons/random.h"
+#include "crypto/sha256.h"
+#include "crypto/siphash.h"
+#include "tx/txmempool.h"
+
+#include <unordered_map>
+
+CCompactBlockStats compactBlockStats;
+
+CBlockHeaderAndShortTxIDs::CBlockHeaderAndShortTxIDs(const CBlock &block)
+    : header(block.GetBlockHeader()), nonce(GetRand(std::numeric_limits<uint64_t>::max())) {
+    FillShortTxIDSelector();
+
+    shortTxIds.reserve(block.vptx.size());
+    for (uint32_t index = 0; index < block.vptx.size(); index++) {
+        const std::shared_ptr<CBaseTx> &pBaseTx = block.vptx[index];
+        // the reward txs and the price median tx are not relayed, so they are never in the mempool of peer
+        if (pBaseTx->IsBlockRewardTx() || pBaseTx->IsPriceMedianTx() || pBaseTx->IsCoinRewardTx())
+            prefilledTxs.emplace_back(index, pBaseTx);
+        else
+            shortTxIds.emplace_back(GetShortTxID(pBaseTx->GetHash()));
+    }
+}
+
+void CBlockHeaderAndShortTxIDs::FillShortTxIDSelector() const {
+    CDataStream stream(SER_NETWORK, PROTOCOL_VERSION);
+    stream << header.GetHash() << nonce;
+    uint256 shortTxIdHash;
+    CSHA256().Write((const unsigned char *)&stream[0], stream.size()).Finalize(shortTxIdHash.begin());
+
+    shortTxIdK0      = shortTxIdHash.GetUint64(0);
+    shortTxIdK1      = shortTxIdHash.GetUint64(1);
+    hasShortTxIdKeys = true;
+}
+
+uint64_t CBlockHeaderAndShortTxIDs::GetShortTxID(const uint256 &txid) const {
+    if (!hasShortTxIdKeys)
+        FillShortTxIDSelector();
+
+    return SipHashUint256(shortTxIdK0, shortTxIdK1, txid) & SHORT_TXID_MASK;
+}
+
+ReadStatus CPartiallyDownloadedBlock::InitData(const CBlockHeaderAndShortTxIDs &cmpctBlock, CTxMemPool &pool) {
+    size_t txCount = cmpctBlock.GetTxCount();
+    if (cmpctBlock.header.GetHeight() == 0 || txCount == 0 || txCount > MAX_CMPCTBLOCK_TX_COUNT)
+        return READ_STATUS_INVALID;
+
+    header = cmpctBlock.header;
+    txsAvailable.assign(txCount, nullptr);
+    prefilledCount = 0;
+    mempoolCount   = 0;
+
+    for (const auto &prefilledTx : cmpctBlock.prefilledTxs) {
+        if (prefilledTx.index >= txCount || !prefilledTx.pTx || txsAvailable[prefilledTx.index])
+            return READ_STATUS_INVALID;
+
+        txsAvailable[prefilledTx.index] = prefilledTx.pTx;
+        prefilledCount++;
+    }
+
+    // the short txids take the rest of the indexes in order
+    std::unordered_map<uint64_t, uint32_t> shortTxIdIndexes;
+    shortTxIdIndexes.reserve(cmpctBlock.shortTxIds.size());
+    uint32_t index = 0;
+    for (const auto &shortTxId : cmpctBlock.shortTxIds) {
+        while (txsAvailable[index])
+            index++;
+
+        // the collision of short txids in block, the full block is to be requested
+        if (!shortTxIdIndexes.emplace(shortTxId.id, index).second)
+            return READ_STATUS_FAILED;
+        index++;
+    }
+
+    {
+        LOCK(pool.cs);
+        vector<bool> haveCollision(txCount, false);
+        for (const auto &item : pool.memPoolTxs) {
+            auto it = shortTxIdIndexes.find(cmpctBlock.GetShortTxID(item.first));
+            if (it == shortTxIdIndexes.end() || haveCollision[it->second])
+                continue;
+
+            if (txsAvailable[it->second]) {
+                // two txs of mempool have the same short txid, request the tx from the peer
+                txsAvailable[it->second] = nullptr;
+                haveCollision[it->second] = true;
+                mempoolCount--;
+                continue;
+            }
+
+            txsAvailable[it->second] = item.second.GetTransaction();
+            mempoolCount++;
+        }
+    }
+
+    return READ_STATUS_OK;
+}
+
+bool CPartiallyDownloadedBlock::IsTxAvailable(size_t index) const {
+    assert(index < txsAvailable.size());
+    return txsAvailable[index] != nullptr;
+}
+
+vector<uint32_t> CPartiallyDownloadedBlock::GetMissingTxIndexes() const {
+    vector<uint32_t> indexes;
+    for (uint32_t index = 0; index < txsAvailable.size(); index++) {
+        if (!txsAvailable[index])
+            indexes.push_back(index);
+    }
+    return indexes;
+}
+
+ReadStatus CPartiallyDownloadedBlock::FillBlock(CBlock &block, const vector<std::shared_ptr<CBaseTx> > &missingTxs) {
+    block = CBlock(header);
+    block.vptx.reserve(txsAvailable.size());
+
+    size_t missingIndex = 0;
+    for (const auto &pBaseTx : txsAvailable) {
+        if (pBaseTx) {
+            block.vptx.push_back(pBaseTx);
+        } else {
+            if (missingIndex >= missingTxs.size() || !missingTxs[missingIndex])
+                return READ_STATUS_INVALID;
+
+            block.vptx.push_back(missingTxs[missingIndex++]);
+        }
+    }
+    if (missingIndex != missingTxs.size())
+        return READ_STATUS_INVALID;
+
+    // a mempool tx might be filled by the collision of short txid, which is caught by the merkle root
+    if (block.BuildMerkleTree() != header.GetMerkleRootHash())
+        return READ_STATUS_FAILED;
+
+    return READ_STATUS_OK;
+}
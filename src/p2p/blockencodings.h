@@ -0,0 +1,152 @@
+// Copyright (c) 2017-2019 The GreenVenturesChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef P2P_BLOCKENCODINGS_H
+#define P2P_BLOCKENCODINGS_H
+
+#include "persistence/block.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+class CTxMemPool;
+
+static const uint64_t CMPCTBLOCKS_VERSION = 1;
+static const uint64_t SHORT_TXID_MASK     = 0xffffffffffffULL;  // 6 bytes
+// no tx is smaller than 64 bytes, the signature only takes more than that
+static const uint32_t MAX_CMPCTBLOCK_TX_COUNT = MAX_BLOCK_SIZE / 64;
+
+// 6-byte short txid of the compact block
+class CShortTxID {
+public:
+    uint64_t id;
+
+    CShortTxID(): id(0) {}
+    CShortTxID(uint64_t idIn): id(idIn & SHORT_TXID_MASK) {}
+
+    IMPLEMENT_SERIALIZE(
+        uint32_t lsb = id & 0xffffffff;
+        uint16_t msb = (id >> 32) & 0xffff;
+        READWRITE(lsb);
+        READWRITE(msb);
+        if (fRead)
+            const_cast<CShortTxID *>(this)->id = ((uint64_t)msb << 32) | lsb;
+    )
+};
+
+// the tx sent in the compact block, which the peer can not have in mempool
+class CPrefilledTx {
+public:
+    uint32_t index;  // the index of the tx in block
+    std::shared_ptr<CBaseTx> pTx;
+
+    CPrefilledTx(): index(0) {}
+    CPrefilledTx(uint32_t indexIn, const std::shared_ptr<CBaseTx> &pTxIn): index(indexIn), pTx(pTxIn) {}
+
+    IMPLEMENT_SERIALIZE(
+        READWRITE(VARINT(index));
+        READWRITE(pTx);
+    )
+};
+
+/**
+ * Compact block: the block header, the short txids of the txs the peer is expected to have in mempool,
+ * and the prefilled txs which are never relayed, like the block reward tx and the price median tx.
+ * The short txid is the SipHash of txid keyed by the block hash and a random nonce.
+ */
+class CBlockHeaderAndShortTxIDs {
+public:
+    CBlockHeader header;
+    uint64_t nonce;
+    vector<CShortTxID> shortTxIds;
+    vector<CPrefilledTx> prefilledTxs;
+
+    CBlockHeaderAndShortTxIDs(): nonce(0) {}
+    CBlockHeaderAndShortTxIDs(const CBlock &block);
+
+    IMPLEMENT_SERIALIZE(
+        READWRITE(header);
+        READWRITE(nonce);
+        READWRITE(shortTxIds);
+        READWRITE(prefilledTxs);
+    )
+
+    uint64_t GetShortTxID(const uint256 &txid) const;
+    size_t GetTxCount() const { return shortTxIds.size() + prefilledTxs.size(); }
+
+private:
+    void FillShortTxIDSelector() const;
+
+    mutable uint64_t shortTxIdK0 = 0;
+    mutable uint64_t shortTxIdK1 = 0;
+    mutable bool hasShortTxIdKeys = false;
+};
+
+// getblocktxn: the indexes of the txs missing from the reconstructed block
+class CBlockTransactionsRequest {
+public:
+    uint256 blockHash;
+    vector<uint32_t> indexes;
+
+    IMPLEMENT_SERIALIZE(
+        READWRITE(blockHash);
+        READWRITE(indexes);
+    )
+};
+
+// blocktxn: the requested txs, in the order of the request
+class CBlockTransactions {
+public:
+    uint256 blockHash;
+    vector<std::shared_ptr<CBaseTx> > txs;
+
+    IMPLEMENT_SERIALIZE(
+        READWRITE(blockHash);
+        READWRITE(txs);
+    )
+};
+
+enum ReadStatus {
+    READ_STATUS_OK,
+    READ_STATUS_INVALID,  // the peer sent invalid data
+    READ_STATUS_FAILED,   // failed to reconstruct the block, the full block is to be requested
+};
+
+/**
+ * The block reconstructed from the compact block, the txs are filled by the prefilled txs and the mempool
+ * txs matching the short txids, the rest are requested from the peer by getblocktxn.
+ */
+class CPartiallyDownloadedBlock {
+public:
+    ReadStatus InitData(const CBlockHeaderAndShortTxIDs &cmpctBlock, CTxMemPool &pool);
+    bool IsTxAvailable(size_t index) const;
+    vector<uint32_t> GetMissingTxIndexes() const;
+    ReadStatus FillBlock(CBlock &block, const vector<std::shared_ptr<CBaseTx> > &missingTxs);
+
+    const CBlockHeader &GetHeader() const { return header; }
+
+public:
+    uint32_t prefilledCount = 0;
+    uint32_t mempoolCount   = 0;
+
+private:
+    CBlockHeader header;
+    vector<std::shared_ptr<CBaseTx> > txsAvailable;
+};
+
+// reconstruction stats of the received compact blocks
+struct CCompactBlockStats {
+    std::atomic<uint64_t> received{0};       // compact blocks received
+    std::atomic<uint64_t> reconstructed{0};  // reconstructed without round trip
+    std::atomic<uint64_t> roundTrips{0};     // the missing txs requested by getblocktxn
+    std::atomic<uint64_t> failed{0};         // the full block requested
+    std::atomic<uint64_t> prefilledTxs{0};
+    std::atomic<uint64_t> mempoolTxs{0};     // the txs found in mempool
+    std::atomic<uint64_t> missingTxs{0};     // the txs requested by getblocktxn
+};
+
+extern CCompactBlockStats compactBlockStats;
+
+#endif  // P2P_BLOCKENCODINGS_H
@@ -11,9 +11,14 @@
 #include "commons/util/util.h"
 #include "main.h"
 #include "net.h"
+#include "p2p/blockencodings.h"
+#include "p2p/headerssync.h"
+#include "p2p/txadmission.h"
+#include "miner/miner.h"
 #include "miner/pbftcontext.h"
 #include "miner/pbftmanager.h"
 
+#include <limits>
 #include <string>
 #include <tuple>
 #include <vector>
@@ -45,6 +50,38 @@ map<uint256, tuple<NodeId, list<uint256>::iterator, int64_t>> mapBlocksToDownloa
 // them, if processing happens afterwards. Protected by cs_main.
 map<uint256, NodeId> mapBlockSource;  // Remember who we got this block from.
 
+// The compact blocks waiting for the missing txs requested by getblocktxn, by the block hash and the peer which
+// sent it, with the time of the request. Protected by cs_mapNodeState.
+map<std::pair<uint256, NodeId>, std::pair<std::shared_ptr<CPartiallyDownloadedBlock>, int64_t>> mapPartialBlocks;
+
+// Requires cs_mapNodeState. Drop the expired partial blocks, and the oldest ones beyond the limit.
+void PrunePartialBlocks(int64_t now) {
+    AssertLockHeld(cs_mapNodeState);
+    for (auto it = mapPartialBlocks.begin(); it != mapPartialBlocks.end();) {
+        if (now - it->second.second > PARTIAL_BLOCK_EXPIRY)
+            it = mapPartialBlocks.erase(it);
+        else
+            ++it;
+    }
+
+    while (mapPartialBlocks.size() >= MAX_PARTIAL_BLOCKS) {
+        auto itOldest = mapPartialBlocks.begin();
+        for (auto it = mapPartialBlocks.begin(); it != mapPartialBlocks.end(); ++it) {
+            if (it->second.second < itOldest->second.second)
+                itOldest = it;
+        }
+        mapPartialBlocks.erase(itOldest);
+    }
+}
+
+// Requires cs_mapNodeState. Drop the partial blocks of the hash from all of the peers.
+void ErasePartialBlocks(const uint256 &hash) {
+    AssertLockHeld(cs_mapNodeState);
+    auto it = mapPartialBlocks.lower_bound(std::make_pair(hash, std::numeric_limits<NodeId>::min()));
+    while (it != mapPartialBlocks.end() && it->first.first == hash)
+        it = mapPartialBlocks.erase(it);
+}
+
 
 // Requires cs_mapNodeState.
 void MarkBlockAsReceived(const uint256 &hash, NodeId nodeFrom = -1) {
@@ -63,8 +100,10 @@ void MarkBlockAsReceived(const uint256 &hash, NodeId nodeFrom = -1) {
         CNodeState *state = State(std::get<0>(itInFlight->second));
         state->vBlocksInFlight.erase(std::get<1>(itInFlight->second));
         state->nBlocksInFlight--;
-        if (std::get<0>(itInFlight->second) == nodeFrom)
+        if (std::get<0>(itInFlight->second) == nodeFrom) {
             state->nLastBlockReceive = GetTimeMicros();
+            state->nBlocksReceived++;
+        }
 
         mapBlocksInFlight.erase(itInFlight);
     }
@@ -100,13 +139,15 @@ inline void ProcessGetData(CNode *pFrom) {
             boost::this_thread::interruption_point();
             it++;
 
-            if (inv.type == MSG_BLOCK || inv.type == MSG_FILTERED_BLOCK) {
+            if (inv.type == MSG_BLOCK || inv.type == MSG_FILTERED_BLOCK || inv.type == MSG_CMPCT_BLOCK) {
                 bool send                                = false;
                 map<uint256, CBlockIndex *>::iterator mi = mapBlockIndex.find(inv.hash);
                 if (mi != mapBlockIndex.end()) {
                     send = true;
                 } else {
+                    // the peer releases the block to the others instead of waiting for it until stalling
                     LogPrint(BCLog::NET, "block %s not exist\n", inv.hash.GetHex());
+                    vNotFound.push_back(inv);
                 }
 
                 if (send) {
@@ -118,6 +159,11 @@ inline void ProcessGetData(CNode *pFrom) {
                                  pFrom->addr.ToString());
                         pFrom->PushMessage(NetMsgType::BLOCK, block);
                     }
+                    else if (inv.type == MSG_CMPCT_BLOCK) {
+                        LogPrint(BCLog::NET, "send compact block[%u]: %s to peer %s\n", block.GetHeight(),
+                                 block.GetHash().GetHex(), pFrom->addr.ToString());
+                        pFrom->PushMessage(NetMsgType::CMPCTBLOCK, CBlockHeaderAndShortTxIDs(block));
+                    }
                     else  // MSG_FILTERED_BLOCK)
                     {
                         LOCK(pFrom->cs_filter);
@@ -151,20 +197,20 @@ inline void ProcessGetData(CNode *pFrom) {
                     }
                 }
             } else if (inv.IsKnownType()) {
-                // Send stream from relay memory
+                // Send stream from relay memory, the relay messages are serialized at PROTOCOL_VERSION
                 bool pushed = false;
-                {
+                if (pFrom->GetSendVersion() == PROTOCOL_VERSION) {
                     LOCK(cs_mapRelay);
-                    map<CInv, CDataStream>::iterator mi = mapRelay.find(inv);
+                    map<CInv, CSharedMessage>::iterator mi = mapRelay.find(inv);
                     if (mi != mapRelay.end()) {
-                        pFrom->PushMessage(inv.GetCommand(), (*mi).second);
+                        pFrom->PushSharedMessage(mi->second);
                         pushed = true;
                     }
                 }
                 if (!pushed && inv.type == MSG_TX) {
                     std::shared_ptr<CBaseTx> pBaseTx = mempool.Lookup(inv.hash);
                     if (pBaseTx.get() && !pBaseTx->IsBlockRewardTx() && !pBaseTx->IsPriceMedianTx()) {
-                        CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+                        CDataStream ss(SER_NETWORK, pFrom->GetSendVersion());
                         ss.reserve(1000);
                         ss << pBaseTx;
                         pFrom->PushMessage(NetMsgType::TX, ss);
@@ -179,7 +225,7 @@ inline void ProcessGetData(CNode *pFrom) {
             // Track requests for our stuff.
             // g_signals.Inventory(inv.hash);
 
-            if (inv.type == MSG_BLOCK || inv.type == MSG_FILTERED_BLOCK)
+            if (inv.type == MSG_BLOCK || inv.type == MSG_FILTERED_BLOCK || inv.type == MSG_CMPCT_BLOCK)
                 break;
         }
     }
@@ -194,14 +240,14 @@ inline void ProcessGetData(CNode *pFrom) {
         // do that because they want to know about (and store and rebroadcast and
         // risk analyze) the dependencies of transactions relevant to them, without
         // having to download the entire memory pool.
-        pFrom->PushMessage("notfound", vNotFound);
+        pFrom->PushMessage(NetMsgType::NOTFOUND, vNotFound);
     }
 }
 
 bool AlreadyHave(const CInv &inv) {
     switch (inv.type) {
         case MSG_TX: {
-            return mempool.Exists(inv.hash);
+            return mempool.Exists(inv.hash) || txAdmission.IsQueued(inv.hash);
         }
 
         case MSG_BLOCK: {
@@ -319,6 +365,9 @@ inline int32_t ProcessVersionMessage(CNode *pFrom, string strCommand, CDataStrea
     pFrom->PushMessage(NetMsgType::VERACK);
     pFrom->ssSend.SetVersion(min(pFrom->nVersion, PROTOCOL_VERSION));
 
+    // Accept the compact blocks, the peers not knowing the message ignore it
+    pFrom->PushMessage(NetMsgType::SENDCMPCT, true, CMPCTBLOCKS_VERSION);
+
     if (!pFrom->fInbound) {
         // Advertise our address
         if (!fNoListen && !IsInitialBlockDownload()) {
@@ -500,30 +549,15 @@ inline bool ProcessTxMessage(CNode *pFrom, string strCommand, CDataStream &vRecv
         return true ;
     }
 
-
-
-    LOCK(cs_main);
-    CValidationState state;
-    if (AcceptToMemoryPool(mempool, state, pBaseTx.get(), true)) {
-        RelayTransaction(pBaseTx.get(), inv.hash);
-        mapAlreadyAskedFor.erase(inv);
-
-        LogPrint(BCLog::INFO, "AcceptToMemoryPool: %s %s : accepted %s (poolsz %u)\n", pFrom->addr.ToString(),
-                 pFrom->cleanSubVer, pBaseTx->GetHash().ToString(), mempool.memPoolTxs.size());
+    // admitted by the admission thread, the message handler goes on with the other messages
+    if (txAdmission.IsRunning()) {
+        if (!txAdmission.Push(pFrom, strCommand, pBaseTx))
+            LogPrint(BCLog::NET, "tx %s from %s is queued already or the admission queue is full\n",
+                     inv.hash.GetHex(), pFrom->addr.ToString());
+        return true;
     }
 
-    int32_t nDoS = 0;
-    if (state.IsInvalid(nDoS)) {
-        LogPrint(BCLog::INFO, "%s [%d] from %s %s was not accepted into the memory pool: %s\n",
-                pBaseTx->GetHash().ToString(), pBaseTx->valid_height,
-                pFrom->addr.ToString(), pFrom->cleanSubVer, state.GetRejectReason());
-
-        pFrom->PushMessage(NetMsgType::REJECT, strCommand, state.GetRejectCode(), state.GetRejectReason(), inv.hash);
-        // if (nDoS > 0) {
-        //     LogPrint(BCLog::INFO, "Misebehaving, add to tx hash %s mempool error, Misbehavior add %d",
-        //     pBaseTx->GetHash().GetHex(), nDoS); Misbehaving(pFrom->GetId(), nDoS);
-        // }
-    }
+    AcceptTxFromPeer(pFrom, strCommand, pBaseTx);
 
     return true;
 }
@@ -552,7 +586,7 @@ inline bool ProcessGetHeadersMessage(CNode *pFrom, CDataStream &vRecv) {
 
     // We must use CBlocks, as CBlockHeaders won't include the 0x00 nTx count at the end
     vector<CBlock> vHeaders;
-    int32_t nLimit = 2000;
+    int32_t nLimit = MAX_HEADERS_RESULTS;
     LogPrint(BCLog::NET, "getheaders %d to %s from peer %s\n", (pIndex ? pIndex->height : -1), hashStop.ToString(),
              pFrom->addr.ToString());
     for (; pIndex; pIndex = chainActive.Next(pIndex)) {
@@ -560,11 +594,98 @@ inline bool ProcessGetHeadersMessage(CNode *pFrom, CDataStream &vRecv) {
         if (--nLimit <= 0 || pIndex->GetBlockHash() == hashStop)
             break;
     }
-    pFrom->PushMessage("headers", vHeaders);
+    pFrom->PushMessage(NetMsgType::HEADERS, vHeaders);
 
     return false;
 }
 
+inline bool ProcessHeadersMessage(CNode *pFrom, CDataStream &vRecv) {
+    // the headers are sent as the blocks without txs
+    vector<CBlock> vHeaders;
+    vRecv >> vHeaders;
+    if (vHeaders.size() > MAX_HEADERS_RESULTS) {
+        Misbehaving(pFrom->GetId(), 20);
+        return ERRORMSG("message headers size() = %u from peer %s", vHeaders.size(), pFrom->addr.ToString());
+    }
+
+    if (vHeaders.empty())
+        return true;
+
+    vector<CBlockHeader> headers;
+    headers.reserve(vHeaders.size());
+    for (const auto &block : vHeaders)
+        headers.push_back(block.GetBlockHeader());
+
+    LOCK(cs_main);
+    CValidationState state;
+    size_t acceptedCount = 0;
+    if (!headersSync.AcceptHeaders(headers, state, acceptedCount)) {
+        int32_t nDoS = 0;
+        if (state.IsInvalid(nDoS) && nDoS > 0)
+            Misbehaving(pFrom->GetId(), nDoS);
+
+        return ERRORMSG("invalid headers from peer %s, reason=%s", pFrom->addr.ToString(), state.GetRejectReason());
+    }
+
+    int32_t bestHeaderHeight = headersSync.GetBestHeight();
+    if (bestHeaderHeight > nSyncTipHeight)
+        nSyncTipHeight = bestHeaderHeight;
+
+    // the blocks are downloaded from the peer up to the last of its headers in the best header chain
+    if (acceptedCount > 0) {
+        const CBlockHeader &lastHeader = headers[acceptedCount - 1];
+        uint256 lastHash               = lastHeader.GetHash();
+        LOCK(cs_mapNodeState);
+        CNodeState *nodeState = State(pFrom->GetId());
+        if (headersSync.HasHeader(lastHash) && (int32_t)lastHeader.GetHeight() > nodeState->nBestHeaderHeight) {
+            nodeState->hashBestHeader    = lastHash;
+            nodeState->nBestHeaderHeight = lastHeader.GetHeight();
+        }
+    }
+
+    LogPrint(BCLog::NET, "recv %u headers, accepted=%u, best header height=%d, tip height=%d, peer=%s\n",
+             vHeaders.size(), acceptedCount, bestHeaderHeight, chainActive.Height(), pFrom->addr.ToString());
+
+    // a full headers message, the peer has more. The headers after an unknown signer are requested again when the
+    // blocks before them are connected.
+    if (vHeaders.size() == MAX_HEADERS_RESULTS && acceptedCount == vHeaders.size())
+        PushGetHeaders(pFrom);
+
+    return true;
+}
+
+// The peer does not have the requested blocks, they are released to the other peers without stalling the download
+// window, and the blocks from them on are not requested from the peer any more.
+inline void ProcessNotFoundMessage(CNode *pFrom, CDataStream &vRecv) {
+    vector<CInv> vInv;
+    vRecv >> vInv;
+    if (vInv.size() > MAX_INV_SZ) {
+        Misbehaving(pFrom->GetId(), 20);
+        return;
+    }
+
+    LOCK(cs_mapNodeState);
+    CNodeState *state = State(pFrom->GetId());
+    for (const auto &inv : vInv) {
+        if (inv.type != MSG_BLOCK && inv.type != MSG_CMPCT_BLOCK)
+            continue;
+
+        auto it = mapBlocksInFlight.find(inv.hash);
+        if (it == mapBlocksInFlight.end() || std::get<0>(it->second) != pFrom->GetId())
+            continue;
+
+        MarkBlockAsReceived(inv.hash);
+        int32_t height = headersSync.GetHeight(inv.hash);
+        if (height > 0 && height <= state->nBestHeaderHeight) {
+            vector<uint256> vHashes;
+            headersSync.GetHashes(height - 1, height - 1, vHashes);
+            state->hashBestHeader    = vHashes.empty() ? uint256() : vHashes.front();
+            state->nBestHeaderHeight = height - 1;
+        }
+        LogPrint(BCLog::NET, "block %s not found by peer %s, release it\n", inv.hash.GetHex(), state->name);
+    }
+}
+
 inline void ProcessGetBlocksMessage(CNode *pFrom, CDataStream &vRecv) {
     CBlockLocator locator;
     uint256 hashStop;
@@ -704,14 +825,7 @@ inline bool ProcessGetDataMessage(CNode *pFrom, CDataStream &vRecv) {
     return true;
 }
 
-inline void ProcessBlockMessage(CNode *pFrom, CDataStream &vRecv) {
-    CBlock block;
-    vRecv >> block;
-
-    LogPrint(BCLog::NET, "recv block! time_ms=%lld, hash=%s, peer=%s\n", GetTimeMillis(),
-        block.GetHash().ToString(), pFrom->addr.ToString());
-    // block.Print();
-
+inline void ProcessReceivedBlock(CNode *pFrom, CBlock &block) {
     CInv inv(MSG_BLOCK, block.GetHash());
     pFrom->AddInventoryKnown(inv);
 
@@ -720,6 +834,7 @@ inline void ProcessBlockMessage(CNode *pFrom, CDataStream &vRecv) {
         LOCK(cs_mapNodeState);
         mapBlockSource[inv.hash] = pFrom->GetId();
         MarkBlockAsReceived(inv.hash, pFrom->GetId());
+        ErasePartialBlocks(inv.hash);
     }
 
     LOCK(cs_main);
@@ -734,6 +849,217 @@ inline void ProcessBlockMessage(CNode *pFrom, CDataStream &vRecv) {
         ProcessBlock(state, pFrom, &block);
     }
 
+    headersSync.Prune(chainActive.Height());
+}
+
+inline void ProcessBlockMessage(CNode *pFrom, CDataStream &vRecv) {
+    CBlock block;
+    vRecv >> block;
+
+    LogPrint(BCLog::NET, "recv block! time_ms=%lld, hash=%s, peer=%s\n", GetTimeMillis(),
+        block.GetHash().ToString(), pFrom->addr.ToString());
+    // block.Print();
+
+    ProcessReceivedBlock(pFrom, block);
+}
+
+inline void ProcessSendCmpctMessage(CNode *pFrom, CDataStream &vRecv) {
+    bool fAnnounce   = false;
+    uint64_t version = 0;
+    vRecv >> fAnnounce >> version;
+
+    if (version == CMPCTBLOCKS_VERSION)
+        pFrom->fSupportsCompactBlocks = true;
+}
+
+// Requires cs_main. The compact block extends the tip, its header is checked before the mempool is scanned for it
+inline bool CheckCompactBlockHeader(const CBlockHeader &header, CValidationState &state) {
+    AssertLockHeld(cs_main);
+    CBlockIndex *pTip = chainActive.Tip();
+    if (header.GetHeight() != (uint32_t)pTip->height + 1)
+        return state.DoS(100, ERRORMSG("CheckCompactBlockHeader() : header height %u mismatches with its prev",
+                         header.GetHeight()), REJECT_INVALID, "incorrect-height");
+
+    if (header.GetVersion() != CBlockHeader::CURRENT_VERSION)
+        return state.DoS(100, ERRORMSG("CheckCompactBlockHeader() : header version error"), REJECT_INVALID,
+                         "block-version-error");
+
+    if (header.GetBlockTime() > GetAdjustedTime() + ::GetBlockInterval(header.GetHeight()) + 2)
+        return state.Invalid(ERRORMSG("CheckCompactBlockHeader() : header timestamp too far in the future"),
+                             REJECT_INVALID, "time-too-new");
+
+    if (header.GetBlockTime() - pTip->GetBlockTime() < ::GetBlockInterval(header.GetHeight()))
+        return state.DoS(100, ERRORMSG("CheckCompactBlockHeader() : header came in too early"), REJECT_INVALID,
+                         "time-too-early");
+
+    CCacheWrapper cw(pCdMan);
+    if (!VerifyBlockHeaderSignature(header, cw))
+        return state.DoS(100, ERRORMSG("CheckCompactBlockHeader() : header not signed by the delegate of its slot"),
+                         REJECT_INVALID, "bad-block-signature");
+
+    return true;
+}
+
+// Fall back to the full block when the compact block can not be reconstructed
+inline void RequestFullBlock(CNode *pFrom, const uint256 &blockHash) {
+    compactBlockStats.failed++;
+    LogPrint(BCLog::NET, "failed to reconstruct compact block, request full block! hash=%s, peer=%s\n",
+             blockHash.ToString(), pFrom->addr.ToString());
+
+    vector<CInv> vGetData = {CInv(MSG_BLOCK, blockHash)};
+    pFrom->PushMessage(NetMsgType::GETDATA, vGetData);
+}
+
+inline void ProcessCmpctBlockMessage(CNode *pFrom, CDataStream &vRecv) {
+    CBlockHeaderAndShortTxIDs cmpctBlock;
+    vRecv >> cmpctBlock;
+
+    uint256 blockHash = cmpctBlock.header.GetHash();
+    LogPrint(BCLog::NET, "recv compact block! time_ms=%lld, hash=%s, short_txids=%u, prefilled_txs=%u, peer=%s\n",
+             GetTimeMillis(), blockHash.ToString(), cmpctBlock.shortTxIds.size(), cmpctBlock.prefilledTxs.size(),
+             pFrom->addr.ToString());
+
+    pFrom->AddInventoryKnown(CInv(MSG_BLOCK, blockHash));
+    compactBlockStats.received++;
+
+    bool fHaveBlock  = false;
+    bool fExtendsTip = false;
+    CValidationState state;
+    {
+        LOCK(cs_main);
+        fHaveBlock = mapBlockIndex.count(blockHash) || mapOrphanBlocks.count(blockHash);
+        if (!fHaveBlock && cmpctBlock.header.GetPrevBlockHash() == chainActive.Tip()->GetBlockHash()) {
+            fExtendsTip = true;
+            if (!CheckCompactBlockHeader(cmpctBlock.header, state)) {
+                int32_t nDoS = 0;
+                if (state.IsInvalid(nDoS) && nDoS > 0)
+                    Misbehaving(pFrom->GetId(), nDoS);
+                LogPrint(BCLog::INFO, "invalid compact block header! hash=%s, reason=%s, peer=%s\n",
+                         blockHash.ToString(), state.GetRejectReason(), pFrom->addr.ToString());
+                return;
+            }
+        }
+    }
+    if (fHaveBlock) {
+        LOCK(cs_mapNodeState);
+        MarkBlockAsReceived(blockHash, pFrom->GetId());
+        return;
+    }
+
+    // the block off the tip is validated as a full block by ProcessBlock, its header can not be checked here
+    if (!fExtendsTip) {
+        LogPrint(BCLog::NET, "compact block not on the tip, request full block! hash=%s, peer=%s\n",
+                 blockHash.ToString(), pFrom->addr.ToString());
+        vector<CInv> vGetData = {CInv(MSG_BLOCK, blockHash)};
+        pFrom->PushMessage(NetMsgType::GETDATA, vGetData);
+        return;
+    }
+
+    auto spPartialBlock = std::make_shared<CPartiallyDownloadedBlock>();
+    ReadStatus status   = spPartialBlock->InitData(cmpctBlock, mempool);
+    if (status == READ_STATUS_INVALID) {
+        Misbehaving(pFrom->GetId(), 100);
+        LogPrint(BCLog::INFO, "invalid compact block! hash=%s, peer=%s\n", blockHash.ToString(), pFrom->addr.ToString());
+        return;
+    } else if (status == READ_STATUS_FAILED) {
+        RequestFullBlock(pFrom, blockHash);
+        return;
+    }
+
+    compactBlockStats.prefilledTxs += spPartialBlock->prefilledCount;
+    compactBlockStats.mempoolTxs += spPartialBlock->mempoolCount;
+
+    vector<uint32_t> missingIndexes = spPartialBlock->GetMissingTxIndexes();
+    if (missingIndexes.empty()) {
+        CBlock block;
+        if (spPartialBlock->FillBlock(block, {}) != READ_STATUS_OK) {
+            RequestFullBlock(pFrom, blockHash);
+            return;
+        }
+
+        compactBlockStats.reconstructed++;
+        ProcessReceivedBlock(pFrom, block);
+        return;
+    }
+
+    compactBlockStats.roundTrips++;
+    compactBlockStats.missingTxs += missingIndexes.size();
+    {
+        LOCK(cs_mapNodeState);
+        int64_t now = GetTime();
+        PrunePartialBlocks(now);
+        mapPartialBlocks[std::make_pair(blockHash, pFrom->GetId())] = std::make_pair(spPartialBlock, now);
+    }
+
+    CBlockTransactionsRequest request;
+    request.blockHash = blockHash;
+    request.indexes   = missingIndexes;
+    pFrom->PushMessage(NetMsgType::GETBLOCKTXN, request);
+}
+
+inline bool ProcessGetBlockTxnMessage(CNode *pFrom, CDataStream &vRecv) {
+    CBlockTransactionsRequest request;
+    vRecv >> request;
+
+    CBlock block;
+    {
+        LOCK(cs_main);
+        auto it = mapBlockIndex.find(request.blockHash);
+        if (it == mapBlockIndex.end()) {
+            LogPrint(BCLog::NET, "block %s not exist\n", request.blockHash.GetHex());
+            return true;
+        }
+
+        if (!ReadBlockFromDisk(it->second, block))
+            return ERRORMSG("failed to read block %s from disk", request.blockHash.GetHex());
+    }
+
+    CBlockTransactions response;
+    response.blockHash = request.blockHash;
+    response.txs.reserve(request.indexes.size());
+    for (auto index : request.indexes) {
+        if (index >= block.vptx.size()) {
+            Misbehaving(pFrom->GetId(), 100);
+            return ERRORMSG("message getblocktxn index %u out of range from peer %s", index, pFrom->addr.ToString());
+        }
+        response.txs.push_back(block.vptx[index]);
+    }
+
+    pFrom->PushMessage(NetMsgType::BLOCKTXN, response);
+    return true;
+}
+
+inline bool ProcessBlockTxnMessage(CNode *pFrom, CDataStream &vRecv) {
+    CBlockTransactions blockTxn;
+    vRecv >> blockTxn;
+
+    std::shared_ptr<CPartiallyDownloadedBlock> spPartialBlock;
+    {
+        LOCK(cs_mapNodeState);
+        auto it = mapPartialBlocks.find(std::make_pair(blockTxn.blockHash, pFrom->GetId()));
+        if (it == mapPartialBlocks.end()) {
+            LogPrint(BCLog::NET, "recv unrequested blocktxn! hash=%s, peer=%s\n", blockTxn.blockHash.ToString(),
+                     pFrom->addr.ToString());
+            return true;
+        }
+
+        spPartialBlock = it->second.first;
+        mapPartialBlocks.erase(it);
+    }
+
+    CBlock block;
+    ReadStatus status = spPartialBlock->FillBlock(block, blockTxn.txs);
+    if (status == READ_STATUS_INVALID) {
+        Misbehaving(pFrom->GetId(), 100);
+        return ERRORMSG("invalid blocktxn of block %s from peer %s", blockTxn.blockHash.ToString(),
+                        pFrom->addr.ToString());
+    } else if (status == READ_STATUS_FAILED) {
+        RequestFullBlock(pFrom, blockTxn.blockHash);
+        return true;
+    }
+
+    ProcessReceivedBlock(pFrom, block);
+    return true;
 }
 
 inline void ProcessMempoolMessage(CNode *pFrom, CDataStream &vRecv) {
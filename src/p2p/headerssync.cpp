@@ -0,0 +1,235 @@
+// Copyright (c) 2017-2019 The GreenVenturesChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "headerssync.h"
+
+#include "main.h"
+#include "miner/miner.h"
+
+CHeadersSync headersSync;
+
+namespace {
+
+// the block index and the delegates of the tip, requires cs_main
+class CChainHeadersContext : public CHeadersContext {
+public:
+    CChainHeadersContext() : cw(pCdMan), pTip(chainActive.Tip()) {}
+
+    bool GetPrevBlock(const uint256 &hash, int32_t &height, uint32_t &time, CValidationState &state) override {
+        auto indexIt = mapBlockIndex.find(hash);
+        if (indexIt == mapBlockIndex.end())
+            return state.Invalid(ERRORMSG("AcceptHeaders() : headers not connecting, prev hash %s", hash.GetHex()),
+                                 REJECT_INVALID, "headers-not-connecting");
+
+        const CBlockIndex *pPrevIndex = indexIt->second;
+        if (!chainActive.Contains(pPrevIndex)) {
+            std::pair<int32_t, uint256> globalFinBlock = std::make_pair(0, uint256());
+            pCdMan->pBlockCache->ReadGlobalFinBlock(globalFinBlock);
+            if (pPrevIndex->height < globalFinBlock.first)
+                return state.DoS(100, ERRORMSG("AcceptHeaders() : headers fork below the finalized block[%d]",
+                                 globalFinBlock.first), REJECT_INVALID, "headers-fork-irreversible");
+        }
+
+        height = pPrevIndex->height;
+        time   = pPrevIndex->GetBlockTime();
+        return true;
+    }
+
+    bool HaveBlock(const uint256 &hash) override { return mapBlockIndex.count(hash) > 0; }
+
+    HeaderSignerStatus CheckSigner(const CBlockHeader &header) override {
+        if (VerifyBlockHeaderSignature(header, cw))
+            return HEADER_SIGNER_VERIFIED;
+
+        // the delegates of the block next to the tip are the active ones of the tip exactly
+        if (header.GetPrevBlockHash() == pTip->GetBlockHash())
+            return HEADER_SIGNER_INVALID;
+
+        // the delegates of the blocks beyond might be changed by the votes, the header signed by one of the active or
+        // pending delegates of the tip is accepted, its block is checked against the delegate of its slot on connect
+        if (!fSignersLoaded)
+            LoadSigners();
+
+        for (const auto &account : signers) {
+            if (VerifyDelegateSignature(header, account))
+                return HEADER_SIGNER_VERIFIED;
+        }
+        return HEADER_SIGNER_UNKNOWN;
+    }
+
+    int64_t GetAdjustedTime() override { return ::GetAdjustedTime(); }
+
+private:
+    void LoadSigners() {
+        fSignersLoaded = true;
+
+        VoteDelegateVector delegates;
+        cw.delegateCache.GetActiveDelegates(delegates);
+        PendingDelegates pendingDelegates;
+        if (cw.delegateCache.GetPendingDelegates(pendingDelegates))
+            delegates.insert(delegates.end(), pendingDelegates.top_vote_delegates.begin(),
+                             pendingDelegates.top_vote_delegates.end());
+
+        set<CRegID> regIds;
+        for (const auto &delegate : delegates) {
+            CAccount account;
+            if (regIds.insert(delegate.regid).second && cw.accountCache.GetAccount(delegate.regid, account))
+                signers.push_back(account);
+        }
+    }
+
+    CCacheWrapper cw;
+    const CBlockIndex *pTip;
+    bool fSignersLoaded = false;
+    vector<CAccount> signers;
+};
+
+}  // namespace
+
+bool CHeadersSync::AcceptHeaders(const vector<CBlockHeader> &newHeaders, CValidationState &state,
+                                 size_t &acceptedCount) {
+    AssertLockHeld(cs_main);
+    CChainHeadersContext context;
+    return AcceptHeaders(newHeaders, context, state, acceptedCount);
+}
+
+bool CHeadersSync::AcceptHeaders(const vector<CBlockHeader> &newHeaders, CHeadersContext &context,
+                                 CValidationState &state, size_t &acceptedCount) {
+    acceptedCount = 0;
+    if (newHeaders.empty())
+        return true;
+
+    LOCK(cs);
+
+    // the first header connects to the header chain or the block index
+    const uint256 &prevHash = newHeaders.front().GetPrevBlockHash();
+    int32_t prevHeight      = 0;
+    uint32_t prevTime       = 0;
+    auto heightIt           = mapHeights.find(prevHash);
+    if (heightIt != mapHeights.end()) {
+        prevHeight = heightIt->second;
+        prevTime   = headers[prevHeight - baseHeight].time;
+    } else if (!context.GetPrevBlock(prevHash, prevHeight, prevTime, state)) {
+        return false;
+    }
+
+    uint256 lastHash     = prevHash;
+    int32_t lastHeight   = prevHeight;
+    uint32_t lastTime    = prevTime;
+    int64_t adjustedTime = context.GetAdjustedTime();
+    vector<uint256> hashes;
+    hashes.reserve(newHeaders.size());
+    for (const auto &header : newHeaders) {
+        if (header.GetPrevBlockHash() != lastHash)
+            return state.DoS(100, ERRORMSG("AcceptHeaders() : non-continuous headers"), REJECT_INVALID,
+                             "headers-non-continuous");
+
+        if (header.GetHeight() != (uint32_t)lastHeight + 1)
+            return state.DoS(100, ERRORMSG("AcceptHeaders() : header height %u mismatches with its prev",
+                             header.GetHeight()), REJECT_INVALID, "incorrect-height");
+
+        if (header.GetVersion() != CBlockHeader::CURRENT_VERSION)
+            return state.DoS(100, ERRORMSG("AcceptHeaders() : header version error"), REJECT_INVALID,
+                             "block-version-error");
+
+        // the same timestamp rules as the blocks
+        if (header.GetBlockTime() > adjustedTime + ::GetBlockInterval(header.GetHeight()) + 2)
+            return state.Invalid(ERRORMSG("AcceptHeaders() : header timestamp too far in the future"),
+                                 REJECT_INVALID, "time-too-new");
+
+        if (header.GetTime() <= lastTime || header.GetTime() - lastTime < ::GetBlockInterval(header.GetHeight()))
+            return state.DoS(100, ERRORMSG("AcceptHeaders() : header came in too early"), REJECT_INVALID,
+                             "time-too-early");
+
+        // the headers of the header chain and the blocks we have are verified already
+        uint256 hash = header.GetHash();
+        if (!mapHeights.count(hash) && !context.HaveBlock(hash)) {
+            HeaderSignerStatus signerStatus = context.CheckSigner(header);
+            if (signerStatus == HEADER_SIGNER_INVALID)
+                return state.DoS(100, ERRORMSG("AcceptHeaders() : header[%u] %s not signed by the delegate of its "
+                                 "slot", header.GetHeight(), hash.GetHex()), REJECT_INVALID, "bad-block-signature");
+
+            if (signerStatus == HEADER_SIGNER_UNKNOWN) {
+                LogPrint(BCLog::NET, "header[%u] %s signed by an unknown delegate, accept the %u headers before it\n",
+                         header.GetHeight(), hash.GetHex(), hashes.size());
+                break;
+            }
+        }
+
+        hashes.push_back(hash);
+        lastHash   = hash;
+        lastHeight = header.GetHeight();
+        lastTime   = header.GetTime();
+    }
+
+    acceptedCount = hashes.size();
+    // keep the longest header chain only
+    if (hashes.empty() || lastHeight <= GetBestHeight())
+        return true;
+
+    if (heightIt != mapHeights.end()) {
+        // extend the header chain, or fork from one of its headers
+        while (baseHeight + (int32_t)headers.size() - 1 > prevHeight) {
+            mapHeights.erase(headers.back().hash);
+            headers.pop_back();
+        }
+    } else {
+        // start the header chain from the block index
+        headers.clear();
+        mapHeights.clear();
+        baseHeight = prevHeight + 1;
+    }
+
+    for (size_t i = 0; i < hashes.size(); i++) {
+        headers.push_back({hashes[i], newHeaders[i].GetTime()});
+        mapHeights[hashes[i]] = newHeaders[i].GetHeight();
+    }
+
+    LogPrint(BCLog::NET, "accept %u headers, best header height=%d, hash=%s\n", hashes.size(), lastHeight,
+             lastHash.GetHex());
+    return true;
+}
+
+int32_t CHeadersSync::GetBestHeight() const {
+    LOCK(cs);
+    return headers.empty() ? 0 : baseHeight + headers.size() - 1;
+}
+
+uint256 CHeadersSync::GetBestHash() const {
+    LOCK(cs);
+    return headers.empty() ? uint256() : headers.back().hash;
+}
+
+bool CHeadersSync::HasHeader(const uint256 &hash) const {
+    LOCK(cs);
+    return mapHeights.count(hash) > 0;
+}
+
+int32_t CHeadersSync::GetHeight(const uint256 &hash) const {
+    LOCK(cs);
+    auto it = mapHeights.find(hash);
+    return it == mapHeights.end() ? -1 : it->second;
+}
+
+void CHeadersSync::GetHashes(int32_t beginHeight, int32_t endHeight, vector<uint256> &hashes) const {
+    LOCK(cs);
+    beginHeight = std::max(beginHeight, baseHeight);
+    endHeight   = std::min(endHeight, baseHeight + (int32_t)headers.size() - 1);
+    for (int32_t height = beginHeight; height <= endHeight; height++)
+        hashes.push_back(headers[height - baseHeight].hash);
+}
+
+void CHeadersSync::Prune(int32_t height) {
+    LOCK(cs);
+    while (!headers.empty() && baseHeight <= height) {
+        mapHeights.erase(headers.front().hash);
+        headers.pop_front();
+        baseHeight++;
+    }
+}
+
+int32_t CHeadersSync::GetPeerDownloadWindow(double downloadRate) {
+    int32_t window = downloadRate * BLOCK_DOWNLOAD_TARGET_TIME;
+    return std::max(MIN_BLOCKS_IN_TRANSIT_PER_PEER, std::min(window, MAX_BLOCKS_IN_TRANSIT_PER_PEER));
+}
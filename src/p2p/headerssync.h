@@ -0,0 +1,81 @@
+// Copyright (c) 2017-2019 The GreenVenturesChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef P2P_HEADERSSYNC_H
+#define P2P_HEADERSSYNC_H
+
+#include "persistence/block.h"
+#include "sync.h"
+
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+class CValidationState;
+
+enum HeaderSignerStatus {
+    HEADER_SIGNER_VERIFIED,  // signed by one of the delegates
+    HEADER_SIGNER_UNKNOWN,   // not verifiable before the blocks in front of it are connected
+    HEADER_SIGNER_INVALID,   // not signed by the delegate of its slot
+};
+
+/**
+ * The chain state the headers are checked against: the block index, which the headers connect to, and the delegates
+ * of the tip, which sign the headers beyond it.
+ */
+class CHeadersContext {
+public:
+    virtual ~CHeadersContext() {}
+
+    // the height and time of the block the headers connect to, false with the state set if it is not acceptable
+    virtual bool GetPrevBlock(const uint256 &hash, int32_t &height, uint32_t &time, CValidationState &state) = 0;
+    // the header of the block we have, which is validated already
+    virtual bool HaveBlock(const uint256 &hash) = 0;
+    virtual HeaderSignerStatus CheckSigner(const CBlockHeader &header) = 0;
+    virtual int64_t GetAdjustedTime() = 0;
+};
+
+/**
+ * The header chain of the headers-first sync, beyond the blocks we have. The headers are fetched by getheaders
+ * from the sync peer and validated against each other and the block index, then the blocks of the download
+ * window are requested from all of the peers in parallel, which are connected in order by the orphan blocks.
+ */
+class CHeadersSync {
+public:
+    // Requires cs_main. Append the headers to the best header chain, return false on the invalid headers. The
+    // headers from the first one of an unknown signer are not accepted, acceptedCount is the count of the rest.
+    bool AcceptHeaders(const std::vector<CBlockHeader> &headers, CValidationState &state, size_t &acceptedCount);
+    bool AcceptHeaders(const std::vector<CBlockHeader> &headers, CHeadersContext &context, CValidationState &state,
+                       size_t &acceptedCount);
+
+    int32_t GetBestHeight() const;
+    uint256 GetBestHash() const;
+    bool HasHeader(const uint256 &hash) const;
+    // the height of the header in the best header chain, -1 if it is not
+    int32_t GetHeight(const uint256 &hash) const;
+
+    // the block hashes of the heights [beginHeight, endHeight] of the best header chain
+    void GetHashes(int32_t beginHeight, int32_t endHeight, std::vector<uint256> &hashes) const;
+
+    // drop the headers of the blocks connected already
+    void Prune(int32_t height);
+
+    // the download window of a peer, the blocks it downloads at its rate (blocks per second) in the target time
+    static int32_t GetPeerDownloadWindow(double downloadRate);
+
+private:
+    struct CHeaderEntry {
+        uint256 hash;
+        uint32_t time;
+    };
+
+    mutable CCriticalSection cs;
+    int32_t baseHeight = 0;  // the height of the first header
+    std::deque<CHeaderEntry> headers;
+    std::unordered_map<uint256, int32_t, CUint256Hasher> mapHeights;  // hash -> height of the headers
+};
+
+extern CHeadersSync headersSync;
+
+#endif  // P2P_HEADERSSYNC_H
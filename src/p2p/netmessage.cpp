@@ -5,6 +5,94 @@
 
 #include "netmessage.h"
 
+#include "crypto/hash.h"
+
+// the buffers of the blocks are allocated on demand, the pooled buffers are limited in number and capacity
+static const uint32_t MIN_POOLED_RECV_BUFFER_SHIFT   = 8;  // 256 bytes
+static const size_t MAX_POOLED_RECV_BUFFERS_PER_CLASS = 16;
+
+CRecvBufferPool recvBufferPool;
+
+CSharedMessage MakeSharedMessage(const char* pszCommand, const CDataStream& payload) {
+    auto spData = std::make_shared<CSerializeData>();
+    spData->reserve(CMessageHeader::HEADER_SIZE + payload.size());
+
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << CMessageHeader(pszCommand, payload.size());
+    ss.GetAndClear(*spData);
+    spData->insert(spData->end(), payload.begin(), payload.end());
+
+    uint256 hash       = Hash(payload.begin(), payload.end());
+    uint32_t nChecksum = 0;
+    memcpy(&nChecksum, &hash, sizeof(nChecksum));
+    memcpy(&(*spData)[CMessageHeader::CHECKSUM_OFFSET], &nChecksum, sizeof(nChecksum));
+
+    return spData;
+}
+
+// the smallest class whose buffers hold nSize bytes, -1 if none
+static int32_t GetAcquireSizeClass(uint32_t nSize) {
+    for (uint32_t sizeClass = 0; sizeClass < CRecvBufferPool::SIZE_CLASS_COUNT; sizeClass++) {
+        if (nSize <= (1U << (sizeClass + MIN_POOLED_RECV_BUFFER_SHIFT)))
+            return sizeClass;
+    }
+    return -1;
+}
+
+// the class of the buffer of the capacity, -1 if it is not pooled
+static int32_t GetReleaseSizeClass(size_t capacity) {
+    for (int32_t sizeClass = CRecvBufferPool::SIZE_CLASS_COUNT - 1; sizeClass >= 0; sizeClass--) {
+        size_t classSize = 1U << (sizeClass + MIN_POOLED_RECV_BUFFER_SHIFT);
+        if (capacity >= classSize)
+            return capacity < classSize * 2 ? sizeClass : -1;
+    }
+    return -1;
+}
+
+void CRecvBufferPool::Acquire(CDataStream& stream, uint32_t nSize) {
+    int32_t sizeClass = GetAcquireSizeClass(nSize);
+    bool fReused      = false;
+    if (sizeClass >= 0) {
+        LOCK(cs);
+        // the buffers of the class and the next one are large enough
+        for (uint32_t c = sizeClass; c <= (uint32_t)sizeClass + 1 && c < SIZE_CLASS_COUNT && !fReused; c++) {
+            if (!buffers[c].empty()) {
+                stream.SwapBuffer(buffers[c].back());
+                buffers[c].pop_back();
+                fReused = true;
+            }
+        }
+    }
+
+    // the new buffer takes the size of its class, to be pooled in it
+    if (!fReused && sizeClass >= 0)
+        stream.reserve(1U << (sizeClass + MIN_POOLED_RECV_BUFFER_SHIFT));
+
+    // A reused buffer keeps the size and data of its last message, which are overwritten by the receiving. The
+    // resize zero-fills only the bytes beyond the last size.
+    stream.resize(nSize);
+}
+
+void CRecvBufferPool::Release(CDataStream& stream) {
+    CSerializeData vch;
+    stream.SwapBuffer(vch);
+    int32_t sizeClass = GetReleaseSizeClass(vch.capacity());
+    if (sizeClass < 0)
+        return;
+
+    LOCK(cs);
+    if (buffers[sizeClass].size() < MAX_POOLED_RECV_BUFFERS_PER_CLASS)
+        buffers[sizeClass].push_back(std::move(vch));
+}
+
+size_t CRecvBufferPool::GetPooledCount() const {
+    LOCK(cs);
+    size_t count = 0;
+    for (const auto &classBuffers : buffers)
+        count += classBuffers.size();
+    return count;
+}
+
 int32_t CNetMessage::readHeader(const char* pch, uint32_t nBytes) {
     // copy data to temporary parsing buffer
     uint32_t nRemaining = 24 - nHdrPos;
@@ -30,7 +118,7 @@ int32_t CNetMessage::readHeader(const char* pch, uint32_t nBytes) {
 
     // switch state to reading message data
     in_data = true;
-    vRecv.resize(hdr.nMessageSize);
+    recvBufferPool.Acquire(vRecv, hdr.nMessageSize);
 
     return nCopy;
 }
@@ -7,7 +7,51 @@
 #define P2P_NETMESSAGE_H
 
 #include "commons/serialize.h"
+#include "config/version.h"
 #include "p2p/protocol.h"
+#include "sync.h"
+
+#include <memory>
+#include <vector>
+
+/**
+ * The immutable framed message (header, checksum and payload) of the send queues, the message relayed to many
+ * peers is serialized and hashed once and the buffer is shared by all of their send queues. The payload is
+ * serialized at the send version of the peers, the message is shared by the peers of the same version only.
+ */
+typedef std::shared_ptr<const CSerializeData> CSharedMessage;
+
+CSharedMessage MakeSharedMessage(const char* pszCommand, const CDataStream& payload);
+
+template <typename T>
+CSharedMessage MakeSharedMessage(const char* pszCommand, const T& payload, int32_t nVersion) {
+    CDataStream ss(SER_NETWORK, nVersion);
+    ss << payload;
+    return MakeSharedMessage(pszCommand, ss);
+}
+
+/**
+ * The pool of the receive buffers of CNetMessage, the buffers of the processed messages are recycled by the
+ * new messages instead of being allocated and freed for every message. The buffers are bucketed by the size class
+ * of their capacity, the powers of two from 256 bytes to 1MiB.
+ */
+class CRecvBufferPool {
+public:
+    static const uint32_t SIZE_CLASS_COUNT = 13;
+
+    // give the stream a buffer of nSize bytes, reused from the pool if any
+    void Acquire(CDataStream& stream, uint32_t nSize);
+    // return the buffer of the stream to the pool, the stream is left empty
+    void Release(CDataStream& stream);
+
+    size_t GetPooledCount() const;
+
+private:
+    mutable CCriticalSection cs;
+    std::vector<CSerializeData> buffers[SIZE_CLASS_COUNT];
+};
+
+extern CRecvBufferPool recvBufferPool;
 
 class CNetMessage {
 public:
@@ -8,6 +8,11 @@
 #include "netmessage.h"
 #include <openssl/rand.h>
 
+#ifndef WIN32
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
+
 uint64_t CNode::nTotalBytesRecv = 0;
 uint64_t CNode::nTotalBytesSent = 0;
 CCriticalSection CNode::cs_totalBytesRecv;
@@ -36,33 +41,70 @@ CNodeState *State(NodeId pNode) {
     return &it->second;
 }
 
+#ifndef WIN32
+// the queued messages gathered by one sendmsg
+static const int32_t MAX_SEND_IOVECS = 64;
+#endif
+
 // requires LOCK(cs_vSend)
 void CNode::SocketSendData() {
-    deque<CSerializeData>::iterator it = vSendMsg.begin();
+    deque<CSharedMessage>::iterator it = vSendMsg.begin();
 
     while (it != vSendMsg.end()) {
-        const CSerializeData& data = *it;
-        assert(data.size() > nSendOffset);
-        int32_t nBytes = send(hSocket, &data[nSendOffset], data.size() - nSendOffset,
-                              MSG_NOSIGNAL | MSG_DONTWAIT);
+        assert((*it)->size() > nSendOffset);
+#ifdef WIN32
+        const CSerializeData& data = **it;
+        size_t nWanted = data.size() - nSendOffset;
+        int32_t nBytes = send(hSocket, &data[nSendOffset], nWanted, MSG_NOSIGNAL | MSG_DONTWAIT);
+#else
+        // scatter-gather the queued messages, the shared buffers are written to the socket without being copied
+        struct iovec iov[MAX_SEND_IOVECS];
+        int32_t nIov   = 0;
+        size_t nWanted = 0;
+        for (auto itMsg = it; itMsg != vSendMsg.end() && nIov < MAX_SEND_IOVECS; ++itMsg, ++nIov) {
+            size_t nOffset     = (nIov == 0) ? nSendOffset : 0;
+            iov[nIov].iov_base = (void*)((*itMsg)->data() + nOffset);
+            iov[nIov].iov_len  = (*itMsg)->size() - nOffset;
+            nWanted += iov[nIov].iov_len;
+        }
+
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov    = iov;
+        msg.msg_iovlen = nIov;
+        ssize_t nBytes = sendmsg(hSocket, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+#endif
         if (nBytes > 0) {
             nLastSend = GetTime();
             nSendBytes += nBytes;
-            nSendOffset += nBytes;
             RecordBytesSent(nBytes);
-            if (nSendOffset == data.size()) {
+
+            // pop the messages sent completely
+            size_t nSent = nBytes;
+            while (nSent > 0) {
+                size_t nRemaining = (*it)->size() - nSendOffset;
+                if (nSent < nRemaining) {
+                    nSendOffset += nSent;
+                    break;
+                }
+                nSent -= nRemaining;
                 nSendOffset = 0;
-                nSendSize -= data.size();
+                nSendSize -= (*it)->size();
                 it++;
-            } else {
-                // could not send full message; stop sending more
+            }
+
+            if ((size_t)nBytes < nWanted) {
+                // could not send all of the data; stop sending more
+                fSendReady = false;
                 break;
             }
         } else {
             if (nBytes < 0) {
                 // error
                 int32_t nErr = WSAGetLastError();
-                if (nErr != WSAEWOULDBLOCK && nErr != WSAEMSGSIZE && nErr != WSAEINTR && nErr != WSAEINPROGRESS) {
+                if (nErr == WSAEWOULDBLOCK) {
+                    fSendReady = false;
+                } else if (nErr != WSAEMSGSIZE && nErr != WSAEINTR && nErr != WSAEINPROGRESS) {
                     LogPrint(BCLog::INFO, "socket send error %s\n", NetworkErrorString(nErr));
                     CloseSocketDisconnect();
                 }
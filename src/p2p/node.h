@@ -17,6 +17,9 @@
 #include "commons/mruset.h"
 #include "commons/random.h"
 #include "p2p/netmessage.h"
+#include "p2p/socketevents.h"
+
+#include <atomic>
 
 class CNode ;
 struct CNodeSignals;
@@ -115,14 +118,29 @@ struct CNodeState {
     int32_t nBlocksToDownload;        // blocks number to be downloaded
     int64_t nLastBlockReceive;        // the latest receiving blocks time
     int64_t nLastBlockProcess;        // the latest processing blocks time
+    int32_t nBlocksReceived;          // requested blocks received since the last download rate sample
+    int64_t nLastRateSample;          // the time of the last download rate sample in microseconds
+    double downloadRate;              // moving average of the requested blocks received per second
+    int32_t nDownloadStalls;          // times of stalling the headers-first download window
+    int64_t nLastStall;               // the time of the last stall in microseconds
+    uint256 hashBestHeader;           // the last header of the best header chain which the peer sent
+    int32_t nBestHeaderHeight;        // the height of hashBestHeader, the peer has the blocks up to it
+    int64_t nLastHeadersRequest;      // the time of the last getheaders to the peer
 
     CNodeState() {
-        nMisbehavior      = 0;
-        fShouldBan        = false;
-        nBlocksToDownload = 0;
-        nBlocksInFlight   = 0;
-        nLastBlockReceive = 0;
-        nLastBlockProcess = 0;
+        nMisbehavior        = 0;
+        fShouldBan          = false;
+        nBlocksToDownload   = 0;
+        nBlocksInFlight     = 0;
+        nLastBlockReceive   = 0;
+        nLastBlockProcess   = 0;
+        nBlocksReceived     = 0;
+        nLastRateSample     = 0;
+        downloadRate        = 0;
+        nDownloadStalls     = 0;
+        nLastStall          = 0;
+        nBestHeaderHeight   = 0;
+        nLastHeadersRequest = 0;
     }
 };
 
@@ -139,8 +157,12 @@ public:
     size_t nSendSize;    // total size of all vSendMsg entries
     size_t nSendOffset;  // offset inside the first vSendMsg already sent
     uint64_t nSendBytes;
-    deque<CSerializeData> vSendMsg;
+    deque<CSharedMessage> vSendMsg;  // the framed messages, shared with the send queues of the other peers
     CCriticalSection cs_vSend;
+    // the socket events, set when the socket is ready, cleared when the recv or send would block
+    std::atomic<bool> fRecvReady;
+    std::atomic<bool> fSendReady;
+    bool fSocketRegistered;  // registered to the epoll, by the socket handler thread only
 
     deque<CInv> vRecvGetData;  // strCommand == "getdata 保存的inv
     deque<CNetMessage> vRecvMsg;
@@ -172,6 +194,7 @@ public:
     // b) the peer may tell us in their version message that we should not relay tx invs
     //    until they have initialized their bloom filter.
     bool fRelayTxes;
+    std::atomic<bool> fSupportsCompactBlocks;  // the peer accepts the compact blocks, announced by sendcmpct
     CSemaphoreGrant grantOutbound;
     CCriticalSection cs_filter;
     CBloomFilter* pFilter;
@@ -245,6 +268,9 @@ public:
         nRefCount                = 0;
         nSendSize                = 0;
         nSendOffset              = 0;
+        fRecvReady               = false;
+        fSendReady               = false;
+        fSocketRegistered        = false;
         hashContinue             = uint256();
         pIndexLastGetBlocksBegin = 0;
         hashLastGetBlocksEnd     = uint256();
@@ -252,6 +278,7 @@ public:
         fStartSync               = false;
         fGetAddr                 = false;
         fRelayTxes               = false;
+        fSupportsCompactBlocks   = false;
         setInventoryKnown.max_size(SendBufferSize() / 1000);
         setBlockConfirmMsgKnown.max_size(200);
         pFilter        = new CBloomFilter();
@@ -318,6 +345,9 @@ public:
     // requires LOCK(cs_vRecvMsg)
     bool ReceiveMsgBytes(const char* pch, uint32_t nBytes);
 
+    // the version of the messages sent to the peer, set by the version handshake
+    int32_t GetSendVersion() { return ssSend.GetVersion(); }
+
     // requires LOCK(cs_vRecvMsg)
     void SetRecvVersion(int32_t nVersionIn) {
         nRecvVersion = nVersionIn;
@@ -465,18 +495,40 @@ public:
 
             LogPrint(BCLog::NET, "(%d bytes)\n", nSize);
 
-            deque<CSerializeData>::iterator it = vSendMsg.insert(vSendMsg.end(), CSerializeData());
-            ssSend.GetAndClear(*it);
-            nSendSize += (*it).size();
-
-            // If write queue empty, attempt "optimistic write"
-            if (it == vSendMsg.begin()) SocketSendData();
+            auto spData = std::make_shared<CSerializeData>();
+            ssSend.GetAndClear(*spData);
+            QueueSendMessage(spData);
 
             LEAVE_CRITICAL_SECTION(cs_vSend);
     }
 
+    // Push the message framed by MakeSharedMessage, the buffer is queued without being copied.
+    void PushSharedMessage(const CSharedMessage& spMessage) {
+        LOCK(cs_vSend);
+        LogPrint(BCLog::NET, "sending shared message (%d bytes)\n", spMessage->size() - CMessageHeader::HEADER_SIZE);
+        QueueSendMessage(spMessage);
+    }
+
     void PushVersion();
 
+    // requires LOCK(cs_vSend)
+    void QueueSendMessage(const CSharedMessage& spMessage) {
+        bool fWasEmpty = vSendMsg.empty();
+        vSendMsg.push_back(spMessage);
+        nSendSize += spMessage->size();
+
+        // If write queue empty, attempt "optimistic write"
+        if (fWasEmpty) {
+            SocketSendData();
+
+            // The rest is sent by the socket handler when the socket is writable again. The edge-triggered epoll
+            // reports it by itself, select is woken up to watch the socket for sending. The messages queued behind
+            // a pending one take no syscall, the socket is watched already.
+            if (!vSendMsg.empty() && !socketEvents.IsEpoll())
+                socketEvents.Wakeup();
+        }
+    }
+
     void PushMessage(const char* pszCommand) {
         try {
             BeginMessage(pszCommand);
@@ -61,6 +61,17 @@ bool static ProcessMessage(CNode *pFrom, string strCommand, CDataStream &vRecv)
             return true;
     }
 
+    else if (strCommand == NetMsgType::HEADERS &&
+            !SysCfg().IsImporting() && !SysCfg().IsReindex())
+    {
+        if (!ProcessHeadersMessage(pFrom, vRecv))
+            return false;
+    }
+
+    else if (strCommand == NetMsgType::NOTFOUND) {
+        ProcessNotFoundMessage(pFrom, vRecv);
+    }
+
     else if (strCommand == NetMsgType::TX) {
         if (!ProcessTxMessage(pFrom, strCommand, vRecv))
             return false;
@@ -72,6 +83,28 @@ bool static ProcessMessage(CNode *pFrom, string strCommand, CDataStream &vRecv)
         ProcessBlockMessage(pFrom, vRecv);
     }
 
+    else if (strCommand == NetMsgType::SENDCMPCT) {
+        ProcessSendCmpctMessage(pFrom, vRecv);
+    }
+
+    else if (strCommand == NetMsgType::CMPCTBLOCK &&
+            !SysCfg().IsImporting() && !SysCfg().IsReindex())  // Ignore blocks received while importing
+    {
+        ProcessCmpctBlockMessage(pFrom, vRecv);
+    }
+
+    else if (strCommand == NetMsgType::GETBLOCKTXN) {
+        if (!ProcessGetBlockTxnMessage(pFrom, vRecv))
+            return false;
+    }
+
+    else if (strCommand == NetMsgType::BLOCKTXN &&
+            !SysCfg().IsImporting() && !SysCfg().IsReindex())
+    {
+        if (!ProcessBlockTxnMessage(pFrom, vRecv))
+            return false;
+    }
+
     else if (strCommand == NetMsgType::GETADDR) {
         pFrom->vAddrToSend.clear();
         vector<CAddress> vAddr = addrman.GetAddr();
@@ -150,6 +183,13 @@ bool static ProcessMessage(CNode *pFrom, string strCommand, CDataStream &vRecv)
     return true;
 }
 
+// the messages taking cs_main ahead of the tx admission
+inline bool IsPriorityMessage(const string &strCommand) {
+    return strCommand == NetMsgType::BLOCK || strCommand == NetMsgType::CMPCTBLOCK ||
+           strCommand == NetMsgType::BLOCKTXN || strCommand == NetMsgType::HEADERS ||
+           strCommand == NetMsgType::CONFIRMBLOCK || strCommand == NetMsgType::FINALITYBLOCK;
+}
+
 // requires LOCK(cs_vRecvMsg)
 bool ProcessMessages(CNode *pFrom) {
     //if (fDebug)
@@ -227,6 +267,7 @@ bool ProcessMessages(CNode *pFrom) {
         // Process message
         bool fRet = false;
         try {
+            CTxAdmissionQueue::CPriorityGuard priorityGuard(txAdmission, IsPriorityMessage(strCommand));
             fRet = ProcessMessage(pFrom, strCommand, vRecv);
             boost::this_thread::interruption_point();
         } catch (std::ios_base::failure &e) {
@@ -256,8 +297,11 @@ bool ProcessMessages(CNode *pFrom) {
     }
 
     // In case the connection got shut down, its receive buffer was wiped
-    if (!pFrom->fDisconnect)
+    if (!pFrom->fDisconnect) {
+        for (auto itMsg = pFrom->vRecvMsg.begin(); itMsg != it; ++itMsg)
+            recvBufferPool.Release(itMsg->vRecv);
         pFrom->vRecvMsg.erase(pFrom->vRecvMsg.begin(), it);
+    }
 
     return fOk;
 }
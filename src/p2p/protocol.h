@@ -131,7 +131,7 @@ extern const char *TX;
  * @since protocol version 31800.
  * @see https://bitcoin.org/en/developer-reference#headers
  */
-// extern const char *HEADERS;
+extern const char *HEADERS;
 /**
  * The block message transmits a single serialized block.
  * @see https://bitcoin.org/en/developer-reference#block
@@ -169,7 +169,7 @@ extern const char *PONG;
  * @since protocol version 70001.
  * @see https://bitcoin.org/en/developer-reference#notfound
  */
-// extern const char *NOTFOUND;
+extern const char *NOTFOUND;
 extern const char *ALERT;
 /**
  * The filterload message tells the receiving peer to filter all relayed
@@ -383,6 +383,8 @@ enum
     // Nodes may always request a MSG_FILTERED_BLOCK in a getdata, however,
     // MSG_FILTERED_BLOCK should not appear in any invs except as a part of getdata.
     MSG_FILTERED_BLOCK,
+    // the block is replied by a "cmpctblock" message, requested only from the peers sent "sendcmpct"
+    MSG_CMPCT_BLOCK,
 };
 
 #endif // __INCLUDED_PROTOCOL_H__
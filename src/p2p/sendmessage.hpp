@@ -26,6 +26,60 @@ void MarkBlockAsInFlight(const uint256 &hash, NodeId nodeId) {
     mapBlocksInFlight[hash] = std::make_tuple(nodeId, it, GetTimeMicros());
 }
 
+// Requires cs_mapNodeState.
+// Headers-first sync: queue the blocks of the download window to the peer by its download rate, and release the
+// blocks of the peer holding the first block of the window for too long to the other peers. The stalling peer is
+// not given any blocks until the stalling timeout passes, so the released ones go to the others.
+void ScheduleBlockDownload(CNode *pTo, CNodeState &state, const vector<uint256> &vWindowBlocks) {
+    AssertLockHeld(cs_mapNodeState);
+    int64_t now = GetTimeMicros();
+    if (state.nLastRateSample == 0) {
+        state.nLastRateSample = now;
+    } else if (now - state.nLastRateSample >= BLOCK_DOWNLOAD_RATE_SAMPLE_INTERVAL * 1000000) {
+        double sampleRate     = state.nBlocksReceived * 1000000.0 / (now - state.nLastRateSample);
+        state.downloadRate    = state.downloadRate * 0.7 + sampleRate * 0.3;
+        state.nBlocksReceived = 0;
+        state.nLastRateSample = now;
+    }
+
+    if (vWindowBlocks.empty() || now - state.nLastStall < BLOCK_STALLING_TIMEOUT * 1000000)
+        return;
+
+    auto itFirst = mapBlocksInFlight.find(vWindowBlocks.front());
+    if (itFirst != mapBlocksInFlight.end() && std::get<0>(itFirst->second) == pTo->GetId() &&
+        now - std::get<2>(itFirst->second) > BLOCK_STALLING_TIMEOUT * 1000000) {
+        LogPrint(BCLog::NET, "peer %s is stalling the block download window, release its %d blocks, stalls=%d\n",
+                 state.name, state.nBlocksInFlight + state.nBlocksToDownload, state.nDownloadStalls + 1);
+
+        vector<uint256> vReleased(state.vBlocksToDownload.begin(), state.vBlocksToDownload.end());
+        for (const auto &queuedBlock : state.vBlocksInFlight)
+            vReleased.push_back(queuedBlock.hash);
+        for (const auto &hash : vReleased)
+            MarkBlockAsReceived(hash);
+
+        state.downloadRate = 0;
+        state.nLastStall   = now;
+        if (++state.nDownloadStalls >= MAX_BLOCK_DOWNLOAD_STALLS) {
+            LogPrint(BCLog::INFO, "Peer %s is stalling block download, disconnecting\n", state.name);
+            pTo->fDisconnect = true;
+        }
+        return;
+    }
+
+    int32_t window = CHeadersSync::GetPeerDownloadWindow(state.downloadRate);
+    for (const auto &hash : vWindowBlocks) {
+        if (state.nBlocksInFlight + state.nBlocksToDownload >= window)
+            break;
+
+        if (mapBlocksInFlight.count(hash) || mapBlocksToDownload.count(hash))
+            continue;
+
+        list<uint256>::iterator it = state.vBlocksToDownload.insert(state.vBlocksToDownload.end(), hash);
+        state.nBlocksToDownload++;
+        mapBlocksToDownload[hash] = std::make_tuple(pTo->GetId(), it, now);
+    }
+}
+
 bool SendMessages(CNode *pTo, bool fSendTrickle) {
     {
         // Don't send anything until we get their version message
@@ -68,11 +122,48 @@ bool SendMessages(CNode *pTo, bool fSendTrickle) {
             //LogPrint(BCLog::NET, "send ping: %s\n", DateTimeStrFormat("YYYY-MM-DDTHH-MM-SS", pTo->nPingUsecStart).c_str());
         }
 
+        vector<uint256> vWindowBlocks;
+        int32_t blockInvType = MSG_BLOCK;
         {
             TRY_LOCK(cs_main, lockMain);  // Acquire cs_main for IsInitialBlockDownload() and CNodeState()
             if (!lockMain)
                 return true;
 
+            // the new blocks are requested as compact blocks, most of their txs are in the mempool already.
+            // IsInitialBlockDownload() takes cs_main, which must not be taken after cs_mapNodeState
+            if (pTo->fSupportsCompactBlocks && !IsInitialBlockDownload())
+                blockInvType = MSG_CMPCT_BLOCK;
+
+            // Headers-first sync: the blocks of the download window which the peer is able to serve, the ones up
+            // to the last of its headers in the best header chain
+            int32_t tipHeight = chainActive.Height();
+            if (fHeadersFirst && pTo->fSuccessfullyConnected && !SysCfg().IsImporting() && !SysCfg().IsReindex()) {
+                int32_t peerHeaderHeight   = 0;
+                int64_t lastHeadersRequest = 0;
+                {
+                    LOCK(cs_mapNodeState);
+                    CNodeState *state = State(pTo->GetId());
+                    if (headersSync.HasHeader(state->hashBestHeader))
+                        peerHeaderHeight = state->nBestHeaderHeight;
+                    lastHeadersRequest = state->nLastHeadersRequest;
+                }
+
+                // the peer has more blocks than its headers we accepted, the sync peer is started below
+                if (!pTo->fStartSync && pTo->nStartingHeight > std::max(tipHeight, peerHeaderHeight) &&
+                    GetTime() - lastHeadersRequest >= HEADERS_REQUEST_INTERVAL)
+                    PushGetHeaders(pTo);
+
+                if (headersSync.GetBestHeight() > tipHeight && peerHeaderHeight > tipHeight) {
+                    vector<uint256> vHashes;
+                    headersSync.GetHashes(tipHeight + 1, std::min(tipHeight + BLOCK_DOWNLOAD_WINDOW,
+                                          peerHeaderHeight), vHashes);
+                    for (const auto &hash : vHashes) {
+                        if (!mapBlockIndex.count(hash) && !mapOrphanBlocks.count(hash))
+                            vWindowBlocks.push_back(hash);
+                    }
+                }
+            }
+
             // Address refresh broadcast
             static int64_t nLastRebroadcast;
             if (!IsInitialBlockDownload() && (GetTime() - nLastRebroadcast > 24 * 60 * 60)) {
@@ -120,8 +211,13 @@ bool SendMessages(CNode *pTo, bool fSendTrickle) {
             if (pTo->fStartSync && !SysCfg().IsImporting() && !SysCfg().IsReindex()) {
                 pTo->fStartSync = false;
                 nSyncTipHeight  = pTo->nStartingHeight;
-                LogPrint(BCLog::NET, "start block sync lead to getblocks\n");
-                PushGetBlocks(pTo, chainActive.Tip(), uint256());
+                if (fHeadersFirst) {
+                    LogPrint(BCLog::NET, "start block sync lead to getheaders\n");
+                    PushGetHeaders(pTo);
+                } else {
+                    LogPrint(BCLog::NET, "start block sync lead to getblocks\n");
+                    PushGetBlocks(pTo, chainActive.Tip(), uint256());
+                }
             }
 
             // Resend wallet transactions that haven't gotten in a block yet
@@ -213,6 +309,8 @@ bool SendMessages(CNode *pTo, bool fSendTrickle) {
             pTo->fDisconnect = true;
         }
 
+        ScheduleBlockDownload(pTo, state, vWindowBlocks);
+
         //
         // Message: getdata (blocks)
         //
@@ -220,7 +318,7 @@ bool SendMessages(CNode *pTo, bool fSendTrickle) {
         int32_t index = 0;
         while (!pTo->fDisconnect && state.nBlocksToDownload && state.nBlocksInFlight < MAX_BLOCKS_IN_TRANSIT_PER_PEER) {
             uint256 hash = state.vBlocksToDownload.front();
-            vGetData.push_back(CInv(MSG_BLOCK, hash));
+            vGetData.push_back(CInv(blockInvType, hash));
             MarkBlockAsInFlight(hash, pTo->GetId());
             LogPrint(BCLog::NET, "send MSG_BLOCK msg! time_ms=%lld, hash=%s, peer=%s, FlightBlocks=%d, index=%d\n",
                 GetTimeMillis(), hash.ToString(), state.name, state.nBlocksInFlight, index++);
@@ -0,0 +1,206 @@
+// Copyright (c) 2017-2019 The GreenVenturesChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "socketevents.h"
+
+#include "commons/util/util.h"
+#include "netbase.h"
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+
+#include <algorithm>
+
+// the ready events returned by one epoll_wait
+static const int32_t MAX_EPOLL_EVENTS = 1024;
+
+CSocketEvents socketEvents;
+
+bool CSocketEvents::Open(bool fUseEpoll) {
+    Close();
+
+#ifdef __linux__
+    wakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeupFd == -1)
+        LogPrint(BCLog::INFO, "eventfd failed: %s, the socket handler is not woken up on sends\n",
+                 NetworkErrorString(errno));
+
+    if (fUseEpoll) {
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        if (epollFd == -1) {
+            LogPrint(BCLog::INFO, "epoll_create1 failed: %s, fall back to select\n", NetworkErrorString(errno));
+        } else if (wakeupFd != -1) {
+            struct epoll_event event;
+            event.events  = EPOLLIN;  // level triggered, drained by the wait
+            event.data.fd = wakeupFd;
+            if (epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeupFd, &event) == -1)
+                LogPrint(BCLog::INFO, "epoll_ctl(eventfd) failed: %s\n", NetworkErrorString(errno));
+        }
+    }
+#endif
+
+    LogPrint(BCLog::INFO, "Using %s for the socket events\n", IsEpoll() ? "epoll" : "select");
+    return true;
+}
+
+void CSocketEvents::Close() {
+#ifdef __linux__
+    if (epollFd != -1) {
+        close(epollFd);
+        epollFd = -1;
+    }
+    if (wakeupFd != -1) {
+        close(wakeupFd);
+        wakeupFd = -1;
+    }
+#endif
+    fWakeupPending = false;
+}
+
+bool CSocketEvents::IsSocketSupported(SOCKET hSocket) const {
+#ifndef WIN32
+    // fd_set is a bitmap of FD_SETSIZE bits
+    if (!IsEpoll() && hSocket >= FD_SETSIZE)
+        return false;
+#endif
+    return true;
+}
+
+bool CSocketEvents::AddSocket(SOCKET hSocket, bool fEdgeTriggered) {
+#ifdef __linux__
+    if (epollFd == -1)
+        return false;
+
+    struct epoll_event event;
+    event.events  = EPOLLIN | EPOLLOUT | EPOLLRDHUP;
+    if (fEdgeTriggered)
+        event.events |= EPOLLET;
+    event.data.fd = hSocket;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, hSocket, &event) == -1) {
+        LogPrint(BCLog::INFO, "epoll_ctl(%d) failed: %s\n", hSocket, NetworkErrorString(errno));
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+int32_t CSocketEvents::Wait(const std::vector<CReadySocket> &wanted, int64_t timeoutMs,
+                            std::vector<CReadySocket> &ready) {
+    ready.clear();
+    int32_t ret = IsEpoll() ? WaitEpoll(timeoutMs, ready) : WaitSelect(wanted, timeoutMs, ready);
+    ClearWakeup();
+    return ret;
+}
+
+int32_t CSocketEvents::WaitEpoll(int64_t timeoutMs, std::vector<CReadySocket> &ready) {
+#ifdef __linux__
+    struct epoll_event events[MAX_EPOLL_EVENTS];
+    int32_t nEvents = epoll_wait(epollFd, events, MAX_EPOLL_EVENTS, timeoutMs);
+    if (nEvents < 0)
+        return errno == EINTR ? 0 : SOCKET_ERROR;
+
+    for (int32_t i = 0; i < nEvents; i++) {
+        if (events[i].data.fd == wakeupFd)
+            continue;
+
+        uint32_t readyEvents = 0;
+        if (events[i].events & (EPOLLIN | EPOLLRDHUP))
+            readyEvents |= EVENT_RECV;
+        if (events[i].events & EPOLLOUT)
+            readyEvents |= EVENT_SEND;
+        if (events[i].events & (EPOLLERR | EPOLLHUP))
+            readyEvents |= EVENT_ERROR;
+        ready.push_back({(SOCKET)events[i].data.fd, readyEvents});
+    }
+    return ready.size();
+#else
+    return SOCKET_ERROR;
+#endif
+}
+
+int32_t CSocketEvents::WaitSelect(const std::vector<CReadySocket> &wanted, int64_t timeoutMs,
+                                  std::vector<CReadySocket> &ready) {
+    struct timeval timeout;
+    timeout.tv_sec  = timeoutMs / 1000;
+    timeout.tv_usec = (timeoutMs % 1000) * 1000;
+
+    fd_set fdsetRecv;
+    fd_set fdsetSend;
+    fd_set fdsetError;
+    FD_ZERO(&fdsetRecv);
+    FD_ZERO(&fdsetSend);
+    FD_ZERO(&fdsetError);
+    SOCKET hSocketMax = 0;
+    bool have_fds     = false;
+
+    for (const auto &socket : wanted) {
+        // refused at accept and connect, never set beyond the fd_set
+        if (!IsSocketSupported(socket.hSocket))
+            continue;
+
+        if (socket.events & EVENT_RECV)
+            FD_SET(socket.hSocket, &fdsetRecv);
+        if (socket.events & EVENT_SEND)
+            FD_SET(socket.hSocket, &fdsetSend);
+        if (socket.events & EVENT_ERROR)
+            FD_SET(socket.hSocket, &fdsetError);
+        hSocketMax = std::max(hSocketMax, socket.hSocket);
+        have_fds   = true;
+    }
+
+#ifdef __linux__
+    if (wakeupFd != -1 && wakeupFd < FD_SETSIZE) {
+        FD_SET(wakeupFd, &fdsetRecv);
+        hSocketMax = std::max(hSocketMax, (SOCKET)wakeupFd);
+        have_fds   = true;
+    }
+#endif
+
+    int32_t nSelect = select(have_fds ? hSocketMax + 1 : 0, &fdsetRecv, &fdsetSend, &fdsetError, &timeout);
+    if (nSelect == SOCKET_ERROR)
+        return SOCKET_ERROR;
+
+    for (const auto &socket : wanted) {
+        if (!IsSocketSupported(socket.hSocket))
+            continue;
+
+        uint32_t readyEvents = 0;
+        if (FD_ISSET(socket.hSocket, &fdsetRecv))
+            readyEvents |= EVENT_RECV;
+        if (FD_ISSET(socket.hSocket, &fdsetSend))
+            readyEvents |= EVENT_SEND;
+        if (FD_ISSET(socket.hSocket, &fdsetError))
+            readyEvents |= EVENT_ERROR;
+        if (readyEvents != 0)
+            ready.push_back({socket.hSocket, readyEvents});
+    }
+    return ready.size();
+}
+
+void CSocketEvents::Wakeup() {
+#ifdef __linux__
+    if (wakeupFd == -1 || fWakeupPending.exchange(true))
+        return;
+
+    uint64_t value = 1;
+    if (write(wakeupFd, &value, sizeof(value)) != sizeof(value))
+        fWakeupPending = false;
+#endif
+}
+
+void CSocketEvents::ClearWakeup() {
+#ifdef __linux__
+    if (wakeupFd == -1 || !fWakeupPending.exchange(false))
+        return;
+
+    // a wakeup racing with the drain is lost, the socket handler is running the pass it asked for
+    uint64_t value = 0;
+    if (read(wakeupFd, &value, sizeof(value)) != sizeof(value) && errno != EAGAIN)
+        LogPrint(BCLog::INFO, "read eventfd failed: %s\n", NetworkErrorString(errno));
+#endif
+}
@@ -0,0 +1,68 @@
+// Copyright (c) 2017-2019 The GreenVenturesChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef P2P_SOCKETEVENTS_H
+#define P2P_SOCKETEVENTS_H
+
+#include "commons/compat/compat.h"
+
+#include <atomic>
+#include <vector>
+
+/**
+ * The socket events of the socket handler thread. On Linux the sockets are registered once to an edge-triggered
+ * epoll, so the wait does not scale with the number of connections, the ready sockets must be read or written
+ * until they would block. Otherwise the sockets wanted by every wait are polled by select, which is limited to
+ * FD_SETSIZE, the sockets beyond it are refused. The select wait is woken up by an eventfd (Linux only) when the
+ * other threads queue data to a socket it does not watch for sending.
+ */
+class CSocketEvents {
+public:
+    enum : uint32_t {
+        EVENT_RECV  = 1,
+        EVENT_SEND  = 2,
+        EVENT_ERROR = 4,
+    };
+
+    struct CReadySocket {
+        SOCKET hSocket;
+        uint32_t events;
+    };
+
+    CSocketEvents() {}
+    ~CSocketEvents() { Close(); }
+
+    // use the epoll if fUseEpoll and it is available, otherwise select
+    bool Open(bool fUseEpoll);
+    void Close();
+
+    bool IsEpoll() const { return epollFd != -1; }
+
+    // select is not able to watch the sockets beyond FD_SETSIZE, they are closed at accept and connect
+    bool IsSocketSupported(SOCKET hSocket) const;
+
+    // epoll: register the socket for the recv and send events, closing the socket unregisters it
+    bool AddSocket(SOCKET hSocket, bool fEdgeTriggered = true);
+
+    // Wait for the ready sockets in timeoutMs, the sockets with the wanted events are polled by select only,
+    // return the number of ready sockets, or SOCKET_ERROR.
+    int32_t Wait(const std::vector<CReadySocket> &wanted, int64_t timeoutMs, std::vector<CReadySocket> &ready);
+
+    // wake up the wait, safe to be called by any thread
+    void Wakeup();
+
+private:
+    int32_t WaitEpoll(int64_t timeoutMs, std::vector<CReadySocket> &ready);
+    int32_t WaitSelect(const std::vector<CReadySocket> &wanted, int64_t timeoutMs, std::vector<CReadySocket> &ready);
+    void ClearWakeup();
+
+private:
+    int epollFd  = -1;
+    int wakeupFd = -1;
+    std::atomic<bool> fWakeupPending{false};
+};
+
+extern CSocketEvents socketEvents;
+
+#endif  // P2P_SOCKETEVENTS_H
@@ -0,0 +1,280 @@
+// Copyright (c) 2017-2019 The GreenVenturesChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "txadmission.h"
+
+#include "main.h"
+#include "net.h"
+
+CTxAdmissionQueue txAdmission;
+
+bool AcceptTxFromPeer(CNode *pFrom, const string &strCommand, const std::shared_ptr<CBaseTx> &pBaseTx) {
+    CInv inv(MSG_TX, pBaseTx->GetHash());
+
+    LOCK(cs_main);
+    CValidationState state;
+    bool fAccepted = AcceptToMemoryPool(mempool, state, pBaseTx.get(), true);
+    if (fAccepted) {
+        RelayTransaction(pBaseTx.get(), inv.hash);
+        mapAlreadyAskedFor.erase(inv);
+
+        LogPrint(BCLog::INFO, "AcceptToMemoryPool: %s %s : accepted %s (poolsz %u)\n", pFrom->addr.ToString(),
+                 pFrom->cleanSubVer, pBaseTx->GetHash().ToString(), mempool.memPoolTxs.size());
+    }
+
+    int32_t nDoS = 0;
+    if (state.IsInvalid(nDoS)) {
+        LogPrint(BCLog::INFO, "%s [%d] from %s %s was not accepted into the memory pool: %s\n",
+                pBaseTx->GetHash().ToString(), pBaseTx->valid_height,
+                pFrom->addr.ToString(), pFrom->cleanSubVer, state.GetRejectReason());
+
+        pFrom->PushMessage(NetMsgType::REJECT, strCommand, state.GetRejectCode(), state.GetRejectReason(), inv.hash);
+        // if (nDoS > 0) {
+        //     LogPrint(BCLog::INFO, "Misebehaving, add to tx hash %s mempool error, Misbehavior add %d",
+        //     pBaseTx->GetHash().GetHex(), nDoS); Misbehaving(pFrom->GetId(), nDoS);
+        // }
+    }
+    return fAccepted;
+}
+
+CTxAdmissionQueue::CPriorityGuard::CPriorityGuard(CTxAdmissionQueue &queueIn, bool fPriorityIn)
+    : queue(queueIn), fPriority(fPriorityIn) {
+    if (fPriority)
+        queue.nPriorityMessages++;
+}
+
+CTxAdmissionQueue::CPriorityGuard::~CPriorityGuard() {
+    if (fPriority && --queue.nPriorityMessages == 0) {
+        STD_LOCK(queue.cs);
+        queue.priorityCond.notify_all();
+    }
+}
+
+void CTxAdmissionQueue::Start(int32_t threadCount) {
+    Stop();
+    if (threadCount <= 0)
+        return;
+
+    verifyPool.Start(std::min(threadCount, MAX_TX_ADMISSION_THREADS));
+    {
+        STD_LOCK(cs);
+        fStopping = false;
+    }
+    fRunning        = true;
+    admissionThread = std::thread(&CTxAdmissionQueue::ThreadAdmission, this);
+
+    LogPrint(BCLog::INFO, "Using %d threads for the tx admission\n", verifyPool.GetThreadCount());
+}
+
+void CTxAdmissionQueue::Stop() {
+    {
+        STD_LOCK(cs);
+        fStopping = true;
+        cond.notify_all();
+        priorityCond.notify_all();
+    }
+    if (admissionThread.joinable())
+        admissionThread.join();
+    fRunning = false;
+    verifyPool.Stop();
+
+    std::vector<CTxRequest> pending;
+    {
+        STD_LOCK(cs);
+        pending.assign(requests.begin(), requests.end());
+        requests.clear();
+        queuedTxids.clear();
+    }
+    ReleaseRequests(pending);
+}
+
+bool CTxAdmissionQueue::Push(CNode *pFrom, const string &strCommand, const std::shared_ptr<CBaseTx> &pBaseTx) {
+    uint256 txid = pBaseTx->GetHash();
+    {
+        STD_LOCK(cs);
+        if (queuedTxids.count(txid)) {
+            stats.duplicated++;
+            return false;
+        }
+        if (requests.size() >= MAX_TX_ADMISSION_QUEUE_SIZE) {
+            stats.dropped++;
+            return false;
+        }
+    }
+
+    {
+        LOCK(cs_vNodes);
+        pFrom->AddRef();
+    }
+
+    STD_LOCK(cs);
+    requests.push_back({pFrom, strCommand, pBaseTx, txid});
+    queuedTxids.insert(txid);
+    stats.queued++;
+    cond.notify_one();
+    return true;
+}
+
+bool CTxAdmissionQueue::IsQueued(const uint256 &txid) const {
+    STD_LOCK(cs);
+    return queuedTxids.count(txid) > 0;
+}
+
+size_t CTxAdmissionQueue::GetQueueSize() const {
+    STD_LOCK(cs);
+    return requests.size();
+}
+
+CTxAdmissionQueue::Stats CTxAdmissionQueue::GetStats() const {
+    STD_LOCK(cs);
+    return stats;
+}
+
+void CTxAdmissionQueue::ThreadAdmission() {
+    RenameThread("coin-txadmission");
+
+    while (true) {
+        std::vector<CTxRequest> batch;
+        {
+            STD_WAIT_LOCK(cs, lock);
+            while (!fStopping && requests.empty())
+                cond.wait(lock);
+            if (fStopping)
+                return;
+
+            size_t count = std::min(requests.size(), MAX_TX_ADMISSION_BATCH_SIZE);
+            batch.assign(requests.begin(), requests.begin() + count);
+            requests.erase(requests.begin(), requests.begin() + count);
+            stats.batches++;
+        }
+
+        try {
+            ProcessBatch(batch);
+        } catch (std::exception &e) {
+            PrintExceptionContinue(&e, "ThreadAdmission()");
+        } catch (...) {
+            PrintExceptionContinue(nullptr, "ThreadAdmission()");
+        }
+
+        {
+            STD_LOCK(cs);
+            for (const auto &request : batch)
+                queuedTxids.erase(request.txid);
+        }
+        ReleaseRequests(batch);
+    }
+}
+
+void CTxAdmissionQueue::ProcessBatch(const std::vector<CTxRequest> &batch) {
+    // the txs accepted already, e.g. announced by several peers
+    std::vector<CTxRequest> pending;
+    pending.reserve(batch.size());
+    uint64_t duplicated = 0;
+    for (const auto &request : batch) {
+        if (mempool.Exists(request.txid))
+            duplicated++;
+        else
+            pending.push_back(request);
+    }
+
+    PreVerifySignatures(pending);
+
+    uint64_t admitted = 0;
+    uint64_t rejected = 0;
+    for (const auto &request : pending) {
+        {
+            STD_LOCK(cs);
+            if (fStopping)
+                break;
+        }
+        if (request.pFrom->fDisconnect)
+            continue;
+
+        bool fAccepted = false;
+        auto fnAccept = [&]() { fAccepted = AcceptTxFromPeer(request.pFrom, request.strCommand, request.pBaseTx); };
+        if (!RunWithMainLock(fnAccept))
+            break;
+
+        if (fAccepted)
+            admitted++;
+        else
+            rejected++;
+    }
+
+    STD_LOCK(cs);
+    stats.duplicated += duplicated;
+    stats.admitted += admitted;
+    stats.rejected += rejected;
+}
+
+// The pubkeys of the signatures are resolved from the mempool state under cs_main, which are cheap lookups, then
+// the signatures are verified in parallel out of cs_main. The txs of the accounts not registered yet are left to
+// CheckTx.
+void CTxAdmissionQueue::PreVerifySignatures(const std::vector<CTxRequest> &batch) {
+    std::vector<CSigVerifyItem> items;
+    items.reserve(batch.size());
+    bool fLocked = RunWithMainLock([&]() {
+        for (const auto &request : batch) {
+            const std::shared_ptr<CBaseTx> &pBaseTx = request.pBaseTx;
+            if (pBaseTx->signature.empty())
+                continue;
+
+            CPubKey pubKey;
+            if (pBaseTx->txUid.is<CPubKey>()) {
+                pubKey = pBaseTx->txUid.get<CPubKey>();
+            } else {
+                CAccount account;
+                if (!mempool.cw->accountCache.GetAccount(pBaseTx->txUid, account))
+                    continue;
+                pubKey = account.owner_pubkey;
+            }
+            if (!pubKey.IsValid())
+                continue;
+
+            items.emplace_back(request.txid, &pBaseTx->signature, pubKey);
+        }
+    });
+    if (!fLocked)
+        return;
+
+    uint32_t validCount = verifyPool.VerifyAndCache(items);
+    STD_LOCK(cs);
+    stats.preverified += validCount;
+}
+
+// Return false if the admission is stopping.
+bool CTxAdmissionQueue::WaitForPriorityMessages() {
+    STD_WAIT_LOCK(cs, lock);
+    while (!fStopping && nPriorityMessages > 0)
+        priorityCond.wait(lock);
+    return !fStopping;
+}
+
+// Run fn under cs_main once no priority message is handled. The priority message started while the admission was
+// waiting for cs_main is blocked on it then, so cs_main is released to it first. Return false if the admission is
+// stopping, fn is not run then.
+bool CTxAdmissionQueue::RunWithMainLock(const std::function<void()> &fn) {
+    while (WaitForPriorityMessages()) {
+        LOCK(cs_main);
+        if (nPriorityMessages > 0)
+            continue;
+
+        fn();
+        return true;
+    }
+    return false;
+}
+
+void CTxAdmissionQueue::ReleaseRequests(std::vector<CTxRequest> &requests) {
+    if (requests.empty())
+        return;
+
+    LOCK(cs_vNodes);
+    for (auto &request : requests) {
+        if (request.pFrom != nullptr) {
+            request.pFrom->Release();
+            request.pFrom = nullptr;
+        }
+    }
+}
@@ -0,0 +1,119 @@
+// Copyright (c) 2017-2019 The GreenVenturesChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef P2P_TXADMISSION_H
+#define P2P_TXADMISSION_H
+
+#include "commons/uint256.h"
+#include "sigverify.h"
+#include "sync.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_set>
+
+class CBaseTx;
+class CNode;
+
+static const int32_t MAX_TX_ADMISSION_THREADS     = 16;
+static const int32_t DEFAULT_TX_ADMISSION_THREADS = 2;  // 0 = admit the txs on the message handler thread
+static const size_t MAX_TX_ADMISSION_QUEUE_SIZE   = 10000;
+static const size_t MAX_TX_ADMISSION_BATCH_SIZE   = 256;
+
+// Admit the tx received from the peer to the mempool, relay it or reject it to the peer. Takes cs_main.
+bool AcceptTxFromPeer(CNode *pFrom, const std::string &strCommand, const std::shared_ptr<CBaseTx> &pBaseTx);
+
+/**
+ * The admission of the txs received from the peers, out of the message handler thread. The message handler
+ * only queues the tx, so a slow tx (e.g. a contract tx) does not stall the blocks, the PBFT messages and the
+ * pings of all peers.
+ * The admission thread takes the queued txs in batches, drops the txs in the mempool already, and verifies
+ * their signatures in parallel on its own verification pool without cs_main, the valid ones are added to the
+ * signature cache. Then the txs are admitted one by one in the order received by AcceptTxFromPeer, which
+ * takes cs_main, the signature checks of CheckTx are the cache hits. The admission yields cs_main to the
+ * priority messages (blocks and PBFT messages) handled meanwhile, see CPriorityGuard.
+ * The scope is the signature verification only, the txs are not executed speculatively out of cs_main: the
+ * execution reads the mempool cache and the chain caches below it, which are written by the admission of the
+ * other txs and by the block connection under cs_main, so each tx is still executed under cs_main, one by one.
+ */
+class CTxAdmissionQueue {
+public:
+    struct Stats {
+        uint64_t queued      = 0;
+        uint64_t admitted    = 0;  // accepted to the mempool
+        uint64_t rejected    = 0;
+        uint64_t duplicated  = 0;  // queued or in the mempool already
+        uint64_t dropped     = 0;  // the queue is full
+        uint64_t batches     = 0;
+        uint64_t preverified = 0;  // the valid signatures verified out of cs_main
+    };
+
+    // The priority messages are handled while the guard is alive, the admission does not take cs_main.
+    class CPriorityGuard {
+    public:
+        CPriorityGuard(CTxAdmissionQueue &queueIn, bool fPriorityIn);
+        ~CPriorityGuard();
+
+    private:
+        CTxAdmissionQueue &queue;
+        bool fPriority;
+    };
+
+    CTxAdmissionQueue() {}
+    ~CTxAdmissionQueue() { Stop(); }
+
+    // threadCount includes the admission thread, 0 = no admission thread
+    void Start(int32_t threadCount);
+    void Stop();
+
+    bool IsRunning() const { return fRunning; }
+    int32_t GetThreadCount() const { return fRunning ? verifyPool.GetThreadCount() : 0; }
+
+    // Queue the tx, the peer is referenced until the tx is admitted. Return false if the tx is queued already
+    // or the queue is full.
+    bool Push(CNode *pFrom, const std::string &strCommand, const std::shared_ptr<CBaseTx> &pBaseTx);
+
+    bool IsQueued(const uint256 &txid) const;
+    size_t GetQueueSize() const;
+    Stats GetStats() const;
+
+private:
+    struct CTxRequest {
+        CNode *pFrom;
+        std::string strCommand;
+        std::shared_ptr<CBaseTx> pBaseTx;
+        uint256 txid;
+    };
+
+    void ThreadAdmission();
+    void ProcessBatch(const std::vector<CTxRequest> &batch);
+    void PreVerifySignatures(const std::vector<CTxRequest> &batch);
+    bool WaitForPriorityMessages();
+    bool RunWithMainLock(const std::function<void()> &fn);
+    static void ReleaseRequests(std::vector<CTxRequest> &requests);
+
+private:
+    std::thread admissionThread;
+    CSigVerifyPool verifyPool;  // not shared with the block connection
+
+    mutable StdMutex cs;
+    std::condition_variable cond;
+    std::condition_variable priorityCond;  // signalled when no priority message is handled
+    std::deque<CTxRequest> requests;
+    std::unordered_set<uint256, CUint256Hasher> queuedTxids;  // the txids of the requests and of the batch
+    Stats stats;
+    bool fStopping = false;
+
+    std::atomic<bool> fRunning{false};
+    std::atomic<int32_t> nPriorityMessages{0};
+};
+
+extern CTxAdmissionQueue txAdmission;
+
+#endif  // P2P_TXADMISSION_H
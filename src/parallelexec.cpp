@@ -0,0 +1,105 @@
+// Copyright (c) 2017-2019 The GreenVenturesChain Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "parallelexec.h"
+
+#include "commons/util/util.h"
+
+CParallelTaskPool parallelExecPool;
+
+void CParallelTaskPool::Start(int32_t threadCount) {
+    Stop();
+
+    threadCount = std::max(1, std::min(threadCount, MAX_PAR_BLOCK_EXEC_THREADS));
+
+    {
+        STD_LOCK(cs);
+        running = true;
+    }
+    for (int32_t i = 1; i < threadCount; i++)
+        workers.emplace_back(&CParallelTaskPool::WorkerLoop, this);
+
+    LogPrint(BCLog::INFO, "Using %d threads for parallel block execution\n", threadCount);
+}
+
+void CParallelTaskPool::Stop() {
+    {
+        STD_LOCK(cs);
+        running = false;
+        cond.notify_all();
+    }
+    for (auto &worker : workers)
+        worker.join();
+    workers.clear();
+}
+
+void CParallelTaskPool::Run(size_t count, const TaskFunc &task) {
+    if (count == 0)
+        return;
+
+    STD_LOCK(csBatch);
+    nextIndex = 0;
+    {
+        STD_LOCK(cs);
+        taskException = nullptr;
+        pTask     = &task;
+        taskCount = count;
+        batchId++;
+        cond.notify_all();
+    }
+
+    RunTasks();
+
+    {
+        STD_WAIT_LOCK(cs, lock);
+        while (activeCount > 0)
+            doneCond.wait(lock);
+        pTask     = nullptr;
+        taskCount = 0;
+    }
+
+    if (taskException)
+        std::rethrow_exception(taskException);
+}
+
+void CParallelTaskPool::WorkerLoop() {
+    RenameThread("coin-parexec");
+
+    uint64_t lastBatchId = 0;
+    while (true) {
+        {
+            STD_WAIT_LOCK(cs, lock);
+            while (running && (pTask == nullptr || batchId == lastBatchId))
+                cond.wait(lock);
+            if (!running)
+                return;
+
+            lastBatchId = batchId;
+            activeCount++;
+        }
+
+        RunTasks();
+
+        {
+            STD_LOCK(cs);
+            if (--activeCount == 0)
+                doneCond.notify_all();
+        }
+    }
+}
+
+void CParallelTaskPool::RunTasks() {
+    // pTask and taskCount are not changed until all of the active workers are done
+    size_t index;
+    while ((index = nextIndex++) < taskCount) {
+        try {
+            (*pTask)(index);
+        } catch (...) {
+            STD_LOCK(cs);
+            if (!taskException)
+                taskException = std::current_exception();
+            nextIndex = taskCount;  // skip the rest of the tasks
+        }
+    }
+}
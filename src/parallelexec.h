@@ -0,0 +1,165 @@
+// Copyright (c) 2017-2019 The GreenVenturesChain Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef COIN_PARALLELEXEC_H
+#define COIN_PARALLELEXEC_H
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "persistence/leveldbwrapper.h"
+#include "sync.h"
+
+static const int32_t MAX_PAR_BLOCK_EXEC_THREADS     = 16;
+static const int32_t DEFAULT_PAR_BLOCK_EXEC_THREADS = 0;  // 0 = serial execution
+
+/**
+ * Run the tasks of a batch on the worker threads, the caller thread works on the tasks too, with 1 thread
+ * (no workers) all of the tasks are run by the caller thread.
+ */
+class CParallelTaskPool {
+public:
+    typedef std::function<void(size_t index)> TaskFunc;
+
+    CParallelTaskPool() {}
+    ~CParallelTaskPool() { Stop(); }
+
+    // threadCount includes the caller thread
+    void Start(int32_t threadCount);
+    void Stop();
+
+    int32_t GetThreadCount() const { return workers.size() + 1; }
+
+    // run task(0) ... task(count - 1), return after all of the tasks are done, the first exception thrown
+    // by the tasks is rethrown, the rest of the tasks are skipped
+    void Run(size_t count, const TaskFunc &task);
+
+private:
+    void WorkerLoop();
+    void RunTasks();
+
+private:
+    std::vector<std::thread> workers;
+    StdMutex csBatch;  // one batch at a time
+
+    StdMutex cs;
+    std::condition_variable cond;
+    std::condition_variable doneCond;
+    const TaskFunc *pTask = nullptr;
+    size_t taskCount      = 0;
+    uint64_t batchId      = 0;
+    int32_t activeCount   = 0;
+    bool running          = false;
+    std::exception_ptr taskException;
+
+    std::atomic<size_t> nextIndex{0};
+};
+
+extern CParallelTaskPool parallelExecPool;
+
+struct CParallelExecStats {
+    uint32_t parallelCount   = 0;  // executed optimistically on the workers
+    uint32_t reexecutedCount = 0;  // re-executed in block order for reading the writes of the prior txs
+    uint32_t serialCount     = 0;  // not eligible for parallel execution
+};
+
+/**
+ * Optimistic parallel execution of the block txs over the cache.
+ * Phase 1 executes the eligible txs in parallel, each tx on its own cache level over the cache, with an
+ * access log recording the read keys, and the lower cache levels locked by the base mutex on lookups.
+ * Phase 2 validates and commits the txs serially in block order: a tx is committed by flushing its cache
+ * level when it has not read any key written by the prior txs of the block, otherwise (or it is not
+ * eligible) it is re-executed on the cache holding the writes of the prior txs. So the state and the undo
+ * logs are the same as the serial execution.
+ * fnExecute(index, cache) executes the tx on the cache level and must be safe to be called in parallel for
+ * the different indexes, fnCommit(index, undoLogs) is called in block order after the tx is applied to the
+ * cache. Return false as soon as the tx execution or the commit fails, the failed index is set.
+ */
+template <typename CacheType>
+bool ExecuteTxsInParallel(CParallelTaskPool &pool, CacheType &cache, size_t count,
+                          const std::function<bool(size_t index)> &fnIsParallel,
+                          const std::function<bool(size_t index, CacheType &txCache)> &fnExecute,
+                          const std::function<bool(size_t index, CDBOpLogMap &undoLogs)> &fnCommit,
+                          size_t &failedIndex, CParallelExecStats &stats) {
+    struct TxExecution {
+        std::shared_ptr<CacheType> spCache;
+        CDbAccessLog accessLog;
+        CDBOpLogMap undoLogs;
+        bool executed = false;
+        bool result   = false;
+    };
+    std::vector<TxExecution> executions(count);
+    std::vector<std::mutex> baseMutexes(dbk::PREFIX_COUNT);
+
+    std::vector<size_t> parallelIndexes;
+    for (size_t index = 0; index < count; index++) {
+        if (fnIsParallel(index))
+            parallelIndexes.push_back(index);
+    }
+
+    try {
+        pool.Run(parallelIndexes.size(), [&](size_t i) {
+            TxExecution &execution = executions[parallelIndexes[i]];
+            execution.accessLog.SetBaseMutexes(baseMutexes.data());
+            execution.spCache = std::make_shared<CacheType>(&cache);
+            execution.spCache->SetDbAccessLog(&execution.accessLog);
+            execution.spCache->SetDbOpLogMap(&execution.undoLogs);
+            execution.result   = fnExecute(parallelIndexes[i], *execution.spCache);
+            execution.executed = true;
+        });
+        stats.parallelCount += parallelIndexes.size();
+    } catch (...) {
+        // the whole batch is failed and run serially in phase 2, which throws the exception if it happens again
+        LogPrint(BCLog::ERROR, "%s : parallel execution exception, run the txs serially\n", __func__);
+        for (auto &execution : executions)
+            execution.executed = false;
+    }
+
+    std::set<string> writtenKeys;
+    std::set<dbk::PrefixType> writtenPrefixes;
+    for (size_t index = 0; index < count; index++) {
+        TxExecution &execution = executions[index];
+        if (execution.executed && !execution.accessLog.HasReadAny(writtenKeys, writtenPrefixes)) {
+            // nothing read by the tx has been changed, the result of the optimistic execution is final
+            if (!execution.result) {
+                failedIndex = index;
+                return false;
+            }
+        } else {
+            if (execution.executed)
+                stats.reexecutedCount++;
+            else if (!fnIsParallel(index))
+                stats.serialCount++;
+
+            execution.accessLog.Clear();
+            execution.undoLogs.Clear();
+            execution.spCache = std::make_shared<CacheType>(&cache);
+            execution.spCache->SetDbAccessLog(&execution.accessLog);
+            execution.spCache->SetDbOpLogMap(&execution.undoLogs);
+            if (!fnExecute(index, *execution.spCache)) {
+                failedIndex = index;
+                return false;
+            }
+        }
+
+        execution.spCache->Flush();
+        execution.spCache = nullptr;
+        execution.accessLog.GetWriteKeys(writtenKeys, writtenPrefixes);
+
+        if (!fnCommit(index, execution.undoLogs)) {
+            failedIndex = index;
+            return false;
+        }
+    }
+    return true;
+}
+
+#endif  // COIN_PARALLELEXEC_H
@@ -103,6 +103,12 @@ public:
         nickId2KeyIdCache.SetDbOpLogMap(pDbOpLogMapIn);
     }
 
+    void SetDbAccessLog(CDbAccessLog *pDbAccessLogIn) {
+        accountCache.SetDbAccessLog(pDbAccessLogIn);
+        regId2KeyIdCache.SetDbAccessLog(pDbAccessLogIn);
+        nickId2KeyIdCache.SetDbAccessLog(pDbAccessLogIn);
+    }
+
     void RegisterUndoFunc(UndoDataFuncMap &undoDataFuncMap) {
         regId2KeyIdCache.RegisterUndoFunc(undoDataFuncMap);
         nickId2KeyIdCache.RegisterUndoFunc(undoDataFuncMap);
@@ -66,6 +66,10 @@ public:
         assetCache.SetDbOpLogMap(pDbOpLogMapIn);
     }
 
+    void SetDbAccessLog(CDbAccessLog *pDbAccessLogIn) {
+        assetCache.SetDbAccessLog(pDbAccessLogIn);
+    }
+
     void RegisterUndoFunc(UndoDataFuncMap &undoDataFuncMap) {
         assetCache.RegisterUndoFunc(undoDataFuncMap);
     }
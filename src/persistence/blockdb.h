@@ -87,6 +87,15 @@ public:
         finalityBlockCache.SetDbOpLogMap(pDbOpLogMapIn);
     }
 
+    void SetDbAccessLog(CDbAccessLog *pDbAccessLogIn) {
+        txDiskPosCache.SetDbAccessLog(pDbAccessLogIn);
+        flagCache.SetDbAccessLog(pDbAccessLogIn);
+        bestBlockHashCache.SetDbAccessLog(pDbAccessLogIn);
+        lastBlockFileCache.SetDbAccessLog(pDbAccessLogIn);
+        reindexCache.SetDbAccessLog(pDbAccessLogIn);
+        finalityBlockCache.SetDbAccessLog(pDbAccessLogIn);
+    }
+
     void RegisterUndoFunc(UndoDataFuncMap &undoDataFuncMap) {
         txDiskPosCache.RegisterUndoFunc(undoDataFuncMap);
         flagCache.RegisterUndoFunc(undoDataFuncMap);
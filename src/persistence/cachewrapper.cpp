@@ -134,6 +134,22 @@ void CCacheWrapper::SetDbOpLogMap(CDBOpLogMap *pDbOpLogMap) {
     priceFeedCache.SetDbOpLogMap(pDbOpLogMap) ;
 }
 
+void CCacheWrapper::SetDbAccessLog(CDbAccessLog *pDbAccessLog) {
+    sysParamCache.SetDbAccessLog(pDbAccessLog);
+    blockCache.SetDbAccessLog(pDbAccessLog);
+    accountCache.SetDbAccessLog(pDbAccessLog);
+    assetCache.SetDbAccessLog(pDbAccessLog);
+    contractCache.SetDbAccessLog(pDbAccessLog);
+    delegateCache.SetDbAccessLog(pDbAccessLog);
+    cdpCache.SetDbAccessLog(pDbAccessLog);
+    closedCdpCache.SetDbAccessLog(pDbAccessLog);
+    dexCache.SetDbAccessLog(pDbAccessLog);
+    txReceiptCache.SetDbAccessLog(pDbAccessLog);
+    txUtxoCache.SetDbAccessLog(pDbAccessLog);
+    sysGovernCache.SetDbAccessLog(pDbAccessLog);
+    priceFeedCache.SetDbAccessLog(pDbAccessLog);
+}
+
 UndoDataFuncMap CCacheWrapper::GetUndoDataFuncMap() {
     UndoDataFuncMap undoDataFuncMap;
     sysParamCache.RegisterUndoFunc(undoDataFuncMap);
@@ -155,51 +171,67 @@ UndoDataFuncMap CCacheWrapper::GetUndoDataFuncMap() {
 ////////////////////////////////////////////////////////////////////////////////
 // class CCacheDBManager
 
-CCacheDBManager::CCacheDBManager(bool fReIndex, bool fMemory) {
+CCacheDBManager::CCacheDBManager(bool fReIndex, bool fMemory, bool fSingleDb) {
     const boost::filesystem::path& dbDir = GetDataDir() / "blocks";
-    pSysParamDb     = new CDBAccess(dbDir, DBNameType::SYSPARAM, false, fReIndex);
+    if (fSingleDb) {
+        spSingleDb = std::make_shared<CLevelDBWrapper>(dbDir / kSingleDbName, GetTotalDbCacheSize(), false, fReIndex);
+        if (!spSingleDb->Exists(kSingleDbMigratedKey)) {
+            // the migration was interrupted, the partial state is dropped and migrated again
+            if (!spSingleDb->IsEmpty()) {
+                LogPrint(BCLog::INFO, "The migration to db %s was not completed, wipe it and migrate again\n",
+                         kSingleDbName);
+                spSingleDb = nullptr;
+                spSingleDb = std::make_shared<CLevelDBWrapper>(dbDir / kSingleDbName, GetTotalDbCacheSize(), false,
+                                                               true);
+            }
+            if (!MigrateToSingleDb(dbDir, *spSingleDb, fReIndex))
+                throw runtime_error("migrate the separated dbs to single db failed");
+        }
+    }
+
+    pSysParamDb     = NewDbAccess(dbDir, DBNameType::SYSPARAM, fReIndex);
     pSysParamCache  = new CSysParamDBCache(pSysParamDb);
 
-    pAccountDb      = new CDBAccess(dbDir, DBNameType::ACCOUNT, false, fReIndex);
+    pAccountDb      = NewDbAccess(dbDir, DBNameType::ACCOUNT, fReIndex);
     pAccountCache   = new CAccountDBCache(pAccountDb);
 
-    pAssetDb        = new CDBAccess(dbDir, DBNameType::ASSET, false, fReIndex);
+    pAssetDb        = NewDbAccess(dbDir, DBNameType::ASSET, fReIndex);
     pAssetCache     = new CAssetDBCache(pAssetDb);
 
-    pContractDb     = new CDBAccess(dbDir, DBNameType::CONTRACT, false, fReIndex);
+    pContractDb     = NewDbAccess(dbDir, DBNameType::CONTRACT, fReIndex);
     pContractCache  = new CContractDBCache(pContractDb);
 
-    pDelegateDb     = new CDBAccess(dbDir, DBNameType::DELEGATE, false, fReIndex);
+    pDelegateDb     = NewDbAccess(dbDir, DBNameType::DELEGATE, fReIndex);
     pDelegateCache  = new CDelegateDBCache(pDelegateDb);
 
-    pCdpDb          = new CDBAccess(dbDir, DBNameType::CDP, false, fReIndex);
+    pCdpDb          = NewDbAccess(dbDir, DBNameType::CDP, fReIndex);
     pCdpCache       = new CCdpDBCache(pCdpDb);
 
-    pClosedCdpDb    = new CDBAccess(dbDir, DBNameType::CLOSEDCDP, false, fReIndex);
+    pClosedCdpDb    = NewDbAccess(dbDir, DBNameType::CLOSEDCDP, fReIndex);
     pClosedCdpCache = new CClosedCdpDBCache(pClosedCdpDb);
 
-    pDexDb          = new CDBAccess(dbDir, DBNameType::DEX, false, fReIndex);
+    pDexDb          = NewDbAccess(dbDir, DBNameType::DEX, fReIndex);
     pDexCache       = new CDexDBCache(pDexDb);
 
 
     pBlockIndexDb   = new CBlockIndexDB(false, fReIndex);
 
-    pBlockDb        = new CDBAccess(dbDir, DBNameType::BLOCK, false, fReIndex);
+    pBlockDb        = NewDbAccess(dbDir, DBNameType::BLOCK, fReIndex);
     pBlockCache     = new CBlockDBCache(pBlockDb);
 
-    pLogDb          = new CDBAccess(dbDir, DBNameType::LOG, false, fReIndex);
+    pLogDb          = NewDbAccess(dbDir, DBNameType::LOG, fReIndex);
     pLogCache       = new CLogDBCache(pLogDb);
 
-    pReceiptDb      = new CDBAccess(dbDir, DBNameType::RECEIPT, false, fReIndex);
+    pReceiptDb      = NewDbAccess(dbDir, DBNameType::RECEIPT, fReIndex);
     pReceiptCache   = new CTxReceiptDBCache(pReceiptDb);
 
-    pUtxoDb         = new CDBAccess(dbDir, DBNameType::UTXO, false, fReIndex);
+    pUtxoDb         = NewDbAccess(dbDir, DBNameType::UTXO, fReIndex);
     pUtxoCache      = new CTxUTXODBCache(pUtxoDb);
 
-    pSysGovernDb    = new CDBAccess(dbDir, DBNameType::SYSGOVERN, false, fReIndex);
+    pSysGovernDb    = NewDbAccess(dbDir, DBNameType::SYSGOVERN, fReIndex);
     pSysGovernCache = new CSysGovernDBCache(pSysGovernDb);
 
-    pPriceFeedDb    = new CDBAccess(dbDir, DBNameType::PRICEFEED, false, fReIndex);
+    pPriceFeedDb    = NewDbAccess(dbDir, DBNameType::PRICEFEED, fReIndex);
     pPriceFeedCache = new CPriceFeedCache(pPriceFeedDb);
 
 
@@ -209,6 +241,9 @@ CCacheDBManager::CCacheDBManager(bool fReIndex, bool fMemory) {
 }
 
 CCacheDBManager::~CCacheDBManager() {
+    // sync the pending writes before closing the dbs
+    spFlusher = nullptr;
+
     delete pSysParamCache;  pSysParamCache = nullptr;
     delete pAccountCache;   pAccountCache = nullptr;
     delete pAssetCache;     pAssetCache = nullptr;
@@ -245,6 +280,20 @@ CCacheDBManager::~CCacheDBManager() {
 }
 
 bool CCacheDBManager::Flush() {
+    // all of the caches are flushed into one write batch of the single db, commit it at the end
+    if (spSingleDb) {
+        for (auto pDbAccess : dbAccessList)
+            pDbAccess->SetBatch(&singleDbBatch);
+    }
+
+    // the price points of the memory cache are saved with the db state of the same best block
+    if (pPpCache && pPpCache->IsLoaded() && pPriceFeedCache && pBlockCache) {
+        CPricePointSnapshot snapshot;
+        pPpCache->GetSnapshot(snapshot);
+        snapshot.block_hash = pBlockCache->GetBestBlockHash();
+        pPriceFeedCache->pricePointSnapshotCache.SetData(snapshot);
+    }
+
     if (pSysParamCache) pSysParamCache->Flush();
 
     if (pAccountCache) pAccountCache->Flush();
@@ -281,5 +330,82 @@ bool CCacheDBManager::Flush() {
     // if (pPpCache)
     //     pPpCache->Flush();
 
+    if (spSingleDb) {
+        for (auto pDbAccess : dbAccessList)
+            pDbAccess->SetBatch(nullptr);
+
+        spSingleDb->WriteBatch(singleDbBatch, !(spFlusher && spFlusher->IsAsync()));
+        singleDbBatch.Clear();
+    }
+
+    if (spFlusher) spFlusher->NotifyFlushed();
+
+    return true;
+}
+
+void CCacheDBManager::StartFlusher(uint32_t syncBlocks, int64_t syncIntervalMs) {
+    vector<std::shared_ptr<CLevelDBWrapper>> dbs;
+    if (spSingleDb) {
+        dbs.push_back(spSingleDb);
+    } else {
+        for (auto pDbAccess : dbAccessList)
+            dbs.push_back(pDbAccess->GetDb());
+    }
+
+    spFlusher = std::make_shared<CDBFlusher>(dbs, syncBlocks, syncIntervalMs);
+    for (auto pDbAccess : dbAccessList)
+        pDbAccess->SetSyncWrite(!spFlusher->IsAsync());
+}
+
+CDBAccess* CCacheDBManager::NewDbAccess(const boost::filesystem::path &dbDir, DBNameType dbNameType, bool fReIndex) {
+    CDBAccess *pDbAccess = nullptr;
+    if (spSingleDb)
+        pDbAccess = new CDBAccess(dbNameType, spSingleDb);
+    else
+        pDbAccess = new CDBAccess(dbDir, dbNameType, false, fReIndex);
+
+    dbAccessList.push_back(pDbAccess);
+    return pDbAccess;
+}
+
+bool CCacheDBManager::MigrateToSingleDb(const boost::filesystem::path &dbDir, CLevelDBWrapper &singleDb,
+                                        bool fReIndex) {
+    static const uint32_t MIGRATE_BATCH_COUNT = 10000;
+
+    // the batches are not synced until the last one with the migrated marker
+    CLevelDBBatch batch;
+    for (int32_t i = 0; i < DBNameType::DB_NAME_COUNT && !fReIndex; i++) {
+        DBNameType dbNameType = (DBNameType)i;
+        const boost::filesystem::path dbPath = dbDir / GetDbName(dbNameType);
+        if (!boost::filesystem::exists(dbPath))
+            continue;
+
+        LogPrint(BCLog::INFO, "Migrating db %s to %s\n", dbPath.string(), kSingleDbName);
+        int64_t beginTime = GetTimeMillis();
+        CLevelDBWrapper db(dbPath, DBCacheSize[dbNameType]);
+        std::unique_ptr<leveldb::Iterator> pCursor(db.NewIterator());
+        uint64_t count = 0;
+        for (pCursor->SeekToFirst(); pCursor->Valid(); pCursor->Next()) {
+            boost::this_thread::interruption_point();
+
+            batch.WriteRaw(pCursor->key(), pCursor->value());
+            if (++count % MIGRATE_BATCH_COUNT == 0) {
+                singleDb.WriteBatch(batch);
+                batch.Clear();
+            }
+        }
+        if (!pCursor->status().ok())
+            return ERRORMSG("%s, iterate db %s error: %s", __func__, dbPath.string(), pCursor->status().ToString());
+
+        LogPrint(BCLog::INFO, "Migrated %llu records of db %s (%lldms)\n", count, dbPath.string(),
+                 GetTimeMillis() - beginTime);
+    }
+
+    batch.Write(kSingleDbMigratedKey, (uint8_t)1);
+    if (!singleDb.WriteBatch(batch, true))
+        return ERRORMSG("%s, write the migrated marker to db %s error", __func__, kSingleDbName);
+
+    if (!fReIndex)
+        LogPrint(BCLog::INFO, "Migrated all of the dbs to %s, the separated dbs can be removed now\n", kSingleDbName);
     return true;
 }
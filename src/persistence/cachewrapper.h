@@ -13,6 +13,7 @@
 #include "commons/uint256.h"
 #include "contractdb.h"
 #include "delegatedb.h"
+#include "dbflusher.h"
 #include "dexdb.h"
 #include "pricefeeddb.h"
 #include "sysparamdb.h"
@@ -47,6 +48,9 @@ public:
 public:
     CCacheWrapper();
 
+    // Child cache of cwIn, copy-on-write: only the changed data will be held and flushed to cwIn.
+    // It only wires the base pointers of the sub-caches, nothing of cwIn is copied. All of the reads, found or
+    // missing, see the current data of cwIn, the missing keys are only remembered by the db level caches.
     CCacheWrapper(CCacheWrapper* cwIn);
     CCacheWrapper(CCacheDBManager* pCdMan);
 
@@ -59,6 +63,7 @@ public:
     UndoDataFuncMap GetUndoDataFuncMap();
 
     void SetDbOpLogMap(CDBOpLogMap *pDbOpLogMap);
+    void SetDbAccessLog(CDbAccessLog *pDbAccessLog);
 private:
     CCacheWrapper(const CCacheWrapper&) = delete;
     CCacheWrapper& operator=(const CCacheWrapper&) = delete;
@@ -115,11 +120,37 @@ public:
     CPricePointMemCache *pPpCache;
 
 public:
-    CCacheDBManager(bool fReIndex, bool fMemory);
+    /**
+     * @param fSingleDb  store all of the db name types in one db, so that all of the changes
+     *                   of a flush are committed by one atomic write batch
+     */
+    CCacheDBManager(bool fReIndex, bool fMemory, bool fSingleDb = false);
 
     ~CCacheDBManager();
 
     bool Flush();
+
+    bool IsSingleDb() const { return spSingleDb != nullptr; }
+
+    const vector<CDBAccess*>& GetDbAccessList() const { return dbAccessList; }
+
+    // start the durability policy of the dbs, see CDBFlusher
+    void StartFlusher(uint32_t syncBlocks, int64_t syncIntervalMs);
+
+    std::shared_ptr<CDBFlusher> GetFlusher() const { return spFlusher; }
+
+    // copy all data of the separated dbs in dbDir to the single db, nothing is copied for the reindex, then
+    // write the migrated marker by the last synced batch
+    static bool MigrateToSingleDb(const boost::filesystem::path &dbDir, CLevelDBWrapper &singleDb, bool fReIndex);
+
+private:
+    CDBAccess* NewDbAccess(const boost::filesystem::path &dbDir, DBNameType dbNameType, bool fReIndex);
+
+private:
+    std::shared_ptr<CLevelDBWrapper> spSingleDb = nullptr;
+    CLevelDBBatch singleDbBatch;
+    vector<CDBAccess*> dbAccessList;
+    std::shared_ptr<CDBFlusher> spFlusher = nullptr;
 };  // CCacheDBManager
 
 #endif //PERSIST_CACHEWRAPPER_H
@@ -11,14 +11,16 @@ CCdpDBCache::CCdpDBCache(CDBAccess *pDbAccess)
       cdpCache(pDbAccess),
       userCdpCache(pDbAccess),
       cdpCoinPairsCache(pDbAccess),
-      cdpRatioSortedCache(pDbAccess) {}
+      cdpRatioSortedCache(pDbAccess),
+      spRatioIndex(make_shared<CCdpRatioIndex>(pDbAccess)) {}
 
 CCdpDBCache::CCdpDBCache(CCdpDBCache *pBaseIn)
     : cdpGlobalDataCache(pBaseIn->cdpGlobalDataCache),
       cdpCache(pBaseIn->cdpCache),
       userCdpCache(pBaseIn->userCdpCache),
       cdpCoinPairsCache(pBaseIn->cdpCoinPairsCache),
-      cdpRatioSortedCache(pBaseIn->cdpRatioSortedCache) {}
+      cdpRatioSortedCache(pBaseIn->cdpRatioSortedCache),
+      spRatioIndex(pBaseIn->spRatioIndex) {}
 
 bool CCdpDBCache::NewCDP(const int32_t blockHeight, CUserCDP &cdp) {
     assert(!cdpCache.HasData(cdp.cdpid));
@@ -104,14 +106,18 @@ bool CCdpDBCache::EraseCDPFromRatioDB(const CUserCDP &userCdp) {
 bool CCdpDBCache::GetCdpListByCollateralRatio(const CCdpCoinPair &cdpCoinPair,
         const uint64_t collateralRatio, const uint64_t bcoinMedianPrice,
         CdpRatioSortedCache::Map &userCdps) {
-    double ratio = (double(collateralRatio) / RATIO_BOOST) / (double(bcoinMedianPrice) / PRICE_BOOST);
-    assert(uint64_t(ratio * CDP_BASE_RATIO_BOOST) < UINT64_MAX);
-    uint64_t ratioBoost = uint64_t(ratio * CDP_BASE_RATIO_BOOST) + 1;
+    uint64_t ratioBoost = GetEndRatio(collateralRatio, bcoinMedianPrice);
     CdpRatioSortedCache::KeyType endKey(cdpCoinPair, ratioBoost, 0, uint256());
 
     return cdpRatioSortedCache.GetAllElements(endKey, userCdps);
 }
 
+shared_ptr<CCdpRatioIterator> CCdpDBCache::CreateCdpRatioIterator(const CCdpCoinPair &cdpCoinPair,
+        const uint64_t collateralRatio, const uint64_t bcoinMedianPrice) {
+    assert(spRatioIndex);
+    return make_shared<CCdpRatioIterator>(*this, cdpCoinPair, GetEndRatio(collateralRatio, bcoinMedianPrice));
+}
+
 CCdpGlobalData CCdpDBCache::GetCdpGlobalData(const CCdpCoinPair &cdpCoinPair) const {
     CCdpGlobalData ret;
     cdpGlobalDataCache.GetData(cdpCoinPair, ret);
@@ -155,6 +161,8 @@ void CCdpDBCache::SetBaseViewPtr(CCdpDBCache *pBaseIn) {
     cdpCoinPairsCache.SetBase(&pBaseIn->cdpCoinPairsCache);
 
     cdpRatioSortedCache.SetBase(&pBaseIn->cdpRatioSortedCache);
+
+    spRatioIndex = pBaseIn->spRatioIndex;
 }
 
 void CCdpDBCache::SetDbOpLogMap(CDBOpLogMap *pDbOpLogMapIn) {
@@ -165,6 +173,14 @@ void CCdpDBCache::SetDbOpLogMap(CDBOpLogMap *pDbOpLogMapIn) {
     cdpRatioSortedCache.SetDbOpLogMap(pDbOpLogMapIn);
 }
 
+void CCdpDBCache::SetDbAccessLog(CDbAccessLog *pDbAccessLogIn) {
+    cdpGlobalDataCache.SetDbAccessLog(pDbAccessLogIn);
+    cdpCache.SetDbAccessLog(pDbAccessLogIn);
+    userCdpCache.SetDbAccessLog(pDbAccessLogIn);
+    cdpCoinPairsCache.SetDbAccessLog(pDbAccessLogIn);
+    cdpRatioSortedCache.SetDbAccessLog(pDbAccessLogIn);
+}
+
 uint32_t CCdpDBCache::GetCacheSize() const {
     return cdpGlobalDataCache.GetCacheSize() + cdpCache.GetCacheSize() + userCdpCache.GetCacheSize() +
             cdpCoinPairsCache.GetCacheSize() + cdpRatioSortedCache.GetCacheSize();
@@ -175,6 +191,9 @@ bool CCdpDBCache::Flush() {
     cdpCache.Flush();
     userCdpCache.Flush();
     cdpCoinPairsCache.Flush();
+    // the ratio index is in sync with db
+    if (spRatioIndex && cdpRatioSortedCache.GetBasePtr() == nullptr)
+        spRatioIndex->Update(cdpRatioSortedCache.GetMapData());
     cdpRatioSortedCache.Flush();
 
     return true;
@@ -190,6 +209,109 @@ CdpRatioSortedCache::KeyType CCdpDBCache::MakeCdpRatioSortedKey(const CUserCDP &
     return key;
 }
 
+uint64_t CCdpDBCache::GetEndRatio(const uint64_t collateralRatio, const uint64_t bcoinMedianPrice) {
+    double ratio = (double(collateralRatio) / RATIO_BOOST) / (double(bcoinMedianPrice) / PRICE_BOOST);
+    assert(uint64_t(ratio * CDP_BASE_RATIO_BOOST) < UINT64_MAX);
+    return uint64_t(ratio * CDP_BASE_RATIO_BOOST) + 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class CCdpRatioIndex
+
+const CCdpRatioIndex::RatioKeySet& CCdpRatioIndex::GetRatioKeys(const CCdpCoinPair &cdpCoinPair) {
+    if (!is_loaded)
+        Load();
+
+    return ratioKeysMap[cdpCoinPair];
+}
+
+void CCdpRatioIndex::Update(const CdpRatioSortedCache::Map &mapData) {
+    if (!is_loaded)
+        return; // loaded from db after the flush
+
+    for (const auto &item : mapData) {
+        const auto &key = item.first;
+        RatioKey ratioKey(std::get<1>(key), std::get<2>(key), std::get<3>(key));
+        if (db_util::IsEmpty(item.second))
+            ratioKeysMap[std::get<0>(key)].erase(ratioKey);
+        else
+            ratioKeysMap[std::get<0>(key)].insert(ratioKey);
+    }
+}
+
+size_t CCdpRatioIndex::GetKeyCount() const {
+    size_t count = 0;
+    for (const auto &item : ratioKeysMap)
+        count += item.second.size();
+    return count;
+}
+
+void CCdpRatioIndex::Load() {
+    // the db level cache without data iterates the db only
+    CdpRatioSortedCache dbCache(pDbAccess);
+    CDBIterator<CdpRatioSortedCache> dbIt(dbCache);
+    for (dbIt.First(); dbIt.IsValid(); dbIt.Next()) {
+        const auto &key = dbIt.GetKey();
+        ratioKeysMap[std::get<0>(key)].emplace(std::get<1>(key), std::get<2>(key), std::get<3>(key));
+    }
+    is_loaded = true;
+
+    LogPrint(BCLog::CDP, "%s(), loaded %llu cdp ratio keys\n", __func__, GetKeyCount());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class CCdpRatioIterator
+
+bool CCdpRatioIterator::First() { return Seek(true); }
+
+bool CCdpRatioIterator::Next() {
+    assert(is_valid);
+    return Seek(false);
+}
+
+bool CCdpRatioIterator::Seek(bool isFirst) {
+    const CdpRatioSortedCache::KeyType beginKey(cdpCoinPair, CFixedUInt64(0), CFixedUInt64(0), uint256());
+    const CCdpRatioIndex::RatioKeySet &ratioKeys = cdpCache.spRatioIndex->GetRatioKeys(cdpCoinPair);
+
+    while (true) {
+        // the next key is the smallest one after the current key of the cache levels and the db
+        bool found = false;
+        CdpRatioSortedCache::KeyType nextKey;
+        for (auto pCache = &cdpCache.cdpRatioSortedCache; pCache != nullptr; pCache = pCache->GetBasePtr()) {
+            const auto &mapData = pCache->GetMapData();
+            auto it = isFirst ? mapData.lower_bound(beginKey) : mapData.upper_bound(curKey);
+            if (it != mapData.end() && std::get<0>(it->first) == cdpCoinPair && (!found || it->first < nextKey)) {
+                nextKey = it->first;
+                found   = true;
+            }
+        }
+
+        auto keyIt = isFirst ? ratioKeys.begin() : ratioKeys.upper_bound(CCdpRatioIndex::RatioKey(
+                                    std::get<1>(curKey), std::get<2>(curKey), std::get<3>(curKey)));
+        if (keyIt != ratioKeys.end()) {
+            CdpRatioSortedCache::KeyType dbKey(cdpCoinPair, std::get<0>(*keyIt), std::get<1>(*keyIt),
+                                               std::get<2>(*keyIt));
+            if (!found || dbKey < nextKey) {
+                nextKey = dbKey;
+                found   = true;
+            }
+        }
+
+        if (!found || std::get<1>(nextKey).value >= endRatio) {
+            is_valid = false;
+            return false;
+        }
+
+        isFirst = false;
+        curKey  = nextKey;
+        // the erased cdp is skipped
+        if (cdpCache.cdpRatioSortedCache.GetData(curKey, curCdp)) {
+            is_valid = true;
+            return true;
+        }
+    }
+}
+
 string GetCdpCloseTypeName(const CDPCloseType type) {
     switch (type) {
         case CDPCloseType:: BY_REDEEM:
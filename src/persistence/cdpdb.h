@@ -13,6 +13,7 @@
 #include "dbiterator.h"
 
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <cstdint>
@@ -25,6 +26,67 @@ using namespace std;
 // height: allows data of the same ratio to be sorted by height
 typedef CCompositeKVCache<dbk::CDP_RATIO, tuple<CCdpCoinPair, CFixedUInt64, CFixedUInt64, uint256>, CUserCDP>      CdpRatioSortedCache;
 
+class CCdpDBCache;
+
+/**
+ * The keys of the CDP_RATIO in db, sorted in memory by the coin pair, so that the CDPs of the lowest collateral
+ * ratio are found without scanning the db. It is owned by the db level cache, loaded from db on the first use,
+ * and updated by the flush of the db level cache.
+ */
+class CCdpRatioIndex {
+public:
+    typedef tuple<CFixedUInt64, CFixedUInt64, uint256> RatioKey;    // ratio, height, cdpid
+    typedef set<RatioKey> RatioKeySet;
+
+    CCdpRatioIndex(CDBAccess *pDbAccessIn): pDbAccess(pDbAccessIn) {}
+
+    const RatioKeySet& GetRatioKeys(const CCdpCoinPair &cdpCoinPair);
+    // apply the changed data of the db level cache before it is flushed
+    void Update(const CdpRatioSortedCache::Map &mapData);
+
+    bool IsLoaded() const { return is_loaded; }
+    size_t GetKeyCount() const;
+
+private:
+    void Load();
+
+private:
+    CDBAccess *pDbAccess;
+    bool is_loaded = false;
+    map<CCdpCoinPair, RatioKeySet> ratioKeysMap;
+};
+
+/**
+ * The lazy iterator of the CDPs of the coin pair whose collateral ratio is below the end ratio, from the lowest
+ * ratio. Every step seeks the next key of the cache levels and the ratio index, so the CDPs can be erased while
+ * iterating, and only the iterated CDPs are read.
+ */
+class CCdpRatioIterator {
+public:
+    CCdpRatioIterator(CCdpDBCache &cdpCacheIn, const CCdpCoinPair &cdpCoinPairIn, uint64_t endRatioIn)
+        : cdpCache(cdpCacheIn), cdpCoinPair(cdpCoinPairIn), endRatio(endRatioIn) {}
+
+    bool First();
+    bool Next();
+    bool IsValid() const { return is_valid; }
+
+    const CdpRatioSortedCache::KeyType& GetKey() const { return curKey; }
+    const CUserCDP& GetValue() const { return curCdp; }
+
+private:
+    // seek the first valid cdp after the current key, or from the first key of the coin pair
+    bool Seek(bool isFirst);
+
+private:
+    CCdpDBCache &cdpCache;
+    CCdpCoinPair cdpCoinPair;
+    uint64_t endRatio;
+
+    bool is_valid = false;
+    CdpRatioSortedCache::KeyType curKey;
+    CUserCDP curCdp;
+};
+
 class CCdpDBCache {
 public:
     CCdpDBCache() {}
@@ -41,6 +103,9 @@ public:
 
     bool GetCdpListByCollateralRatio(const CCdpCoinPair &cdpCoinPair, const uint64_t collateralRatio,
             const uint64_t bcoinMedianPrice, CdpRatioSortedCache::Map &userCdps);
+    // the CDPs to be force liquidated in the same order as GetCdpListByCollateralRatio(), read lazily
+    shared_ptr<CCdpRatioIterator> CreateCdpRatioIterator(const CCdpCoinPair &cdpCoinPair,
+            const uint64_t collateralRatio, const uint64_t bcoinMedianPrice);
 
     inline uint64_t GetGlobalStakedBcoins() const;
     inline uint64_t GetGlobalOwedScoins() const;
@@ -53,6 +118,7 @@ public:
 
     void SetBaseViewPtr(CCdpDBCache *pBaseIn);
     void SetDbOpLogMap(CDBOpLogMap * pDbOpLogMapIn);
+    void SetDbAccessLog(CDbAccessLog *pDbAccessLogIn);
 
     void RegisterUndoFunc(UndoDataFuncMap &undoDataFuncMap) {
         cdpGlobalDataCache.RegisterUndoFunc(undoDataFuncMap);
@@ -73,6 +139,8 @@ private:
     bool EraseCDPFromRatioDB(const CUserCDP &userCdp);
 
     CdpRatioSortedCache::KeyType MakeCdpRatioSortedKey(const CUserCDP &cdp);
+    // the collateral ratio key of the CDPs to be force liquidated is below it
+    static uint64_t GetEndRatio(const uint64_t collateralRatio, const uint64_t bcoinMedianPrice);
 public:
     /*  CCompositeKVCache  prefixType       key                            value             variable  */
     /*  ---------------- --------------   ------------                --------------    ----- --------*/
@@ -86,6 +154,9 @@ public:
     CCompositeKVCache<  dbk::CDP_COIN_PAIRS, CCdpCoinPair, uint8_t> cdpCoinPairsCache;
     // cdpr{Ratio}{$cdpid} -> CUserCDP
     CdpRatioSortedCache           cdpRatioSortedCache;
+
+    // created by the db level cache, shared by the upper level caches
+    shared_ptr<CCdpRatioIndex>    spRatioIndex;
 };
 
 enum CDPCloseType: uint8_t {
@@ -139,6 +210,11 @@ public:
         closedTxCdpCache.SetDbOpLogMap(pDbOpLogMapIn);
     }
 
+    void SetDbAccessLog(CDbAccessLog *pDbAccessLogIn) {
+        closedCdpTxCache.SetDbAccessLog(pDbAccessLogIn);
+        closedTxCdpCache.SetDbAccessLog(pDbAccessLogIn);
+    }
+
     void RegisterUndoFunc(UndoDataFuncMap &undoDataFuncMap) {
         closedCdpTxCache.RegisterUndoFunc(undoDataFuncMap);
         closedTxCdpCache.RegisterUndoFunc(undoDataFuncMap);
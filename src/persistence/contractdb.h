@@ -112,6 +112,13 @@ public:
         contractTracesCache.SetDbOpLogMap(pDbOpLogMapIn);
     }
 
+    void SetDbAccessLog(CDbAccessLog *pDbAccessLogIn) {
+        contractCache.SetDbAccessLog(pDbAccessLogIn);
+        contractDataCache.SetDbAccessLog(pDbAccessLogIn);
+        contractAccountCache.SetDbAccessLog(pDbAccessLogIn);
+        contractTracesCache.SetDbAccessLog(pDbAccessLogIn);
+    }
+
     void RegisterUndoFunc(UndoDataFuncMap &undoDataFuncMap) {
         contractCache.RegisterUndoFunc(undoDataFuncMap);
         contractDataCache.RegisterUndoFunc(undoDataFuncMap);
@@ -17,6 +17,9 @@
 
 using namespace std;
 
+// the keys confirmed absent in db kept by one db level cache, the set is dropped when it is full
+static const uint32_t MAX_MISSING_KEY_COUNT = 100000;
+
 /**
  * Empty functions
  */
@@ -268,19 +271,51 @@ class CDBAccess {
 public:
     CDBAccess(const boost::filesystem::path& dir, DBNameType dbNameTypeIn, bool fMemory, bool fWipe) :
               dbNameType(dbNameTypeIn),
-              db( dir / ::GetDbName(dbNameTypeIn), DBCacheSize[dbNameTypeIn], fMemory, fWipe ) {}
+              spDb(std::make_shared<CLevelDBWrapper>(dir / ::GetDbName(dbNameTypeIn), DBCacheSize[dbNameTypeIn],
+                   fMemory, fWipe)) {}
+
+    // access the db name type in the shared db, the data are separated by key prefixes
+    CDBAccess(DBNameType dbNameTypeIn, std::shared_ptr<CLevelDBWrapper> spDbIn) :
+              dbNameType(dbNameTypeIn), spDb(spDbIn) {
+        assert(spDbIn != nullptr);
+    }
+
+    // the read-only access of the db name type of the base, all of the reads see the state of the snapshot
+    CDBAccess(const CDBAccess &base, std::shared_ptr<const leveldb::Snapshot> spSnapshotIn) :
+              dbNameType(base.dbNameType), spDb(base.spDb), spSnapshot(spSnapshotIn) {
+        assert(spSnapshotIn != nullptr);
+    }
+
+    bool IsSnapshot() const { return spSnapshot != nullptr; }
+
+    int64_t GetDbCount() const { return spDb->GetDbCount(); }
+
+    // approximate disk size of all the key prefixes of this db name type
+    uint64_t GetApproximateSize() const {
+        uint64_t size = 0;
+        for (int32_t i = dbk::EMPTY + 1; i < dbk::PREFIX_COUNT; i++) {
+            dbk::PrefixType prefixType = (dbk::PrefixType)i;
+            if (dbk::GetDbNameEnumByPrefix(prefixType) != dbNameType)
+                continue;
+
+            const string &beginKey = dbk::GetKeyPrefix(prefixType);
+            string endKey = beginKey;
+            endKey.back()++;
+            size += spDb->GetApproximateSize(beginKey, endKey);
+        }
+        return size;
+    }
 
-    int64_t GetDbCount() const { return db.GetDbCount(); }
     template<typename KeyType, typename ValueType>
     bool GetData(const dbk::PrefixType prefixType, const KeyType &key, ValueType &value) const {
         string keyStr = dbk::GenDbKey(prefixType, key);
-        return db.Read(keyStr, value);
+        return spDb->Read(keyStr, value, spSnapshot.get());
     }
 
     template<typename ValueType>
     bool GetData(const dbk::PrefixType prefixType, ValueType &value) const {
         const string prefix = dbk::GetKeyPrefix(prefixType);
-        return db.Read(prefix, value);
+        return spDb->Read(prefix, value, spSnapshot.get());
     }
 
     template <typename KeyType>
@@ -447,44 +482,64 @@ public:
     template<typename KeyType, typename ValueType>
     bool HasData(const dbk::PrefixType prefixType, const KeyType &key) const {
         string keyStr = dbk::GenDbKey(prefixType, key);
-        return db.Exists(keyStr);
+        return spDb->Exists(keyStr, spSnapshot.get());
     }
 
     template<typename KeyType, typename ValueType>
     void BatchWrite(const dbk::PrefixType prefixType, const map<KeyType, ValueType> &mapData) {
+        assert(!IsSnapshot() && "the snapshot is read-only");
         CLevelDBBatch batch;
+        CLevelDBBatch &writeBatch = pBatch != nullptr ? *pBatch : batch;
         for (auto item : mapData) {
             string key = dbk::GenDbKey(prefixType, item.first);
             if (db_util::IsEmpty(item.second)) {
-                batch.Erase(key);
+                writeBatch.Erase(key);
             } else {
-                batch.Write(key, item.second);
+                writeBatch.Write(key, item.second);
             }
         }
-        db.WriteBatch(batch, true);
+        if (pBatch == nullptr)
+            spDb->WriteBatch(batch, fSyncWrite);
     }
 
     template<typename ValueType>
     void BatchWrite(const dbk::PrefixType prefixType, ValueType &value) {
+        assert(!IsSnapshot() && "the snapshot is read-only");
         CLevelDBBatch batch;
+        CLevelDBBatch &writeBatch = pBatch != nullptr ? *pBatch : batch;
         const string prefix = dbk::GetKeyPrefix(prefixType);
 
         if (db_util::IsEmpty(value)) {
-            batch.Erase(prefix);
+            writeBatch.Erase(prefix);
         } else {
-            batch.Write(prefix, value);
+            writeBatch.Write(prefix, value);
         }
-        db.WriteBatch(batch, true);
+        if (pBatch == nullptr)
+            spDb->WriteBatch(batch, fSyncWrite);
     }
 
+    /**
+     * While the batch is set, BatchWrite() only appends data to it, the owner of the batch must
+     * commit it before any data is read back from db.
+     */
+    void SetBatch(CLevelDBBatch *pBatchIn) { pBatch = pBatchIn; }
+
+    // the unsynced writes are readable at once, the owner must sync the db later for durability
+    void SetSyncWrite(bool fSyncWriteIn) { fSyncWrite = fSyncWriteIn; }
+
+    std::shared_ptr<CLevelDBWrapper> GetDb() const { return spDb; }
+
     DBNameType GetDbNameType() const { return dbNameType; }
 
     std::shared_ptr<leveldb::Iterator> NewIterator() {
-        return std::shared_ptr<leveldb::Iterator>(db.NewIterator());
+        return std::shared_ptr<leveldb::Iterator>(spDb->NewIterator(spSnapshot.get()));
     }
 private:
     DBNameType dbNameType;
-    mutable CLevelDBWrapper db; // // TODO: remove the mutable declare
+    std::shared_ptr<CLevelDBWrapper> spDb;
+    std::shared_ptr<const leveldb::Snapshot> spSnapshot = nullptr;  // released before the db
+    CLevelDBBatch *pBatch = nullptr;
+    bool fSyncWrite = true;
 };
 
 template<int32_t PREFIX_TYPE_VALUE, typename __KeyType, typename __ValueType>
@@ -516,7 +571,7 @@ public:
 
     void SetBase(CCompositeKVCache *pBaseIn) {
         assert(pDbAccess == nullptr);
-        assert(mapData.empty());
+        assert(mapData.empty() && missingKeys.empty());
         pBase = pBaseIn;
     };
 
@@ -524,6 +579,10 @@ public:
         pDbOpLogMap = pDbOpLogMapIn;
     }
 
+    void SetDbAccessLog(CDbAccessLog *pDbAccessLogIn) {
+        pDbAccessLog = pDbAccessLogIn;
+    }
+
     bool IsCalcSize() const { return is_calc_size; }
 
     uint32_t GetCacheSize() const {
@@ -531,6 +590,8 @@ public:
     }
 
     bool GetTopNElements(const uint32_t maxNum, set<KeyType> &keys) {
+        AddPrefixReadLog();
+
         // 1. Get all candidate elements.
         set<KeyType> expiredKeys;
         set<KeyType> candidateKeys;
@@ -553,6 +614,7 @@ public:
 
     // map<string, ValueType>
     bool GetAllElements(const KeyType &endKey, Map &elements) {
+        AddPrefixReadLog();
         set<KeyType> expiredKeys;
         if (!GetAllElements(endKey, elements, expiredKeys)) {
             // TODO: log
@@ -563,6 +625,7 @@ public:
     }
 
     bool GetAllElements(map<KeyType, ValueType> &elements) {
+        AddPrefixReadLog();
         set<KeyType> expiredKeys;
         if (!GetAllElements(expiredKeys, elements)) {
             // TODO: log
@@ -576,9 +639,9 @@ public:
         if (db_util::IsEmpty(key)) {
             return false;
         }
-        auto it = GetDataIt(key);
-        if (it != mapData.end() && !db_util::IsEmpty(it->second)) {
-            value = it->second;
+        auto pValue = FindData(key);
+        if (pValue != nullptr && !db_util::IsEmpty(*pValue)) {
+            value = *pValue;
             return true;
         }
         return false;
@@ -605,8 +668,8 @@ public:
         if (db_util::IsEmpty(key)) {
             return false;
         }
-        auto it = GetDataIt(key);
-        return it != mapData.end() && !db_util::IsEmpty(it->second);
+        auto pValue = FindData(key);
+        return pValue != nullptr && !db_util::IsEmpty(*pValue);
     }
 
     bool EraseData(const KeyType &key) {
@@ -625,15 +688,27 @@ public:
 
     void Clear() {
         mapData.clear();
+        missingKeys.clear();
         size = 0;
     }
 
     void Flush() {
         assert(pBase != nullptr || pDbAccess != nullptr);
+        if (pDbAccessLog != nullptr) {
+            for (const auto &item : mapData)
+                pDbAccessLog->AddWrite(PREFIX_TYPE, item.first, item.second);
+        }
+
         if (pBase != nullptr) {
             assert(pDbAccess == nullptr);
             for (auto it : mapData) {
-                pBase->mapData[it.first] = it.second;
+                auto baseIt = pBase->mapData.find(it.first);
+                if (baseIt == pBase->mapData.end()) {
+                    pBase->AddDataToMap(it.first, it.second);
+                } else {
+                    pBase->UpdateDataSize(baseIt->second, it.second);
+                    baseIt->second = it.second;
+                }
             }
         } else if (pDbAccess != nullptr) {
             assert(pBase == nullptr);
@@ -678,25 +753,66 @@ public:
 
     CCompositeKVCache<PREFIX_TYPE, KeyType, ValueType>* GetBasePtr() { return pBase; }
 
-    map<KeyType, ValueType>& GetMapData() { return mapData; };
+    // for iterating the elements, it is logged as a read of the whole prefix
+    map<KeyType, ValueType>& GetMapData() {
+        AddPrefixReadLog();
+        return mapData;
+    };
+
+    uint32_t GetMissingKeyCount() const { return missingKeys.size(); }
 private:
+    /**
+     * Read-only lookup, copy-on-write for the upper level caches:
+     * the found value is referenced in place and only be copied into mapData when
+     * it is loaded from db, so the upper level cache holds the changed keys only,
+     * and the Flush() of it costs O(changed keys).
+     */
+    const ValueType* FindData(const KeyType &key) const {
+        if (pDbAccessLog != nullptr)
+            pDbAccessLog->AddRead(PREFIX_TYPE, key);
+
+        auto it = mapData.find(key);
+        if (it != mapData.end()) {
+            return &it->second;
+        } else if (pBase != nullptr) {
+            auto baseLock   = LockBase();
+            auto pBaseValue = pBase->FindData(key);
+            if (pBaseValue != nullptr)
+                return pBaseValue;
+        } else if (pDbAccess != nullptr && !missingKeys.count(key)) {
+            auto pDbValue = db_util::MakeEmptyValue<ValueType>();
+            if (pDbAccess->GetData(PREFIX_TYPE, key, *pDbValue)) {
+                return &AddDataToMap(key, *pDbValue)->second;
+            }
+            AddMissingKey(key);
+        }
+
+        return nullptr;
+    }
+
+    // Lookup for modification, the found value will be copied into current mapData
     Iterator GetDataIt(const KeyType &key) const {
+        if (pDbAccessLog != nullptr)
+            pDbAccessLog->AddRead(PREFIX_TYPE, key);
+
         Iterator it = mapData.find(key);
         if (it != mapData.end()) {
             return it;
         } else if (pBase != nullptr) {
             // find key-value at base cache
-            auto baseIt = pBase->GetDataIt(key);
+            auto baseLock = LockBase();
+            auto baseIt   = pBase->GetDataIt(key);
             if (baseIt != pBase->mapData.end()) {
                 // the found key-value add to current mapData
                 return AddDataToMap(key, baseIt->second);
             }
-        } else if (pDbAccess != NULL) {
-            // TODO: need to save the empty value to mapData for search performance?
+        } else if (pDbAccess != NULL && !missingKeys.count(key)) {
+            // the key confirmed absent in db is not looked up again
             auto pDbValue = db_util::MakeEmptyValue<ValueType>();
             if (pDbAccess->GetData(PREFIX_TYPE, key, *pDbValue)) {
                 return AddDataToMap(key, *pDbValue);
             }
+            AddMissingKey(key);
         }
 
         return mapData.end();
@@ -706,10 +822,39 @@ private:
         auto newRet = mapData.emplace(keyIn, valueIn);
         if (!newRet.second)
             throw runtime_error(strprintf("%s :  %s, alloc new cache item failed", __FUNCTION__, __LINE__));
+        EraseMissingKey(keyIn);
         IncDataSize(keyIn, valueIn);
         return newRet.first;
     }
 
+    // negative cache: keys not found in db, only kept by the db level cache, which all of the writes of the upper
+    // level caches are flushed into, so the missing key is dropped by AddDataToMap() once the key is set by any of
+    // them. It is kept disjoint with mapData, never flushed to db, and bounded by MAX_MISSING_KEY_COUNT.
+    inline void AddMissingKey(const KeyType &keyIn) const {
+        if (missingKeys.size() >= MAX_MISSING_KEY_COUNT)
+            ClearMissingKeys();
+
+        if (missingKeys.emplace(keyIn).second && is_calc_size)
+            size += CalcDataSize(keyIn);
+    }
+
+    inline void ClearMissingKeys() const {
+        if (is_calc_size) {
+            for (const auto &key : missingKeys) {
+                uint32_t sz = CalcDataSize(key);
+                size = size > sz ? size - sz : 0;
+            }
+        }
+        missingKeys.clear();
+    }
+
+    inline void EraseMissingKey(const KeyType &keyIn) const {
+        if (missingKeys.erase(keyIn) > 0 && is_calc_size) {
+            uint32_t sz = CalcDataSize(keyIn);
+            size = size > sz ? size - sz : 0;
+        }
+    }
+
     inline void IncDataSize(const KeyType &keyIn, const ValueType &valueIn) const {
         if (is_calc_size) {
             size += CalcDataSize(keyIn);
@@ -763,6 +908,7 @@ private:
         }
 
         if (pBase != nullptr) {
+            auto baseLock = LockBase();
             return pBase->GetTopNElements(maxNum, expiredKeys, keys);
         } else if (pDbAccess != nullptr) {
             return pDbAccess->GetTopNElements(maxNum, PREFIX_TYPE, expiredKeys, keys);
@@ -786,6 +932,7 @@ private:
         }
 
         if (pBase != nullptr) {
+            auto baseLock = LockBase();
             return pBase->GetAllElements(endKey, mapDataOut, expiredKeys);
         } else if (pDbAccess != nullptr) {
             return pDbAccess->GetAllElements(PREFIX_TYPE, endKey, mapDataOut, expiredKeys);
@@ -810,6 +957,7 @@ private:
         }
 
         if (pBase != nullptr) {
+            auto baseLock = LockBase();
             return pBase->GetAllElements(expiredKeys, elements);
         } else if (pDbAccess != nullptr) {
             return pDbAccess->GetAllElements(PREFIX_TYPE, expiredKeys, elements);
@@ -833,11 +981,22 @@ private:
         }
 
     }
+
+    inline void AddPrefixReadLog() const {
+        if (pDbAccessLog != nullptr)
+            pDbAccessLog->AddPrefixRead(PREFIX_TYPE);
+    }
+
+    inline std::unique_lock<std::mutex> LockBase() const {
+        return pDbAccessLog != nullptr ? pDbAccessLog->LockBase(PREFIX_TYPE) : std::unique_lock<std::mutex>();
+    }
 private:
     mutable CCompositeKVCache<PREFIX_TYPE, KeyType, ValueType> *pBase = nullptr;
     CDBAccess *pDbAccess = nullptr;
     mutable map<KeyType, ValueType> mapData;
+    mutable set<KeyType> missingKeys;
     CDBOpLogMap *pDbOpLogMap = nullptr;
+    CDbAccessLog *pDbAccessLog = nullptr;
     bool is_calc_size = false;
     mutable uint32_t size = 0;
 };
@@ -878,6 +1037,7 @@ public:
             ptrData = make_shared<ValueType>(*other.ptrData);
         }
         pDbOpLogMap = other.pDbOpLogMap;
+        pDbAccessLog = other.pDbAccessLog;
         return *this;
     }
 
@@ -891,6 +1051,10 @@ public:
         pDbOpLogMap = pDbOpLogMapIn;
     }
 
+    void SetDbAccessLog(CDbAccessLog *pDbAccessLogIn) {
+        pDbAccessLog = pDbAccessLogIn;
+    }
+
     uint32_t GetCacheSize() const {
         if (!ptrData) {
             return 0;
@@ -909,7 +1073,8 @@ public:
     }
 
     bool SetData(const ValueType &value) {
-        if (!ptrData) {
+        auto ptr = GetOwnDataPtr();
+        if (!ptr) {
             ptrData = db_util::MakeEmptyValue<ValueType>();
         }
         AddOpLog(*ptrData);
@@ -923,7 +1088,7 @@ public:
     }
 
     bool EraseData() {
-        auto ptr = GetDataPtr();
+        auto ptr = GetOwnDataPtr();
         if (ptr && !db_util::IsEmpty(*ptr)) {
             AddOpLog(*ptr);
             db_util::SetEmpty(*ptr);
@@ -938,6 +1103,9 @@ public:
     void Flush() {
         assert(pBase != nullptr || pDbAccess != nullptr);
         if (ptrData) {
+            if (pDbAccessLog != nullptr)
+                pDbAccessLog->AddWrite(PREFIX_TYPE, *ptrData);
+
             if (pBase != nullptr) {
                 assert(pDbAccess == nullptr);
                 pBase->ptrData = ptrData;
@@ -968,16 +1136,16 @@ public:
 
     dbk::PrefixType GetPrefixType() const { return PREFIX_TYPE; }
 
-    std::shared_ptr<ValueType> GetDataPtr() const {
+    // Read-only data ptr, the data of base cache is shared without copy.
+    std::shared_ptr<const ValueType> GetDataPtr() const {
+        if (pDbAccessLog != nullptr)
+            pDbAccessLog->AddRead(PREFIX_TYPE);
 
         if (ptrData) {
             return ptrData;
         } else if (pBase != nullptr){
-            auto ptr = pBase->GetDataPtr();
-            if (ptr) {
-                ptrData = std::make_shared<ValueType>(*ptr);
-                return ptrData;
-            }
+            auto baseLock = LockBase();
+            return pBase->GetDataPtr();
         } else if (pDbAccess != NULL) {
             auto ptrDbData = db_util::MakeEmptyValue<ValueType>();
 
@@ -991,6 +1159,17 @@ public:
     }
 
 private:
+    // Data ptr for modification, the data of base cache will be copied into current cache.
+    std::shared_ptr<ValueType> GetOwnDataPtr() {
+        if (!ptrData) {
+            auto ptr = GetDataPtr();
+            if (ptr) {
+                ptrData = std::make_shared<ValueType>(*ptr);
+            }
+        }
+        return ptrData;
+    }
+
     inline void AddOpLog(const ValueType &oldValue) {
         if (pDbOpLogMap != nullptr) {
             CDbOpLog dbOpLog;
@@ -999,11 +1178,16 @@ private:
         }
 
     }
+
+    inline std::unique_lock<std::mutex> LockBase() const {
+        return pDbAccessLog != nullptr ? pDbAccessLog->LockBase(PREFIX_TYPE) : std::unique_lock<std::mutex>();
+    }
 private:
     mutable CSimpleKVCache<PREFIX_TYPE, ValueType> *pBase;
     CDBAccess *pDbAccess;
     mutable std::shared_ptr<ValueType> ptrData = nullptr;
     CDBOpLogMap *pDbOpLogMap                   = nullptr;
+    CDbAccessLog *pDbAccessLog                 = nullptr;
 };
 
 #endif  // PERSIST_DB_ACCESS_H
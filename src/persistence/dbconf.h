@@ -59,6 +59,18 @@ inline const std::string& GetDbName(DBNameType dbNameType) {
     return kDbNames[dbNameType];
 }
 
+// the single db holding all of the db name types above, enabled by -singledb
+static const std::string kSingleDbName = "chainstate";
+// the marker of the single db written by the last synced batch of the migration, the single db without it is partial
+static const std::string kSingleDbMigratedKey = "#migrated";
+
+inline int64_t GetTotalDbCacheSize() {
+    int64_t ret = 0;
+    for (int32_t i = 0; i < DBNameType::DB_NAME_COUNT; i++)
+        ret += DBCacheSize[i];
+    return ret;
+}
+
 namespace dbk {
 
 
@@ -116,6 +128,8 @@ namespace dbk {
         /**** dex db                                                                    */ \
         DEFINE( DEX_ACTIVE_ORDER,     "dato",       DEX )        /* [prefix]{txid} --> active order */ \
         DEFINE( DEX_BLOCK_ORDERS,     "dbos",       DEX )        /* [prefix]{height, generate_type, txid} --> active order */ \
+        DEFINE( DEX_ORDER_BOOK,       "dobk",       DEX )        /* [prefix]{coin, asset, side}{price_key}{height, index}{txid} --> active order */ \
+        DEFINE( DEX_PRICE_LEVELS,     "dopl",       DEX )        /* [prefix]{coin, asset, side}{price_key} --> price level */ \
         DEFINE( DEX_OPERATOR_LAST_ID, "doli",       DEX )        /* [prefix] --> dex_operator_new_id */ \
         DEFINE( DEX_OPERATOR_DETAIL,  "dode",       DEX )        /* [prefix]{dex_operator_id} --> dex_operator_detail */ \
         DEFINE( DEX_OPERATOR_OWNER_MAP, "doom",     DEX )        /* [prefix]{owner_name} --> dex_operator_id */ \
@@ -133,6 +147,7 @@ namespace dbk {
         DEFINE( MEDIAN_PRICES,        "mdps",       PRICEFEED)   /* [prefix] --> median prices */ \
         DEFINE( PRICE_FEED_COIN,      "pfco",       PRICEFEED)   /* [prefix] --> price feed coins */      \
         DEFINE( PRICE_FEEDERS,         "pfdr",       PRICEFEED)   /* [prefix] --> price feeder */      \
+        DEFINE( PRICE_POINT_SNAPSHOT, "ppss",       PRICEFEED)   /* [prefix] --> price points of the latest blocks */ \
         /*                                                                             */ \
         /* Add new Enum elements above, PREFIX_COUNT Must be the last one              */ \
         DEFINE( PREFIX_COUNT,          "",       DB_NAME_NONE)    /* enum count, must be the last one */
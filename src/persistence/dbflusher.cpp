@@ -0,0 +1,103 @@
+// Copyright (c) 2017-2019 The GreenVenturesChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "dbflusher.h"
+
+#include "commons/util/util.h"
+#include "logging.h"
+
+#include <chrono>
+
+CDBFlusher::CDBFlusher(const std::vector<std::shared_ptr<CLevelDBWrapper>> &dbsIn, uint32_t syncBlocksIn,
+                       int64_t syncIntervalMsIn)
+    : dbs(dbsIn), syncBlocks(syncBlocksIn), syncIntervalMs(std::max<int64_t>(syncIntervalMsIn, 0)) {
+    // no limit of both would never sync the pending writes until the shutdown
+    if (syncBlocks == 0 && syncIntervalMs == 0)
+        syncBlocks = 1;
+
+    if (IsAsync()) {
+        running = true;
+        thread  = std::thread(&CDBFlusher::Run, this);
+        LogPrint(BCLog::INFO, "db flusher started, sync_blocks=%u, sync_interval=%lldms\n", syncBlocks,
+                 syncIntervalMs);
+    }
+}
+
+CDBFlusher::~CDBFlusher() { Stop(); }
+
+void CDBFlusher::NotifyFlushed() {
+    if (!IsAsync())
+        return;
+
+    STD_LOCK(cs);
+    if (pendingCount++ == 0)
+        firstPendingTimeMs = GetTimeMillis();
+    cond.notify_one();
+}
+
+void CDBFlusher::Stop() {
+    {
+        STD_LOCK(cs);
+        if (!running)
+            return;
+        running = false;
+        cond.notify_all();
+    }
+    thread.join();
+
+    SyncDbs();
+    LogPrint(BCLog::INFO, "db flusher stopped\n");
+}
+
+uint32_t CDBFlusher::GetPendingCount() {
+    STD_LOCK(cs);
+    return pendingCount;
+}
+
+void CDBFlusher::Run() {
+    RenameThread("coin-dbflush");
+
+    while (true) {
+        {
+            STD_WAIT_LOCK(cs, lock);
+            while (running) {
+                if (pendingCount > 0) {
+                    if (syncBlocks > 0 && pendingCount >= syncBlocks)
+                        break;
+
+                    if (syncIntervalMs > 0) {
+                        int64_t waitMs = firstPendingTimeMs + syncIntervalMs - GetTimeMillis();
+                        if (waitMs <= 0)
+                            break;
+
+                        cond.wait_for(lock, std::chrono::milliseconds(waitMs));
+                        continue;
+                    }
+                }
+                cond.wait(lock);
+            }
+            if (!running)
+                break;
+
+            pendingCount       = 0;
+            firstPendingTimeMs = 0;
+        }
+
+        // the new flushes will be written while syncing, they will be synced by the next round
+        SyncDbs();
+    }
+}
+
+void CDBFlusher::SyncDbs() {
+    int64_t beginTime = GetTimeMillis();
+    try {
+        for (auto &spDb : dbs)
+            spDb->Sync();
+    } catch (std::exception &e) {
+        // the unsynced writes are still readable, only the durability is affected
+        LogPrint(BCLog::ERROR, "%s, sync db error: %s\n", __func__, e.what());
+        return;
+    }
+    LogPrint(BCLog::LDB, "synced %u dbs (%lldms)\n", dbs.size(), GetTimeMillis() - beginTime);
+}
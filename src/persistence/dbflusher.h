@@ -0,0 +1,61 @@
+// Copyright (c) 2017-2019 The GreenVenturesChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef PERSIST_DBFLUSHER_H
+#define PERSIST_DBFLUSHER_H
+
+#include "leveldbwrapper.h"
+#include "sync.h"
+
+#include <condition_variable>
+#include <memory>
+#include <thread>
+#include <vector>
+
+static const uint32_t DEFAULT_DB_SYNC_BLOCKS        = 1;
+static const int64_t DEFAULT_DB_SYNC_INTERVAL_MS    = 0;
+
+/**
+ * Durability policy of the chain state dbs.
+ * The flushed data are written to db without fsync and are readable at once, the flusher thread
+ * group commits all of the pending writes with one fsync, when there are syncBlocks pending flushes
+ * or the oldest pending flush is older than syncIntervalMs.
+ * syncBlocks = 1 and syncIntervalMs = 0 means every flush is synced inline, without the thread.
+ * syncBlocks = 0 and syncIntervalMs = 0 would never sync, it is treated as the inline sync.
+ */
+class CDBFlusher {
+public:
+    CDBFlusher(const std::vector<std::shared_ptr<CLevelDBWrapper>> &dbsIn, uint32_t syncBlocksIn,
+               int64_t syncIntervalMsIn);
+
+    ~CDBFlusher();
+
+    bool IsAsync() const { return syncBlocks != 1 || syncIntervalMs > 0; }
+
+    // must be called after each flush written to dbs
+    void NotifyFlushed();
+
+    // sync all of the pending writes and stop the thread
+    void Stop();
+
+    uint32_t GetPendingCount();
+
+private:
+    void Run();
+    void SyncDbs();
+
+private:
+    std::vector<std::shared_ptr<CLevelDBWrapper>> dbs;
+    uint32_t syncBlocks;
+    int64_t syncIntervalMs;
+
+    StdMutex cs;
+    std::condition_variable cond;
+    uint32_t pendingCount       = 0;
+    int64_t firstPendingTimeMs  = 0;
+    bool running                = false;
+    std::thread thread;
+};
+
+#endif // PERSIST_DBFLUSHER_H
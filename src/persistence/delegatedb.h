@@ -79,6 +79,14 @@ public:
         active_delegates_cache.SetDbOpLogMap(pDbOpLogMapIn);
     }
 
+    void SetDbAccessLog(CDbAccessLog *pDbAccessLogIn) {
+        voteRegIdCache.SetDbAccessLog(pDbAccessLogIn);
+        regId2VoteCache.SetDbAccessLog(pDbAccessLogIn);
+        last_vote_height_cache.SetDbAccessLog(pDbAccessLogIn);
+        pending_delegates_cache.SetDbAccessLog(pDbAccessLogIn);
+        active_delegates_cache.SetDbAccessLog(pDbAccessLogIn);
+    }
+
     void RegisterUndoFunc(UndoDataFuncMap &undoDataFuncMap) {
         voteRegIdCache.RegisterUndoFunc(undoDataFuncMap);
         regId2VoteCache.RegisterUndoFunc(undoDataFuncMap);
@@ -7,6 +7,8 @@
 #include "entities/account.h"
 #include "entities/asset.h"
 #include "main.h"
+#include "persistence/dbiterator.h"
+#include "persistence/statesnapshot.h"
 #include <optional>
 #include <functional>
 
@@ -33,16 +35,17 @@ void DEX_DB::BlockOrdersToJson(const BlockOrders &orders, Object &obj) {
     obj.push_back(Pair("orders", array));
 }
 
-shared_ptr<string> DEX_DB::ParseLastPos(const string &lastPosInfo, DEXBlockOrdersCache::KeyType &lastKey) {
+shared_ptr<string> DEX_DB::ParseLastPos(const CStateView &view, const string &lastPosInfo,
+                                         DEXBlockOrdersCache::KeyType &lastKey) {
 
     CDataStream ds(lastPosInfo, SER_DISK, CLIENT_VERSION);
     uint256 lastBlockHash;
     ds >> lastBlockHash >> lastKey;
     uint32_t lastHeight = DEX_DB::GetHeight(lastKey);
-    CBlockIndex *pBlockIndex = chainActive[lastHeight];
+    const CBlockIndex *pBlockIndex = view.GetBlockIndex(lastHeight);
     if (pBlockIndex == nullptr)
         return make_shared<string>(strprintf("The last_pos_info is not contained in active chains,"
-            " last_height=%d, tip_height=%d", lastHeight, chainActive.Height()));
+            " last_height=%d, tip_height=%d", lastHeight, view.GetHeight()));
     if (pBlockIndex->GetBlockHash() != lastBlockHash)
         return make_shared<string>(strprintf("The block of height in last_pos_info does not match with the active block,"
             " height=%d, last_block_hash=%s, cur_height_block_hash=%s",
@@ -50,12 +53,13 @@ shared_ptr<string> DEX_DB::ParseLastPos(const string &lastPosInfo, DEXBlockOrder
     return nullptr;
 }
 
-shared_ptr<string> DEX_DB::MakeLastPos(const DEXBlockOrdersCache::KeyType &lastKey, string &lastPosInfo) {
+shared_ptr<string> DEX_DB::MakeLastPos(const CStateView &view, const DEXBlockOrdersCache::KeyType &lastKey,
+                                        string &lastPosInfo) {
     uint32_t lastHeight = DEX_DB::GetHeight(lastKey);
-    CBlockIndex *pBlockIndex = chainActive[lastHeight];
+    const CBlockIndex *pBlockIndex = view.GetBlockIndex(lastHeight);
     if (pBlockIndex == nullptr)
         return make_shared<string>(strprintf("The block of lastKey is not contained in active chains,"
-            " last_height=%d, tip_height=%d", lastHeight, chainActive.Height()));
+            " last_height=%d, tip_height=%d", lastHeight, view.GetHeight()));
 
     CDataStream ds(SER_DISK, CLIENT_VERSION);
     ds << pBlockIndex->GetBlockHash() << lastKey;
@@ -377,6 +381,56 @@ void CDEXSysOrdersGetter::ToJson(Object &obj) {
     DEX_DB::BlockOrdersToJson(orders, obj);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// class CDEXOrderBookGetter
+
+// The price key of the price-time priority: the market orders have no price and are matched first, the buy orders
+// with the higher price and the sell orders with the lower price are matched first.
+static uint64_t MakePriceKey(const CDEXOrderDetail &order) {
+    if (order.order_type != ORDER_LIMIT_PRICE)
+        return 0;
+    return (order.order_side == ORDER_BUY) ? UINT64_MAX - order.price : order.price;
+}
+
+static uint64_t GetPriceByKey(OrderSide side, uint64_t priceKey) {
+    return (side == ORDER_BUY) ? UINT64_MAX - priceKey : priceKey;
+}
+
+bool CDEXOrderBookGetter::Execute(const CDEXOrderBookSide &side, uint32_t maxDepth, uint32_t maxCount) {
+    assert(levels.empty() && orders.empty() && "Can only execute 1 times");
+
+    if (maxDepth > 0) {
+        CDBPrefixIterator<DEXPriceLevelsCache, CDEXOrderBookSide> levelIt(price_levels_cache, side);
+        for (levelIt.First(); levelIt.IsValid() && levels.size() < maxDepth; levelIt.Next())
+            levels.emplace_back(GetPriceByKey(side.order_side, levelIt.GetKey().second.value), levelIt.GetValue());
+    }
+
+    if (maxCount > 0) {
+        CDBPrefixIterator<DEXOrderBookCache, CDEXOrderBookSide> orderIt(order_book_cache, side);
+        for (orderIt.First(); orderIt.IsValid() && orders.size() < maxCount; orderIt.Next())
+            orders.emplace_back(DEX_DB::GetOrderId(orderIt.GetKey()), orderIt.GetValue());
+    }
+    return true;
+}
+
+void CDEXOrderBookGetter::LevelsToJson(Array &arr) {
+    for (const auto &item : levels) {
+        Object obj;
+        obj.push_back(Pair("price",         item.first));
+        obj.push_back(Pair("asset_amount",  item.second.asset_amount));
+        obj.push_back(Pair("order_count",   (int64_t)item.second.order_count));
+        arr.push_back(obj);
+    }
+}
+
+void CDEXOrderBookGetter::OrdersToJson(Array &arr) {
+    for (const auto &item : orders) {
+        Object obj;
+        DEX_DB::OrderToJson(item.first, item.second, obj);
+        arr.push_back(obj);
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // class CDexDBCache
 
@@ -393,17 +447,82 @@ bool CDexDBCache::CreateActiveOrder(const uint256 &orderId, const CDEXOrderDetai
     }
 
     return activeOrderCache.SetData(orderId, activeOrder)
-        && blockOrdersCache.SetData(MakeBlockOrderKey(orderId, activeOrder), activeOrder);
+        && blockOrdersCache.SetData(MakeBlockOrderKey(orderId, activeOrder), activeOrder)
+        && orderBookCache.SetData(MakeOrderBookKey(orderId, activeOrder), activeOrder)
+        && UpdatePriceLevel(nullptr, &activeOrder);
 }
 
 bool CDexDBCache::UpdateActiveOrder(const uint256 &orderId, const CDEXOrderDetail &activeOrder) {
+    CDEXOrderDetail oldOrder;
+    bool hasOldOrder = activeOrderCache.GetData(orderId, oldOrder);
     return activeOrderCache.SetData(orderId, activeOrder)
-        && blockOrdersCache.SetData(MakeBlockOrderKey(orderId, activeOrder), activeOrder);
+        && blockOrdersCache.SetData(MakeBlockOrderKey(orderId, activeOrder), activeOrder)
+        && orderBookCache.SetData(MakeOrderBookKey(orderId, activeOrder), activeOrder)
+        && UpdatePriceLevel(hasOldOrder ? &oldOrder : nullptr, &activeOrder);
 }
 
 bool CDexDBCache::EraseActiveOrder(const uint256 &orderId, const CDEXOrderDetail &activeOrder) {
+    // the residual amount of the price level is removed by the stored order, not the dealt one to be erased
+    CDEXOrderDetail oldOrder;
+    bool hasOldOrder = activeOrderCache.GetData(orderId, oldOrder);
     return activeOrderCache.EraseData(orderId)
-        && blockOrdersCache.EraseData(MakeBlockOrderKey(orderId, activeOrder));
+        && blockOrdersCache.EraseData(MakeBlockOrderKey(orderId, activeOrder))
+        && orderBookCache.EraseData(MakeOrderBookKey(orderId, activeOrder))
+        && (!hasOldOrder || UpdatePriceLevel(&oldOrder, nullptr));
+}
+
+bool CDexDBCache::BuildOrderBook(uint32_t &orderCount) {
+    assert(orderBookCache.GetBasePtr() == nullptr && "only support top level cache");
+    orderCount = 0;
+
+    CDBIterator<DEXOrderBookCache> bookIt(orderBookCache);
+    if (bookIt.First())
+        return true; // the index is built
+
+    CDBIterator<decltype(activeOrderCache)> dbIt(activeOrderCache);
+    for (dbIt.First(); dbIt.IsValid(); dbIt.Next()) {
+        const CDEXOrderDetail &activeOrder = dbIt.GetValue();
+        if (!orderBookCache.SetData(MakeOrderBookKey(dbIt.GetKey(), activeOrder), activeOrder) ||
+            !UpdatePriceLevel(nullptr, &activeOrder))
+            return false;
+        orderCount++;
+    }
+    return true;
+}
+
+// the orders of the same price are matched by the earlier first
+DEXOrderBookCache::KeyType CDexDBCache::MakeOrderBookKey(const uint256 &orderId, const CDEXOrderDetail &activeOrder) {
+    uint64_t timeKey = ((uint64_t)activeOrder.tx_cord.GetHeight() << 32) | activeOrder.tx_cord.GetIndex();
+    return make_tuple(CDEXOrderBookSide(activeOrder.coin_symbol, activeOrder.asset_symbol, activeOrder.order_side),
+                      CFixedUInt64(MakePriceKey(activeOrder)), CFixedUInt64(timeKey), orderId);
+}
+
+bool CDexDBCache::UpdatePriceLevel(const CDEXOrderDetail *pOldOrder, const CDEXOrderDetail *pNewOrder) {
+    const CDEXOrderDetail &order = pNewOrder ? *pNewOrder : *pOldOrder;
+    if (order.order_type != ORDER_LIMIT_PRICE)
+        return true;
+
+    auto residualAmount = [](const CDEXOrderDetail &order) {
+        return order.asset_amount > order.total_deal_asset_amount ?
+            order.asset_amount - order.total_deal_asset_amount : 0;
+    };
+
+    DEXPriceLevelsCache::KeyType key(CDEXOrderBookSide(order.coin_symbol, order.asset_symbol, order.order_side),
+                                     CFixedUInt64(MakePriceKey(order)));
+    CDEXPriceLevel level;
+    priceLevelsCache.GetData(key, level);
+    if (pOldOrder != nullptr && level.order_count > 0) {
+        level.asset_amount -= std::min(level.asset_amount, residualAmount(*pOldOrder));
+        level.order_count--;
+    }
+    if (pNewOrder != nullptr) {
+        level.asset_amount += residualAmount(*pNewOrder);
+        level.order_count++;
+    }
+
+    if (level.IsEmpty())
+        return priceLevelsCache.EraseData(key);
+    return priceLevelsCache.SetData(key, level);
 }
 
 bool CDexDBCache::IncDexID(DexID &id) {
@@ -19,12 +19,89 @@
 
 using namespace std;
 
+class CStateView;
+
 /*       type               prefixType                   key                            value                type             */
 /*  ----------------   -------------------------  ---------------------------       ------------------   ------------------------ */
     /////////// DexDB
     // block orders: height generate_type txid -> active order
 typedef CCompositeKVCache<dbk::DEX_BLOCK_ORDERS,  tuple<CFixedUInt32, uint8_t, uint256>, dex::CDEXOrderDetail>     DEXBlockOrdersCache;
 
+// the side of the order book of the trading pair, the prefix of the order book key
+class CDEXOrderBookSide {
+public:
+    TokenSymbol coin_symbol;
+    TokenSymbol asset_symbol;
+    dex::OrderSide order_side = dex::ORDER_SIDE_NULL;
+
+public:
+    CDEXOrderBookSide() {}
+
+    CDEXOrderBookSide(const TokenSymbol &coinSymbol, const TokenSymbol &assetSymbol, dex::OrderSide orderSide)
+        : coin_symbol(coinSymbol), asset_symbol(assetSymbol), order_side(orderSide) {}
+
+    IMPLEMENT_SERIALIZE(
+        READWRITE(coin_symbol);
+        READWRITE(asset_symbol);
+        READWRITE((uint8_t&)order_side);
+    )
+
+    // the same order as the serialized key in db, the shorter symbol first
+    friend bool operator<(const CDEXOrderBookSide &a, const CDEXOrderBookSide &b) {
+        return std::make_tuple(a.coin_symbol.size(), std::cref(a.coin_symbol), a.asset_symbol.size(),
+                               std::cref(a.asset_symbol), a.order_side) <
+               std::make_tuple(b.coin_symbol.size(), std::cref(b.coin_symbol), b.asset_symbol.size(),
+                               std::cref(b.asset_symbol), b.order_side);
+    }
+
+    friend bool operator==(const CDEXOrderBookSide &a, const CDEXOrderBookSide &b) {
+        return a.coin_symbol == b.coin_symbol && a.asset_symbol == b.asset_symbol && a.order_side == b.order_side;
+    }
+
+    string ToString() const {
+        return strprintf("%s-%s-%s", coin_symbol, asset_symbol, dex::kOrderSideHelper.GetName(order_side));
+    }
+
+    bool IsEmpty() const { return coin_symbol.empty() && asset_symbol.empty() && order_side == dex::ORDER_SIDE_NULL; }
+
+    void SetEmpty() {
+        coin_symbol.clear();
+        asset_symbol.clear();
+        order_side = dex::ORDER_SIDE_NULL;
+    }
+};
+
+    // order book: {coin, asset, side} price_key {height, index} txid -> active order
+    // sorted by the price-time priority, the market orders first, then the best price, then the earliest order
+typedef CCompositeKVCache<dbk::DEX_ORDER_BOOK,  tuple<CDEXOrderBookSide, CFixedUInt64, CFixedUInt64, uint256>, dex::CDEXOrderDetail>     DEXOrderBookCache;
+
+// the limit orders at the same price of the order book
+class CDEXPriceLevel {
+public:
+    uint64_t asset_amount   = 0;    // the residual asset amount of the orders
+    uint32_t order_count    = 0;
+
+public:
+    IMPLEMENT_SERIALIZE(
+        READWRITE(VARINT(asset_amount));
+        READWRITE(VARINT(order_count));
+    )
+
+    string ToString() const {
+        return strprintf("asset_amount=%llu, order_count=%u", asset_amount, order_count);
+    }
+
+    bool IsEmpty() const { return order_count == 0; }
+
+    void SetEmpty() {
+        asset_amount = 0;
+        order_count  = 0;
+    }
+};
+
+    // price levels: {coin, asset, side} price_key -> price level, the best price first
+typedef CCompositeKVCache<dbk::DEX_PRICE_LEVELS,  pair<CDEXOrderBookSide, CFixedUInt64>, CDEXPriceLevel>     DEXPriceLevelsCache;
+
 // DEX_DB
 namespace DEX_DB {
     //block order key: height generate_type txid
@@ -43,14 +120,21 @@ namespace DEX_DB {
         return std::get<2>(key);
     }
 
-    // return err str if err happens
-    shared_ptr<string> ParseLastPos(const string &lastPosInfo, DEXBlockOrdersCache::KeyType &lastKey);
+    // return err str if err happens, the position is checked by the chain of the view
+    shared_ptr<string> ParseLastPos(const CStateView &view, const string &lastPosInfo,
+                                    DEXBlockOrdersCache::KeyType &lastKey);
 
-    shared_ptr<string> MakeLastPos(const DEXBlockOrdersCache::KeyType &lastKey, string &lastPosInfo);
+    shared_ptr<string> MakeLastPos(const CStateView &view, const DEXBlockOrdersCache::KeyType &lastKey,
+                                   string &lastPosInfo);
 
     void OrderToJson(const uint256 &orderId, const dex::CDEXOrderDetail &order, Object &obj);
 
     void BlockOrdersToJson(const BlockOrders &orderList, Object &obj);
+
+    //order book key: {coin, asset, side} price_key {height, index} txid
+    inline const uint256& GetOrderId(const DEXOrderBookCache::KeyType &key) {
+        return std::get<3>(key);
+    }
 };
 
 class CDEXOrdersGetter {
@@ -88,12 +172,37 @@ public:
     void ToJson(Object &obj);
 };
 
+/**
+ * The top of the order book of one side of the trading pair, read from the order book indexes by the price-time
+ * priority without scanning the active orders. The price levels are aggregated from the limit orders, the market
+ * orders have no price and are only returned by the orders.
+ */
+class CDEXOrderBookGetter {
+public:
+    vector<pair<uint64_t, CDEXPriceLevel>> levels;       // exec result, price -> level, the best price first
+    vector<pair<uint256, dex::CDEXOrderDetail>> orders;  // exec result, in the priority of matching
+private:
+    DEXOrderBookCache &order_book_cache;
+    DEXPriceLevelsCache &price_levels_cache;
+public:
+    CDEXOrderBookGetter(DEXOrderBookCache &orderBookCache, DEXPriceLevelsCache &priceLevelsCache)
+        : order_book_cache(orderBookCache), price_levels_cache(priceLevelsCache) {}
+
+    // get the first maxDepth price levels and the first maxCount orders of the side
+    bool Execute(const CDEXOrderBookSide &side, uint32_t maxDepth, uint32_t maxCount);
+
+    void LevelsToJson(Array &arr);
+    void OrdersToJson(Array &arr);
+};
+
 class CDexDBCache {
 public:
     CDexDBCache() {}
     CDexDBCache(CDBAccess *pDbAccess)
         : activeOrderCache(pDbAccess),
           blockOrdersCache(pDbAccess),
+          orderBookCache(pDbAccess),
+          priceLevelsCache(pDbAccess),
           operator_detail_cache(pDbAccess),
           operator_owner_map_cache(pDbAccess),
           operator_trade_pair_cache(pDbAccess),
@@ -107,6 +216,8 @@ public:
     bool CreateActiveOrder(const uint256 &orderTxId, const dex::CDEXOrderDetail& activeOrder);
     bool UpdateActiveOrder(const uint256 &orderTxId, const dex::CDEXOrderDetail& activeOrder);
     bool EraseActiveOrder(const uint256 &orderTxId, const dex::CDEXOrderDetail &activeOrder);
+    // build the order book index of the active orders persisted before the index, only for the top level cache
+    bool BuildOrderBook(uint32_t &orderCount);
 
     bool IncDexID(DexID &id);
     bool GetDexOperator(const DexID &id, DexOperatorDetail& detail);
@@ -126,6 +237,8 @@ public:
     bool Flush() {
         activeOrderCache.Flush();
         blockOrdersCache.Flush();
+        orderBookCache.Flush();
+        priceLevelsCache.Flush();
         operator_detail_cache.Flush(),
         operator_owner_map_cache.Flush();
         operator_last_id_cache.Flush();
@@ -137,6 +250,8 @@ public:
     uint32_t GetCacheSize() const {
         return activeOrderCache.GetCacheSize() +
             blockOrdersCache.GetCacheSize() +
+            orderBookCache.GetCacheSize() +
+            priceLevelsCache.GetCacheSize() +
             operator_detail_cache.GetCacheSize() +
             operator_owner_map_cache.GetCacheSize() +
             operator_last_id_cache.GetCacheSize() +
@@ -146,6 +261,8 @@ public:
     void SetBaseViewPtr(CDexDBCache *pBaseIn) {
         activeOrderCache.SetBase(&pBaseIn->activeOrderCache);
         blockOrdersCache.SetBase(&pBaseIn->blockOrdersCache);
+        orderBookCache.SetBase(&pBaseIn->orderBookCache);
+        priceLevelsCache.SetBase(&pBaseIn->priceLevelsCache);
         operator_detail_cache.SetBase(&pBaseIn->operator_detail_cache);
         operator_owner_map_cache.SetBase(&pBaseIn->operator_owner_map_cache);
         operator_last_id_cache.SetBase(&pBaseIn->operator_last_id_cache);
@@ -156,6 +273,8 @@ public:
     void SetDbOpLogMap(CDBOpLogMap *pDbOpLogMapIn) {
         activeOrderCache.SetDbOpLogMap(pDbOpLogMapIn);
         blockOrdersCache.SetDbOpLogMap(pDbOpLogMapIn);
+        orderBookCache.SetDbOpLogMap(pDbOpLogMapIn);
+        priceLevelsCache.SetDbOpLogMap(pDbOpLogMapIn);
         operator_detail_cache.SetDbOpLogMap(pDbOpLogMapIn);
         operator_owner_map_cache.SetDbOpLogMap(pDbOpLogMapIn);
         operator_last_id_cache.SetDbOpLogMap(pDbOpLogMapIn);
@@ -163,9 +282,23 @@ public:
         dex_quote_coin_cache.SetDbOpLogMap(pDbOpLogMapIn);
     }
 
+    void SetDbAccessLog(CDbAccessLog *pDbAccessLogIn) {
+        activeOrderCache.SetDbAccessLog(pDbAccessLogIn);
+        blockOrdersCache.SetDbAccessLog(pDbAccessLogIn);
+        orderBookCache.SetDbAccessLog(pDbAccessLogIn);
+        priceLevelsCache.SetDbAccessLog(pDbAccessLogIn);
+        operator_detail_cache.SetDbAccessLog(pDbAccessLogIn);
+        operator_owner_map_cache.SetDbAccessLog(pDbAccessLogIn);
+        operator_last_id_cache.SetDbAccessLog(pDbAccessLogIn);
+        operator_trade_pair_cache.SetDbAccessLog(pDbAccessLogIn);
+        dex_quote_coin_cache.SetDbAccessLog(pDbAccessLogIn);
+    }
+
     void RegisterUndoFunc(UndoDataFuncMap &undoDataFuncMap) {
         activeOrderCache.RegisterUndoFunc(undoDataFuncMap);
         blockOrdersCache.RegisterUndoFunc(undoDataFuncMap);
+        orderBookCache.RegisterUndoFunc(undoDataFuncMap);
+        priceLevelsCache.RegisterUndoFunc(undoDataFuncMap);
         operator_detail_cache.RegisterUndoFunc(undoDataFuncMap);
         operator_owner_map_cache.RegisterUndoFunc(undoDataFuncMap);
         operator_last_id_cache.RegisterUndoFunc(undoDataFuncMap);
@@ -183,11 +316,18 @@ public:
         return make_shared<CDEXSysOrdersGetter>(blockOrdersCache);
     }
 
+    shared_ptr<CDEXOrderBookGetter> CreateOrderBookGetter() {
+        return make_shared<CDEXOrderBookGetter>(orderBookCache, priceLevelsCache);
+    }
+
 
 private:
     DEXBlockOrdersCache::KeyType MakeBlockOrderKey(const uint256 &orderid, const dex::CDEXOrderDetail &activeOrder) {
         return make_tuple(CFixedUInt32(activeOrder.tx_cord.GetHeight()), (uint8_t)activeOrder.generate_type, orderid);
     }
+    DEXOrderBookCache::KeyType MakeOrderBookKey(const uint256 &orderid, const dex::CDEXOrderDetail &activeOrder);
+    // remove the old order from its price level and add the new one, the limit orders of the same price
+    bool UpdatePriceLevel(const dex::CDEXOrderDetail *pOldOrder, const dex::CDEXOrderDetail *pNewOrder);
 public:
 /*       type               prefixType                      key                        value                variable             */
 /*  ----------------   -----------------------------  ---------------------------  ------------------   ------------------------ */
@@ -195,6 +335,8 @@ public:
     // order tx id -> active order
     CCompositeKVCache< dbk::DEX_ACTIVE_ORDER,          uint256,                     dex::CDEXOrderDetail >     activeOrderCache;
     DEXBlockOrdersCache    blockOrdersCache;
+    DEXOrderBookCache      orderBookCache;
+    DEXPriceLevelsCache    priceLevelsCache;
     CCompositeKVCache< dbk::DEX_OPERATOR_DETAIL,       std::optional<CVarIntValue<DexID>> , DexOperatorDetail >   operator_detail_cache;
     CCompositeKVCache< dbk::DEX_OPERATOR_OWNER_MAP,    CRegIDKey,               std::optional<CVarIntValue<DexID>>> operator_owner_map_cache;
     CCompositeKVCache< dbk::DEX_OPERATOR_TRADE_PAIR,   std::optional<CVarIntValue<DexID>>, vector<CAssetTradingPair>> operator_trade_pair_cache ;
@@ -40,6 +40,42 @@ std::string CDBOpLogMap::ToString() const {
     return str;
 }
 
+void CDbAccessLog::GetWriteKeys(set<string> &keys, set<dbk::PrefixType> &prefixes) const {
+    for (const auto &itemOpLogs : writeLogs.GetMap()) {
+        prefixes.insert(dbk::ParseKeyPrefixType(itemOpLogs.first));
+        for (const auto &dbOpLog : itemOpLogs.second)
+            keys.insert(itemOpLogs.first + dbOpLog.GetKey());
+    }
+}
+
+bool CDbAccessLog::HasReadAny(const set<string> &keys, const set<dbk::PrefixType> &prefixes) const {
+    for (auto prefixType : readPrefixes) {
+        if (prefixes.count(prefixType))
+            return true;
+    }
+    for (const auto &key : readKeys) {
+        if (keys.count(key))
+            return true;
+    }
+    return false;
+}
+
+uint64_t CDbAccessLog::GetMemoryUsage() const {
+    // the node of set or map is estimated by three pointers
+    static const uint64_t NODE_USAGE = 3 * sizeof(void *);
+
+    uint64_t usage = sizeof(CDbAccessLog);
+    for (const auto &key : readKeys)
+        usage += NODE_USAGE + sizeof(string) + key.size();
+    usage += readPrefixes.size() * (NODE_USAGE + sizeof(dbk::PrefixType));
+    for (const auto &itemOpLogs : writeLogs.GetMap()) {
+        usage += NODE_USAGE + sizeof(string) + itemOpLogs.first.size() + sizeof(CDbOpLogs);
+        for (const auto &dbOpLog : itemOpLogs.second)
+            usage += sizeof(CDbOpLog) + dbOpLog.GetKey().size() + dbOpLog.GetValue().size();
+    }
+    return usage;
+}
+
 static leveldb::Options GetOptions(size_t nCacheSize) {
     leveldb::Options options;
     options.block_cache       = leveldb::NewLRUCache(nCacheSize / 2);
@@ -117,3 +153,16 @@ int64_t CLevelDBWrapper::GetDbCount() {
 
     return ret;
 }
+
+bool CLevelDBWrapper::IsEmpty() {
+    std::unique_ptr<leveldb::Iterator> pCursor(NewIterator());
+    pCursor->SeekToFirst();
+    return !pCursor->Valid();
+}
+
+uint64_t CLevelDBWrapper::GetApproximateSize(const std::string &beginKey, const std::string &endKey) {
+    leveldb::Range range(beginKey, endKey);
+    uint64_t size = 0;
+    pdb->GetApproximateSizes(&range, 1, &size);
+    return size;
+}
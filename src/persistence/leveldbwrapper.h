@@ -16,6 +16,9 @@
 #include <leveldb/db.h>
 #include <leveldb/write_batch.h>
 
+#include <memory>
+#include <mutex>
+
 using namespace json_spirit;
 
 class CDbOpLog {
@@ -87,6 +90,7 @@ typedef vector<CDbOpLog> CDbOpLogs;
 class CDBOpLogMap {
 public:
     map<string, CDbOpLogs>& GetMap() { return mapDbOpLogs; }
+    const map<string, CDbOpLogs>& GetMap() const { return mapDbOpLogs; }
 
     const CDbOpLogs* GetDbOpLogsPtr(dbk::PrefixType prefixType) const {
         assert(prefixType != dbk::EMPTY);
@@ -115,6 +119,80 @@ private:
     mutable map<string, CDbOpLogs> mapDbOpLogs; // dbName -> dbOpLogs
 };
 
+/**
+ * Access log of the cache level which it is set to, the keys are full db keys (prefix + serialized key).
+ * The lookups of the cache level are logged as reads, iterating or listing the elements is logged as a
+ * read of the whole prefix. The changed key-values are logged as writes with the new values when the
+ * cache level is flushed to its base, so the writes can be replayed by the undo funcs.
+ * When the cache levels over the same base are executed in parallel, the base mutexes serialize the lookups
+ * of the lower levels, which fill their caches on read. A lookup only goes down the caches of its own prefix
+ * type, so the mutexes are sharded by prefix type.
+ */
+class CDbAccessLog {
+public:
+    // for key-value
+    template<typename K>
+    void AddRead(dbk::PrefixType prefixType, const K &key) {
+        readKeys.insert(dbk::GenDbKey(prefixType, key));
+    }
+
+    // for single value
+    void AddRead(dbk::PrefixType prefixType) {
+        readKeys.insert(dbk::GetKeyPrefix(prefixType));
+    }
+
+    void AddPrefixRead(dbk::PrefixType prefixType) {
+        readPrefixes.insert(prefixType);
+    }
+
+    // for key-value
+    template<typename K, typename V>
+    void AddWrite(dbk::PrefixType prefixType, const K &key, const V &value) {
+        CDbOpLog dbOpLog;
+        dbOpLog.Set(key, value);
+        writeLogs.AddOpLog(prefixType, dbOpLog);
+    }
+
+    // for single value
+    template<typename V>
+    void AddWrite(dbk::PrefixType prefixType, const V &value) {
+        CDbOpLog dbOpLog;
+        dbOpLog.Set(value);
+        writeLogs.AddOpLog(prefixType, dbOpLog);
+    }
+
+    // add the written keys to keys, and the prefix types of them to prefixes
+    void GetWriteKeys(set<string> &keys, set<dbk::PrefixType> &prefixes) const;
+
+    // whether any of the keys, or any key with one of the prefixes, has been read
+    bool HasReadAny(const set<string> &keys, const set<dbk::PrefixType> &prefixes) const;
+
+    const CDBOpLogMap& GetWriteLogs() const { return writeLogs; }
+
+    // the estimated memory of the logged keys and values
+    uint64_t GetMemoryUsage() const;
+
+    // the mutexes are indexed by the prefix type, the count is dbk::PREFIX_COUNT
+    void SetBaseMutexes(std::mutex *pBaseMutexesIn) { pBaseMutexes = pBaseMutexesIn; }
+
+    std::unique_lock<std::mutex> LockBase(dbk::PrefixType prefixType) const {
+        return pBaseMutexes != nullptr ? std::unique_lock<std::mutex>(pBaseMutexes[prefixType])
+                                       : std::unique_lock<std::mutex>();
+    }
+
+    void Clear() {
+        readKeys.clear();
+        readPrefixes.clear();
+        writeLogs.Clear();
+    }
+
+private:
+    set<string> readKeys;
+    set<dbk::PrefixType> readPrefixes;
+    CDBOpLogMap writeLogs;
+    std::mutex *pBaseMutexes = nullptr;
+};
+
 class leveldb_error : public runtime_error
 {
 public:
@@ -145,6 +223,14 @@ public:
         batch.Delete(key);
     }
 
+    // write the serialized key and value directly
+    void WriteRaw(const leveldb::Slice &key, const leveldb::Slice &value) {
+        batch.Put(key, value);
+    }
+
+    void Clear() {
+        batch.Clear();
+    }
  };
 
 class CLevelDBWrapper {
@@ -170,16 +256,24 @@ private:
     // the database itself
     leveldb::DB *pdb;
 
+    static leveldb::ReadOptions GetReadOptions(const leveldb::ReadOptions &options,
+                                               const leveldb::Snapshot *pSnapshot) {
+        leveldb::ReadOptions ret = options;
+        ret.snapshot = pSnapshot;
+        return ret;
+    }
+
 public:
     CLevelDBWrapper(const boost::filesystem::path &path, size_t nCacheSize, bool fMemory = false, bool fWipe = false);
     ~CLevelDBWrapper();
 
+    // pSnapshot: read the state of the snapshot, nullptr reads the current state
     template<typename V>
-    bool Read(std::string key, V &value) {
+    bool Read(std::string key, V &value, const leveldb::Snapshot *pSnapshot = nullptr) {
     	leveldb::Slice slKey(key);
 
         string strValue;
-        leveldb::Status status = pdb->Get(readoptions, slKey, &strValue);
+        leveldb::Status status = pdb->Get(GetReadOptions(readoptions, pSnapshot), slKey, &strValue);
         if (!status.ok()) {
             if (status.IsNotFound())
                 return false;
@@ -202,10 +296,10 @@ public:
         return WriteBatch(batch, fSync);
     }
 
-    bool Exists(const std::string &key) {
+    bool Exists(const std::string &key, const leveldb::Snapshot *pSnapshot = nullptr) {
     	leveldb::Slice slKey(key);
         string strValue;
-        leveldb::Status status = pdb->Get(readoptions, slKey, &strValue);
+        leveldb::Status status = pdb->Get(GetReadOptions(readoptions, pSnapshot), slKey, &strValue);
         if (!status.ok()) {
             if (status.IsNotFound())
                 return false;
@@ -234,10 +328,24 @@ public:
     }
 
     // not exactly clean encapsulation, but it's easiest for now
-    leveldb::Iterator *NewIterator() {
-        return pdb->NewIterator(iteroptions);
+    leveldb::Iterator *NewIterator(const leveldb::Snapshot *pSnapshot = nullptr) {
+        return pdb->NewIterator(GetReadOptions(iteroptions, pSnapshot));
+    }
+
+    /**
+     * The consistent read-only view of the db at this moment, the later writes are not visible by the reads
+     * with the snapshot. It is released with the last reference, which must not outlive the db.
+     */
+    std::shared_ptr<const leveldb::Snapshot> NewSnapshot() {
+        leveldb::DB *pDbIn = pdb;
+        return std::shared_ptr<const leveldb::Snapshot>(pdb->GetSnapshot(),
+            [pDbIn](const leveldb::Snapshot *pSnapshot) { pDbIn->ReleaseSnapshot(pSnapshot); });
     }
+
     int64_t GetDbCount();
+    bool IsEmpty();
+    // approximate file system space used by keys in [beginKey, endKey)
+    uint64_t GetApproximateSize(const std::string &beginKey, const std::string &endKey);
    // Object ToJsonObj();
 };
 
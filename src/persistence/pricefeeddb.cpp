@@ -25,6 +25,182 @@ bool CConsecutiveBlockPrice::ExistBlockUserPrice(const int32_t blockHeight, cons
     return mapBlockUserPrices[blockHeight].count(regId);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// CMedianPriceSet
+
+void CMedianPriceSet::Insert(const uint64_t price) {
+    if (lower.empty() || price <= *lower.rbegin())
+        lower.insert(price);
+    else
+        upper.insert(price);
+
+    Rebalance();
+}
+
+bool CMedianPriceSet::Erase(const uint64_t price) {
+    auto it = lower.find(price);
+    if (it != lower.end()) {
+        lower.erase(it);
+    } else {
+        it = upper.find(price);
+        if (it == upper.end())
+            return false;
+        upper.erase(it);
+    }
+
+    Rebalance();
+    return true;
+}
+
+uint64_t CMedianPriceSet::GetMedian() const {
+    if (lower.empty())
+        return 0;
+
+    return (lower.size() > upper.size()) ? *lower.rbegin() : (*lower.rbegin() + *upper.begin()) / 2;
+}
+
+void CMedianPriceSet::Rebalance() {
+    if (lower.size() > upper.size() + 1) {
+        auto it = std::prev(lower.end());
+        upper.insert(*it);
+        lower.erase(it);
+    } else if (upper.size() > lower.size()) {
+        auto it = upper.begin();
+        lower.insert(*it);
+        upper.erase(it);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// CBlockPriceWindow
+
+bool CBlockPriceWindow::ExistUserPrice(const int32_t blockHeight, const CRegID &regId) const {
+    const CBlockSlot &slot = slots[blockHeight % slots.size()];
+    return slot.height == blockHeight && slot.userPrices.count(regId);
+}
+
+bool CBlockPriceWindow::AddUserPrice(const int32_t blockHeight, const CRegID &regId, const uint64_t price) {
+    if (blockHeight > top_height)
+        SetTopHeight(blockHeight);
+
+    CBlockSlot &slot = GetSlot(blockHeight);
+    if (!slot.userPrices.empty() && slot.height != blockHeight) {
+        LogPrint(BCLog::PRICEFEED, "CBlockPriceWindow::AddUserPrice, drop the block user prices of height: %d "
+                 "for height: %d\n", slot.height, blockHeight);
+        evicted_height = std::max(evicted_height, slot.height);
+        ClearSlot(slot);
+    }
+
+    slot.height = blockHeight;
+    if (!slot.userPrices.emplace(regId, price).second)
+        return false;
+
+    if (IsInMedianSet(blockHeight, top_height))
+        prices.Insert(price);
+
+    return true;
+}
+
+void CBlockPriceWindow::DeleteBlock(const int32_t blockHeight) {
+    CBlockSlot &slot = GetSlot(blockHeight);
+    if (slot.height != blockHeight || slot.userPrices.empty())
+        return;
+
+    ClearSlot(slot);
+    if (blockHeight == top_height) {
+        // the disconnected top block, the previous blocks slide back into the median set
+        int32_t topHeight = 0;
+        for (const auto &item : slots) {
+            if (!item.userPrices.empty())
+                topHeight = std::max(topHeight, item.height);
+        }
+        SetTopHeight(topHeight);
+    }
+}
+
+void CBlockPriceWindow::SetTopHeight(const int32_t topHeight) {
+    for (const auto &slot : slots) {
+        if (slot.userPrices.empty())
+            continue;
+
+        bool inMedianSet = IsInMedianSet(slot.height, top_height);
+        if (inMedianSet == IsInMedianSet(slot.height, topHeight))
+            continue;
+
+        for (const auto &item : slot.userPrices) {
+            if (inMedianSet)
+                prices.Erase(item.second);
+            else
+                prices.Insert(item.second);
+        }
+    }
+    top_height = topHeight;
+}
+
+void CBlockPriceWindow::ClearSlot(CBlockSlot &slot) {
+    if (IsInMedianSet(slot.height, top_height)) {
+        for (const auto &item : slot.userPrices)
+            prices.Erase(item.second);
+    }
+
+    slot.userPrices.clear();
+}
+
+uint64_t CBlockPriceWindow::ComputeMedianPrice(const int32_t beginHeight, const int32_t endHeight,
+                                               const BlockUserPriceMap &changedBlocks) {
+    // the median set has the latest blocks, the blocks of the other range and the changed blocks are replaced in the
+    // median set temporarily, it costs O(log n) for each replaced price
+    vector<uint64_t> removedPrices;
+    vector<uint64_t> addedPrices;
+    for (const auto &slot : slots) {
+        if (slot.userPrices.empty())
+            continue;
+
+        bool inRange = slot.height > beginHeight && slot.height <= endHeight && !changedBlocks.count(slot.height);
+        if (inRange == IsInMedianSet(slot.height, top_height))
+            continue;
+
+        for (const auto &item : slot.userPrices)
+            (inRange ? addedPrices : removedPrices).push_back(item.second);
+    }
+
+    for (auto it = changedBlocks.upper_bound(beginHeight); it != changedBlocks.end() && it->first <= endHeight; it++) {
+        for (const auto &item : it->second)
+            addedPrices.push_back(item.second);
+    }
+
+    for (const auto price : removedPrices)
+        prices.Erase(price);
+    for (const auto price : addedPrices)
+        prices.Insert(price);
+
+    uint64_t medianPrice = prices.GetMedian();
+
+    for (const auto price : addedPrices)
+        prices.Erase(price);
+    for (const auto price : removedPrices)
+        prices.Insert(price);
+
+    return medianPrice;
+}
+
+void CBlockPriceWindow::GetBlockUserPrices(BlockUserPriceMap &blockUserPrices) const {
+    for (const auto &slot : slots) {
+        if (!slot.userPrices.empty())
+            blockUserPrices[slot.height] = slot.userPrices;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// CPricePointSnapshot
+
+string CPricePointSnapshot::ToString() const {
+    return strprintf("block_hash=%s, price_points=%s", block_hash.GetHex(), db_util::ToString(price_points));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// CPricePointMemCache
+
 bool CPricePointMemCache::AddPrice(const int32_t blockHeight, const CRegID &regId,
                                                     const vector<CPricePoint> &pps) {
     for (CPricePoint pp : pps) {
@@ -36,8 +212,12 @@ bool CPricePointMemCache::AddPrice(const int32_t blockHeight, const CRegID &regI
             return false;
         }
 
-        CConsecutiveBlockPrice &cbp = mapCoinPricePointCache[pp.GetCoinPricePair()];
-        cbp.AddUserPrice(blockHeight, regId, pp.GetPrice());
+        if (pBase == nullptr) {
+            priceWindows[pp.GetCoinPricePair()].AddUserPrice(blockHeight, regId, pp.GetPrice());
+        } else {
+            CConsecutiveBlockPrice &cbp = mapCoinPricePointCache[pp.GetCoinPricePair()];
+            cbp.AddUserPrice(blockHeight, regId, pp.GetPrice());
+        }
         LogPrint(BCLog::PRICEFEED,
                  "CPricePointMemCache::AddPrice, add block user price, "
                  "height: %d, redId: %s, pricePoint: %s\n",
@@ -49,14 +229,16 @@ bool CPricePointMemCache::AddPrice(const int32_t blockHeight, const CRegID &regI
 
 bool CPricePointMemCache::ExistBlockUserPrice(const int32_t blockHeight, const CRegID &regId,
                                               const CoinPricePair &coinPricePair) {
+    if (pBase == nullptr) {
+        auto it = priceWindows.find(coinPricePair);
+        return it != priceWindows.end() && it->second.ExistUserPrice(blockHeight, regId);
+    }
+
     if (mapCoinPricePointCache.count(coinPricePair) &&
         mapCoinPricePointCache[coinPricePair].ExistBlockUserPrice(blockHeight, regId))
         return true;
 
-    if (pBase)
-        return pBase->ExistBlockUserPrice(blockHeight, regId, coinPricePair);
-    else
-        return false;
+    return pBase->ExistBlockUserPrice(blockHeight, regId, coinPricePair);
 }
 
 bool CPricePointMemCache::AddPriceByBlock(const CBlock &block) {
@@ -82,7 +264,11 @@ bool CPricePointMemCache::AddPriceByBlock(const CBlock &block) {
 }
 
 bool CPricePointMemCache::DeleteBlockPricePoint(const int32_t blockHeight) {
-    if (mapCoinPricePointCache.empty()) {
+    if (pBase == nullptr) {
+        for (auto &item : priceWindows) {
+            item.second.DeleteBlock(blockHeight);
+        }
+    } else if (mapCoinPricePointCache.empty()) {
         // TODO: multi stable coin
         mapCoinPricePointCache[CoinPricePair(SYMB::GVC, SYMB::USD)].DeleteUserPrice(blockHeight);
         mapCoinPricePointCache[CoinPricePair(SYMB::WGRT, SYMB::USD)].DeleteUserPrice(blockHeight);
@@ -101,6 +287,20 @@ void CPricePointMemCache::BatchWrite(const CoinPricePointMap &mapCoinPricePointC
     for (const auto &item : mapCoinPricePointCacheIn) {
         // map<int32_t /* block height */, map<CRegID, uint64_t /* price */>>
         const auto &mapBlockUserPrices = item.second.mapBlockUserPrices;
+        if (pBase == nullptr) {
+            CBlockPriceWindow &window = priceWindows[item.first /* CoinPricePair */];
+            for (const auto &userPrice : mapBlockUserPrices) {
+                if (userPrice.second.empty()) {
+                    window.DeleteBlock(userPrice.first /* height */);
+                } else {
+                    for (const auto &priceItem : userPrice.second)
+                        window.AddUserPrice(userPrice.first /* height */, priceItem.first /* CRegID */,
+                                            priceItem.second /* price */);
+                }
+            }
+            continue;
+        }
+
         for (const auto &userPrice : mapBlockUserPrices) {
             if (userPrice.second.empty()) {
                 mapCoinPricePointCache[item.first /* CoinPricePair */].mapBlockUserPrices.erase(userPrice.first /* height */);
@@ -127,81 +327,69 @@ void CPricePointMemCache::Flush() {
     mapCoinPricePointCache.clear();
 }
 
-bool CPricePointMemCache::GetBlockUserPrices(const CoinPricePair &coinPricePair, set<int32_t> &expired,
-                                             BlockUserPriceMap &blockUserPrices) {
-    const auto &iter = mapCoinPricePointCache.find(coinPricePair);
-    if (iter != mapCoinPricePointCache.end()) {
-        const auto &mapBlockUserPrices = iter->second.mapBlockUserPrices;
-        for (const auto &item : mapBlockUserPrices) {
-            if (item.second.empty()) {
-                expired.insert(item.first);
-            } else if (expired.count(item.first) || blockUserPrices.count(item.first)) {
-                // TODO: log
-                continue;
-            } else {
-                // Got a valid item.
-                blockUserPrices[item.first] = item.second;
-            }
-        }
-    }
+void CPricePointMemCache::GetSnapshot(CPricePointSnapshot &snapshot) const {
+    assert(pBase == nullptr);
 
-    if (pBase != nullptr) {
-        return pBase->GetBlockUserPrices(coinPricePair, expired, blockUserPrices);
+    snapshot.price_points.clear();
+    for (const auto &item : priceWindows) {
+        BlockUserPriceMap blockUserPrices;
+        item.second.GetBlockUserPrices(blockUserPrices);
+        if (!blockUserPrices.empty())
+            snapshot.price_points[item.first] = std::move(blockUserPrices);
     }
-
-    return true;
 }
 
-bool CPricePointMemCache::GetBlockUserPrices(const CoinPricePair &coinPricePair, BlockUserPriceMap &blockUserPrices) {
-    set<int32_t /* block height */> expired;
-    if (!GetBlockUserPrices(coinPricePair, expired, blockUserPrices)) {
-        // TODO: log
-        return false;
-    }
+void CPricePointMemCache::RestoreSnapshot(const CPricePointSnapshot &snapshot) {
+    assert(pBase == nullptr);
 
-    return true;
+    priceWindows.clear();
+    for (const auto &item : snapshot.price_points) {
+        CBlockPriceWindow &window = priceWindows[item.first];
+        for (const auto &userPrice : item.second) {
+            for (const auto &priceItem : userPrice.second)
+                window.AddUserPrice(userPrice.first, priceItem.first, priceItem.second);
+        }
+    }
+    is_loaded = true;
 }
 
-uint64_t CPricePointMemCache::ComputeBlockMedianPrice(const int32_t blockHeight, const uint64_t slideWindow,
-                                                      const CoinPricePair &coinPricePair) {
-    // 1. merge block user prices with base cache.
-    BlockUserPriceMap blockUserPrices;
-    if (!GetBlockUserPrices(coinPricePair, blockUserPrices) || blockUserPrices.empty()) {
-        return 0;
+CPricePointMemCache* CPricePointMemCache::GetChangedBlockUserPrices(const CoinPricePair &coinPricePair,
+                                                                    BlockUserPriceMap &changedBlocks) {
+    if (pBase == nullptr)
+        return this;
+
+    const auto &iter = mapCoinPricePointCache.find(coinPricePair);
+    if (iter != mapCoinPricePointCache.end()) {
+        // the block of the upper cache replaces the one of the lower caches, the empty one is deleted
+        for (const auto &item : iter->second.mapBlockUserPrices)
+            changedBlocks.emplace(item.first, item.second);
     }
 
-    // 2. compute block median price.
-    return ComputeBlockMedianPrice(blockHeight, slideWindow, blockUserPrices);
+    return pBase->GetChangedBlockUserPrices(coinPricePair, changedBlocks);
 }
 
 uint64_t CPricePointMemCache::ComputeBlockMedianPrice(const int32_t blockHeight, const uint64_t slideWindow,
-                                                      const BlockUserPriceMap &blockUserPrices) {
-    // for (const auto &item : blockUserPrices) {
-    //     string price;
-    //     for (const auto &userPrice : item.second) {
-    //         price += strprintf("{user:%s, price:%lld}", userPrice.first.ToString(), userPrice.second);
-    //     }
-
-    //     LogPrint(BCLog::PRICEFEED, "CPricePointMemCache::ComputeBlockMedianPrice, height: %d, userPrice: %s\n",
-    //              item.first, price);
-    // }
-
-    vector<uint64_t> prices;
+                                                      const CoinPricePair &coinPricePair) {
+    BlockUserPriceMap changedBlocks;
+    CPricePointMemCache *pBaseCache = GetChangedBlockUserPrices(coinPricePair, changedBlocks);
+
     int32_t beginBlockHeight = std::max<int32_t>((blockHeight - slideWindow), 0);
-    for (int32_t height = blockHeight; height > beginBlockHeight; --height) {
-        const auto &iter = blockUserPrices.find(height);
-        if (iter != blockUserPrices.end()) {
-            for (const auto &userPrice : iter->second) {
-                prices.push_back(userPrice.second);
-            }
+    uint64_t medianPrice     = 0;
+    auto it = pBaseCache->priceWindows.find(coinPricePair);
+    if (it != pBaseCache->priceWindows.end()) {
+        // the median price misses the user prices dropped by the ring buffer, e.g. after a deep disconnect
+        if (it->second.GetEvictedHeight() > beginBlockHeight) {
+            LogPrint(BCLog::ERROR, "CPricePointMemCache::ComputeBlockMedianPrice, the user prices of height: %d "
+                     "are evicted, the median price of blocks (%d, %d] is incomplete! price: %s/%s\n",
+                     it->second.GetEvictedHeight(), beginBlockHeight, blockHeight, std::get<0>(coinPricePair),
+                     std::get<1>(coinPricePair));
         }
+        medianPrice = it->second.ComputeMedianPrice(beginBlockHeight, blockHeight, changedBlocks);
+    } else if (!changedBlocks.empty()) {
+        CBlockPriceWindow emptyWindow;
+        medianPrice = emptyWindow.ComputeMedianPrice(beginBlockHeight, blockHeight, changedBlocks);
     }
 
-    // for (const auto &item : prices) {
-    //     LogPrint(BCLog::PRICEFEED, "CPricePointMemCache::ComputeBlockMedianPrice, found a candidate price: %llu\n", item);
-    // }
-
-    uint64_t medianPrice = ComputeMedianNumber(prices);
     LogPrint(BCLog::PRICEFEED,
              "CPricePointMemCache::ComputeBlockMedianPrice, blockHeight: %d, computed median number: %llu\n",
              blockHeight, medianPrice);
@@ -209,15 +397,6 @@ uint64_t CPricePointMemCache::ComputeBlockMedianPrice(const int32_t blockHeight,
     return medianPrice;
 }
 
-uint64_t CPricePointMemCache::ComputeMedianNumber(vector<uint64_t> &numbers) {
-    int32_t size = numbers.size();
-    if (size < 2) {
-        return size == 0 ? 0 : numbers[0];
-    }
-    sort(numbers.begin(), numbers.end());
-    return (size % 2 == 0) ? (numbers[size / 2 - 1] + numbers[size / 2]) / 2 : numbers[size / 2];
-}
-
 uint64_t CPricePointMemCache::GetMedianPrice(const int32_t blockHeight, const uint64_t slideWindow,
                                              const CoinPricePair &coinPricePair) {
     uint64_t medianPrice = ComputeBlockMedianPrice(blockHeight, slideWindow, coinPricePair);
@@ -242,6 +421,13 @@ bool CPricePointMemCache::CalcBlockMedianPrices(CCacheWrapper &cw, const int32_t
     if (!cw.sysParamCache.GetParam(SysParamType::MEDIAN_PRICE_SLIDE_WINDOW_BLOCKCOUNT, slideWindow)) {
         return ERRORMSG("%s, read sys param MEDIAN_PRICE_SLIDE_WINDOW_BLOCKCOUNT error", __func__);
     }
+    // only the latest PRICE_POINT_CACHE_BLOCK_COUNT blocks are kept, e.g. restored at startup
+    if (slideWindow > (uint64_t)PRICE_POINT_CACHE_BLOCK_COUNT) {
+        LogPrint(BCLog::ERROR, "%s, sys param MEDIAN_PRICE_SLIDE_WINDOW_BLOCKCOUNT: %llu exceeds the cached blocks: "
+                 "%d, the median price of the blocks (%d, %d] is computed\n", __func__, slideWindow,
+                 PRICE_POINT_CACHE_BLOCK_COUNT, blockHeight - PRICE_POINT_CACHE_BLOCK_COUNT, blockHeight);
+        slideWindow = PRICE_POINT_CACHE_BLOCK_COUNT;
+    }
 
     latest_median_prices = cw.priceFeedCache.GetMedianPrices();
 
@@ -8,6 +8,7 @@
 
 #include "block.h"
 #include "commons/serialize.h"
+#include "config/sysparams.h"
 #include "entities/account.h"
 #include "entities/asset.h"
 #include "entities/id.h"
@@ -16,6 +17,7 @@
 #include "persistence/dbaccess.h"
 
 #include <map>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -26,6 +28,11 @@ class CConsecutiveBlockPrice;
 typedef map<int32_t /* block height */, map<CRegID, uint64_t /* price */>> BlockUserPriceMap;
 typedef map<CoinPricePair, CConsecutiveBlockPrice> CoinPricePointMap;
 
+// the latest blocks of the price points kept in the memory cache, the max median price slide window
+static const int32_t PRICE_POINT_CACHE_BLOCK_COUNT = MEDIAN_PRICE_SLIDE_WINDOW_BLOCKCOUNT_MAX;
+// the block slots of the ring buffer, more than the cached blocks for the block re-added by the disconnect
+static const int32_t PRICE_POINT_WINDOW_SLOT_COUNT = PRICE_POINT_CACHE_BLOCK_COUNT * 2;
+
 // Price Points in 11 consecutive blocks
 class CConsecutiveBlockPrice {
 public:
@@ -38,6 +45,85 @@ public:
     BlockUserPriceMap mapBlockUserPrices;
 };
 
+// The order statistics of the prices by two sorted halves, the lower half has one more price if the count is odd.
+// Insert and erase are O(log n), the median is O(1).
+class CMedianPriceSet {
+public:
+    void Insert(const uint64_t price);
+    bool Erase(const uint64_t price);
+    // the middle one, or the average of the two middle ones, 0 if empty
+    uint64_t GetMedian() const;
+    size_t Size() const { return lower.size() + upper.size(); }
+
+private:
+    void Rebalance();
+
+private:
+    multiset<uint64_t> lower;
+    multiset<uint64_t> upper;
+};
+
+// The user prices of the latest blocks of one coin price pair: a fixed size ring buffer of the block slots by the
+// height, and the median set of the prices of the latest PRICE_POINT_CACHE_BLOCK_COUNT blocks in the slots, which
+// slides with the top block.
+class CBlockPriceWindow {
+public:
+    CBlockPriceWindow(): slots(PRICE_POINT_WINDOW_SLOT_COUNT) {}
+
+    bool ExistUserPrice(const int32_t blockHeight, const CRegID &regId) const;
+    // false if the user price of the block exists
+    bool AddUserPrice(const int32_t blockHeight, const CRegID &regId, const uint64_t price);
+    void DeleteBlock(const int32_t blockHeight);
+
+    // the median price of the blocks in (beginHeight, endHeight], the blocks changed by the upper caches replace
+    // the ones of the window, the empty ones are deleted
+    uint64_t ComputeMedianPrice(const int32_t beginHeight, const int32_t endHeight,
+                                const BlockUserPriceMap &changedBlocks);
+
+    void GetBlockUserPrices(BlockUserPriceMap &blockUserPrices) const;
+    // the highest block of which the user prices are dropped from the ring buffer for a higher block
+    int32_t GetEvictedHeight() const { return evicted_height; }
+
+private:
+    struct CBlockSlot {
+        int32_t height = 0;
+        map<CRegID, uint64_t> userPrices;   // the slot is free if it is empty
+    };
+
+    CBlockSlot& GetSlot(const int32_t blockHeight) { return slots[blockHeight % slots.size()]; }
+    static bool IsInMedianSet(const int32_t blockHeight, const int32_t topHeight) {
+        return blockHeight > topHeight - PRICE_POINT_CACHE_BLOCK_COUNT && blockHeight <= topHeight;
+    }
+    // slide the median set to the new top block
+    void SetTopHeight(const int32_t topHeight);
+    void ClearSlot(CBlockSlot &slot);
+
+private:
+    vector<CBlockSlot> slots;
+    CMedianPriceSet prices;
+    int32_t top_height = 0;
+    int32_t evicted_height = 0;
+};
+
+// The price points of the latest blocks, saved with the db flush to restore the memory cache at startup.
+class CPricePointSnapshot {
+public:
+    uint256 block_hash;     // the best block of the price points
+    map<CoinPricePair, BlockUserPriceMap> price_points;
+
+    IMPLEMENT_SERIALIZE(
+        READWRITE(block_hash);
+        READWRITE(price_points);
+    )
+
+    bool IsEmpty() const { return block_hash.IsNull(); }
+    void SetEmpty() {
+        block_hash.SetNull();
+        price_points.clear();
+    }
+    string ToString() const;
+};
+
 class CPricePointMemCache {
 public:
     CPricePointMemCache() : pBase(nullptr) {}
@@ -52,6 +138,12 @@ public:
 
     bool CalcBlockMedianPrices(CCacheWrapper &cw, const int32_t blockHeight, PriceMap &medianPrices);
 
+    // only for the base cache, it is saved to the snapshot after it is loaded at startup
+    void GetSnapshot(CPricePointSnapshot &snapshot) const;
+    void RestoreSnapshot(const CPricePointSnapshot &snapshot);
+    void SetLoaded() { is_loaded = true; }
+    bool IsLoaded() const { return is_loaded; }
+
     void SetBaseViewPtr(CPricePointMemCache *pBaseIn);
     void Flush();
 
@@ -64,19 +156,19 @@ private:
 
     void BatchWrite(const CoinPricePointMap &mapCoinPricePointCacheIn);
 
-    bool GetBlockUserPrices(const CoinPricePair &coinPricePair, set<int32_t> &expired, BlockUserPriceMap &blockUserPrices);
-    bool GetBlockUserPrices(const CoinPricePair &coinPricePair, BlockUserPriceMap &blockUserPrices);
+    // the blocks changed by this cache and the upper caches of the base cache, return the base cache
+    CPricePointMemCache* GetChangedBlockUserPrices(const CoinPricePair &coinPricePair,
+                                                   BlockUserPriceMap &changedBlocks);
 
     uint64_t ComputeBlockMedianPrice(const int32_t blockHeight, const uint64_t slideWindow,
                                      const CoinPricePair &coinPricePair);
-    uint64_t ComputeBlockMedianPrice(const int32_t blockHeight, const uint64_t slideWindow,
-                                     const BlockUserPriceMap &blockUserPrices);
-    static uint64_t ComputeMedianNumber(vector<uint64_t> &numbers);
 
 private:
-    CoinPricePointMap mapCoinPricePointCache;  // coinPriceType -> consecutiveBlockPrice
+    CoinPricePointMap mapCoinPricePointCache;  // coinPriceType -> consecutiveBlockPrice, the changes of the upper cache
+    map<CoinPricePair, CBlockPriceWindow> priceWindows;  // the price points of the base cache
     CPricePointMemCache *pBase;
     PriceMap latest_median_prices;
+    bool is_loaded = false;
 
 };
 
@@ -86,36 +178,49 @@ public:
     CPriceFeedCache(CDBAccess *pDbAccess)
     : price_feed_coin_cache(pDbAccess),
       medianPricesCache(pDbAccess),
-      price_feeders_cache(pDbAccess) {};
+      price_feeders_cache(pDbAccess),
+      pricePointSnapshotCache(pDbAccess) {};
 public:
     bool Flush() {
         price_feed_coin_cache.Flush();
         medianPricesCache.Flush();
         price_feeders_cache.Flush();
+        pricePointSnapshotCache.Flush();
         return true;
     }
 
     uint32_t GetCacheSize() const {
         return  price_feed_coin_cache.GetCacheSize() +
                 medianPricesCache.GetCacheSize() +
-                price_feeders_cache.GetCacheSize();
+                price_feeders_cache.GetCacheSize() +
+                pricePointSnapshotCache.GetCacheSize();
     }
     void SetBaseViewPtr(CPriceFeedCache *pBaseIn) {
         price_feed_coin_cache.SetBase(&pBaseIn->price_feed_coin_cache);
         medianPricesCache.SetBase(&pBaseIn->medianPricesCache);
         price_feeders_cache.SetBase(&pBaseIn->price_feeders_cache);
+        pricePointSnapshotCache.SetBase(&pBaseIn->pricePointSnapshotCache);
     };
 
     void SetDbOpLogMap(CDBOpLogMap *pDbOpLogMapIn) {
         price_feed_coin_cache.SetDbOpLogMap(pDbOpLogMapIn);
         medianPricesCache.SetDbOpLogMap(pDbOpLogMapIn);
         price_feeders_cache.SetDbOpLogMap(pDbOpLogMapIn);
+        pricePointSnapshotCache.SetDbOpLogMap(pDbOpLogMapIn);
+    }
+
+    void SetDbAccessLog(CDbAccessLog *pDbAccessLogIn) {
+        price_feed_coin_cache.SetDbAccessLog(pDbAccessLogIn);
+        medianPricesCache.SetDbAccessLog(pDbAccessLogIn);
+        price_feeders_cache.SetDbAccessLog(pDbAccessLogIn);
+        pricePointSnapshotCache.SetDbAccessLog(pDbAccessLogIn);
     }
 
     void RegisterUndoFunc(UndoDataFuncMap &undoDataFuncMap) {
         price_feed_coin_cache.RegisterUndoFunc(undoDataFuncMap);
         medianPricesCache.RegisterUndoFunc(undoDataFuncMap);
         price_feeders_cache.RegisterUndoFunc(undoDataFuncMap);
+        pricePointSnapshotCache.RegisterUndoFunc(undoDataFuncMap);
     }
 
     bool AddFeedCoinPair(TokenSymbol feedCoin, TokenSymbol baseCoin) ;
@@ -142,6 +247,8 @@ public:
     CSimpleKVCache< dbk::MEDIAN_PRICES,        PriceMap>     medianPricesCache;
     // [prefix] -> price feeders
     CSimpleKVCache< dbk::PRICE_FEEDERS,        vector<CRegID>>  price_feeders_cache ;
+    // [prefix] -> price points of the latest blocks, written by the flush of the db level cache only
+    CSimpleKVCache< dbk::PRICE_POINT_SNAPSHOT, CPricePointSnapshot>  pricePointSnapshotCache;
 
 };
 
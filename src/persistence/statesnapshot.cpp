@@ -0,0 +1,86 @@
+// Copyright (c) 2017-2019 The GreenVenturesChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "statesnapshot.h"
+
+#include "commons/util/util.h"
+#include "persistence/block.h"
+
+#include <map>
+
+CStateSnapshotManager stateSnapshots;
+
+CStateSnapshot::CStateSnapshot(const CCacheDBManager &cdMan, const CBlockIndex *pTipIn)
+    : pTip(pTipIn), height(pTipIn->height), blockHash(pTipIn->GetBlockHash()), time(GetTimeMillis()) {
+    dbAccesses.resize(DBNameType::DB_NAME_COUNT);
+
+    // the db name types in the single db share one snapshot
+    std::map<CLevelDBWrapper *, std::shared_ptr<const leveldb::Snapshot>> snapshots;
+    for (auto pDbAccess : cdMan.GetDbAccessList()) {
+        std::shared_ptr<CLevelDBWrapper> spDb = pDbAccess->GetDb();
+        auto &spDbSnapshot = snapshots[spDb.get()];
+        if (spDbSnapshot == nullptr)
+            spDbSnapshot = spDb->NewSnapshot();
+
+        dbAccesses[pDbAccess->GetDbNameType()].reset(new CDBAccess(*pDbAccess, spDbSnapshot));
+    }
+}
+
+CDBAccess *CStateSnapshot::GetDbAccess(DBNameType dbNameType) const {
+    assert(dbNameType < (int32_t)dbAccesses.size() && dbAccesses[dbNameType] != nullptr);
+    return dbAccesses[dbNameType].get();
+}
+
+CStateView::CStateView(const std::shared_ptr<const CStateSnapshot> &spSnapshotIn)
+    : spSnapshot(spSnapshotIn), pTip(spSnapshotIn->GetTip()), height(spSnapshotIn->GetHeight()) {
+    spAccountCache.reset(new CAccountDBCache(spSnapshot->GetDbAccess(DBNameType::ACCOUNT)));
+    spDelegateCache.reset(new CDelegateDBCache(spSnapshot->GetDbAccess(DBNameType::DELEGATE)));
+    spCdpCache.reset(new CCdpDBCache(spSnapshot->GetDbAccess(DBNameType::CDP)));
+    spDexCache.reset(new CDexDBCache(spSnapshot->GetDbAccess(DBNameType::DEX)));
+    spPriceFeedCache.reset(new CPriceFeedCache(spSnapshot->GetDbAccess(DBNameType::PRICEFEED)));
+
+    pAccountCache   = spAccountCache.get();
+    pDelegateCache  = spDelegateCache.get();
+    pCdpCache       = spCdpCache.get();
+    pDexCache       = spDexCache.get();
+    pPriceFeedCache = spPriceFeedCache.get();
+}
+
+CStateView::CStateView(CCacheDBManager &cdMan, const CBlockIndex *pTipIn)
+    : pAccountCache(cdMan.pAccountCache),
+      pDelegateCache(cdMan.pDelegateCache),
+      pCdpCache(cdMan.pCdpCache),
+      pDexCache(cdMan.pDexCache),
+      pPriceFeedCache(cdMan.pPriceFeedCache),
+      pTip(pTipIn),
+      height(pTipIn != nullptr ? pTipIn->height : -1) {}
+
+const CBlockIndex *CStateView::GetBlockIndex(int32_t heightIn) const {
+    if (pTip == nullptr || heightIn < 0 || heightIn > height)
+        return nullptr;
+
+    return pTip->GetAncestor(heightIn);
+}
+
+void CStateSnapshotManager::Take(const CCacheDBManager &cdMan, const CBlockIndex *pTip) {
+    std::shared_ptr<const CStateSnapshot> spSnapshot = std::make_shared<const CStateSnapshot>(cdMan, pTip);
+    {
+        STD_LOCK(cs);
+        spLatest.swap(spSnapshot);
+    }
+    // the previous snapshot is released out of the lock, or by its last reader
+}
+
+void CStateSnapshotManager::Clear() {
+    std::shared_ptr<const CStateSnapshot> spPrevious;
+    {
+        STD_LOCK(cs);
+        spPrevious.swap(spLatest);
+    }
+}
+
+std::shared_ptr<const CStateSnapshot> CStateSnapshotManager::GetLatest() const {
+    STD_LOCK(cs);
+    return spLatest;
+}
@@ -0,0 +1,107 @@
+// Copyright (c) 2017-2019 The GreenVenturesChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef PERSIST_STATESNAPSHOT_H
+#define PERSIST_STATESNAPSHOT_H
+
+#include "cachewrapper.h"
+#include "commons/uint256.h"
+#include "sync.h"
+
+#include <memory>
+#include <vector>
+
+class CBlockIndex;
+
+/**
+ * The immutable chain state of a tip, taken right after the caches of the tip are flushed to the dbs. It holds
+ * a leveldb snapshot of every db, so the reads see the state of the tip while the later blocks are written.
+ * The snapshot accesses are safe for the concurrent reads of many threads, the caches are not, every reader
+ * builds its own caches over them, see CStateView.
+ */
+class CStateSnapshot {
+public:
+    // the caches of cdMan must be flushed, cs_main must be held
+    CStateSnapshot(const CCacheDBManager &cdMan, const CBlockIndex *pTipIn);
+
+    const CBlockIndex *GetTip() const { return pTip; }
+    int32_t GetHeight() const { return height; }
+    const uint256 &GetBlockHash() const { return blockHash; }
+    int64_t GetTime() const { return time; }
+
+    CDBAccess *GetDbAccess(DBNameType dbNameType) const;
+
+private:
+    CStateSnapshot(const CStateSnapshot &) = delete;
+    CStateSnapshot &operator=(const CStateSnapshot &) = delete;
+
+private:
+    const CBlockIndex *pTip;
+    int32_t height;
+    uint256 blockHash;
+    int64_t time;
+    std::vector<std::unique_ptr<CDBAccess>> dbAccesses;  // indexed by DBNameType
+};
+
+/**
+ * The chain state read by one read-only RPC call, either the private caches over a state snapshot, read without
+ * cs_main, or the live caches of the cache db manager, read under cs_main.
+ */
+class CStateView {
+public:
+    explicit CStateView(const std::shared_ptr<const CStateSnapshot> &spSnapshotIn);
+
+    // cs_main must be held while the view is read
+    CStateView(CCacheDBManager &cdMan, const CBlockIndex *pTipIn);
+
+    bool IsSnapshot() const { return spSnapshot != nullptr; }
+    int32_t GetHeight() const { return height; }
+
+    // The block of the height on the chain of the view, nullptr if it is beyond the tip. The block index entries
+    // are never changed after being linked to their ancestors, so the chain is read without cs_main.
+    const CBlockIndex *GetBlockIndex(int32_t heightIn) const;
+
+    CAccountDBCache     *pAccountCache;
+    CDelegateDBCache    *pDelegateCache;
+    CCdpDBCache         *pCdpCache;
+    CDexDBCache         *pDexCache;
+    CPriceFeedCache     *pPriceFeedCache;
+
+private:
+    CStateView(const CStateView &) = delete;
+    CStateView &operator=(const CStateView &) = delete;
+
+private:
+    std::shared_ptr<const CStateSnapshot> spSnapshot = nullptr;
+    const CBlockIndex *pTip;
+    int32_t height;
+
+    // the private db level caches over the snapshot
+    std::unique_ptr<CAccountDBCache>    spAccountCache;
+    std::unique_ptr<CDelegateDBCache>   spDelegateCache;
+    std::unique_ptr<CCdpDBCache>        spCdpCache;
+    std::unique_ptr<CDexDBCache>        spDexCache;
+    std::unique_ptr<CPriceFeedCache>    spPriceFeedCache;
+};
+
+// The latest state snapshot, published by the block connection and read by the RPC threads.
+class CStateSnapshotManager {
+public:
+    // take the snapshot of the flushed state of the tip, cs_main must be held
+    void Take(const CCacheDBManager &cdMan, const CBlockIndex *pTip);
+
+    // the state of the dbs is not the one of the tip, e.g. the flush is skipped in the initial block download
+    void Clear();
+
+    // nullptr if there is no snapshot of the tip
+    std::shared_ptr<const CStateSnapshot> GetLatest() const;
+
+private:
+    mutable StdMutex cs;
+    std::shared_ptr<const CStateSnapshot> spLatest = nullptr;
+};
+
+extern CStateSnapshotManager stateSnapshots;
+
+#endif  // PERSIST_STATESNAPSHOT_H
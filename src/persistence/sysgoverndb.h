@@ -52,6 +52,12 @@ public:
         approvals_cache.SetDbOpLogMap(pDbOpLogMapIn);
     }
 
+    void SetDbAccessLog(CDbAccessLog *pDbAccessLogIn) {
+        governors_cache.SetDbAccessLog(pDbAccessLogIn);
+        proposals_cache.SetDbAccessLog(pDbAccessLogIn);
+        approvals_cache.SetDbAccessLog(pDbAccessLogIn);
+    }
+
 
 
 
@@ -123,6 +123,15 @@ public:
 
     }
 
+    void SetDbAccessLog(CDbAccessLog *pDbAccessLogIn) {
+        sys_param_chache.SetDbAccessLog(pDbAccessLogIn);
+        miner_fee_cache.SetDbAccessLog(pDbAccessLogIn);
+        cdp_param_cache.SetDbAccessLog(pDbAccessLogIn);
+        cdp_interest_param_changes_cache.SetDbAccessLog(pDbAccessLogIn);
+        current_bp_count_cache.SetDbAccessLog(pDbAccessLogIn);
+        new_bp_count_cache.SetDbAccessLog(pDbAccessLogIn);
+    }
+
     void RegisterUndoFunc(UndoDataFuncMap &undoDataFuncMap) {
         sys_param_chache.RegisterUndoFunc(undoDataFuncMap);
         miner_fee_cache.RegisterUndoFunc(undoDataFuncMap);
@@ -34,6 +34,7 @@ public:
     void SetBaseViewPtr(CTxReceiptDBCache *pBaseIn) { txReceiptCache.SetBase(&pBaseIn->txReceiptCache); }
 
     void SetDbOpLogMap(CDBOpLogMap *pDbOpLogMapIn) { txReceiptCache.SetDbOpLogMap(pDbOpLogMapIn); }
+    void SetDbAccessLog(CDbAccessLog *pDbAccessLogIn) { txReceiptCache.SetDbAccessLog(pDbAccessLogIn); }
 
     void RegisterUndoFunc(UndoDataFuncMap &undoDataFuncMap) {
         txReceiptCache.RegisterUndoFunc(undoDataFuncMap);
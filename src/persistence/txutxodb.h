@@ -52,6 +52,11 @@ public:
         txUtxoPasswordProofCache.SetDbOpLogMap(pDbOpLogMapIn);
     }
 
+    void SetDbAccessLog(CDbAccessLog *pDbAccessLogIn) {
+        txUtxoCache.SetDbAccessLog(pDbAccessLogIn);
+        txUtxoPasswordProofCache.SetDbAccessLog(pDbAccessLogIn);
+    }
+
     void RegisterUndoFunc(UndoDataFuncMap &undoDataFuncMap) {
         txUtxoCache.RegisterUndoFunc(undoDataFuncMap);
         txUtxoPasswordProofCache.RegisterUndoFunc(undoDataFuncMap);
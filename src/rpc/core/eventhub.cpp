@@ -0,0 +1,201 @@
+// Copyright (c) 2017-2019 The GreenVenturesChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "eventhub.h"
+
+#include "commons/util/util.h"
+
+#include <boost/algorithm/string.hpp>
+
+CRPCEventHub rpcEventHub;
+
+static const std::pair<RPCEventTopic, const char *> EVENT_TOPIC_NAMES[] = {
+    {EVENT_TOPIC_BLOCK, "block"},
+    {EVENT_TOPIC_TX,    "tx"},
+    {EVENT_TOPIC_DEX,   "dex"},
+    {EVENT_TOPIC_CDP,   "cdp"},
+};
+
+bool ParseEventTopics(const std::string &str, uint32_t &topics) {
+    if (str.empty()) {
+        topics = EVENT_TOPIC_ALL;
+        return true;
+    }
+
+    topics = 0;
+    std::vector<std::string> names;
+    boost::split(names, str, boost::is_any_of(","));
+    for (const auto &name : names) {
+        bool found = false;
+        for (const auto &item : EVENT_TOPIC_NAMES) {
+            if (name == item.second) {
+                topics |= item.first;
+                found = true;
+                break;
+            }
+        }
+        if (!found)
+            return false;
+    }
+    return true;
+}
+
+std::vector<std::string> GetEventTopicNames(uint32_t topics) {
+    std::vector<std::string> names;
+    for (const auto &item : EVENT_TOPIC_NAMES) {
+        if (topics & item.first)
+            names.push_back(item.second);
+    }
+    return names;
+}
+
+void CRPCEventHub::Start() {
+    Stop();
+
+    STD_LOCK(cs);
+    fStopping      = false;
+    fRunning       = true;
+    dispatchThread = std::thread(&CRPCEventHub::ThreadDispatch, this);
+}
+
+void CRPCEventHub::Stop() {
+    {
+        STD_LOCK(cs);
+        fStopping = true;
+        cond.notify_all();
+    }
+    if (dispatchThread.joinable())
+        dispatchThread.join();
+
+    std::vector<std::unique_ptr<CSubscriber>> released;
+    {
+        STD_LOCK(cs);
+        fRunning = false;
+        released.swap(subscribers);
+        stats.subscribers = 0;
+        UpdateTopicMask();
+    }
+    // the sinks are released out of the lock
+}
+
+void CRPCEventHub::Publish(RPCEventTopic topic, std::string &&event) {
+    event += '\n';
+    auto spEvent = std::make_shared<const std::string>(std::move(event));
+
+    STD_LOCK(cs);
+    stats.published++;
+    for (auto &subscriber : subscribers) {
+        if (!(subscriber->topics & topic))
+            continue;
+
+        if (subscriber->events.size() >= MAX_RPC_EVENT_QUEUE_SIZE) {
+            subscriber->events.pop_front();
+            subscriber->dropped++;
+            stats.dropped++;
+        }
+        subscriber->events.push_back(spEvent);
+    }
+    if (!fPending) {
+        fPending = true;
+        cond.notify_one();
+    }
+}
+
+bool CRPCEventHub::Subscribe(uint32_t topics, std::unique_ptr<CRPCEventSink> sink) {
+    std::unique_ptr<CSubscriber> subscriber(new CSubscriber());
+    subscriber->topics        = topics;
+    subscriber->sink          = std::move(sink);
+    subscriber->dropped       = 0;
+    subscriber->lastWriteTime = GetTimeMillis();
+
+    STD_LOCK(cs);
+    if (!fRunning || fStopping || subscribers.size() >= MAX_RPC_EVENT_SUBSCRIBERS)
+        return false;
+
+    subscribers.push_back(std::move(subscriber));
+    stats.subscribers = subscribers.size();
+    UpdateTopicMask();
+    return true;
+}
+
+size_t CRPCEventHub::GetSubscriberCount() const {
+    STD_LOCK(cs);
+    return subscribers.size();
+}
+
+CRPCEventHub::Stats CRPCEventHub::GetStats() const {
+    STD_LOCK(cs);
+    return stats;
+}
+
+void CRPCEventHub::UpdateTopicMask() {
+    uint32_t mask = 0;
+    for (const auto &subscriber : subscribers)
+        mask |= subscriber->topics;
+    topicMask = mask;
+}
+
+void CRPCEventHub::TakeEvents(std::vector<CWrite> &writes, int64_t now) {
+    std::vector<std::unique_ptr<CSubscriber>> closed;
+    for (auto it = subscribers.begin(); it != subscribers.end();) {
+        CSubscriber &subscriber = **it;
+        if (subscriber.sink->IsClosed()) {
+            closed.push_back(std::move(*it));
+            it = subscribers.erase(it);
+            continue;
+        }
+        it++;
+
+        // the events are held while the sink is full
+        bool fFull = subscriber.sink->GetUnsentSize() >= MAX_RPC_EVENT_UNSENT_SIZE;
+        if (!fFull && !subscriber.events.empty()) {
+            CWrite write = {subscriber.sink.get(), {}, subscriber.dropped};
+            write.events.swap(subscriber.events);
+            stats.delivered += write.events.size();
+            subscriber.dropped       = 0;
+            subscriber.lastWriteTime = now;
+            writes.push_back(std::move(write));
+        } else if (now - subscriber.lastWriteTime >= RPC_EVENT_HEARTBEAT_INTERVAL) {
+            // keep the idle connection, and find the closed one
+            subscriber.lastWriteTime = now;
+            writes.push_back({subscriber.sink.get(), {}, 0});
+        }
+    }
+
+    if (!closed.empty()) {
+        stats.subscribers = subscribers.size();
+        UpdateTopicMask();
+    }
+}
+
+void CRPCEventHub::ThreadDispatch() {
+    RenameThread("coin-rpcevents");
+
+    while (true) {
+        std::vector<CWrite> writes;
+        {
+            STD_WAIT_LOCK(cs, lock);
+            // wake up by the events, or periodically for the heartbeats and the sinks drained
+            if (!fStopping && !fPending)
+                cond.wait_for(lock, std::chrono::milliseconds(100));
+            if (fStopping)
+                break;
+
+            fPending = false;
+            TakeEvents(writes, GetTimeMillis());
+        }
+
+        // the text is built out of the lock, the sinks are only released by this thread and Stop()
+        for (auto &write : writes) {
+            std::string text;
+            if (write.dropped > 0)
+                text = strprintf("{\"event\":\"dropped\",\"count\":%llu}\n", write.dropped);
+            for (const auto &spEvent : write.events)
+                text += *spEvent;
+            if (text.empty())
+                text = "\n";  // the heartbeat
+            write.sink->Write(std::move(text));
+        }
+    }
+}
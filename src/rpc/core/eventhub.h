@@ -0,0 +1,124 @@
+// Copyright (c) 2017-2019 The GreenVenturesChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef RPC_CORE_EVENTHUB_H
+#define RPC_CORE_EVENTHUB_H
+
+#include "sync.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+static const size_t MAX_RPC_EVENT_SUBSCRIBERS       = 64;
+static const size_t MAX_RPC_EVENT_QUEUE_SIZE        = 10000;      // the events queued for one subscriber
+static const size_t MAX_RPC_EVENT_UNSENT_SIZE       = 1 << 20;    // the bytes written to one subscriber not sent yet
+static const int64_t RPC_EVENT_HEARTBEAT_INTERVAL   = 15 * 1000;  // in milliseconds
+
+// The topics of the events, a subscriber receives the events of the topics subscribed.
+enum RPCEventTopic : uint32_t {
+    EVENT_TOPIC_BLOCK   = 1 << 0,   // block_connected, block_disconnected
+    EVENT_TOPIC_TX      = 1 << 1,   // tx_accepted, tx_rejected
+    EVENT_TOPIC_DEX     = 1 << 2,   // dex_order
+    EVENT_TOPIC_CDP     = 1 << 3,   // cdp_liquidation, by the liquidate tx or forced by the price median tx
+
+    EVENT_TOPIC_ALL     = EVENT_TOPIC_BLOCK | EVENT_TOPIC_TX | EVENT_TOPIC_DEX | EVENT_TOPIC_CDP
+};
+
+// Parse the comma separated topic names, e.g. "block,dex", all of the topics if it is empty
+bool ParseEventTopics(const std::string &str, uint32_t &topics);
+std::vector<std::string> GetEventTopicNames(uint32_t topics);
+
+// The connection of the subscriber, e.g. the detached chunked HTTP reply
+class CRPCEventSink {
+public:
+    virtual ~CRPCEventSink() {}
+
+    virtual void Write(std::string &&text) = 0;
+    // the subscriber is gone, the sink is released
+    virtual bool IsClosed() const = 0;
+    // the size of the text written but not sent to the subscriber yet
+    virtual size_t GetUnsentSize() const = 0;
+};
+
+/**
+ * The fan-out of the chain events to the subscribers. Every event is one line of json, serialized once and shared
+ * by the queues of the subscribers. The publisher only appends the event to the queues, the dispatch thread writes
+ * the queued events to the sinks in batches.
+ * Every subscriber has its own bounded queue. The events are held in the queue while the sink has more than
+ * MAX_RPC_EVENT_UNSENT_SIZE bytes not sent, when the queue is full the oldest events are dropped, and the count is
+ * sent to the subscriber by a "dropped" event before the next events, so that the slow subscriber resyncs by the
+ * RPCs instead of slowing down the others or the publisher.
+ */
+class CRPCEventHub {
+public:
+    struct Stats {
+        uint64_t subscribers    = 0;
+        uint64_t published      = 0;
+        uint64_t delivered      = 0;    // the events written to the sinks
+        uint64_t dropped        = 0;    // the events dropped by the full queues
+    };
+
+    CRPCEventHub() {}
+    ~CRPCEventHub() { Stop(); }
+
+    void Start();
+    // release all of the subscribers
+    void Stop();
+
+    // some subscriber receives the events of the topic, checked before building the event
+    bool HasSubscribers(uint32_t topic) const { return (topicMask & topic) != 0; }
+
+    // one line of json without the line end
+    void Publish(RPCEventTopic topic, std::string &&event);
+
+    // false if the hub is stopped or the subscribers are too many, the sink is released
+    bool Subscribe(uint32_t topics, std::unique_ptr<CRPCEventSink> sink);
+
+    size_t GetSubscriberCount() const;
+    Stats GetStats() const;
+
+private:
+    struct CSubscriber {
+        uint32_t topics;
+        std::unique_ptr<CRPCEventSink> sink;
+        std::deque<std::shared_ptr<const std::string>> events;
+        uint64_t dropped;           // the events dropped since the last write
+        int64_t lastWriteTime;
+    };
+
+    // the events taken from the queue of the subscriber, no events for the heartbeat
+    struct CWrite {
+        CRPCEventSink *sink;
+        std::deque<std::shared_ptr<const std::string>> events;
+        uint64_t dropped;
+    };
+
+    void ThreadDispatch();
+    // take the events to be written to the subscribers, and release the closed subscribers
+    void TakeEvents(std::vector<CWrite> &writes, int64_t now);
+    void UpdateTopicMask();
+
+private:
+    std::thread dispatchThread;
+
+    mutable StdMutex cs;
+    std::condition_variable cond;
+    std::vector<std::unique_ptr<CSubscriber>> subscribers;
+    bool fPending  = false;     // some events are published since the last dispatch
+    bool fRunning  = false;
+    bool fStopping = false;
+    Stats stats;
+
+    std::atomic<uint32_t> topicMask{0};
+};
+
+extern CRPCEventHub rpcEventHub;
+
+#endif  // RPC_CORE_EVENTHUB_H
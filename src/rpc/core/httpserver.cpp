@@ -13,6 +13,7 @@
 #include <init.h>
 #include <sync.h>
 
+#include <atomic>
 #include <memory>
 #include <stdio.h>
 #include <stdlib.h>
@@ -525,7 +526,10 @@ HTTPRequest::~HTTPRequest() {
     if (!replySent) {
         // Keep track of whether reply was sent to avoid request leaks
         LogPrint(BCLog::ERROR, "%s: Unhandled request\n", __func__);
-        WriteReply(HTTP_INTERNAL, "Unhandled request");
+        if (chunkedReply)
+            EndChunkedReply();
+        else
+            WriteReply(HTTP_INTERNAL, "Unhandled request");
     }
     // evhttpd cleans up the request, as long as a reply was sent.
 }
@@ -564,6 +568,21 @@ void HTTPRequest::WriteHeader(const std::string& hdr, const std::string& value)
     evhttp_add_header(headers, hdr.c_str(), value.c_str());
 }
 
+/** Re-enable reading from the socket after the reply is sent. This is the second part of the
+ * libevent workaround in http_request_cb.
+ */
+static void http_enable_reading(struct evhttp_request* req) {
+    if (event_get_version_number() >= 0x02010600 && event_get_version_number() < 0x02020001) {
+        evhttp_connection* conn = evhttp_request_get_connection(req);
+        if (conn) {
+            bufferevent* bev = evhttp_connection_get_bufferevent(conn);
+            if (bev) {
+                bufferevent_enable(bev, EV_READ | EV_WRITE);
+            }
+        }
+    }
+}
+
 /** Closure sent to main thread to request a reply to be sent to
  * a HTTP request.
  * Replies must be sent in the main loop in the main http thread,
@@ -581,23 +600,133 @@ void HTTPRequest::WriteReply(int nStatus, const std::string& strReply) {
     auto req_copy = req;
     HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, nStatus] {
         evhttp_send_reply(req_copy, nStatus, nullptr, nullptr);
-        // Re-enable reading from the socket. This is the second part of the libevent
-        // workaround above.
-        if (event_get_version_number() >= 0x02010600 && event_get_version_number() < 0x02020001) {
-            evhttp_connection* conn = evhttp_request_get_connection(req_copy);
-            if (conn) {
-                bufferevent* bev = evhttp_connection_get_bufferevent(conn);
-                if (bev) {
-                    bufferevent_enable(bev, EV_READ | EV_WRITE);
-                }
-            }
-        }
+        http_enable_reading(req_copy);
     });
     ev->trigger(nullptr);
     replySent = true;
     req       = nullptr;  // transferred back to main thread
 }
 
+/** The unsent size of the chunked reply above which the writer waits for the client to read it. */
+static const size_t MAX_CHUNKED_REPLY_UNSENT_SIZE = 4 * 64 * 1024;
+
+/** The state of the chunked reply, the request is only accessed by the main http thread. */
+struct HTTPChunkedReply {
+    struct evhttp_request* req;
+    std::atomic<bool> fClosed{false};     // the connection is closed, the request is freed by evhttp
+    std::atomic<size_t> nUnsentSize{0};   // the size of the chunks not written to the socket yet
+    size_t nBufferedSize = 0;             // the size of the chunks added to the output buffer, main thread only
+
+    // signalled when the chunks are written or the connection is closed
+    StdMutex cs;
+    std::condition_variable cond;
+
+    void Notify() {
+        STD_LOCK(cs);
+        cond.notify_all();
+    }
+};
+
+static void http_chunked_reply_close_cb(struct evhttp_connection*, void* arg) {
+    HTTPChunkedReply* pReply = static_cast<HTTPChunkedReply*>(arg);
+    pReply->fClosed = true;
+    pReply->Notify();
+}
+
+// the output buffer of the connection is drained, all of the chunks added to it are written
+static void http_chunk_sent_cb(struct evhttp_connection*, void* arg) {
+    HTTPChunkedReply* pReply = static_cast<HTTPChunkedReply*>(arg);
+    pReply->nUnsentSize -= pReply->nBufferedSize;
+    pReply->nBufferedSize = 0;
+    pReply->Notify();
+}
+
+static void http_write_reply_chunk(const std::shared_ptr<HTTPChunkedReply>& spReply, std::string&& strChunk) {
+    if (strChunk.empty() || spReply->fClosed)
+        return;
+
+    spReply->nUnsentSize += strChunk.size();
+    auto spChunk = std::make_shared<std::string>(std::move(strChunk));
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [spReply, spChunk] {
+        if (spReply->fClosed)
+            return;
+        struct evbuffer* evb = evbuffer_new();
+        assert(evb);
+        evbuffer_add(evb, spChunk->data(), spChunk->size());
+        spReply->nBufferedSize += spChunk->size();
+        evhttp_send_reply_chunk_with_cb(spReply->req, evb, http_chunk_sent_cb, spReply.get());
+        evbuffer_free(evb);
+    });
+    ev->trigger(nullptr);
+}
+
+static void http_end_chunked_reply(const std::shared_ptr<HTTPChunkedReply>& spReply) {
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [spReply] {
+        if (spReply->fClosed)
+            return;
+        evhttp_connection* conn = evhttp_request_get_connection(spReply->req);
+        if (conn)
+            evhttp_connection_set_closecb(conn, nullptr, nullptr);
+        evhttp_send_reply_end(spReply->req);
+        http_enable_reading(spReply->req);
+    });
+    ev->trigger(nullptr);
+}
+
+void HTTPRequest::StartChunkedReply(int nStatus) {
+    assert(!replySent && req && !chunkedReply);
+    if (ShutdownRequested()) {
+        WriteHeader("Connection", "close");
+    }
+    chunkedReply      = std::make_shared<HTTPChunkedReply>();
+    chunkedReply->req = req;
+    auto spReply      = chunkedReply;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [spReply, nStatus] {
+        evhttp_connection* conn = evhttp_request_get_connection(spReply->req);
+        if (conn)
+            evhttp_connection_set_closecb(conn, http_chunked_reply_close_cb, spReply.get());
+        evhttp_send_reply_start(spReply->req, nStatus, nullptr);
+    });
+    ev->trigger(nullptr);
+}
+
+void HTTPRequest::WriteReplyChunk(std::string&& strChunk) {
+    assert(!replySent && chunkedReply);
+    {
+        // the connection timed out by evhttp is closed, which wakes up the writer too
+        STD_WAIT_LOCK(chunkedReply->cs, lock);
+        while (!chunkedReply->fClosed && chunkedReply->nUnsentSize >= MAX_CHUNKED_REPLY_UNSENT_SIZE &&
+               !ShutdownRequested())
+            chunkedReply->cond.wait_for(lock, std::chrono::milliseconds(100));
+    }
+    http_write_reply_chunk(chunkedReply, std::move(strChunk));
+}
+
+void HTTPRequest::EndChunkedReply() {
+    assert(!replySent && chunkedReply);
+    http_end_chunked_reply(chunkedReply);
+    chunkedReply = nullptr;
+    replySent    = true;
+    req          = nullptr;  // transferred back to main thread
+}
+
+std::unique_ptr<HTTPReplyStream> HTTPRequest::DetachReplyStream() {
+    assert(!replySent && chunkedReply);
+    std::unique_ptr<HTTPReplyStream> stream(new HTTPReplyStream(chunkedReply));
+    chunkedReply = nullptr;
+    replySent    = true;
+    req          = nullptr;  // ended by the stream
+    return stream;
+}
+
+HTTPReplyStream::~HTTPReplyStream() { http_end_chunked_reply(chunkedReply); }
+
+void HTTPReplyStream::Write(std::string&& strChunk) { http_write_reply_chunk(chunkedReply, std::move(strChunk)); }
+
+bool HTTPReplyStream::IsClosed() const { return chunkedReply->fClosed; }
+
+size_t HTTPReplyStream::GetUnsentSize() const { return chunkedReply->nUnsentSize; }
+
 CService HTTPRequest::GetPeer() const {
     evhttp_connection* con = evhttp_request_get_connection(req);
     CService peer;
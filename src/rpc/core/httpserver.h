@@ -5,6 +5,7 @@
 #ifndef COIN_HTTPSERVER_H
 #define COIN_HTTPSERVER_H
 
+#include <memory>
 #include <string>
 #include <stdint.h>
 #include <functional>
@@ -17,6 +18,7 @@ struct evhttp_request;
 struct event_base;
 class CService;
 class HTTPRequest;
+class HTTPReplyStream;
 
 /** Initialize HTTP server.
  * Call this before RegisterHTTPHandler or EventBase().
@@ -54,11 +56,14 @@ struct event_base* EventBase();
 /** In-flight HTTP request.
  * Thin C++ wrapper around evhttp_request.
  */
+struct HTTPChunkedReply;
+
 class HTTPRequest
 {
 private:
     struct evhttp_request* req;
     bool replySent;
+    std::shared_ptr<HTTPChunkedReply> chunkedReply;
 
 public:
     explicit HTTPRequest(struct evhttp_request* req);
@@ -114,6 +119,46 @@ public:
      * main thread, do not call any other HTTPRequest methods after calling this.
      */
     void WriteReply(int nStatus, const std::string& strReply = "");
+
+    /**
+     * Start the chunked HTTP reply, the body is sent by WriteReplyChunk() as it is produced and is ended by
+     * EndChunkedReply(), which gives the request back to the main thread like WriteReply().
+     * The chunks are sent by the main http thread in order, the ones of a closed connection are dropped.
+     * WriteReplyChunk() waits while the chunks not written to the socket exceed MAX_CHUNKED_REPLY_UNSENT_SIZE,
+     * so the reply to a slow client is not buffered without bound.
+     *
+     * @note write the headers before calling this.
+     */
+    void StartChunkedReply(int nStatus);
+    void WriteReplyChunk(std::string&& strChunk);
+    void EndChunkedReply();
+
+    /**
+     * Detach the started chunked reply from the request, the reply outlives the handler and is written by the
+     * stream, e.g. the events of the subscription.
+     *
+     * @note do not call any other HTTPRequest methods after calling this.
+     */
+    std::unique_ptr<HTTPReplyStream> DetachReplyStream();
+};
+
+/** The chunked reply detached from its request, written by any thread until the client closes the connection.
+ * The reply is ended when the stream is destroyed.
+ */
+class HTTPReplyStream
+{
+public:
+    explicit HTTPReplyStream(const std::shared_ptr<HTTPChunkedReply>& chunkedReplyIn) : chunkedReply(chunkedReplyIn) {}
+    ~HTTPReplyStream();
+
+    void Write(std::string&& strChunk);
+    /** The client closed the connection, the chunks written are dropped */
+    bool IsClosed() const;
+    /** The size of the chunks written but not sent to the socket yet */
+    size_t GetUnsentSize() const;
+
+private:
+    std::shared_ptr<HTTPChunkedReply> chunkedReply;
 };
 
 /** Event handler closure.
@@ -0,0 +1,232 @@
+// Copyright (c) 2017-2019 The GreenVenturesChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "jsonwriter.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cwctype>
+
+static const char HEX_DIGITS_UPPER[] = "0123456789ABCDEF";
+static const char HEX_DIGITS_LOWER[] = "0123456789abcdef";
+
+CJsonWriter::CJsonWriter(size_t chunkSizeIn, const ChunkSink &sinkIn) : chunkSize(chunkSizeIn), sink(sinkIn) {
+    buffer.reserve(sink ? chunkSize + chunkSize / 4 : 1024);
+}
+
+void CJsonWriter::BeginValue() {
+    if (fPendingKey) {
+        fPendingKey = false;
+        return;
+    }
+    if (!scopes.empty()) {
+        CScope &scope = scopes.back();
+        assert(!scope.fObject && "the member of the object must have a key");
+        if (scope.count++ > 0)
+            buffer += ',';
+    }
+}
+
+void CJsonWriter::EndValue() {
+    if (sink && buffer.size() >= chunkSize)
+        Flush();
+}
+
+CJsonWriter &CJsonWriter::BeginObject() {
+    BeginValue();
+    buffer += '{';
+    scopes.push_back({true, 0});
+    return *this;
+}
+
+CJsonWriter &CJsonWriter::EndObject() {
+    assert(!scopes.empty() && scopes.back().fObject && !fPendingKey);
+    scopes.pop_back();
+    buffer += '}';
+    EndValue();
+    return *this;
+}
+
+CJsonWriter &CJsonWriter::BeginArray() {
+    BeginValue();
+    buffer += '[';
+    scopes.push_back({false, 0});
+    return *this;
+}
+
+CJsonWriter &CJsonWriter::EndArray() {
+    assert(!scopes.empty() && !scopes.back().fObject);
+    scopes.pop_back();
+    buffer += ']';
+    EndValue();
+    return *this;
+}
+
+CJsonWriter &CJsonWriter::EndAll() {
+    if (fPendingKey)
+        WriteNull();
+    while (!scopes.empty()) {
+        if (scopes.back().fObject)
+            EndObject();
+        else
+            EndArray();
+    }
+    return *this;
+}
+
+CJsonWriter &CJsonWriter::Key(const std::string &key) {
+    assert(!scopes.empty() && scopes.back().fObject && !fPendingKey);
+    CScope &scope = scopes.back();
+    if (scope.count++ > 0)
+        buffer += ',';
+    WriteString(key);
+    buffer += ':';
+    fPendingKey = true;
+    return *this;
+}
+
+// the same escapes as json_spirit::add_esc_chars()
+void CJsonWriter::WriteString(const std::string &value) {
+    buffer += '"';
+    for (char c : value) {
+        if (c >= 0x20 && c < 0x7F && c != '"' && c != '\\') {
+            buffer += c;
+            continue;
+        }
+
+        switch (c) {
+            case '"':  buffer += "\\\""; continue;
+            case '\\': buffer += "\\\\"; continue;
+            case '\b': buffer += "\\b";  continue;
+            case '\f': buffer += "\\f";  continue;
+            case '\n': buffer += "\\n";  continue;
+            case '\r': buffer += "\\r";  continue;
+            case '\t': buffer += "\\t";  continue;
+        }
+
+        const wint_t unsignedChar = (c >= 0) ? c : 256 + c;
+        if (iswprint(unsignedChar)) {
+            buffer += c;
+        } else {
+            buffer += "\\u00";
+            buffer += HEX_DIGITS_UPPER[(unsignedChar >> 4) & 0x0F];
+            buffer += HEX_DIGITS_UPPER[unsignedChar & 0x0F];
+        }
+    }
+    buffer += '"';
+}
+
+CJsonWriter &CJsonWriter::Write(const std::string &value) {
+    BeginValue();
+    WriteString(value);
+    EndValue();
+    return *this;
+}
+
+CJsonWriter &CJsonWriter::Write(const char *value) { return Write(std::string(value)); }
+
+CJsonWriter &CJsonWriter::Write(bool value) {
+    BeginValue();
+    buffer += value ? "true" : "false";
+    EndValue();
+    return *this;
+}
+
+CJsonWriter &CJsonWriter::Write(int64_t value) {
+    BeginValue();
+    char text[24];
+    int32_t len = snprintf(text, sizeof(text), "%lld", (long long)value);
+    buffer.append(text, len);
+    EndValue();
+    return *this;
+}
+
+CJsonWriter &CJsonWriter::Write(uint64_t value) {
+    BeginValue();
+    char text[24];
+    int32_t len = snprintf(text, sizeof(text), "%llu", (unsigned long long)value);
+    buffer.append(text, len);
+    EndValue();
+    return *this;
+}
+
+// the same format as the real value of json_spirit, std::fixed with the precision of 8
+CJsonWriter &CJsonWriter::Write(double value) {
+    BeginValue();
+    char text[384];
+    int32_t len = snprintf(text, sizeof(text), "%.8f", value);
+    buffer.append(text, std::min<size_t>(len, sizeof(text) - 1));
+    EndValue();
+    return *this;
+}
+
+CJsonWriter &CJsonWriter::WriteNull() {
+    BeginValue();
+    buffer += "null";
+    EndValue();
+    return *this;
+}
+
+CJsonWriter &CJsonWriter::Write(const json_spirit::Value &value) {
+    switch (value.type()) {
+        case json_spirit::obj_type:
+            BeginObject();
+            for (const auto &member : value.get_obj()) {
+                Key(member.name_);
+                Write(member.value_);
+            }
+            return EndObject();
+        case json_spirit::array_type:
+            BeginArray();
+            for (const auto &item : value.get_array())
+                Write(item);
+            return EndArray();
+        case json_spirit::str_type:
+            return Write(value.get_str());
+        case json_spirit::bool_type:
+            return Write(value.get_bool());
+        case json_spirit::int_type:
+            return value.is_uint64() ? Write(value.get_uint64()) : Write(value.get_int64());
+        case json_spirit::real_type:
+            return Write(value.get_real());
+        case json_spirit::null_type:
+            return WriteNull();
+        default:
+            assert(false);
+    }
+    return *this;
+}
+
+CJsonWriter &CJsonWriter::WriteHex(const char *begin, const char *end) {
+    BeginValue();
+    buffer += '"';
+    for (const char *p = begin; p != end; p++) {
+        uint8_t c = (uint8_t)*p;
+        buffer += HEX_DIGITS_LOWER[c >> 4];
+        buffer += HEX_DIGITS_LOWER[c & 0x0F];
+        if (sink && buffer.size() >= chunkSize)
+            Flush();
+    }
+    buffer += '"';
+    EndValue();
+    return *this;
+}
+
+CJsonWriter &CJsonWriter::WriteRaw(const std::string &text) {
+    buffer += text;
+    EndValue();
+    return *this;
+}
+
+void CJsonWriter::Flush() {
+    if (!sink || buffer.empty())
+        return;
+
+    flushedSize += buffer.size();
+    std::string chunk;
+    chunk.reserve(chunkSize + chunkSize / 4);
+    chunk.swap(buffer);
+    sink(std::move(chunk));
+}
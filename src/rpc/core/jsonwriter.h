@@ -0,0 +1,96 @@
+// Copyright (c) 2017-2019 The GreenVenturesChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef RPC_CORE_JSONWRITER_H
+#define RPC_CORE_JSONWRITER_H
+
+#include "commons/json/json_spirit_value.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+static const size_t DEFAULT_JSON_CHUNK_SIZE = 64 * 1024;
+
+/**
+ * The streaming JSON encoder of the RPC results. The handlers write the result into it directly instead of
+ * building the json_spirit::Value tree, the text is the same as write_string(value, false) of the equivalent
+ * Value. The encoded text is passed to the sink in chunks of about chunkSize bytes as it is produced, without
+ * the sink all of the text is kept in the buffer.
+ */
+class CJsonWriter {
+public:
+    typedef std::function<void(std::string &&chunk)> ChunkSink;
+    // the deferred encoding of the value into the writer
+    typedef std::function<void(CJsonWriter &writer)> Encoder;
+
+    explicit CJsonWriter(size_t chunkSizeIn = DEFAULT_JSON_CHUNK_SIZE, const ChunkSink &sinkIn = nullptr);
+
+    CJsonWriter &BeginObject();
+    CJsonWriter &EndObject();
+    CJsonWriter &BeginArray();
+    CJsonWriter &EndArray();
+
+    // the key of the next member of the object
+    CJsonWriter &Key(const std::string &key);
+
+    CJsonWriter &Write(const std::string &value);
+    CJsonWriter &Write(const char *value);
+    CJsonWriter &Write(bool value);
+    CJsonWriter &Write(int32_t value) { return Write((int64_t)value); }
+    CJsonWriter &Write(uint32_t value) { return Write((uint64_t)value); }
+    CJsonWriter &Write(int64_t value);
+    CJsonWriter &Write(uint64_t value);
+    CJsonWriter &Write(double value);
+    CJsonWriter &WriteNull();
+    // the subtree built by the Value path
+    CJsonWriter &Write(const json_spirit::Value &value);
+    // the hex string of the data, encoded into the buffer directly
+    CJsonWriter &WriteHex(const char *begin, const char *end);
+
+    template <typename T>
+    CJsonWriter &Member(const std::string &key, const T &value) {
+        Key(key);
+        return Write(value);
+    }
+
+    // the text out of the JSON value, e.g. the line end of the reply
+    CJsonWriter &WriteRaw(const std::string &text);
+
+    // end the open objects and arrays of the value written in part, e.g. the handler failed in the middle, the
+    // key without its value gets null
+    CJsonWriter &EndAll();
+
+    // pass the buffered text to the sink
+    void Flush();
+
+    // the text not passed to the sink yet
+    std::string &GetBuffer() { return buffer; }
+    // the size of all of the text written
+    uint64_t GetSize() const { return flushedSize + buffer.size(); }
+    bool IsFlushed() const { return flushedSize > 0; }
+    bool IsComplete() const { return scopes.empty() && !fPendingKey; }
+
+private:
+    // the separator before the value in the current scope
+    void BeginValue();
+    void EndValue();
+    void WriteString(const std::string &value);
+
+private:
+    struct CScope {
+        bool fObject;
+        uint32_t count;
+    };
+
+    size_t chunkSize;
+    ChunkSink sink;
+    std::string buffer;
+    uint64_t flushedSize = 0;
+    std::vector<CScope> scopes;
+    bool fPendingKey = false;  // the value of the key is not written yet
+};
+
+#endif  // RPC_CORE_JSONWRITER_H
@@ -494,7 +494,11 @@ uint64_t RPC_PARAM::GetWiccFee(const Array& params, const size_t index, const Tx
 }
 
 CUserID RPC_PARAM::ParseUserIdByAddr(const Value &jsonValue) {
-    auto pUserId = CUserID::ParseUserId(jsonValue.get_str());
+    return ParseUserIdByAddr(jsonValue, *pCdMan->pAccountCache);
+}
+
+CUserID RPC_PARAM::ParseUserIdByAddr(const Value &jsonValue, const CAccountDBCache &accountCache) {
+    auto pUserId = CUserID::ParseUserId(jsonValue.get_str(), accountCache);
     if (!pUserId) {
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, strprintf("Invalid address=%s", jsonValue.get_str()));
     }
@@ -546,8 +550,12 @@ CUserID RPC_PARAM::GetUserId(const Value &jsonValue, const bool senderUid ) {
 }
 
 CKeyID RPC_PARAM::GetUserKeyId(const CUserID &uid) {
+    return GetUserKeyId(uid, *pCdMan->pAccountCache);
+}
+
+CKeyID RPC_PARAM::GetUserKeyId(const CUserID &uid, const CAccountDBCache &accountCache) {
     CKeyID keyid;
-    if (!pCdMan->pAccountCache->GetKeyId(uid, keyid))
+    if (!accountCache.GetKeyId(uid, keyid))
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY,
                            strprintf("Get keyid by userid=%s failed", uid.ToString()));
     return keyid;
@@ -557,6 +565,10 @@ CKeyID RPC_PARAM::GetKeyId(const Value &jsonValue){
     return GetUserKeyId(ParseUserIdByAddr(jsonValue));
 }
 
+CKeyID RPC_PARAM::GetKeyId(const Value &jsonValue, const CAccountDBCache &accountCache) {
+    return GetUserKeyId(ParseUserIdByAddr(jsonValue, accountCache), accountCache);
+}
+
 string RPC_PARAM::GetLuaContractScript(const Value &jsonValue) {
     string filePath = GetAbsolutePath(jsonValue.get_str()).string();
     if (filePath.empty())
@@ -48,14 +48,17 @@ namespace RPC_PARAM {
 
 
     CUserID ParseUserIdByAddr(const Value &jsonValue);
+    CUserID ParseUserIdByAddr(const Value &jsonValue, const CAccountDBCache &accountCache);
 
     CKeyID GetUserKeyId(const CUserID &userId);
+    CKeyID GetUserKeyId(const CUserID &userId, const CAccountDBCache &accountCache);
 
     CUserID ParseUserId(const Value &jsonValue);
     CUserID GetUserId(const Value &jsonValue, const bool senderUid = false);
 
     string GetLuaContractScript(const Value &jsonValue);
     CKeyID GetKeyId(const Value &jsonValue);
+    CKeyID GetKeyId(const Value &jsonValue, const CAccountDBCache &accountCache);
 
     uint64_t GetPrice(const Value &jsonValue);
 
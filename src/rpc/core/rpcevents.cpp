@@ -0,0 +1,166 @@
+// Copyright (c) 2017-2019 The GreenVenturesChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "rpcevents.h"
+
+#include "eventhub.h"
+#include "commons/json/json_spirit_writer_template.h"
+#include "main.h"
+#include "persistence/cachewrapper.h"
+#include "tx/tx.h"
+
+using namespace json_spirit;
+
+static bool IsDexOrderTx(TxType txType) {
+    switch (txType) {
+        case DEX_LIMIT_BUY_ORDER_TX:
+        case DEX_LIMIT_SELL_ORDER_TX:
+        case DEX_MARKET_BUY_ORDER_TX:
+        case DEX_MARKET_SELL_ORDER_TX:
+        case DEX_CANCEL_ORDER_TX:
+        case DEX_TRADE_SETTLE_TX:
+        case DEX_ORDER_TX:
+        case DEX_OPERATOR_ORDER_TX:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static void PublishEvent(RPCEventTopic topic, const Object &event) {
+    rpcEventHub.Publish(topic, write_string(Value(event), false));
+}
+
+// The events are built under cs_main only if they are subscribed
+class CRPCEventListener : public CChainEventListener {
+protected:
+    void SyncTransaction(const uint256 &hash, CBaseTx *pBaseTx, const CBlock *pBlock) override {
+        if (pBlock != nullptr) {
+            PublishBlock(*pBlock);
+        } else if (pBaseTx != nullptr && rpcEventHub.HasSubscribers(EVENT_TOPIC_TX)) {
+            Object event;
+            event.push_back(Pair("event",       "tx_accepted"));
+            event.push_back(Pair("txid",        hash.GetHex()));
+            event.push_back(Pair("tx_type",     pBaseTx->GetTxTypeName()));
+            event.push_back(Pair("valid_height", pBaseTx->valid_height));
+            PublishEvent(EVENT_TOPIC_TX, event);
+        }
+    }
+
+    void RejectTransaction(const uint256 &hash, CBaseTx *pBaseTx, const CValidationState &state) override {
+        if (!rpcEventHub.HasSubscribers(EVENT_TOPIC_TX))
+            return;
+
+        Object event;
+        event.push_back(Pair("event",           "tx_rejected"));
+        event.push_back(Pair("txid",            hash.GetHex()));
+        event.push_back(Pair("tx_type",         pBaseTx->GetTxTypeName()));
+        event.push_back(Pair("reject_code",     (int32_t)state.GetRejectCode()));
+        event.push_back(Pair("reject_reason",   state.GetRejectReason()));
+        PublishEvent(EVENT_TOPIC_TX, event);
+    }
+
+    // held until the block of the price median tx is connected, the tx is also executed by the miner
+    void ForceLiquidateCdps(const uint256 &txid, const vector<CUserCDP> &cdps, uint64_t bcoinMedianPrice) override {
+        if (!rpcEventHub.HasSubscribers(EVENT_TOPIC_CDP))
+            return;
+
+        vector<Object> cdpObjs;
+        for (const auto &cdp : cdps)
+            cdpObjs.push_back(cdp.ToJson(bcoinMedianPrice));
+
+        STD_LOCK(cs);
+        forceLiquidatedCdps[txid] = std::move(cdpObjs);
+    }
+
+private:
+    StdMutex cs;
+    map<uint256, vector<Object>> forceLiquidatedCdps;  // price median txid -> the cdps force liquidated
+
+
+    // the block connected to the tip, or disconnected from it, by UpdateTip()
+    void PublishBlock(const CBlock &block) {
+        uint256 blockHash = block.GetHash();
+        bool fConnected   = chainActive.Tip() != nullptr && chainActive.Tip()->GetBlockHash() == blockHash;
+
+        if (rpcEventHub.HasSubscribers(EVENT_TOPIC_BLOCK)) {
+            Object event;
+            event.push_back(Pair("event",       fConnected ? "block_connected" : "block_disconnected"));
+            event.push_back(Pair("block_hash",  blockHash.GetHex()));
+            event.push_back(Pair("height",      (int32_t)block.GetHeight()));
+            event.push_back(Pair("time",        block.GetBlockTime()));
+            event.push_back(Pair("tx_count",    (int32_t)block.vptx.size()));
+            PublishEvent(EVENT_TOPIC_BLOCK, event);
+        }
+
+        // the executions of the other price median txs are not confirmed by the block
+        map<uint256, vector<Object>> liquidatedCdps;
+        {
+            STD_LOCK(cs);
+            liquidatedCdps.swap(forceLiquidatedCdps);
+        }
+
+        // the clients resync the orders and the cdps by the RPCs after the block is disconnected
+        if (!fConnected || !rpcEventHub.HasSubscribers(EVENT_TOPIC_DEX | EVENT_TOPIC_CDP))
+            return;
+
+        for (const auto &pTx : block.vptx) {
+            if (pTx->nTxType == PRICE_MEDIAN_TX) {
+                PublishForceLiquidatedCdps(block, pTx->GetHash(), liquidatedCdps);
+                continue;
+            }
+
+            RPCEventTopic topic;
+            const char *eventName;
+            if (IsDexOrderTx(pTx->nTxType)) {
+                topic     = EVENT_TOPIC_DEX;
+                eventName = "dex_order";
+            } else if (pTx->nTxType == CDP_LIQUIDATE_TX) {
+                topic     = EVENT_TOPIC_CDP;
+                eventName = "cdp_liquidation";
+            } else {
+                continue;
+            }
+            if (!rpcEventHub.HasSubscribers(topic))
+                continue;
+
+            Object event;
+            event.push_back(Pair("event",       eventName));
+            event.push_back(Pair("block_hash",  blockHash.GetHex()));
+            event.push_back(Pair("height",      (int32_t)block.GetHeight()));
+            event.push_back(Pair("tx",          pTx->ToJson(*pCdMan->pAccountCache)));
+            PublishEvent(topic, event);
+        }
+    }
+
+    void PublishForceLiquidatedCdps(const CBlock &block, const uint256 &txid,
+                                    const map<uint256, vector<Object>> &liquidatedCdps) {
+        auto it = liquidatedCdps.find(txid);
+        if (it == liquidatedCdps.end() || !rpcEventHub.HasSubscribers(EVENT_TOPIC_CDP))
+            return;
+
+        for (const auto &cdpObj : it->second) {
+            Object event;
+            event.push_back(Pair("event",       "cdp_liquidation"));
+            event.push_back(Pair("block_hash",  block.GetHash().GetHex()));
+            event.push_back(Pair("height",      (int32_t)block.GetHeight()));
+            event.push_back(Pair("txid",        txid.GetHex()));
+            event.push_back(Pair("forced",      true));
+            event.push_back(Pair("cdp",         cdpObj));
+            PublishEvent(EVENT_TOPIC_CDP, event);
+        }
+    }
+};
+
+static CRPCEventListener rpcEventListener;
+
+void StartRPCEvents() {
+    rpcEventHub.Start();
+    RegisterChainEventListener(&rpcEventListener);
+}
+
+void StopRPCEvents() {
+    UnregisterChainEventListener(&rpcEventListener);
+    rpcEventHub.Stop();
+}
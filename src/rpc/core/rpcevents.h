@@ -0,0 +1,13 @@
+// Copyright (c) 2017-2019 The GreenVenturesChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef RPC_CORE_RPCEVENTS_H
+#define RPC_CORE_RPCEVENTS_H
+
+/** Publish the chain and the mempool events to the subscribers of rpcEventHub, see CChainEventListener */
+void StartRPCEvents();
+/** Stop publishing the events and release the subscribers, before the HTTP server is stopped */
+void StopRPCEvents();
+
+#endif  // RPC_CORE_RPCEVENTS_H
@@ -11,12 +11,16 @@
 #include "commons/util/util.h"
 #include "init.h"
 #include "main.h"
+#include "persistence/statesnapshot.h"
 
 #include <boost/algorithm/string.hpp>
 #include <memory>
 #include "wallet/wallet.h"
 #include "commons/json/json_spirit_writer_template.h"
+#include "eventhub.h"
 #include "httpserver.h"
+#include "jsonwriter.h"
+#include "rpcevents.h"
 
 using namespace std;
 using namespace json_spirit;
@@ -70,6 +74,39 @@ std::unique_ptr<T> MakeUnique(Args&&... args) {
 }
 
 static bool JsonRPCHandler(HTTPRequest* req, const std::string&);
+static bool EventsRequestHandler(HTTPRequest* req, const std::string& strPath);
+
+// the chain state of the read-only handler running on this thread
+static thread_local CStateView* pRPCStateView = nullptr;
+
+class CRPCStateViewScope {
+public:
+    explicit CRPCStateViewScope(CStateView &view) { pRPCStateView = &view; }
+    ~CRPCStateViewScope() { pRPCStateView = nullptr; }
+};
+
+CStateView& GetRPCStateView() {
+    if (pRPCStateView == nullptr)
+        throw JSONRPCError(RPC_INTERNAL_ERROR, "The chain state is only readable by the read-only RPC handler");
+    return *pRPCStateView;
+}
+
+// Run the read-only handler against the latest state snapshot without cs_main, or against the live chain state
+// under cs_main if there is no snapshot of the tip, e.g. in the initial block download.
+static void ExecuteReadOnly(const std::function<void()>& handler) {
+    auto spSnapshot = stateSnapshots.GetLatest();
+    if (spSnapshot != nullptr) {
+        CStateView view(spSnapshot);
+        CRPCStateViewScope scope(view);
+        handler();
+        return;
+    }
+
+    LOCK(cs_main);
+    CStateView view(*pCdMan, chainActive.Tip());
+    CRPCStateViewScope scope(view);
+    handler();
+}
 
 void RPCTypeCheck(const Array& params, const list<Value_type>& typesExpected, bool fAllowNull) {
     unsigned int i = 0;
@@ -233,6 +270,11 @@ CRPCTable::CRPCTable() {
         pCMD                    = &vRPCCommands[index];
         mapCommands[pCMD->name] = pCMD;
     }
+    for (uint32_t index = 0; index < (sizeof(vRPCStreamCommands) / sizeof(vRPCStreamCommands[0])); ++index) {
+        const CRPCStreamCommand* pCMD = &vRPCStreamCommands[index];
+        assert(mapCommands.count(pCMD->name) > 0);
+        mapStreamCommands[pCMD->name] = pCMD;
+    }
 }
 
 const CRPCCommand* CRPCTable::operator[](string name) const {
@@ -325,6 +367,8 @@ bool StartRPCServer() {
     }
 
     RegisterHTTPHandler("/", true, JsonRPCHandler);
+    RegisterHTTPHandler("/events", false, EventsRequestHandler);
+    StartRPCEvents();
 
     struct event_base* eventBase = EventBase();
     assert(eventBase);
@@ -342,7 +386,10 @@ void InterruptRPCServer() {
 
 void StopRPCServer() {
     LogPrint(BCLog::INFO, "Stopping HTTP RPC server\n");
+    UnregisterHTTPHandler("/events", false);
     UnregisterHTTPHandler("/", true);
+    // the event streams are ended before the http server is stopped
+    StopRPCEvents();
 
     if (httpRPCTimerInterface) {
         RPCUnsetTimerInterface(httpRPCTimerInterface.get());
@@ -430,9 +477,8 @@ string JSONRPCExecBatch(const Array& vReq) {
     return write_string(Value(ret), false) + "\n";
 }
 
-json_spirit::Value CRPCTable::execute(const string& strMethod,
-                                      const json_spirit::Array& params) const {
-    // Find method
+// Find the method and check whether it can be called by the configs
+static const CRPCCommand* FindCommand(const string& strMethod) {
     const CRPCCommand* pcmd = tableRPC[strMethod];
     if (!pcmd)
         throw JSONRPCError(RPC_METHOD_NOT_FOUND, "Method not found");
@@ -465,25 +511,57 @@ json_spirit::Value CRPCTable::execute(const string& strMethod,
         }
     }
 
+    return pcmd;
+}
+
+// Run the handler of the method with the locks or the chain state of the command
+static void ExecuteCommand(const CRPCCommand* pcmd, const std::function<void()>& handler) {
     try {
-        // Execute
-        Value result;
-        {
-            if (pcmd->threadSafe)
-                result = pcmd->actor(params, false);
-            else if (!pWalletMain) {
-                LOCK(cs_main);
-                result = pcmd->actor(params, false);
-            } else {
-                LOCK2(cs_main, pWalletMain->cs_wallet);
-                result = pcmd->actor(params, false);
-            }
+        if (pcmd->threadSafe)
+            handler();
+        else if (pcmd->readOnly)
+            ExecuteReadOnly(handler);
+        else if (!pWalletMain) {
+            LOCK(cs_main);
+            handler();
+        } else {
+            LOCK2(cs_main, pWalletMain->cs_wallet);
+            handler();
         }
+    } catch (std::exception& e) {
+        throw JSONRPCError(RPC_MISC_ERROR, e.what());
+    }
+}
+
+json_spirit::Value CRPCTable::execute(const string& strMethod,
+                                      const json_spirit::Array& params) const {
+    const CRPCCommand* pcmd = FindCommand(strMethod);
 
-        return result;
+    // Execute
+    Value result;
+    ExecuteCommand(pcmd, [&]() { result = pcmd->actor(params, false); });
+    return result;
+}
+
+bool CRPCTable::executeStream(const string& strMethod, const json_spirit::Array& params,
+                              CJsonWriter& writer) const {
+    auto it = mapStreamCommands.find(strMethod);
+    if (it == mapStreamCommands.end())
+        return false;
+
+    const CRPCCommand* pcmd = FindCommand(strMethod);
+    rpcstreamfn_type actor  = it->second->actor;
+
+    CJsonWriter::Encoder encoder;
+    ExecuteCommand(pcmd, [&]() { encoder = actor(params); });
+
+    // the result is encoded and sent out of the locks of the command
+    try {
+        encoder(writer);
     } catch (std::exception& e) {
         throw JSONRPCError(RPC_MISC_ERROR, e.what());
     }
+    return true;
 }
 
 string HelpExampleCli(string methodname, string args) {
@@ -499,15 +577,58 @@ string HelpExampleRpc(string methodname, string args) {
 
 const CRPCTable tableRPC;
 
-/** json rpc handler registered to http server */
-static bool JsonRPCHandler(HTTPRequest* req, const std::string&) {
-    // JSONRPC handles only POST or GET
-    auto reqMethod = req->GetRequestMethod();
-    if (reqMethod != HTTPRequest::POST && reqMethod != HTTPRequest::GET) {
-        req->WriteReply(HTTP_BAD_METHOD, "RPC server handles only POST or GET requests");
-        return false;
+/**
+ * Stream the result of the singleton request into the chunked reply as it is written, the reply is sent in one
+ * piece if it is smaller than a chunk. Returns false if the method has no streaming handler.
+ */
+static bool StreamRPCReply(HTTPRequest* req, const JSONRequest& jreq) {
+    bool fChunked = false;
+    CJsonWriter writer(DEFAULT_JSON_CHUNK_SIZE, [req, &fChunked](std::string&& chunk) {
+        if (!fChunked) {
+            req->WriteHeader("Content-Type", "application/json");
+            req->StartChunkedReply(HTTP_OK);
+            fChunked = true;
+        }
+        req->WriteReplyChunk(std::move(chunk));
+    });
+
+    // the same reply as JSONRPCReply()
+    writer.WriteRaw("{\"result\":");
+    Value error;
+    try {
+        if (!tableRPC.executeStream(jreq.strMethod, jreq.params, writer))
+            return false;
+    } catch (const Object& objError) {
+        if (!fChunked)
+            throw;  // nothing is sent, reply the error
+        error = objError;
+    } catch (const std::exception& e) {
+        if (!fChunked)
+            throw;
+        error = JSONRPCError(RPC_MISC_ERROR, e.what());
     }
-    // Check authorization
+
+    if (error.type() != null_type) {
+        // the status and a part of the result are sent already, the result is closed and the error is set, so the
+        // client sees the failed call
+        LogPrint(BCLog::ERROR, "%s: streaming the result of %s failed after %llu bytes: %s\n", __func__,
+                 jreq.strMethod, writer.GetSize(), write_string(error, false));
+        writer.EndAll();
+    }
+    writer.WriteRaw(",\"error\":" + write_string(error, false) + ",\"id\":" + write_string(jreq.id, false) + "}\n");
+
+    if (fChunked) {
+        writer.Flush();
+        req->EndChunkedReply();
+    } else {
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, writer.GetBuffer());
+    }
+    return true;
+}
+
+/** Check the authorization of the request, the unauthorized reply is sent if it fails */
+static bool CheckAuthorization(HTTPRequest* req) {
     std::pair<bool, std::string> authHeader = req->GetHeader("authorization");
     if (!authHeader.first) {
         req->WriteHeader("WWW-Authenticate", WWW_AUTH_HEADER_DATA);
@@ -515,8 +636,6 @@ static bool JsonRPCHandler(HTTPRequest* req, const std::string&) {
         return false;
     }
 
-    JSONRequest jreq;
-
     if (!HTTPAuthorized(authHeader.second)) {
         LogPrint(BCLog::RPC, "RPCServer incorrect password attempt from %s\n",
                  req->GetPeer().ToString());
@@ -530,6 +649,21 @@ static bool JsonRPCHandler(HTTPRequest* req, const std::string&) {
         req->WriteReply(HTTP_UNAUTHORIZED);
         return false;
     }
+    return true;
+}
+
+/** json rpc handler registered to http server */
+static bool JsonRPCHandler(HTTPRequest* req, const std::string&) {
+    // JSONRPC handles only POST or GET
+    auto reqMethod = req->GetRequestMethod();
+    if (reqMethod != HTTPRequest::POST && reqMethod != HTTPRequest::GET) {
+        req->WriteReply(HTTP_BAD_METHOD, "RPC server handles only POST or GET requests");
+        return false;
+    }
+    if (!CheckAuthorization(req))
+        return false;
+
+    JSONRequest jreq;
 
     try {
         // Parse request
@@ -543,6 +677,9 @@ static bool JsonRPCHandler(HTTPRequest* req, const std::string&) {
         // singleton request
         if (valRequest.type() == obj_type) {
             jreq.parse(valRequest);
+            if (StreamRPCReply(req, jreq))
+                return true;
+
             Value result = tableRPC.execute(jreq.strMethod, jreq.params);
 
             // Send reply
@@ -567,6 +704,72 @@ static bool JsonRPCHandler(HTTPRequest* req, const std::string&) {
     return true;
 }
 
+/** The subscription events written to the detached HTTP reply */
+class HTTPEventSink : public CRPCEventSink {
+public:
+    explicit HTTPEventSink(std::unique_ptr<HTTPReplyStream> streamIn) : stream(std::move(streamIn)) {}
+
+    void Write(std::string&& text) override { stream->Write(std::move(text)); }
+    bool IsClosed() const override { return stream->IsClosed(); }
+    size_t GetUnsentSize() const override { return stream->GetUnsentSize(); }
+
+private:
+    std::unique_ptr<HTTPReplyStream> stream;
+};
+
+/**
+ * The event subscription handler registered to http server, e.g. GET /events?topics=block,dex.
+ * The reply is a chunked stream of the events, one line of json per event, until the client closes it.
+ */
+static bool EventsRequestHandler(HTTPRequest* req, const std::string& strPath) {
+    if (req->GetRequestMethod() != HTTPRequest::GET) {
+        req->WriteReply(HTTP_BAD_METHOD, "The event subscription handles only GET requests");
+        return false;
+    }
+    if (!CheckAuthorization(req))
+        return false;
+
+    std::string strTopics;
+    if (!strPath.empty()) {
+        static const std::string TOPICS_QUERY = "?topics=";
+        if (strPath.compare(0, TOPICS_QUERY.size(), TOPICS_QUERY) != 0) {
+            req->WriteReply(HTTP_NOT_FOUND);
+            return false;
+        }
+        strTopics = strPath.substr(TOPICS_QUERY.size());
+    }
+    uint32_t topics;
+    if (!ParseEventTopics(strTopics, topics) || topics == 0) {
+        req->WriteReply(HTTP_BAD_REQUEST, strprintf("Invalid topics, the topics are %s",
+                                                    boost::algorithm::join(GetEventTopicNames(EVENT_TOPIC_ALL), ",")));
+        return false;
+    }
+    if (rpcEventHub.GetSubscriberCount() >= MAX_RPC_EVENT_SUBSCRIBERS) {
+        req->WriteReply(HTTP_SERVICE_UNAVAILABLE, "Too many event subscribers");
+        return false;
+    }
+
+    Array topicNames;
+    for (const auto& name : GetEventTopicNames(topics))
+        topicNames.push_back(name);
+    Object subscribed;
+    subscribed.push_back(Pair("event", "subscribed"));
+    subscribed.push_back(Pair("topics", topicNames));
+
+    // the stream is never reused by the next request
+    req->WriteHeader("Content-Type", "application/x-ndjson");
+    req->WriteHeader("Connection", "close");
+    req->StartChunkedReply(HTTP_OK);
+    req->WriteReplyChunk(write_string(Value(subscribed), false) + "\n");
+
+    std::string strPeer = req->GetPeer().ToString();
+    std::unique_ptr<CRPCEventSink> sink(new HTTPEventSink(req->DetachReplyStream()));
+    if (!rpcEventHub.Subscribe(topics, std::move(sink)))
+        LogPrint(BCLog::RPC, "The event subscription from %s is rejected\n", strPeer);
+
+    return true;
+}
+
 void RPCSetTimerInterface(RPCTimerInterface* iface) {
     timerInterface = iface;
 }
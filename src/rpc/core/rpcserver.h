@@ -6,6 +6,7 @@
 #ifndef _COINRPC_SERVER_H_
 #define _COINRPC_SERVER_H_
 
+#include "jsonwriter.h"
 #include "rpcprotocol.h"
 #include "commons/uint256.h"
 #include "rpc/rpcapi.h"
@@ -21,6 +22,7 @@
 using namespace std;
 using namespace json_spirit ;
 class CBlockIndex;
+class CStateView;
 
 Value help(const Array& params, bool fHelp);
 Value stop(const Array& params, bool fHelp);
@@ -65,6 +67,26 @@ public:
     bool okSafeMode;
     bool threadSafe;
     bool reqWallet;
+    // the handler only reads the chain state by GetRPCStateView(), it runs without cs_main against the state
+    // snapshot of the tip, concurrently with the other RPC threads
+    bool readOnly = false;
+};
+
+// The chain state of the running read-only handler, see CRPCCommand::readOnly.
+CStateView &GetRPCStateView();
+
+typedef CJsonWriter::Encoder (*rpcstreamfn_type)(const json_spirit::Array& params);
+
+/**
+ * The streaming handler of the command with the large result. It runs with the locks or the chain state of the
+ * command, copies the data of the result and returns its encoder, which writes the result into the writer of the
+ * chunked HTTP reply after the locks are released, so a slow client does not hold cs_main. The help and the batch
+ * requests still go through the actor of the command.
+ */
+class CRPCStreamCommand {
+public:
+    string name;
+    rpcstreamfn_type actor;
 };
 
 /**
@@ -73,6 +95,7 @@ public:
 class CRPCTable {
 private:
     map<string, const CRPCCommand*> mapCommands;
+    map<string, const CRPCStreamCommand*> mapStreamCommands;
 
 public:
     CRPCTable();
@@ -87,6 +110,16 @@ public:
      * @throws an exception (json_spirit::Value) when an error happens.
      */
     json_spirit::Value execute(const string& method, const json_spirit::Array& params) const;
+
+    /**
+     * Execute the streaming handler of a method.
+     * @param method   Method to execute
+     * @param params   Array of arguments (JSON objects)
+     * @param writer   The writer of the result
+     * @returns false if the method has no streaming handler.
+     * @throws an exception (json_spirit::Value) when an error happens.
+     */
+    bool executeStream(const string& method, const json_spirit::Array& params, CJsonWriter& writer) const;
 };
 
 extern const CRPCTable tableRPC;
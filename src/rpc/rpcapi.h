@@ -8,6 +8,7 @@
 
 #include "commons/json/json_spirit_utils.h"
 #include "commons/json/json_spirit_value.h"
+#include "core/jsonwriter.h"
 #include "core/rpcserver.h"
 
 using namespace std;
@@ -90,6 +91,8 @@ extern Value submitdexsettletx(const Array& params, bool fHelp);
 
 extern Value getdexorder(const Array& params, bool fHelp);
 extern Value getdexorders(const Array& params, bool fHelp);
+extern CJsonWriter::Encoder getdexordersstream(const Array& params);
+extern Value getdexorderbook(const Array& params, bool fHelp);
 extern Value getdexsysorders(const Array& params, bool fHelp);
 extern Value getdexoperator(const Array& params, bool fHelp);
 extern Value getdexoperatorbyowner(const Array& params, bool fHelp);
@@ -118,6 +121,7 @@ extern Value listmintxfees(const Array& params, bool fHelp) ;
 
 /******************************  WASM VM *********************************/
 extern Value vmexecutescript(const Array& params, bool fHelp);
+extern Value getvmcacheinfo(const Array& params, bool fHelp);
 
 extern Value submitwasmcontractdeploytx(const Array& params, bool fHelp);
 extern Value submitwasmcontractcalltx(const Array& params, bool fHelp);
@@ -183,7 +187,10 @@ extern Value getfcoingenesistxinfo(const Array& params, bool fHelp);
 extern Value getblockcount(const Array& params, bool fHelp);
 extern Value getdifficulty(const Array& params, bool fHelp);
 extern Value getrawmempool(const Array& params, bool fHelp);
+extern CJsonWriter::Encoder getrawmempoolstream(const Array& params);
+extern Value getmempoolinfo(const Array& params, bool fHelp);
 extern Value getblock(const Array& params, bool fHelp);
+extern CJsonWriter::Encoder getblockstream(const Array& params);
 extern Value verifychain(const Array& params, bool fHelp);
 extern Value getcontractregid(const Array& params, bool fHelp);
 extern Value invalidateblock(const Array& params, bool fHelp);
@@ -207,5 +214,7 @@ extern Value getbpcount(const Array& params, bool fHelp);
 
 // debug
 Value dumpdb(const Array& params, bool fHelp);
+Value getdbinfo(const Array& params, bool fHelp);
+Value getsigcacheinfo(const Array& params, bool fHelp);
 
 #endif /* RPC_API_H_ */
@@ -13,8 +13,8 @@
 //
 
 static const CRPCCommand vRPCCommands[] =
-{ //  name                      actor (function)         okSafeMode threadSafe reqWallet
-  //  ------------------------  -----------------------  ---------- ---------- ---------
+{ //  name                      actor (function)         okSafeMode threadSafe reqWallet readOnly (default false)
+  //  ------------------------  -----------------------  ---------- ---------- --------- ------------------------
     /* Overall control/query calls */
     { "help",                           &help,                              true,      true,        false   },
     { "getinfo",                        &getinfo,                           true,      false,       false   }, /* uses wallet if enabled */
@@ -37,6 +37,7 @@ static const CRPCCommand vRPCCommands[] =
     { "getblockcount",                  &getblockcount,                     true,      true,        false   },
     { "getblock",                       &getblock,                          true,      false,       false   },
     { "getrawmempool",                  &getrawmempool,                     true,      false,       false   },
+    { "getmempoolinfo",                 &getmempoolinfo,                    true,      false,       false   },
     { "verifychain",                    &verifychain,                       true,      false,       false   },
     { "getblockundo",                   &getblockundo,                      true,      false,       false   },
 
@@ -52,7 +53,7 @@ static const CRPCCommand vRPCCommands[] =
     { "genmulsigtx",                    &genmulsigtx,                       true,      false,       false   },
     /* uses wallet if enabled */
     { "addmulsigaddr",                  &addmulsigaddr,                     false,     false,       true    },
-    { "getaccountinfo",                 &getaccountinfo,                    true,      false,       true    },
+    { "getaccountinfo",                 &getaccountinfo,                    true,      false,       true,       true    },
     { "getnewaddr",                     &getnewaddr,                        false,     false,       true    },
     { "gettxdetail",                    &gettxdetail,                       true,      false,       true    },
     { "getclosedcdp",                   &getclosedcdp,                      true,      false,       true    },
@@ -123,7 +124,7 @@ static const CRPCCommand vRPCCommands[] =
     { "submitcdpliquidatetx",           &submitcdpliquidatetx,              false,      false,      true    },
     { "getscoininfo",                   &getscoininfo,                      true,       false,      false   },
     { "getcdpinfo",                     &getcdpinfo,                            true,       false,      false   },
-    { "getusercdp",                     &getusercdp,                        true,       false,      false   },
+    { "getusercdp",                     &getusercdp,                        true,       false,      false,      true    },
     { "listcdpcoinpairs",                &listcdpcoinpairs,                   true,       false,      false   },
 
     { "getsysparam",                    &getsysparam,                       true,       false,      false   },
@@ -143,7 +144,8 @@ static const CRPCCommand vRPCCommands[] =
     { "submitdexoperatorupdatetx",      &submitdexoperatorupdatetx,         false,      false,      false   },
     { "getdexorder",                    &getdexorder,                       true,       false,      false   },
     { "getdexsysorders",                &getdexsysorders,                   true,       false,      false   },
-    { "getdexorders",                   &getdexorders,                      true,       false,      false   },
+    { "getdexorders",                   &getdexorders,                      true,       false,      false,      true    },
+    { "getdexorderbook",                &getdexorderbook,                   true,       false,      false,      true    },
     { "getdexoperator",                 &getdexoperator,                    true,       false,      false   },
     { "getdexoperatorbyowner",          &getdexoperatorbyowner,             true,       false,      false   },
     { "getdexorderfee",                 &getdexorderfee,                    true,       false,      false   },
@@ -175,9 +177,24 @@ static const CRPCCommand vRPCCommands[] =
     { "getblockfailures",               &getblockfailures,                  true,       false,      false   },
     /* vm functions work in vm simulator */
     { "vmexecutescript",                &vmexecutescript,                   true,       true,       true    },
+    { "getvmcacheinfo",                 &getvmcacheinfo,                    true,       true,       false   },
 
     /* debug */
     { "dumpdb",                         &dumpdb,                            true,       true,       true    },
+    { "getdbinfo",                      &getdbinfo,                         true,       true,       false   },
+    { "getsigcacheinfo",                &getsigcacheinfo,                   true,       true,       false   },
+};
+
+//
+// Streaming handlers of the commands with the large results, see CRPCStreamCommand
+//
+
+static const CRPCStreamCommand vRPCStreamCommands[] =
+{ //  name                      actor (function)
+  //  ------------------------  -----------------------
+    { "getrawmempool",                  &getrawmempoolstream                },
+    { "getblock",                       &getblockstream                     },
+    { "getdexorders",                   &getdexordersstream                 },
 };
 
 #endif //RPC_APICONF_H_
@@ -13,6 +13,8 @@
 #include "config/configuration.h"
 #include "init.h"
 #include "main.h"
+#include "p2p/txadmission.h"
+#include "rpc/core/jsonwriter.h"
 #include "rpc/core/rpcserver.h"
 #include "sync.h"
 #include "tx/merkletx.h"
@@ -70,6 +72,67 @@ Object BlockToJSON(const CBlock& block, const CBlockIndex* pBlockIndex) {
     return result;
 }
 
+// The position of the block in the active chain, read under cs_main for encoding the block out of it
+struct CBlockChainPos {
+    int32_t confirmations;
+    string prevBlockHash;  // empty if none
+    string nextBlockHash;
+};
+
+static CBlockChainPos GetBlockChainPos(const CBlock& block, const CBlockIndex* pBlockIndex) {
+    CBlockChainPos pos;
+    CMerkleTx txGen(block.vptx[0]);
+    txGen.SetMerkleBranch(&block);
+    pos.confirmations = txGen.GetDepthInMainChain();
+    if (pBlockIndex->pprev)
+        pos.prevBlockHash = pBlockIndex->pprev->GetBlockHash().GetHex();
+    CBlockIndex* pNext = chainActive.Next(pBlockIndex);
+    if (pNext)
+        pos.nextBlockHash = pNext->GetBlockHash().GetHex();
+    return pos;
+}
+
+// The same json as BlockToJSON(), streamed into the writer
+static void WriteBlockJson(CJsonWriter& writer, const CBlock& block, const CBlockChainPos& pos) {
+    writer.BeginObject();
+    writer.Member("block_hash",     block.GetHash().GetHex());
+    writer.Member("block_miner",    block.vptx[0]->txUid.ToString());
+    writer.Member("confirmations",  pos.confirmations);
+    writer.Member("size",           (int32_t)::GetSerializeSize(block, SER_NETWORK, PROTOCOL_VERSION));
+    writer.Member("height",         (int32_t)block.GetHeight());
+    writer.Member("version",        block.GetVersion());
+    writer.Member("merkle_root",    block.GetMerkleRootHash().GetHex());
+    writer.Member("tx_count",       (int32_t)block.vptx.size());
+    writer.Key("tx").BeginArray();
+    for (const auto& ptx : block.vptx)
+        writer.Write(ptx->GetHash().GetHex());
+    writer.EndArray();
+    writer.Member("time",           block.GetBlockTime());
+    writer.Member("nonce",          (uint64_t)block.GetNonce());
+
+    if (!pos.prevBlockHash.empty())
+        writer.Member("previous_block_hash", pos.prevBlockHash);
+    if (!pos.nextBlockHash.empty())
+        writer.Member("next_block_hash", pos.nextBlockHash);
+
+    writer.Key("median_price").BeginArray();
+    const auto& priceMap = block.GetBlockMedianPrice();
+    for (const auto &item : priceMap) {
+        if (item.second == 0) {
+            continue;
+        }
+
+        writer.BeginObject();
+        writer.Member("coin_symbol",    item.first.first);
+        writer.Member("price_symbol",   item.first.second);
+        writer.Member("price",          (double) item.second / PRICE_BOOST);
+        writer.EndObject();
+    }
+    writer.EndArray();
+
+    writer.EndObject();
+}
+
 Value getblockcount(const Array& params, bool fHelp) {
     if (fHelp || params.size() != 0)
         throw runtime_error(
@@ -109,6 +172,17 @@ Value getfcoingenesistxinfo(const Array& params, bool fHelp) {
     return output;
 }
 
+static Object MempoolEntryToJson(const CTxMemPoolEntry& mpe) {
+    Object info;
+    info.push_back(Pair("size",         (int) mpe.GetTxSize()));
+    info.push_back(Pair("fees_type",    std::get<0>(mpe.GetFees())));
+    info.push_back(Pair("fees",         ValueFromAmount(std::get<1>(mpe.GetFees()))));
+    info.push_back(Pair("time",         mpe.GetTime()));
+    info.push_back(Pair("height",       (int) mpe.GetHeight()));
+    info.push_back(Pair("priority",     mpe.GetPriority()));
+    return info;
+}
+
 Value getrawmempool(const Array& params, bool fHelp)
 {
     if (fHelp || params.size() > 1)
@@ -145,17 +219,7 @@ Value getrawmempool(const Array& params, bool fHelp)
         LOCK(mempool.cs);
         Object obj;
         for (const auto& entry : mempool.memPoolTxs) {
-            const uint256& hash      = entry.first;
-            const CTxMemPoolEntry& mpe = entry.second;
-            Object info;
-            info.push_back(Pair("size",         (int) mpe.GetTxSize()));
-            info.push_back(Pair("fees_type",    std::get<0>(mpe.GetFees())));
-            info.push_back(Pair("fees",         ValueFromAmount(std::get<1>(mpe.GetFees()))));
-            info.push_back(Pair("time",         mpe.GetTime()));
-            info.push_back(Pair("height",       (int) mpe.GetHeight()));
-            info.push_back(Pair("priority",     mpe.GetPriority()));
-
-            obj.push_back(Pair(hash.ToString(), info));
+            obj.push_back(Pair(entry.first.ToString(), MempoolEntryToJson(entry.second)));
         }
         return obj;
     } else {
@@ -171,6 +235,130 @@ Value getrawmempool(const Array& params, bool fHelp)
     }
 }
 
+CJsonWriter::Encoder getrawmempoolstream(const Array& params) {
+    if (params.size() > 1) {
+        Value result = getrawmempool(params, false);  // the help of the command
+        return [result](CJsonWriter& writer) { writer.Write(result); };
+    }
+
+    bool fVerbose = false;
+    if (params.size() > 0)
+        fVerbose = params[0].get_bool();
+
+    if (fVerbose) {
+        auto spEntries = std::make_shared<vector<pair<uint256, CTxMemPoolEntry>>>();
+        {
+            LOCK(mempool.cs);
+            spEntries->assign(mempool.memPoolTxs.begin(), mempool.memPoolTxs.end());
+        }
+        return [spEntries](CJsonWriter& writer) {
+            writer.BeginObject();
+            for (const auto& entry : *spEntries) {
+                writer.Member(entry.first.ToString(), MempoolEntryToJson(entry.second));
+            }
+            writer.EndObject();
+        };
+    } else {
+        auto spTxids = std::make_shared<vector<uint256>>();
+        mempool.QueryHash(*spTxids);
+
+        return [spTxids](CJsonWriter& writer) {
+            writer.BeginArray();
+            for (const auto& hash : *spTxids) {
+                writer.Write(hash.ToString());
+            }
+            writer.EndArray();
+        };
+    }
+}
+
+Value getmempoolinfo(const Array& params, bool fHelp) {
+    if (fHelp || params.size() != 0)
+        throw runtime_error(
+            "getmempoolinfo\n"
+            "\nReturns details on the state of the memory pool.\n"
+            "\nArguments:\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"size\": n,            (numeric) the count of transactions\n"
+            "  \"bytes\": n,           (numeric) the total serialized size of transactions\n"
+            "  \"usage\": n,           (numeric) the estimated memory of transactions and their access logs in bytes\n"
+            "  \"max_mempool\": n,     (numeric) the memory limit in bytes set by -maxmempool\n"
+            "  \"evicted\": n,         (numeric) the count of transactions evicted since startup\n"
+            "  \"min_fee_per_kb\": n,  (numeric) the min fee per KB in sawi of the accepted transactions\n"
+            "  \"admission\": {         (json object) the admission of the transactions received from the peers\n"
+            "    \"threads\": n,        (numeric) the admission threads set by -txadmission, 0 = on the message handler\n"
+            "    \"queue\": n,          (numeric) the count of queued transactions\n"
+            "    \"queued\": n,         (numeric) the count of transactions queued since startup\n"
+            "    \"admitted\": n,       (numeric) the count of queued transactions accepted to the memory pool\n"
+            "    \"rejected\": n,       (numeric) the count of queued transactions rejected\n"
+            "    \"duplicated\": n,     (numeric) the count of transactions queued or accepted already\n"
+            "    \"dropped\": n,        (numeric) the count of transactions dropped by the full queue\n"
+            "    \"preverified\": n     (numeric) the count of signatures verified in parallel out of cs_main\n"
+            "  }\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getmempoolinfo", "") + "\nAs json rpc\n" + HelpExampleRpc("getmempoolinfo", ""));
+
+    LOCK(mempool.cs);
+    uint64_t bytes = 0;
+    for (const auto& entry : mempool.memPoolTxs)
+        bytes += entry.second.GetTxSize();
+
+    Object obj;
+    obj.push_back(Pair("size",              (uint64_t)mempool.memPoolTxs.size()));
+    obj.push_back(Pair("bytes",             bytes));
+    obj.push_back(Pair("usage",             mempool.GetMemoryUsage()));
+    obj.push_back(Pair("max_mempool",       mempool.GetMaxMemory()));
+    obj.push_back(Pair("evicted",           mempool.GetEvictedCount()));
+    obj.push_back(Pair("min_fee_per_kb",    mempool.GetMinFeePerKb()));
+
+    CTxAdmissionQueue::Stats stats = txAdmission.GetStats();
+    Object admissionObj;
+    admissionObj.push_back(Pair("threads",      txAdmission.GetThreadCount()));
+    admissionObj.push_back(Pair("queue",        (uint64_t)txAdmission.GetQueueSize()));
+    admissionObj.push_back(Pair("queued",       stats.queued));
+    admissionObj.push_back(Pair("admitted",     stats.admitted));
+    admissionObj.push_back(Pair("rejected",     stats.rejected));
+    admissionObj.push_back(Pair("duplicated",   stats.duplicated));
+    admissionObj.push_back(Pair("dropped",      stats.dropped));
+    admissionObj.push_back(Pair("preverified",  stats.preverified));
+    obj.push_back(Pair("admission",         admissionObj));
+    return obj;
+}
+
+// Read the block of the params of getblock
+static CBlockIndex* ReadRPCBlock(const Array& params, CBlock& block, bool& fVerbose) {
+    // RPCTypeCheck(params, boost::assign::list_of(str_type)(bool_type)); disable this to allow either string or int argument
+
+    std::string strHash;
+    if (int_type == params[0].type()) {
+        int height = params[0].get_int();
+        if (height < 0 || height > chainActive.Height())
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Block height out of range.");
+
+        CBlockIndex* pBlockIndex = chainActive[height];
+        strHash                  = pBlockIndex->GetBlockHash().GetHex();
+    } else {
+        strHash = params[0].get_str();
+    }
+    uint256 hash(uint256S(strHash));
+
+    fVerbose = true;
+    if (params.size() > 1)
+        fVerbose = params[1].get_bool();
+
+    if (mapBlockIndex.count(hash) == 0)
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
+
+    CBlockIndex* pBlockIndex = mapBlockIndex[hash];
+    if (!ReadBlockFromDisk(pBlockIndex, block)) {
+        throw JSONRPCError(RPC_INTERNAL_ERROR, "Can't read block from disk");
+    }
+
+    return pBlockIndex;
+}
+
 Value getblock(const Array& params, bool fHelp) {
     if (fHelp || params.size() < 1 || params.size() > 2) {
         throw runtime_error(
@@ -208,33 +396,9 @@ Value getblock(const Array& params, bool fHelp) {
             HelpExampleRpc("getblock", "\"d640d051704155b1fd3ec8d0331497448c259b0ab0499e109da7ae2bc7423bc2\""));
     }
 
-    // RPCTypeCheck(params, boost::assign::list_of(str_type)(bool_type)); disable this to allow either string or int argument
-
-    std::string strHash;
-    if (int_type == params[0].type()) {
-        int height = params[0].get_int();
-        if (height < 0 || height > chainActive.Height())
-            throw JSONRPCError(RPC_INVALID_PARAMETER, "Block height out of range.");
-
-        CBlockIndex* pBlockIndex = chainActive[height];
-        strHash                  = pBlockIndex->GetBlockHash().GetHex();
-    } else {
-        strHash = params[0].get_str();
-    }
-    uint256 hash(uint256S(strHash));
-
-    bool fVerbose = true;
-    if (params.size() > 1)
-        fVerbose = params[1].get_bool();
-
-    if (mapBlockIndex.count(hash) == 0)
-        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
-
+    bool fVerbose;
     CBlock block;
-    CBlockIndex* pBlockIndex = mapBlockIndex[hash];
-    if (!ReadBlockFromDisk(pBlockIndex, block)) {
-        throw JSONRPCError(RPC_INTERNAL_ERROR, "Can't read block from disk");
-    }
+    CBlockIndex* pBlockIndex = ReadRPCBlock(params, block, fVerbose);
 
     if (!fVerbose) {
         CDataStream ssBlock(SER_NETWORK, PROTOCOL_VERSION);
@@ -246,6 +410,29 @@ Value getblock(const Array& params, bool fHelp) {
     return BlockToJSON(block, pBlockIndex);
 }
 
+CJsonWriter::Encoder getblockstream(const Array& params) {
+    if (params.size() < 1 || params.size() > 2) {
+        Value result = getblock(params, false);  // the help of the command
+        return [result](CJsonWriter& writer) { writer.Write(result); };
+    }
+
+    bool fVerbose;
+    auto spBlock = std::make_shared<CBlock>();
+    CBlockIndex* pBlockIndex = ReadRPCBlock(params, *spBlock, fVerbose);
+
+    if (!fVerbose) {
+        return [spBlock](CJsonWriter& writer) {
+            CDataStream ssBlock(SER_NETWORK, PROTOCOL_VERSION);
+            ssBlock << *spBlock;
+            const char* pBegin = &ssBlock.begin()[0];
+            writer.WriteHex(pBegin, pBegin + ssBlock.size());
+        };
+    }
+
+    CBlockChainPos pos = GetBlockChainPos(*spBlock, pBlockIndex);
+    return [spBlock, pos](CJsonWriter& writer) { WriteBlockJson(writer, *spBlock, pos); };
+}
+
 Value verifychain(const Array& params, bool fHelp) {
     if (fHelp || params.size() > 2) {
         throw runtime_error(
@@ -5,6 +5,7 @@
 
 #include "commons/base58.h"
 #include "config/const.h"
+#include "rpc/core/jsonwriter.h"
 #include "rpc/core/rpccommons.h"
 #include "rpc/rpcapi.h"
 #include "init.h"
@@ -12,6 +13,7 @@
 #include "commons/util/util.h"
 #include "wallet/wallet.h"
 #include "wallet/walletdb.h"
+#include "persistence/statesnapshot.h"
 #include "tx/dextx.h"
 #include "tx/dexoperatortx.h"
 
@@ -711,31 +713,82 @@ extern Value getdexsysorders(const Array& params, bool fHelp) {
     return obj;
 }
 
-extern Value getdexorders(const Array& params, bool fHelp) {
-     if (fHelp || params.size() > 4) {
+extern Value getdexorderbook(const Array& params, bool fHelp) {
+     if (fHelp || params.size() < 2 || params.size() > 4) {
         throw runtime_error(
-            "getdexorders [\"begin_height\"] [\"end_height\"] [\"max_count\"] [\"last_pos_info\"]\n"
-            "\nget dex all active orders by block height range.\n"
+            "getdexorderbook \"coin_symbol\" \"asset_symbol\" [\"max_depth\"] [\"max_count\"]\n"
+            "\nget the order book of the trading pair by the price-time priority.\n"
             "\nArguments:\n"
-            "1.\"begin_height\":    (numeric, optional) the begin block height, default is 0\n"
-            "2.\"end_height\":      (numeric, optional) the end block height, default is current tip block height\n"
-            "3.\"max_count\":       (numeric, optional) the max order count to get, default is 500\n"
-            "4.\"last_pos_info\":   (string, optional) the last position info to get more orders, default is empty\n"
+            "1.\"coin_symbol\":     (string, required) the coin symbol of the trading pair\n"
+            "2.\"asset_symbol\":    (string, required) the asset symbol of the trading pair\n"
+            "3.\"max_depth\":       (numeric, optional) the max price levels of each side, default is 20\n"
+            "4.\"max_count\":       (numeric, optional) the max orders of each side, default is 0\n"
             "\nResult:\n"
-            "\"begin_height\"       (numeric) the begin block height of returned orders.\n"
-            "\"end_height\"         (numeric) the end block height of returned orders.\n"
-            "\"has_more\"           (bool) has more orders in db.\n"
-            "\"last_pos_info\"      (string) the last position info to get more orders.\n"
-            "\"count\"              (numeric) the count of returned orders.\n"
-            "\"orders\"             (string) a list of system-generated DEX orders.\n"
+            "\"height\"             (numeric) the block height of the order book.\n"
+            "\"bids\"               (array) the price levels of the buy limit orders, the highest price first.\n"
+            "\"asks\"               (array) the price levels of the sell limit orders, the lowest price first.\n"
+            "\"buy_orders\"         (array) the buy orders in the priority of matching, the market orders first.\n"
+            "\"sell_orders\"        (array) the sell orders in the priority of matching, the market orders first.\n"
             "\nExamples:\n"
-            + HelpExampleCli("getdexorders", "0 100 500")
+            + HelpExampleCli("getdexorderbook", "\"WUSD\" \"GVC\" 20 100")
             + "\nAs json rpc call\n"
-            + HelpExampleRpc("getdexorders", "0, 100, 500")
+            + HelpExampleRpc("getdexorderbook", "\"WUSD\", \"GVC\", 20, 100")
         );
     }
 
-    int64_t tipHeight = chainActive.Height();
+    const TokenSymbol &coinSymbol  = RPC_PARAM::GetOrderCoinSymbol(params[0]);
+    const TokenSymbol &assetSymbol = RPC_PARAM::GetOrderAssetSymbol(params[1]);
+    if (coinSymbol.empty() || coinSymbol.size() > MAX_TOKEN_SYMBOL_LEN)
+        throw JSONRPCError(RPC_INVALID_PARAMS, strprintf("invalid coin_symbol=%s", coinSymbol));
+    if (assetSymbol.empty() || assetSymbol.size() > MAX_TOKEN_SYMBOL_LEN)
+        throw JSONRPCError(RPC_INVALID_PARAMS, strprintf("invalid asset_symbol=%s", assetSymbol));
+
+    int64_t maxDepth = 20;
+    if (params.size() > 2) {
+        maxDepth = params[2].get_int64();
+        if (maxDepth < 0 || maxDepth > 1000)
+            throw JSONRPCError(RPC_INVALID_PARAMS, strprintf("max_depth=%d must >= 0 and <= 1000", maxDepth));
+    }
+
+    int64_t maxCount = 0;
+    if (params.size() > 3) {
+        maxCount = params[3].get_int64();
+        if (maxCount < 0 || maxCount > 1000)
+            throw JSONRPCError(RPC_INVALID_PARAMS, strprintf("max_count=%d must >= 0 and <= 1000", maxCount));
+    }
+
+    CStateView &view = GetRPCStateView();
+    auto pBuyGetter  = view.pDexCache->CreateOrderBookGetter();
+    auto pSellGetter = view.pDexCache->CreateOrderBookGetter();
+    if (!pBuyGetter->Execute(CDEXOrderBookSide(coinSymbol, assetSymbol, ORDER_BUY), maxDepth, maxCount) ||
+        !pSellGetter->Execute(CDEXOrderBookSide(coinSymbol, assetSymbol, ORDER_SELL), maxDepth, maxCount)) {
+        throw JSONRPCError(RPC_INVALID_PARAMS, strprintf("get the order book error! coin_symbol=%s, asset_symbol=%s",
+            coinSymbol, assetSymbol));
+    }
+
+    Object obj;
+    obj.push_back(Pair("coin_symbol",   coinSymbol));
+    obj.push_back(Pair("asset_symbol",  assetSymbol));
+    obj.push_back(Pair("height",        (int64_t)view.GetHeight()));
+    Array bids, asks;
+    pBuyGetter->LevelsToJson(bids);
+    pSellGetter->LevelsToJson(asks);
+    obj.push_back(Pair("bids",          bids));
+    obj.push_back(Pair("asks",          asks));
+    if (maxCount > 0) {
+        Array buyOrders, sellOrders;
+        pBuyGetter->OrdersToJson(buyOrders);
+        pSellGetter->OrdersToJson(sellOrders);
+        obj.push_back(Pair("buy_orders",    buyOrders));
+        obj.push_back(Pair("sell_orders",   sellOrders));
+    }
+    return obj;
+}
+
+// Get the orders of the params of getdexorders from the chain state of the read-only handler
+static shared_ptr<CDEXOrdersGetter> GetDexOrders(const Array& params, string &newLastPosInfo) {
+    CStateView &view = GetRPCStateView();
+    int64_t tipHeight = view.GetHeight();
     int64_t beginHeight = 0;
     if (params.size() > 0)
         beginHeight = params[0].get_int64();
@@ -762,7 +815,7 @@ extern Value getdexorders(const Array& params, bool fHelp) {
     DEXBlockOrdersCache::KeyType lastKey;
     if (params.size() > 3) {
         string lastPosInfo = RPC_PARAM::GetBinStrFromHex(params[3], "last_pos_info");
-        auto err = DEX_DB::ParseLastPos(lastPosInfo, lastKey);
+        shared_ptr<string> err = DEX_DB::ParseLastPos(view, lastPosInfo, lastKey);
         if (err)
             throw JSONRPCError(RPC_INVALID_PARAMS, strprintf("Invalid last_pos_info! %s", *err));
         uint32_t lastHeight = DEX_DB::GetHeight(lastKey);
@@ -773,18 +826,46 @@ extern Value getdexorders(const Array& params, bool fHelp) {
                                          beginHeight, endHeight));
     }
 
-    auto pGetter = pCdMan->pDexCache->CreateOrdersGetter();
+    auto pGetter = view.pDexCache->CreateOrdersGetter();
     if (!pGetter->Execute(beginHeight, endHeight, maxCount, lastKey)) {
         throw JSONRPCError(RPC_INVALID_PARAMS, strprintf("get all active orders error! begin_height=%d, end_height=%d",
             beginHeight, endHeight));
     }
 
-    string newLastPosInfo;
     if (pGetter->has_more) {
-        auto err = DEX_DB::MakeLastPos(pGetter->last_key, newLastPosInfo);
+        shared_ptr<string> err = DEX_DB::MakeLastPos(view, pGetter->last_key, newLastPosInfo);
         if (err)
             throw JSONRPCError(RPC_INVALID_PARAMS, strprintf("Make new last_pos_info error! %s", *err));
     }
+    return pGetter;
+}
+
+extern Value getdexorders(const Array& params, bool fHelp) {
+     if (fHelp || params.size() > 4) {
+        throw runtime_error(
+            "getdexorders [\"begin_height\"] [\"end_height\"] [\"max_count\"] [\"last_pos_info\"]\n"
+            "\nget dex all active orders by block height range.\n"
+            "\nArguments:\n"
+            "1.\"begin_height\":    (numeric, optional) the begin block height, default is 0\n"
+            "2.\"end_height\":      (numeric, optional) the end block height, default is current tip block height\n"
+            "3.\"max_count\":       (numeric, optional) the max order count to get, default is 500\n"
+            "4.\"last_pos_info\":   (string, optional) the last position info to get more orders, default is empty\n"
+            "\nResult:\n"
+            "\"begin_height\"       (numeric) the begin block height of returned orders.\n"
+            "\"end_height\"         (numeric) the end block height of returned orders.\n"
+            "\"has_more\"           (bool) has more orders in db.\n"
+            "\"last_pos_info\"      (string) the last position info to get more orders.\n"
+            "\"count\"              (numeric) the count of returned orders.\n"
+            "\"orders\"             (string) a list of system-generated DEX orders.\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getdexorders", "0 100 500")
+            + "\nAs json rpc call\n"
+            + HelpExampleRpc("getdexorders", "0, 100, 500")
+        );
+    }
+
+    string newLastPosInfo;
+    auto pGetter = GetDexOrders(params, newLastPosInfo);
     Object obj;
     obj.push_back(Pair("begin_height", (int64_t)pGetter->begin_height));
     obj.push_back(Pair("end_height", (int64_t)pGetter->end_height));
@@ -794,6 +875,38 @@ extern Value getdexorders(const Array& params, bool fHelp) {
     return obj;
 }
 
+CJsonWriter::Encoder getdexordersstream(const Array& params) {
+    if (params.size() > 4) {
+        Value result = getdexorders(params, false);  // the help of the command
+        return [result](CJsonWriter &writer) { writer.Write(result); };
+    }
+
+    string newLastPosInfo;
+    auto pGetter = GetDexOrders(params, newLastPosInfo);
+
+    // the same json as getdexorders, the orders are written one by one out of the caches of the state view
+    auto spOrders        = std::make_shared<DEX_DB::BlockOrders>(std::move(pGetter->orders));
+    int64_t beginHeight  = pGetter->begin_height;
+    int64_t endHeight    = pGetter->end_height;
+    bool hasMore         = pGetter->has_more;
+    return [spOrders, beginHeight, endHeight, hasMore, newLastPosInfo](CJsonWriter &writer) {
+        writer.BeginObject();
+        writer.Member("begin_height", beginHeight);
+        writer.Member("end_height", endHeight);
+        writer.Member("has_more", hasMore);
+        writer.Member("last_pos_info", HexStr(newLastPosInfo));
+        writer.Member("count", (int64_t)spOrders->size());
+        writer.Key("orders").BeginArray();
+        for (auto &item : *spOrders) {
+            Object objItem;
+            DEX_DB::OrderToJson(DEX_DB::GetOrderId(item.first), item.second, objItem);
+            writer.Write(objItem);
+        }
+        writer.EndArray();
+        writer.EndObject();
+    };
+}
+
 
 void checkAccountRegId(const CUserID uid , const string field){
 
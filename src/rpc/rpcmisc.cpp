@@ -234,6 +234,8 @@ Value verifymessage(const Array& params, bool fHelp) {
     /**** dex db                                                                    */ \
     DEFINE( DEX_ACTIVE_ORDER,     pDexCache, activeOrderCache) \
     DEFINE( DEX_BLOCK_ORDERS,     pDexCache, blockOrdersCache) \
+    DEFINE( DEX_ORDER_BOOK,       pDexCache, orderBookCache) \
+    DEFINE( DEX_PRICE_LEVELS,     pDexCache, priceLevelsCache) \
     DEFINE( DEX_OPERATOR_LAST_ID, pDexCache, operator_last_id_cache) \
     DEFINE( DEX_OPERATOR_DETAIL,  pDexCache, operator_detail_cache) \
     DEFINE( DEX_OPERATOR_OWNER_MAP, pDexCache, operator_owner_map_cache) \
@@ -242,6 +244,7 @@ Value verifymessage(const Array& params, bool fHelp) {
     DEFINE( MEDIAN_PRICES,        pPriceFeedCache, medianPricesCache) \
     DEFINE( PRICE_FEED_COIN,      pPriceFeedCache,price_feed_coin_cache) \
     DEFINE( PRICE_FEEDERS,        pPriceFeedCache,price_feeders_cache)  \
+    DEFINE( PRICE_POINT_SNAPSHOT, pPriceFeedCache, pricePointSnapshotCache) \
     /**** log db                                                                    */ \
     DEFINE( TX_EXECUTE_FAIL,      pLogCache,  executeFailCache ) \
     /**** tx receipt db                                                                    */ \
@@ -359,3 +362,73 @@ Value dumpdb(const Array& params, bool fHelp) {
 
     return Object();
 }
+
+Value getsigcacheinfo(const Array& params, bool fHelp) {
+    if (fHelp || params.size() != 0)
+        throw runtime_error(
+            "getsigcacheinfo\n"
+            "\nget the signature cache stats\n"
+            "\nArguments:\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"max_size\": n,       (numeric) the max entry count allowed by -maxsigcachesize\n"
+            "  \"size\": n,           (numeric) the current entry count\n"
+            "  \"hits\": n,           (numeric) the count of lookups found in cache\n"
+            "  \"misses\": n,         (numeric) the count of lookups not found in cache\n"
+            "  \"inserts\": n,        (numeric) the count of inserted entries\n"
+            "  \"evictions\": n       (numeric) the count of evicted entries\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getsigcacheinfo", "") + "\nAs json rpc\n" + HelpExampleRpc("getsigcacheinfo", "")
+        );
+
+    CSignatureCache::Stats stats = signatureCache.GetStats();
+    Object obj;
+    obj.push_back(Pair("max_size",  stats.max_size));
+    obj.push_back(Pair("size",      stats.size));
+    obj.push_back(Pair("hits",      stats.hits));
+    obj.push_back(Pair("misses",    stats.misses));
+    obj.push_back(Pair("inserts",   stats.inserts));
+    obj.push_back(Pair("evictions", stats.evictions));
+    return obj;
+}
+
+Value getdbinfo(const Array& params, bool fHelp) {
+    if (fHelp || params.size() != 0)
+        throw runtime_error(
+            "getdbinfo\n"
+            "\nget the storage info of each db name type\n"
+            "\nArguments:\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"single_db\": true|false,     (boolean) whether all of the db name types are stored in one db\n"
+            "  \"pending_sync_count\": n,     (numeric) the count of the flushes which are not synced to disk yet\n"
+            "  \"dbs\": [\n"
+            "    {\n"
+            "      \"name\": \"xxx\",           (string) the db name\n"
+            "      \"cache_size\": n,         (numeric) the configured leveldb cache size in bytes\n"
+            "      \"disk_size\": n           (numeric) the approximate disk size in bytes\n"
+            "    }, ...\n"
+            "  ]\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getdbinfo", "") + "\nAs json rpc\n" + HelpExampleRpc("getdbinfo", "")
+        );
+
+    Array dbs;
+    for (auto pDbAccess : pCdMan->GetDbAccessList()) {
+        DBNameType dbNameType = pDbAccess->GetDbNameType();
+        Object obj;
+        obj.push_back(Pair("name",          GetDbName(dbNameType)));
+        obj.push_back(Pair("cache_size",    DBCacheSize[dbNameType]));
+        obj.push_back(Pair("disk_size",     pDbAccess->GetApproximateSize()));
+        dbs.push_back(obj);
+    }
+
+    Object obj;
+    obj.push_back(Pair("single_db", pCdMan->IsSingleDb()));
+    if (pCdMan->GetFlusher())
+        obj.push_back(Pair("pending_sync_count", (uint64_t)pCdMan->GetFlusher()->GetPendingCount()));
+    obj.push_back(Pair("dbs",       dbs));
+    return obj;
+}
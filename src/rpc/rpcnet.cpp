@@ -8,6 +8,7 @@
 #include "main.h"
 #include "net.h"
 #include "netbase.h"
+#include "p2p/blockencodings.h"
 #include "p2p/protocol.h"
 #include "sync.h"
 #include "commons/util/util.h"
@@ -90,6 +91,8 @@ Value getpeerinfo(const Array& params, bool fHelp) {
             "    \"inbound\": true|false,     (boolean) Inbound (true) or Outbound (false)\n"
             "    \"startingheight\": n,       (numeric) The starting height (block) of the peer\n"
             "    \"banscore\": n,             (numeric) The ban score (stats.nMisbehavior)\n"
+            "    \"blocksinflight\": n,       (numeric) The number of blocks downloading from the peer\n"
+            "    \"downloadrate\": x.xx,      (numeric) The blocks per second downloaded from the peer\n"
             "    \"syncnode\" : true|false    (boolean) if sync node\n"
             "  }\n"
             "  ,...\n"
@@ -134,6 +137,8 @@ Value getpeerinfo(const Array& params, bool fHelp) {
 
         if (fStateStats) {
             obj.push_back(Pair("banscore",  statestats.nMisbehavior));
+            obj.push_back(Pair("blocksinflight", statestats.nBlocksInFlight));
+            obj.push_back(Pair("downloadrate", statestats.downloadRate));
         }
 
         obj.push_back(Pair("syncnode",      stats.fSyncNode));
@@ -308,7 +313,17 @@ Value getnettotals(const Array& params, bool fHelp) {
             "{\n"
             "  \"totalbytesrecv\": n,   (numeric) Total bytes received\n"
             "  \"totalbytessent\": n,   (numeric) Total bytes sent\n"
-            "  \"timemillis\": t        (numeric) Total cpu time\n"
+            "  \"timemillis\": t,       (numeric) Total cpu time\n"
+            "  \"compactblocks\": {     (json object) the reconstruction stats of the received compact blocks\n"
+            "    \"received\": n,       (numeric) compact blocks received\n"
+            "    \"reconstructed\": n,  (numeric) blocks reconstructed without the round trip\n"
+            "    \"round_trips\": n,    (numeric) blocks waiting for the missing txs by getblocktxn\n"
+            "    \"failed\": n,         (numeric) blocks failed to reconstruct, requested in full\n"
+            "    \"prefilled_txs\": n,  (numeric) txs prefilled in the compact blocks\n"
+            "    \"mempool_txs\": n,    (numeric) txs found in the mempool\n"
+            "    \"missing_txs\": n,    (numeric) txs requested by getblocktxn\n"
+            "    \"hit_rate\": x.xx     (numeric) the ratio of the txs found in the mempool to the relayed txs\n"
+            "  }\n"
             "}\n"
             "\nExamples:\n" +
             HelpExampleCli("getnettotals", "") + "\nAs json rpc\n" + HelpExampleRpc("getnettotals", ""));
@@ -317,6 +332,20 @@ Value getnettotals(const Array& params, bool fHelp) {
     obj.push_back(Pair("totalbytesrecv",    CNode::GetTotalBytesRecv()));
     obj.push_back(Pair("totalbytessent",    CNode::GetTotalBytesSent()));
     obj.push_back(Pair("timemillis",        GetTimeMillis()));
+
+    uint64_t mempoolTxs = compactBlockStats.mempoolTxs;
+    uint64_t missingTxs = compactBlockStats.missingTxs;
+    Object cmpctObj;
+    cmpctObj.push_back(Pair("received",         compactBlockStats.received.load()));
+    cmpctObj.push_back(Pair("reconstructed",    compactBlockStats.reconstructed.load()));
+    cmpctObj.push_back(Pair("round_trips",      compactBlockStats.roundTrips.load()));
+    cmpctObj.push_back(Pair("failed",           compactBlockStats.failed.load()));
+    cmpctObj.push_back(Pair("prefilled_txs",    compactBlockStats.prefilledTxs.load()));
+    cmpctObj.push_back(Pair("mempool_txs",      mempoolTxs));
+    cmpctObj.push_back(Pair("missing_txs",      missingTxs));
+    cmpctObj.push_back(Pair("hit_rate",         mempoolTxs + missingTxs == 0 ? 0.0 :
+                                                (double)mempoolTxs / (mempoolTxs + missingTxs)));
+    obj.push_back(Pair("compactblocks",     cmpctObj));
     return obj;
 }
 
@@ -13,6 +13,7 @@
 #include "commons/util/util.h"
 #include "wallet/wallet.h"
 #include "wallet/walletdb.h"
+#include "persistence/statesnapshot.h"
 #include "tx/cdptx.h"
 #include "tx/pricefeedtx.h"
 #include "tx/assettx.h"
@@ -406,22 +407,23 @@ Value getusercdp(const Array& params, bool fHelp){
         );
     }
 
-    auto pUserId = CUserID::ParseUserId(params[0].get_str());
+    CStateView &view = GetRPCStateView();
+    auto pUserId = CUserID::ParseUserId(params[0].get_str(), *view.pAccountCache);
     if (!pUserId) {
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid addr");
     }
 
     CAccount account;
-    if (!pCdMan->pAccountCache->GetAccount(*pUserId, account)) {
+    if (!view.pAccountCache->GetAccount(*pUserId, account)) {
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, strprintf("The account not exists! userId=%s", pUserId->ToString()));
     }
 
-    uint64_t bcoinMedianPrice = pCdMan->pPriceFeedCache->GetMedianPrice(CoinPricePair(SYMB::GVC, SYMB::USD));
+    uint64_t bcoinMedianPrice = view.pPriceFeedCache->GetMedianPrice(CoinPricePair(SYMB::GVC, SYMB::USD));
 
     Object obj;
     Array cdps;
     vector<CUserCDP> userCdps;
-    if (pCdMan->pCdpCache->GetCDPList(account.regid, userCdps)) {
+    if (view.pCdpCache->GetCDPList(account.regid, userCdps)) {
         for (auto& cdp : userCdps) {
             cdps.push_back(cdp.ToJson(bcoinMedianPrice));
         }
@@ -13,6 +13,7 @@
 #include "wallet/wallet.h"
 #include "wallet/walletdb.h"
 #include "persistence/blockdb.h"
+#include "persistence/statesnapshot.h"
 #include "persistence/txdb.h"
 #include "config/configuration.h"
 #include "miner/miner.h"
@@ -803,12 +804,14 @@ Value getaccountinfo(const Array& params, bool fHelp) {
     }
 
     RPCTypeCheck(params, list_of(str_type));
-    CKeyID keyid = RPC_PARAM::GetKeyId(params[0]);
+    CStateView &view = GetRPCStateView();
+    CKeyID keyid = RPC_PARAM::GetKeyId(params[0], *view.pAccountCache);
     CUserID userId = keyid;
     Object obj;
     CAccount account;
-    if (pCdMan->pAccountCache->GetAccount(userId, account)) {
+    if (view.pAccountCache->GetAccount(userId, account)) {
         if (!account.owner_pubkey.IsValid()) {
+            LOCK(pWalletMain->cs_wallet);
             CPubKey pubKey;
             CPubKey minerPubKey;
             if (pWalletMain->GetPubKey(keyid, pubKey)) {
@@ -820,14 +823,14 @@ Value getaccountinfo(const Array& params, bool fHelp) {
                 }
             }
         }
-        obj = account.ToJsonObj();
+        obj = account.ToJsonObj(*view.pDelegateCache, view.GetHeight());
         obj.push_back(Pair("registered", true));
 
         // TODO: multi stable coin
-        uint64_t bcoinMedianPrice = pCdMan->pPriceFeedCache->GetMedianPrice(CoinPricePair(SYMB::GVC, SYMB::USD));
+        uint64_t bcoinMedianPrice = view.pPriceFeedCache->GetMedianPrice(CoinPricePair(SYMB::GVC, SYMB::USD));
         Array cdps;
         vector<CUserCDP> userCdps;
-        if (pCdMan->pCdpCache->GetCDPList(account.regid, userCdps)) {
+        if (view.pCdpCache->GetCDPList(account.regid, userCdps)) {
             for (auto& cdp : userCdps) {
                 cdps.push_back(cdp.ToJson(bcoinMedianPrice));
             }
@@ -838,6 +841,8 @@ Value getaccountinfo(const Array& params, bool fHelp) {
          obj.push_back(Pair("registered", false));
     }
 
+    // the read-only handler runs without cs_main, the wallet is locked by itself
+    LOCK(pWalletMain->cs_wallet);
     CPubKey pubKey;
     CPubKey minerPubKey;
     if (pWalletMain->GetPubKey(keyid, pubKey)) {
@@ -847,7 +852,7 @@ Value getaccountinfo(const Array& params, bool fHelp) {
         if (minerPubKey != pubKey)
             account.miner_pubkey = minerPubKey;
 
-        obj = account.ToJsonObj();
+        obj = account.ToJsonObj(*view.pDelegateCache, view.GetHeight());
         obj.push_back(Pair("in_wallet", true));
 
     } else {
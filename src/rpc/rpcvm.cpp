@@ -17,6 +17,7 @@
 #include "config/configuration.h"
 #include "main.h"
 #include "vm/luavm/luavmrunenv.h"
+#include "vm/wasm/wasm_module_cache.hpp"
 #include <algorithm>
 
 #include "commons/json/json_spirit_utils.h"
@@ -243,3 +244,74 @@ Value vmexecutescript(const Array& params, bool fHelp) {
 
     return retObj;
 }
+
+Value getvmcacheinfo(const Array& params, bool fHelp) {
+    if (fHelp || params.size() != 0)
+        throw runtime_error(
+            "getvmcacheinfo\n"
+            "\nget the stats of the vm caches\n"
+            "\nArguments:\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"lua_code_cache\": {      (object) the compiled lua contract chunks\n"
+            "    \"max_memory\": n,       (numeric) the memory limit in bytes set by -luacodecachesize\n"
+            "    \"memory\": n,           (numeric) the memory used in bytes\n"
+            "    \"count\": n,            (numeric) the count of cached contracts\n"
+            "    \"hits\": n,             (numeric) the count of lookups found in cache\n"
+            "    \"misses\": n,           (numeric) the count of lookups not found in cache\n"
+            "    \"evictions\": n         (numeric) the count of evicted contracts\n"
+            "  },\n"
+            "  \"lua_state_pool\": {      (object) the prepared lua states of mempool execution\n"
+            "    \"max_size\": n,         (numeric) the count of prepared states set by -luastatepoolsize\n"
+            "    \"prepared\": n,         (numeric) the count of states ready to acquire\n"
+            "    \"created\": n,          (numeric) the count of created states\n"
+            "    \"acquired\": n,         (numeric) the count of acquired states\n"
+            "    \"missed\": n            (numeric) the count of executions without prepared state\n"
+            "  },\n"
+            "  \"wasm_module_cache\": {   (object) the instantiated wasm modules\n"
+            "    \"max_memory\": n,       (numeric) the memory limit in bytes set by -wasmcachesize\n"
+            "    \"memory\": n,           (numeric) the memory used in bytes, estimated by code size\n"
+            "    \"count\": n,            (numeric) the count of cached modules\n"
+            "    \"hits\": n,             (numeric) the count of lookups found in cache\n"
+            "    \"misses\": n,           (numeric) the count of lookups not found in cache\n"
+            "    \"evictions\": n,        (numeric) the count of evicted modules\n"
+            "    \"instantiation_time\": n (numeric) the total time of instantiating modules in microseconds\n"
+            "  }\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getvmcacheinfo", "") + "\nAs json rpc\n" + HelpExampleRpc("getvmcacheinfo", "")
+        );
+
+    CLuaCodeCache::Stats luaStats = luaCodeCache.GetStats();
+    Object luaObj;
+    luaObj.push_back(Pair("max_memory", luaStats.max_memory));
+    luaObj.push_back(Pair("memory",     luaStats.memory));
+    luaObj.push_back(Pair("count",      luaStats.count));
+    luaObj.push_back(Pair("hits",       luaStats.hits));
+    luaObj.push_back(Pair("misses",     luaStats.misses));
+    luaObj.push_back(Pair("evictions",  luaStats.evictions));
+
+    CLuaStatePool::Stats poolStats = luaStatePool.GetStats();
+    Object poolObj;
+    poolObj.push_back(Pair("max_size",  (uint64_t)poolStats.max_size));
+    poolObj.push_back(Pair("prepared",  (uint64_t)poolStats.prepared));
+    poolObj.push_back(Pair("created",   poolStats.created));
+    poolObj.push_back(Pair("acquired",  poolStats.acquired));
+    poolObj.push_back(Pair("missed",    poolStats.missed));
+
+    Object obj;
+    obj.push_back(Pair("lua_code_cache", luaObj));
+    obj.push_back(Pair("lua_state_pool", poolObj));
+
+    wasm::wasm_module_cache::stats wasmStats = wasm::get_wasm_module_cache().get_stats();
+    Object wasmObj;
+    wasmObj.push_back(Pair("max_memory",         wasmStats.max_memory));
+    wasmObj.push_back(Pair("memory",             wasmStats.memory));
+    wasmObj.push_back(Pair("count",              wasmStats.count));
+    wasmObj.push_back(Pair("hits",               wasmStats.hits));
+    wasmObj.push_back(Pair("misses",             wasmStats.misses));
+    wasmObj.push_back(Pair("evictions",          wasmStats.evictions));
+    wasmObj.push_back(Pair("instantiation_time", wasmStats.instantiation_time_us));
+    obj.push_back(Pair("wasm_module_cache", wasmObj));
+    return obj;
+}
@@ -6,6 +6,8 @@
 
 #include "sigcache.h"
 
+#include <mutex>
+
 void CSignatureCache::ComputeEntry(uint256& entry, const uint256& sigHash,
                                    const std::vector<unsigned char>& vchSig,
                                    const CPubKey& pubKey) {
@@ -16,35 +18,70 @@ void CSignatureCache::ComputeEntry(uint256& entry, const uint256& sigHash,
         .Finalize(entry.begin());
 }
 
+void CSignatureCache::SetMaxMemory(uint64_t maxBytes) {
+    // two generations per shard
+    maxGenerationSize = maxBytes / ENTRY_MEMORY_SIZE / SHARD_COUNT / 2;
+
+    for (auto& shard : shards) {
+        std::unique_lock<std::shared_mutex> lock(shard.mtx);
+        if (shard.current.size() > maxGenerationSize || shard.previous.size() > maxGenerationSize) {
+            evictions += shard.current.size() + shard.previous.size();
+            shard.current.clear();
+            shard.previous.clear();
+        }
+    }
+}
+
 bool CSignatureCache::Get(const uint256& sigHash, const std::vector<unsigned char>& vchSig,
                           const CPubKey& pubKey) {
     uint256 entry;
     ComputeEntry(entry, sigHash, vchSig, pubKey);
-    std::unique_lock<std::mutex> lock(mtx);
-    return setValid.count(entry);
+
+    Shard& shard = GetShard(entry);
+    bool found;
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mtx);
+        found = shard.current.count(entry) || shard.previous.count(entry);
+    }
+    (found ? hits : misses).fetch_add(1, std::memory_order_relaxed);
+    return found;
 }
 
 void CSignatureCache::Set(const uint256& sigHash, const std::vector<unsigned char>& vchSig,
                           const CPubKey& pubKey) {
-    static int64_t nMaxCacheSize = SysCfg().GetArg("-maxsigcachesize", 50000);
-    if (nMaxCacheSize <= 0) return;
+    uint64_t maxSize = maxGenerationSize;
+    if (maxSize == 0) return;
 
     uint256 entry;
     ComputeEntry(entry, sigHash, vchSig, pubKey);
 
-    std::unique_lock<std::mutex> lock(mtx);
-
-    while (static_cast<int64_t>(setValid.size()) > nMaxCacheSize) {
-        // Evict a random entry. Random because that helps
-        // foil would-be DoS attackers who might try to pre-generate
-        // and re-use a set of valid signatures just-slightly-greater
-        // than our cache size.
-        UnorderedHashSet::size_type s       = GetRand(setValid.bucket_count());
-        UnorderedHashSet::local_iterator it = setValid.begin(s);
-        if (it != setValid.end(s)) {
-            setValid.erase(*it);
-        }
+    Shard& shard = GetShard(entry);
+    std::unique_lock<std::shared_mutex> lock(shard.mtx);
+    if (shard.previous.count(entry))
+        return;
+
+    if (shard.current.size() >= maxSize) {
+        // Drop the oldest generation as a whole instead of evicting entry by entry, the
+        // entries of the previous generation are still hits until they are dropped.
+        evictions.fetch_add(shard.previous.size(), std::memory_order_relaxed);
+        shard.previous.clear();
+        shard.current.swap(shard.previous);
     }
 
-    setValid.insert(entry);
+    if (shard.current.insert(entry).second)
+        inserts.fetch_add(1, std::memory_order_relaxed);
+}
+
+CSignatureCache::Stats CSignatureCache::GetStats() const {
+    Stats stats;
+    stats.max_size = maxGenerationSize * 2 * SHARD_COUNT;
+    for (const auto& shard : shards) {
+        std::shared_lock<std::shared_mutex> lock(shard.mtx);
+        stats.size += shard.current.size() + shard.previous.size();
+    }
+    stats.hits      = hits;
+    stats.misses    = misses;
+    stats.inserts   = inserts;
+    stats.evictions = evictions;
+    return stats;
 }
@@ -7,7 +7,8 @@
 #ifndef COIN_SIGCACHE_H
 #define COIN_SIGCACHE_H
 
-#include <mutex>
+#include <atomic>
+#include <shared_mutex>
 #include <vector>
 
 #include "config/chainparams.h"
@@ -17,28 +18,71 @@
 #include "commons/uint256.h"
 #include "commons/util/util.h"
 
+static const int64_t DEFAULT_MAX_SIG_CACHE_SIZE = 32;    // MiB
+static const int64_t MAX_MAX_SIG_CACHE_SIZE     = 16384; // MiB
+
 /**
  * Valid signature cache, to avoid doing expensive ECDSA signature checking
  * twice for every transaction (once when accepted into memory pool, and
  * again when accepted into the block chain)
+ *
+ * The entries are spread over shards by hash, each shard has its own read/write lock, so the
+ * lookups only take a shared lock and do not block each other.
+ * Each shard keeps two generations, the new entries are added to the current generation, when it
+ * is full the previous generation is dropped and the current one becomes the previous, so the
+ * memory is bounded by the -maxsigcachesize budget.
  */
 class CSignatureCache {
+public:
+    static const uint32_t SHARD_COUNT = 32;
+    // approximate memory of one entry in unordered set: node (next pointer + value) + bucket
+    static const uint64_t ENTRY_MEMORY_SIZE = sizeof(void*) + sizeof(uint256) + sizeof(void*);
+
+    struct Stats {
+        uint64_t max_size   = 0;  // max entry count
+        uint64_t size       = 0;
+        uint64_t hits       = 0;
+        uint64_t misses     = 0;
+        uint64_t inserts    = 0;
+        uint64_t evictions  = 0;
+    };
+
 private:
-    //! Entries are SHA256(signature hash || public key || signature):
-    UnorderedHashSet setValid;
-    std::mutex mtx;
+    struct Shard {
+        mutable std::shared_mutex mtx;
+        //! Entries are SHA256(signature hash || public key || signature):
+        UnorderedHashSet current;
+        UnorderedHashSet previous;
+    };
+
+    Shard shards[SHARD_COUNT];
+    std::atomic<uint64_t> maxGenerationSize{0};  // max entry count of one generation of a shard, 0 = disabled
+
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> inserts{0};
+    std::atomic<uint64_t> evictions{0};
 
 public:
-    CSignatureCache() {}
+    CSignatureCache() { SetMaxMemory(DEFAULT_MAX_SIG_CACHE_SIZE << 20); }
     ~CSignatureCache() {}
+
+    // set the memory budget in bytes, 0 disables the cache
+    void SetMaxMemory(uint64_t maxBytes);
+
     bool Get(const uint256& sigHash, const std::vector<unsigned char>& vchSig,
              const CPubKey& pubKey);
     void Set(const uint256& sigHash, const std::vector<unsigned char>& vchSig,
              const CPubKey& pubKey);
 
+    Stats GetStats() const;
+
 private:
     void ComputeEntry(uint256& entry, const uint256& sigHash,
                       const std::vector<unsigned char>& vchSig, const CPubKey& pubKey);
+
+    // the low bytes are used by the hasher of the set, so select the shard by the last byte
+    Shard& GetShard(const uint256& entry) { return shards[*(entry.end() - 1) % SHARD_COUNT]; }
 };
 
 #endif  // COIN_SIGCACHE_H
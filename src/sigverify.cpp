@@ -0,0 +1,100 @@
+// Copyright (c) 2017-2019 The GreenVenturesChain Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "sigverify.h"
+
+#include "main.h"
+
+CSigVerifyPool sigVerifyPool;
+
+void CSigVerifyPool::Start(int32_t threadCount) {
+    Stop();
+
+    if (threadCount <= 0)
+        threadCount = std::thread::hardware_concurrency();
+    threadCount = std::max(1, std::min(threadCount, MAX_SIG_VERIFY_THREADS));
+
+    {
+        STD_LOCK(cs);
+        running = true;
+    }
+    for (int32_t i = 1; i < threadCount; i++)
+        workers.emplace_back(&CSigVerifyPool::WorkerLoop, this);
+
+    LogPrint(BCLog::INFO, "Using %d threads for signature verification\n", threadCount);
+}
+
+void CSigVerifyPool::Stop() {
+    {
+        STD_LOCK(cs);
+        running = false;
+        cond.notify_all();
+    }
+    for (auto &worker : workers)
+        worker.join();
+    workers.clear();
+}
+
+uint32_t CSigVerifyPool::VerifyAndCache(const std::vector<CSigVerifyItem> &items) {
+    if (items.empty())
+        return 0;
+
+    STD_LOCK(csBatch);
+    nextIndex  = 0;
+    validCount = 0;
+    {
+        STD_LOCK(cs);
+        pItems = &items;
+        batchId++;
+        cond.notify_all();
+    }
+
+    ProcessItems(items);
+
+    {
+        STD_WAIT_LOCK(cs, lock);
+        while (activeCount > 0)
+            doneCond.wait(lock);
+        pItems = nullptr;
+    }
+    return validCount;
+}
+
+void CSigVerifyPool::WorkerLoop() {
+    RenameThread("coin-sigverify");
+
+    uint64_t lastBatchId = 0;
+    while (true) {
+        const std::vector<CSigVerifyItem> *pBatchItems = nullptr;
+        {
+            STD_WAIT_LOCK(cs, lock);
+            while (running && (pItems == nullptr || batchId == lastBatchId))
+                cond.wait(lock);
+            if (!running)
+                return;
+
+            lastBatchId = batchId;
+            pBatchItems = pItems;
+            activeCount++;
+        }
+
+        ProcessItems(*pBatchItems);
+
+        {
+            STD_LOCK(cs);
+            if (--activeCount == 0)
+                doneCond.notify_all();
+        }
+    }
+}
+
+void CSigVerifyPool::ProcessItems(const std::vector<CSigVerifyItem> &items) {
+    size_t index;
+    while ((index = nextIndex++) < items.size()) {
+        const CSigVerifyItem &item = items[index];
+        // VerifySignature() adds the valid signature to signature cache
+        if (::VerifySignature(item.sigHash, *item.pSignature, item.pubKey))
+            validCount++;
+    }
+}
@@ -0,0 +1,71 @@
+// Copyright (c) 2017-2019 The GreenVenturesChain Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef COIN_SIGVERIFY_H
+#define COIN_SIGVERIFY_H
+
+#include <atomic>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+
+#include "entities/key.h"
+#include "commons/uint256.h"
+#include "sync.h"
+
+static const int32_t MAX_SIG_VERIFY_THREADS     = 16;
+static const int32_t DEFAULT_SIG_VERIFY_THREADS = 0;  // 0 = auto
+
+struct CSigVerifyItem {
+    uint256 sigHash;
+    const std::vector<uint8_t> *pSignature;
+    CPubKey pubKey;
+
+    CSigVerifyItem(const uint256 &sigHashIn, const std::vector<uint8_t> *pSignatureIn, const CPubKey &pubKeyIn)
+        : sigHash(sigHashIn), pSignature(pSignatureIn), pubKey(pubKeyIn) {}
+};
+
+/**
+ * Verify signatures in parallel and add the valid ones to signature cache, so that the following
+ * VerifySignature() calls of the serial tx execution are cache hits.
+ * The caller thread works on the items too, with 1 thread (no workers) all of the items are verified
+ * by the caller thread.
+ */
+class CSigVerifyPool {
+public:
+    CSigVerifyPool() {}
+    ~CSigVerifyPool() { Stop(); }
+
+    // threadCount includes the caller thread
+    void Start(int32_t threadCount);
+    void Stop();
+
+    int32_t GetThreadCount() const { return workers.size() + 1; }
+
+    // return the count of valid signatures
+    uint32_t VerifyAndCache(const std::vector<CSigVerifyItem> &items);
+
+private:
+    void WorkerLoop();
+    void ProcessItems(const std::vector<CSigVerifyItem> &items);
+
+private:
+    std::vector<std::thread> workers;
+    StdMutex csBatch;  // one batch at a time
+
+    StdMutex cs;
+    std::condition_variable cond;
+    std::condition_variable doneCond;
+    const std::vector<CSigVerifyItem> *pItems = nullptr;
+    uint64_t batchId        = 0;
+    int32_t activeCount     = 0;
+    bool running            = false;
+
+    std::atomic<size_t> nextIndex{0};
+    std::atomic<uint32_t> validCount{0};
+};
+
+extern CSigVerifyPool sigVerifyPool;
+
+#endif  // COIN_SIGVERIFY_H
@@ -0,0 +1,151 @@
+// Copyright (c) 2017-2019 The GreenVenturesChain Core developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "p2p/blockencodings.h"
+
+#include <memory>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "tx/blockrewardtx.h"
+#include "tx/cointransfertx.h"
+#include "tx/txmempool.h"
+
+using namespace std;
+
+// the reward tx followed by the transfer txs of distinct amounts
+static CBlock MakeBlock(uint32_t txCount) {
+    CBlock block;
+    block.SetVersion(CBlockHeader::CURRENT_VERSION);
+    block.SetHeight(10);
+    block.SetTime(1000);
+    block.vptx.push_back(std::make_shared<CBlockRewardTx>(CRegID(1, 1).GetRegIdRaw(), 0, 10));
+    for (uint32_t n = 0; n < txCount; n++)
+        block.vptx.push_back(std::make_shared<CBaseCoinTransferTx>(CRegID(1, 2), CRegID(1, 3), 10, n + 1, 10000, ""));
+    block.SetMerkleRootHash(block.BuildMerkleTree());
+    return block;
+}
+
+static void AddToPool(CTxMemPool &pool, const std::shared_ptr<CBaseTx> &pBaseTx) {
+    pool.memPoolTxs[pBaseTx->GetHash()] = CTxMemPoolEntry(pBaseTx.get(), 0, 10);
+}
+
+// the compact block as received from the peer
+template <typename T>
+static T SerializeRoundTrip(const T &obj) {
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << obj;
+    T result;
+    ss >> result;
+    return result;
+}
+
+static bool HaveSameTxs(const CBlock &block, const CBlock &other) {
+    if (block.vptx.size() != other.vptx.size())
+        return false;
+
+    for (size_t i = 0; i < block.vptx.size(); i++) {
+        if (block.vptx[i]->GetHash() != other.vptx[i]->GetHash())
+            return false;
+    }
+    return true;
+}
+
+BOOST_AUTO_TEST_SUITE(blockencodings_tests)
+
+BOOST_AUTO_TEST_CASE(blockencodings_reconstruct_test)
+{
+    CBlock block = MakeBlock(5);
+    CTxMemPool pool;
+    for (size_t i = 1; i < block.vptx.size(); i++)
+        AddToPool(pool, block.vptx[i]);
+
+    CBlockHeaderAndShortTxIDs cmpctBlock = SerializeRoundTrip(CBlockHeaderAndShortTxIDs(block));
+    BOOST_CHECK(cmpctBlock.prefilledTxs.size() == 1 && cmpctBlock.prefilledTxs[0].index == 0);
+    BOOST_CHECK(cmpctBlock.shortTxIds.size() == 5);
+
+    CPartiallyDownloadedBlock partialBlock;
+    BOOST_CHECK(partialBlock.InitData(cmpctBlock, pool) == READ_STATUS_OK);
+    BOOST_CHECK(partialBlock.prefilledCount == 1 && partialBlock.mempoolCount == 5);
+    BOOST_CHECK(partialBlock.GetMissingTxIndexes().empty());
+
+    CBlock reconstructed;
+    BOOST_CHECK(partialBlock.FillBlock(reconstructed, {}) == READ_STATUS_OK);
+    BOOST_CHECK(reconstructed.GetHash() == block.GetHash());
+    BOOST_CHECK(HaveSameTxs(reconstructed, block));
+}
+
+BOOST_AUTO_TEST_CASE(blockencodings_blocktxn_test)
+{
+    CBlock block = MakeBlock(6);
+    CTxMemPool pool;
+    for (size_t i = 1; i < block.vptx.size(); i++) {
+        if (i != 2 && i != 5)
+            AddToPool(pool, block.vptx[i]);
+    }
+
+    CBlockHeaderAndShortTxIDs cmpctBlock = SerializeRoundTrip(CBlockHeaderAndShortTxIDs(block));
+    CPartiallyDownloadedBlock partialBlock;
+    BOOST_CHECK(partialBlock.InitData(cmpctBlock, pool) == READ_STATUS_OK);
+    vector<uint32_t> missingIndexes = partialBlock.GetMissingTxIndexes();
+    BOOST_CHECK(missingIndexes == vector<uint32_t>({2, 5}));
+
+    // getblocktxn is served by the peer from its block
+    CBlockTransactionsRequest request;
+    request.blockHash = block.GetHash();
+    request.indexes   = missingIndexes;
+    request           = SerializeRoundTrip(request);
+
+    CBlockTransactions response;
+    response.blockHash = request.blockHash;
+    for (auto index : request.indexes)
+        response.txs.push_back(block.vptx[index]);
+    response = SerializeRoundTrip(response);
+
+    // the missing txs out of order or short are invalid
+    CBlock reconstructed;
+    CPartiallyDownloadedBlock badPartialBlock = partialBlock;
+    BOOST_CHECK(badPartialBlock.FillBlock(reconstructed, {response.txs[0]}) == READ_STATUS_INVALID);
+    badPartialBlock = partialBlock;
+    BOOST_CHECK(badPartialBlock.FillBlock(reconstructed, {response.txs[1], response.txs[0]}) == READ_STATUS_FAILED);
+
+    BOOST_CHECK(partialBlock.FillBlock(reconstructed, response.txs) == READ_STATUS_OK);
+    BOOST_CHECK(reconstructed.GetHash() == block.GetHash());
+    BOOST_CHECK(HaveSameTxs(reconstructed, block));
+}
+
+BOOST_AUTO_TEST_CASE(blockencodings_collision_test)
+{
+    CBlock block = MakeBlock(3);
+    CTxMemPool pool;
+    for (size_t i = 1; i < block.vptx.size(); i++)
+        AddToPool(pool, block.vptx[i]);
+
+    // the duplicated short txids in block, the full block is requested
+    CBlockHeaderAndShortTxIDs cmpctBlock(block);
+    cmpctBlock.shortTxIds[1] = cmpctBlock.shortTxIds[0];
+    CPartiallyDownloadedBlock partialBlock;
+    BOOST_CHECK(partialBlock.InitData(cmpctBlock, pool) == READ_STATUS_FAILED);
+
+    // the short txid matching another tx of mempool is filled by it, and caught by the merkle root
+    auto pOtherTx = std::make_shared<CBaseCoinTransferTx>(CRegID(1, 2), CRegID(1, 3), 10, 100, 10000, "");
+    AddToPool(pool, pOtherTx);
+    cmpctBlock = CBlockHeaderAndShortTxIDs(block);
+    cmpctBlock.shortTxIds[2] = CShortTxID(cmpctBlock.GetShortTxID(pOtherTx->GetHash()));
+    pool.memPoolTxs.erase(block.vptx[3]->GetHash());
+    BOOST_CHECK(partialBlock.InitData(cmpctBlock, pool) == READ_STATUS_OK);
+    BOOST_CHECK(partialBlock.GetMissingTxIndexes().empty());
+
+    CBlock reconstructed;
+    BOOST_CHECK(partialBlock.FillBlock(reconstructed, {}) == READ_STATUS_FAILED);
+
+    // the invalid prefilled txs
+    cmpctBlock = CBlockHeaderAndShortTxIDs(block);
+    cmpctBlock.prefilledTxs[0].index = block.vptx.size();
+    BOOST_CHECK(partialBlock.InitData(cmpctBlock, pool) == READ_STATUS_INVALID);
+    cmpctBlock = CBlockHeaderAndShortTxIDs(block);
+    cmpctBlock.prefilledTxs.push_back(cmpctBlock.prefilledTxs[0]);
+    BOOST_CHECK(partialBlock.InitData(cmpctBlock, pool) == READ_STATUS_INVALID);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
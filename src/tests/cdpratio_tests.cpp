@@ -0,0 +1,124 @@
+// Copyright (c) 2017-2019 The GreenVenturesChain Core developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "persistence/cdpdb.h"
+
+#include <string>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "commons/util/util.h"
+
+using namespace std;
+
+struct FCdpRatioTests {
+    FCdpRatioTests() {
+        root_dir = "/tmp/coin_unit_test";
+        if (!boost::filesystem::exists(root_dir))
+            BOOST_CHECK_NO_THROW(boost::filesystem::create_directory(root_dir));
+
+        db_dir = root_dir / "cdpratio_tests";
+        boost::filesystem::remove_all(db_dir);
+        BOOST_CHECK_NO_THROW(boost::filesystem::create_directory(db_dir));
+    }
+    ~FCdpRatioTests() {
+        BOOST_CHECK_NO_THROW(boost::filesystem::remove_all(db_dir));
+    }
+
+    boost::filesystem::path root_dir;
+    boost::filesystem::path db_dir;
+};
+
+static const CCdpCoinPair kCdpCoinPair(SYMB::GVC, SYMB::WUSD);
+static const uint64_t kForceLiquidateRatio = 10400;        // 104%
+static const uint64_t kBcoinMedianPrice    = PRICE_BOOST;  // 1 WUSD
+
+// the collateral ratio is staked / 100, the CDPs of the same n % 7 have the same ratio and height
+static CUserCDP MakeCdp(uint32_t n, uint64_t staked, int32_t height, const TokenSymbol &bcoinSymbol = SYMB::GVC) {
+    return CUserCDP(CRegID(height, n), uint256S(strprintf("%064x", (uint64_t)n * 0x100000001ULL + 1)), height,
+                    bcoinSymbol, SYMB::WUSD, staked, 100);
+}
+
+static vector<uint256> GetListedCdpIds(CCdpDBCache &cdpCache) {
+    CdpRatioSortedCache::Map cdpMap;
+    BOOST_CHECK(cdpCache.GetCdpListByCollateralRatio(kCdpCoinPair, kForceLiquidateRatio, kBcoinMedianPrice, cdpMap));
+    vector<uint256> ids;
+    for (const auto &item : cdpMap)
+        ids.push_back(item.second.cdpid);
+    return ids;
+}
+
+static vector<uint256> GetIteratedCdpIds(CCdpDBCache &cdpCache, size_t maxCount = SIZE_MAX) {
+    vector<uint256> ids;
+    auto pCdpIt = cdpCache.CreateCdpRatioIterator(kCdpCoinPair, kForceLiquidateRatio, kBcoinMedianPrice);
+    for (pCdpIt->First(); pCdpIt->IsValid() && ids.size() < maxCount; pCdpIt->Next())
+        ids.push_back(pCdpIt->GetValue().cdpid);
+    return ids;
+}
+
+BOOST_FIXTURE_TEST_SUITE(cdpratio_tests, FCdpRatioTests)
+
+BOOST_AUTO_TEST_CASE(cdpratio_iterator_test)
+{
+    CDBAccess dbAccess(db_dir, DBNameType::CDP, false, true);
+    CCdpDBCache baseCache(&dbAccess);
+
+    vector<CUserCDP> cdps;
+    for (uint32_t n = 0; n < 60; n++)
+        cdps.push_back(MakeCdp(n, 90 + n % 7 * 3, 100 + n % 7));
+    // the CDPs of the other coin pair are not iterated
+    cdps.push_back(MakeCdp(60, 50, 100, SYMB::WGRT));
+
+    // the first CDPs are persisted in db, the others are kept in the cache of the block
+    for (uint32_t n = 0; n < 40; n++)
+        BOOST_CHECK(baseCache.NewCDP(cdps[n].block_height, cdps[n]));
+    baseCache.Flush();
+
+    CCdpDBCache blockCache;
+    blockCache.SetBaseViewPtr(&baseCache);
+    for (uint32_t n = 40; n < cdps.size(); n++)
+        BOOST_CHECK(blockCache.NewCDP(cdps[n].block_height, cdps[n]));
+
+    CCdpDBCache txCache;
+    txCache.SetBaseViewPtr(&blockCache);
+    BOOST_CHECK(txCache.EraseCDP(cdps[0], cdps[0]));
+    BOOST_CHECK(txCache.EraseCDP(cdps[45], cdps[45]));
+    CUserCDP newCdp = cdps[1];
+    newCdp.AddStake(200, 0, 20);   // 91 / 120
+    BOOST_CHECK(txCache.UpdateCDP(cdps[1], newCdp));
+
+    // the same CDPs in the same order of the liquidation before
+    vector<uint256> ids = GetListedCdpIds(txCache);
+    BOOST_CHECK(ids.size() == 42);
+    BOOST_CHECK(GetIteratedCdpIds(txCache) == ids);
+    BOOST_CHECK(GetIteratedCdpIds(txCache, 5) == vector<uint256>(ids.begin(), ids.begin() + 5));
+    BOOST_CHECK(ids[0] == newCdp.cdpid);
+
+    // erase the iterated CDPs
+    vector<uint256> erasedIds;
+    auto pCdpIt = txCache.CreateCdpRatioIterator(kCdpCoinPair, kForceLiquidateRatio, kBcoinMedianPrice);
+    for (pCdpIt->First(); pCdpIt->IsValid(); pCdpIt->Next()) {
+        CUserCDP cdp = pCdpIt->GetValue();
+        if (erasedIds.size() % 2 == 0)
+            BOOST_CHECK(txCache.EraseCDP(cdp, cdp));
+        erasedIds.push_back(cdp.cdpid);
+    }
+    BOOST_CHECK(erasedIds == ids);
+    ids = GetListedCdpIds(txCache);
+    BOOST_CHECK(ids.size() == 21);
+    BOOST_CHECK(GetIteratedCdpIds(txCache) == ids);
+
+    // the ratio index is updated by the flush to db
+    txCache.Flush();
+    blockCache.Flush();
+    BOOST_CHECK(GetIteratedCdpIds(baseCache) == ids);
+    baseCache.Flush();
+    BOOST_CHECK(baseCache.spRatioIndex->IsLoaded() && baseCache.spRatioIndex->GetKeyCount() == 59 - 21);
+    BOOST_CHECK(GetIteratedCdpIds(baseCache) == ids);
+
+    CCdpDBCache reloadedCache(&dbAccess);
+    BOOST_CHECK(GetIteratedCdpIds(reloadedCache) == ids);
+    BOOST_CHECK(reloadedCache.spRatioIndex->GetKeyCount() == 59 - 21);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
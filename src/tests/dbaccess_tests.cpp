@@ -7,8 +7,12 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <atomic>
+#include <thread>
 #include <boost/test/unit_test.hpp>
 #include "persistence/dbaccess.h"
+#include "persistence/dbflusher.h"
+#include "commons/util/time.h"
 
 using namespace std;
 
@@ -60,6 +64,119 @@ BOOST_AUTO_TEST_CASE(dbaccess_test)
 
 }
 
+BOOST_AUTO_TEST_CASE(dbaccess_single_db_test)
+{
+    auto spDb = make_shared<CLevelDBWrapper>(db_dir / kSingleDbName, GetTotalDbCacheSize(), false, true);
+    BOOST_CHECK(spDb->IsEmpty());
+    CDBAccess accountDb(DBNameType::ACCOUNT, spDb);
+    CDBAccess assetDb(DBNameType::ASSET, spDb);
+
+    CCompositeKVCache<dbk::REGID_KEYID, string, string> accountCache(&accountDb);
+    CCompositeKVCache<dbk::ASSET, string, string> assetCache(&assetDb);
+    accountCache.SetData("regid-1", "keyid-1");
+    assetCache.SetData("asset-1", "asset-value-1");
+
+    // both of the caches are flushed into one batch, nothing is visible before the batch is committed
+    CLevelDBBatch batch;
+    accountDb.SetBatch(&batch);
+    assetDb.SetBatch(&batch);
+    accountCache.Flush();
+    assetCache.Flush();
+    accountDb.SetBatch(nullptr);
+    assetDb.SetBatch(nullptr);
+    BOOST_CHECK(spDb->IsEmpty());
+
+    BOOST_CHECK(spDb->WriteBatch(batch, true));
+    string value;
+    BOOST_CHECK(accountDb.GetData(dbk::REGID_KEYID, string("regid-1"), value) && value == "keyid-1");
+    BOOST_CHECK(assetDb.GetData(dbk::ASSET, string("asset-1"), value) && value == "asset-value-1");
+    // the namespaces must not see each other
+    BOOST_CHECK(!assetDb.GetData(dbk::ASSET, string("regid-1"), value));
+}
+
+BOOST_AUTO_TEST_CASE(dbflusher_group_commit_test)
+{
+    auto spDb = make_shared<CLevelDBWrapper>(db_dir / kSingleDbName, GetTotalDbCacheSize(), false, true);
+    CDBAccess accountDb(DBNameType::ACCOUNT, spDb);
+    CDBFlusher flusher({spDb}, 2, 0);
+    BOOST_CHECK(flusher.IsAsync());
+    accountDb.SetSyncWrite(false);
+
+    // the unsynced write is readable at once
+    CCompositeKVCache<dbk::REGID_KEYID, string, string> accountCache(&accountDb);
+    accountCache.SetData("regid-1", "keyid-1");
+    accountCache.Flush();
+    flusher.NotifyFlushed();
+    string value;
+    BOOST_CHECK(accountDb.GetData(dbk::REGID_KEYID, string("regid-1"), value) && value == "keyid-1");
+    BOOST_CHECK(flusher.GetPendingCount() == 1);
+
+    // the second flush reaches the sync blocks, both of the flushes are synced by one group commit
+    accountCache.SetData("regid-2", "keyid-2");
+    accountCache.Flush();
+    flusher.NotifyFlushed();
+    for (int32_t i = 0; i < 100 && flusher.GetPendingCount() > 0; i++)
+        MilliSleep(10);
+    BOOST_CHECK(flusher.GetPendingCount() == 0);
+
+    flusher.Stop();
+    BOOST_CHECK(!CDBFlusher({spDb}, 1, 0).IsAsync());
+    BOOST_CHECK(!CDBFlusher({spDb}, 0, 0).IsAsync());
+}
+
+BOOST_AUTO_TEST_CASE(dbaccess_snapshot_test)
+{
+    auto spDb = make_shared<CLevelDBWrapper>(db_dir / kSingleDbName, GetTotalDbCacheSize(), false, true);
+    CDBAccess accountDb(DBNameType::ACCOUNT, spDb);
+    CCompositeKVCache<dbk::REGID_KEYID, string, string> accountCache(&accountDb);
+    accountCache.SetData("regid-1", "keyid-1");
+    accountCache.SetData("regid-2", "keyid-2");
+    accountCache.Flush();
+
+    CDBAccess snapshotDb(accountDb, spDb->NewSnapshot());
+    BOOST_CHECK(snapshotDb.IsSnapshot() && !accountDb.IsSnapshot());
+
+    // the later writes are not visible by the snapshot
+    accountCache.SetData("regid-1", "keyid-1-new");
+    accountCache.EraseData("regid-2");
+    accountCache.SetData("regid-3", "keyid-3");
+    accountCache.Flush();
+
+    string value;
+    BOOST_CHECK(accountDb.GetData(dbk::REGID_KEYID, string("regid-1"), value) && value == "keyid-1-new");
+    BOOST_CHECK(snapshotDb.GetData(dbk::REGID_KEYID, string("regid-1"), value) && value == "keyid-1");
+    BOOST_CHECK(snapshotDb.GetData(dbk::REGID_KEYID, string("regid-2"), value) && value == "keyid-2");
+    BOOST_CHECK(!snapshotDb.GetData(dbk::REGID_KEYID, string("regid-3"), value));
+    BOOST_CHECK((snapshotDb.HasData<string, string>(dbk::REGID_KEYID, "regid-2")));
+    BOOST_CHECK((!accountDb.HasData<string, string>(dbk::REGID_KEYID, "regid-2")));
+
+    map<string, string> elements;
+    BOOST_CHECK(snapshotDb.GetAllElements(dbk::REGID_KEYID, elements));
+    BOOST_CHECK(elements == (map<string, string>{{"regid-1", "keyid-1"}, {"regid-2", "keyid-2"}}));
+
+    // the private caches of the concurrent readers over the snapshot
+    vector<std::thread> readers;
+    std::atomic<int32_t> mismatches{0};
+    for (int32_t i = 0; i < 4; i++) {
+        readers.emplace_back([&]() {
+            CCompositeKVCache<dbk::REGID_KEYID, string, string> readerCache(&snapshotDb);
+            for (int32_t n = 0; n < 100; n++) {
+                string readerValue;
+                if (!readerCache.GetData("regid-2", readerValue) || readerValue != "keyid-2" ||
+                    readerCache.HasData("regid-3"))
+                    mismatches++;
+            }
+        });
+    }
+    for (int32_t n = 0; n < 100; n++) {
+        accountCache.SetData("regid-2", strprintf("keyid-2-%d", n));
+        accountCache.Flush();
+    }
+    for (auto &reader : readers)
+        reader.join();
+    BOOST_CHECK(mismatches == 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 
@@ -181,4 +298,170 @@ BOOST_AUTO_TEST_CASE(dbcache_cache_size_test)
     BOOST_CHECK(!pDBCache2->IsCalcSize() && pDBCache2->GetCacheSize() == 0);
 }
 
+BOOST_AUTO_TEST_CASE(dbcache_missing_key_test)
+{
+    const bool isWipe = true;
+    const dbk::PrefixType prefix = dbk::REGID_KEYID;
+    shared_ptr<CDBAccess> pDBAccess = make_shared<CDBAccess>(
+        db_dir, DBNameType::ACCOUNT, false, isWipe);
+
+    auto pDBCache1 = make_shared< CCompositeKVCache<prefix, string, string> >(pDBAccess.get());
+    auto pDBCache2 = make_shared< CCompositeKVCache<prefix, string, string> >(pDBCache1.get());
+
+    auto pSiblingCache = make_shared< CCompositeKVCache<prefix, string, string> >(pDBCache1.get());
+
+    // the missing keys are only kept by the db level cache
+    string value;
+    BOOST_CHECK(!pDBCache2->GetData(string("regid-1"), value));
+    BOOST_CHECK(!pDBCache2->HasData(string("regid-1")));
+    BOOST_CHECK(pDBCache1->GetMissingKeyCount() == 1 && pDBCache2->GetMissingKeyCount() == 0);
+    BOOST_CHECK(pDBCache1->GetCacheSize() == GetSerSize(string("regid-1")));
+
+    // the key flushed into the base by the sibling cache is found at once
+    pSiblingCache->SetData("regid-1", "keyid-0");
+    pSiblingCache->Flush();
+    BOOST_CHECK(pDBCache1->GetMissingKeyCount() == 0);
+    BOOST_CHECK(pDBCache2->GetData(string("regid-1"), value) && value == "keyid-0");
+
+    pDBCache2->SetData("regid-1", "keyid-1");
+    BOOST_CHECK(pDBCache2->GetData(string("regid-1"), value) && value == "keyid-1");
+
+    pDBCache2->Flush();
+    BOOST_CHECK(pDBCache1->GetMissingKeyCount() == 0);
+    BOOST_CHECK(pDBCache1->GetData(string("regid-1"), value) && value == "keyid-1");
+    BOOST_CHECK(pDBCache1->GetCacheSize() == GetCacheSerializeSize(*pDBCache1));
+
+    pDBCache1->Flush();
+    BOOST_CHECK(pDBCache1->GetMissingKeyCount() == 0 && pDBCache1->GetCacheSize() == 0);
+    BOOST_CHECK(pDBCache2->GetData(string("regid-1"), value) && value == "keyid-1");
+
+    // the missing keys are bounded, and accounted in the cache size
+    for (uint32_t i = 0; i < MAX_MISSING_KEY_COUNT + 10; i++)
+        BOOST_CHECK(!pDBCache2->HasData(strprintf("missing-%u", i)));
+    BOOST_CHECK(pDBCache1->GetMissingKeyCount() == 10);
+    BOOST_CHECK(pDBCache1->GetCacheSize() == GetCacheSerializeSize(*pDBCache1) + 10 * GetSerSize(string("missing-100000")));
+}
+
+BOOST_AUTO_TEST_CASE(dbcache_copy_on_write_test)
+{
+    const bool isWipe = true;
+    const dbk::PrefixType prefix = dbk::REGID_KEYID;
+    shared_ptr<CDBAccess> pDBAccess = make_shared<CDBAccess>(
+        db_dir, DBNameType::ACCOUNT, false, isWipe);
+
+    auto pDBCache1 = make_shared< CCompositeKVCache<prefix, string, string> >(pDBAccess.get());
+    pDBCache1->SetData("regid-1", "keyid-1");
+    pDBCache1->SetData("regid-2", "keyid-2");
+    pDBCache1->Flush();
+
+    // reads of the upper level cache must not copy the data of base
+    auto pDBCache2 = make_shared< CCompositeKVCache<prefix, string, string> >(pDBCache1.get());
+    string value;
+    BOOST_CHECK(pDBCache2->GetData(string("regid-1"), value) && value == "keyid-1");
+    BOOST_CHECK(pDBCache2->HasData(string("regid-2")));
+    BOOST_CHECK(pDBCache2->GetMapData().empty());
+    BOOST_CHECK(pDBCache1->GetMapData().size() == 2);
+
+    pDBCache2->SetData("regid-2", "keyid-22");
+    pDBCache2->EraseData("regid-1");
+    BOOST_CHECK(pDBCache2->GetMapData().size() == 2);
+    BOOST_CHECK(pDBCache1->GetData(string("regid-2"), value) && value == "keyid-2");
+
+    pDBCache2->Flush();
+    BOOST_CHECK(!pDBCache1->HasData(string("regid-1")));
+    BOOST_CHECK(pDBCache1->GetData(string("regid-2"), value) && value == "keyid-22");
+
+    auto pDBValue1 = make_shared< CSimpleKVCache<prefix, string> >(pDBAccess.get());
+    auto pDBValue2 = make_shared< CSimpleKVCache<prefix, string> >(pDBValue1.get());
+    auto pDbOpLogMap = make_shared<CDBOpLogMap>();
+    pDBValue1->SetData("keyid-1");
+    pDBValue2->SetDbOpLogMap(pDbOpLogMap.get());
+    BOOST_CHECK(pDBValue2->GetData(value) && value == "keyid-1");
+    BOOST_CHECK(pDBValue2->GetCacheSize() == 0);
+    // the op log must record the value of base as old value
+    pDBValue2->SetData("keyid-2");
+    string opValue;
+    pDbOpLogMap->GetDbOpLogsPtr(prefix)->at(0).Get(opValue);
+    BOOST_CHECK(opValue == "keyid-1");
+    BOOST_CHECK(pDBValue1->GetData(value) && value == "keyid-1");
+}
+
+BOOST_AUTO_TEST_CASE(dbcache_access_log_test)
+{
+    const bool isWipe = true;
+    const dbk::PrefixType prefix = dbk::REGID_KEYID;
+    shared_ptr<CDBAccess> pDBAccess = make_shared<CDBAccess>(
+        db_dir, DBNameType::ACCOUNT, false, isWipe);
+
+    auto pDBCache1 = make_shared< CCompositeKVCache<prefix, string, string> >(pDBAccess.get());
+    pDBCache1->SetData("regid-1", "keyid-1");
+    pDBCache1->SetData("regid-2", "keyid-2");
+    pDBCache1->Flush();
+
+    // the lookups are logged as reads, the flushed key-values are logged as writes
+    CDbAccessLog accessLog;
+    auto pDBCache2 = make_shared< CCompositeKVCache<prefix, string, string> >(pDBCache1.get());
+    pDBCache2->SetDbAccessLog(&accessLog);
+    string value;
+    BOOST_CHECK(pDBCache2->GetData(string("regid-1"), value) && value == "keyid-1");
+    BOOST_CHECK(!pDBCache2->HasData(string("regid-3")));
+    pDBCache2->SetData("regid-2", "keyid-22");
+    pDBCache2->Flush();
+
+    set<string> keys;
+    set<dbk::PrefixType> prefixes;
+    accessLog.GetWriteKeys(keys, prefixes);
+    BOOST_CHECK(keys.size() == 1 && keys.count(dbk::GenDbKey(prefix, string("regid-2"))));
+    BOOST_CHECK(prefixes.size() == 1 && prefixes.count(prefix));
+
+    BOOST_CHECK(accessLog.HasReadAny({dbk::GenDbKey(prefix, string("regid-1"))}, {}));
+    BOOST_CHECK(accessLog.HasReadAny({dbk::GenDbKey(prefix, string("regid-3"))}, {}));
+    BOOST_CHECK(!accessLog.HasReadAny({dbk::GenDbKey(prefix, string("regid-4"))}, {}));
+    BOOST_CHECK(!accessLog.HasReadAny({}, {prefix}));
+
+    // iterating the elements is logged as a read of the whole prefix
+    pDBCache2->GetMapData();
+    BOOST_CHECK(accessLog.HasReadAny({}, {prefix}));
+
+    // the writes can be replayed onto another cache by the undo func
+    auto pDBCache3 = make_shared< CCompositeKVCache<prefix, string, string> >(pDBAccess.get());
+    UndoDataFuncMap undoDataFuncMap;
+    pDBCache3->RegisterUndoFunc(undoDataFuncMap);
+    undoDataFuncMap[prefix](*accessLog.GetWriteLogs().GetDbOpLogsPtr(prefix));
+    BOOST_CHECK(pDBCache3->GetData(string("regid-2"), value) && value == "keyid-22");
+    BOOST_CHECK(pDBCache3->GetData(string("regid-1"), value) && value == "keyid-1");
+}
+
+BOOST_AUTO_TEST_CASE(dbcache_tx_sandbox_test)
+{
+    const bool isWipe = true;
+    const dbk::PrefixType prefix = dbk::REGID_KEYID;
+    shared_ptr<CDBAccess> pDBAccess = make_shared<CDBAccess>(
+        db_dir, DBNameType::ACCOUNT, false, isWipe);
+
+    auto pDBCache = make_shared< CCompositeKVCache<prefix, string, string> >(pDBAccess.get());
+    pDBCache->SetData("regid-1", "keyid-1");
+    pDBCache->Flush();
+    auto pMempoolCache = make_shared< CCompositeKVCache<prefix, string, string> >(pDBCache.get());
+
+    // the found and the missing keys of the sandbox both see the changes of the base
+    auto pTxCache = make_shared< CCompositeKVCache<prefix, string, string> >(pMempoolCache.get());
+    string value;
+    BOOST_CHECK(pTxCache->GetData(string("regid-1"), value) && value == "keyid-1");
+    BOOST_CHECK(!pTxCache->HasData(string("regid-2")));
+
+    auto pSiblingTxCache = make_shared< CCompositeKVCache<prefix, string, string> >(pMempoolCache.get());
+    pSiblingTxCache->EraseData("regid-1");
+    pSiblingTxCache->SetData("regid-2", "keyid-2");
+    pSiblingTxCache->Flush();
+    BOOST_CHECK(!pTxCache->HasData(string("regid-1")));
+    BOOST_CHECK(pTxCache->GetData(string("regid-2"), value) && value == "keyid-2");
+
+    // the discarded sandbox leaves nothing in the base
+    pTxCache->SetData("regid-3", "keyid-3");
+    pTxCache.reset();
+    BOOST_CHECK(!pMempoolCache->HasData(string("regid-3")));
+    BOOST_CHECK(pMempoolCache->GetMapData().size() == 2);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,148 @@
+// Copyright (c) 2017-2019 The GreenVenturesChain Core developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "persistence/dexdb.h"
+
+#include <string>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "commons/util/util.h"
+
+using namespace std;
+using namespace dex;
+
+struct FDexOrderBookTests {
+    FDexOrderBookTests() {
+        root_dir = "/tmp/coin_unit_test";
+        if (!boost::filesystem::exists(root_dir))
+            BOOST_CHECK_NO_THROW(boost::filesystem::create_directory(root_dir));
+
+        db_dir = root_dir / "dexorderbook_tests";
+        boost::filesystem::remove_all(db_dir);
+        BOOST_CHECK_NO_THROW(boost::filesystem::create_directory(db_dir));
+    }
+    ~FDexOrderBookTests() {
+        BOOST_CHECK_NO_THROW(boost::filesystem::remove_all(db_dir));
+    }
+
+    boost::filesystem::path root_dir;
+    boost::filesystem::path db_dir;
+};
+
+static uint256 MakeOrderId(uint32_t n) {
+    return uint256S(strprintf("%064x", n + 1));
+}
+
+static CDEXOrderDetail MakeOrder(OrderSide side, OrderType type, uint64_t price, uint64_t assetAmount,
+                                 uint32_t height, const TokenSymbol &coinSymbol = "WUSD") {
+    CDEXOrderDetail order;
+    order.generate_type = USER_GEN_ORDER;
+    order.order_type    = type;
+    order.order_side    = side;
+    order.coin_symbol   = coinSymbol;
+    order.asset_symbol  = "GVC";
+    order.asset_amount  = assetAmount;
+    order.coin_amount   = assetAmount * price / PRICE_BOOST;
+    order.price         = (type == ORDER_LIMIT_PRICE) ? price : 0;
+    order.tx_cord       = CTxCord(height, 1);
+    return order;
+}
+
+static vector<uint256> GetOrderIds(const CDEXOrderBookGetter &getter) {
+    vector<uint256> ids;
+    for (const auto &item : getter.orders)
+        ids.push_back(item.first);
+    return ids;
+}
+
+BOOST_FIXTURE_TEST_SUITE(dexorderbook_tests, FDexOrderBookTests)
+
+BOOST_AUTO_TEST_CASE(dexorderbook_priority_test)
+{
+    CDBAccess dbAccess(db_dir, DBNameType::DEX, false, true);
+    CDexDBCache baseCache(&dbAccess);
+
+    vector<CDEXOrderDetail> orders = {
+        MakeOrder(ORDER_BUY,  ORDER_LIMIT_PRICE,  100, 10, 1),
+        MakeOrder(ORDER_BUY,  ORDER_LIMIT_PRICE,  120, 20, 2),
+        MakeOrder(ORDER_BUY,  ORDER_LIMIT_PRICE,  100, 30, 3),
+        MakeOrder(ORDER_BUY,  ORDER_MARKET_PRICE, 0,   40, 4),
+        MakeOrder(ORDER_SELL, ORDER_LIMIT_PRICE,  130, 50, 5),
+        MakeOrder(ORDER_SELL, ORDER_LIMIT_PRICE,  125, 60, 6),
+        MakeOrder(ORDER_SELL, ORDER_LIMIT_PRICE,  90,  70, 7, "WCNY"),  // the other trading pair
+    };
+    // the first orders are persisted in db, the others are kept in the cache of the block
+    for (uint32_t n = 0; n < 3; n++)
+        BOOST_CHECK(baseCache.CreateActiveOrder(MakeOrderId(n), orders[n]));
+    baseCache.Flush();
+
+    CDexDBCache blockCache;
+    blockCache.SetBaseViewPtr(&baseCache);
+    for (uint32_t n = 3; n < orders.size(); n++)
+        BOOST_CHECK(blockCache.CreateActiveOrder(MakeOrderId(n), orders[n]));
+
+    auto pBuyGetter = blockCache.CreateOrderBookGetter();
+    BOOST_CHECK(pBuyGetter->Execute(CDEXOrderBookSide("WUSD", "GVC", ORDER_BUY), 20, 20));
+    BOOST_CHECK(GetOrderIds(*pBuyGetter) ==
+                vector<uint256>({MakeOrderId(3), MakeOrderId(1), MakeOrderId(0), MakeOrderId(2)}));
+    BOOST_CHECK(pBuyGetter->levels.size() == 2);
+    BOOST_CHECK(pBuyGetter->levels[0].first == 120 && pBuyGetter->levels[0].second.asset_amount == 20);
+    BOOST_CHECK(pBuyGetter->levels[1].first == 100 && pBuyGetter->levels[1].second.asset_amount == 40 &&
+                pBuyGetter->levels[1].second.order_count == 2);
+
+    auto pSellGetter = blockCache.CreateOrderBookGetter();
+    BOOST_CHECK(pSellGetter->Execute(CDEXOrderBookSide("WUSD", "GVC", ORDER_SELL), 1, 0));
+    BOOST_CHECK(pSellGetter->orders.empty());
+    BOOST_CHECK(pSellGetter->levels.size() == 1 && pSellGetter->levels[0].first == 125);
+
+    // the deals, the fulfilled order is erased with its dealt amount, and the cancel
+    orders[1].total_deal_asset_amount = 15;
+    BOOST_CHECK(blockCache.UpdateActiveOrder(MakeOrderId(1), orders[1]));
+    orders[0].total_deal_asset_amount = 10;
+    BOOST_CHECK(blockCache.EraseActiveOrder(MakeOrderId(0), orders[0]));
+    BOOST_CHECK(blockCache.EraseActiveOrder(MakeOrderId(3), orders[3]));
+    orders[1].total_deal_asset_amount = 20;
+    BOOST_CHECK(blockCache.EraseActiveOrder(MakeOrderId(1), orders[1]));
+
+    pBuyGetter = blockCache.CreateOrderBookGetter();
+    BOOST_CHECK(pBuyGetter->Execute(CDEXOrderBookSide("WUSD", "GVC", ORDER_BUY), 20, 20));
+    BOOST_CHECK(GetOrderIds(*pBuyGetter) == vector<uint256>({MakeOrderId(2)}));
+    BOOST_CHECK(pBuyGetter->levels.size() == 1 && pBuyGetter->levels[0].first == 100 &&
+                pBuyGetter->levels[0].second.asset_amount == 30 && pBuyGetter->levels[0].second.order_count == 1);
+
+    // the base is not changed until the block is flushed
+    pBuyGetter = baseCache.CreateOrderBookGetter();
+    BOOST_CHECK(pBuyGetter->Execute(CDEXOrderBookSide("WUSD", "GVC", ORDER_BUY), 20, 20));
+    BOOST_CHECK(pBuyGetter->orders.size() == 3);
+    blockCache.Flush();
+    baseCache.Flush();
+    pBuyGetter = baseCache.CreateOrderBookGetter();
+    BOOST_CHECK(pBuyGetter->Execute(CDEXOrderBookSide("WUSD", "GVC", ORDER_BUY), 20, 20));
+    BOOST_CHECK(GetOrderIds(*pBuyGetter) == vector<uint256>({MakeOrderId(2)}));
+    BOOST_CHECK(pBuyGetter->levels.size() == 1 && pBuyGetter->levels[0].second.asset_amount == 30);
+}
+
+BOOST_AUTO_TEST_CASE(dexorderbook_build_test)
+{
+    CDBAccess dbAccess(db_dir, DBNameType::DEX, false, true);
+    CDexDBCache dexCache(&dbAccess);
+
+    // the active orders persisted before the index
+    for (uint32_t n = 0; n < 10; n++) {
+        auto order = MakeOrder(n % 2 ? ORDER_BUY : ORDER_SELL, ORDER_LIMIT_PRICE, 100 + n, 10, n + 1);
+        BOOST_CHECK(dexCache.activeOrderCache.SetData(MakeOrderId(n), order));
+    }
+    dexCache.Flush();
+
+    uint32_t orderCount = 0;
+    BOOST_CHECK(dexCache.BuildOrderBook(orderCount) && orderCount == 10);
+    dexCache.Flush();
+    BOOST_CHECK(dexCache.BuildOrderBook(orderCount) && orderCount == 0);
+
+    auto pGetter = dexCache.CreateOrderBookGetter();
+    BOOST_CHECK(pGetter->Execute(CDEXOrderBookSide("WUSD", "GVC", ORDER_BUY), 2, 0));
+    BOOST_CHECK(pGetter->levels.size() == 2 && pGetter->levels[0].first == 109 && pGetter->levels[1].first == 107);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
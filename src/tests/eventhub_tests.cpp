@@ -0,0 +1,134 @@
+// Copyright (c) 2017-2019 The GreenVenturesChain Core developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "rpc/core/eventhub.h"
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "commons/util/util.h"
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(eventhub_tests)
+
+// The received text of the sink is kept by the test after the sink is released by the hub
+struct CTestSinkState {
+    mutable StdMutex cs;
+    string text;
+    atomic<bool> fClosed{false};
+    atomic<bool> fReleased{false};
+    atomic<size_t> unsentSize{0};
+
+    string GetText() const {
+        STD_LOCK(cs);
+        return text;
+    }
+};
+
+class CTestSink : public CRPCEventSink {
+public:
+    explicit CTestSink(const shared_ptr<CTestSinkState> &stateIn) : state(stateIn) {}
+    ~CTestSink() { state->fReleased = true; }
+
+    void Write(string &&text) override {
+        STD_LOCK(state->cs);
+        state->text += text;
+    }
+    bool IsClosed() const override { return state->fClosed; }
+    size_t GetUnsentSize() const override { return state->unsentSize; }
+
+private:
+    shared_ptr<CTestSinkState> state;
+};
+
+static shared_ptr<CTestSinkState> Subscribe(CRPCEventHub &hub, uint32_t topics) {
+    auto spState = make_shared<CTestSinkState>();
+    BOOST_CHECK(hub.Subscribe(topics, unique_ptr<CRPCEventSink>(new CTestSink(spState))));
+    return spState;
+}
+
+template <typename Pred>
+static bool WaitFor(Pred pred) {
+    for (int32_t i = 0; i < 500 && !pred(); i++)
+        MilliSleep(10);
+    return pred();
+}
+
+static size_t CountLines(const string &text) { return std::count(text.begin(), text.end(), '\n'); }
+
+BOOST_AUTO_TEST_CASE(eventhub_topics_test)
+{
+    uint32_t topics;
+    BOOST_CHECK(ParseEventTopics("", topics) && topics == EVENT_TOPIC_ALL);
+    BOOST_CHECK(ParseEventTopics("block,dex", topics) && topics == (EVENT_TOPIC_BLOCK | EVENT_TOPIC_DEX));
+    BOOST_CHECK(!ParseEventTopics("block,unknown", topics));
+    BOOST_CHECK(GetEventTopicNames(EVENT_TOPIC_TX | EVENT_TOPIC_CDP) == vector<string>({"tx", "cdp"}));
+}
+
+BOOST_AUTO_TEST_CASE(eventhub_fanout_test)
+{
+    CRPCEventHub hub;
+    // not started
+    BOOST_CHECK(!hub.Subscribe(EVENT_TOPIC_ALL, unique_ptr<CRPCEventSink>(new CTestSink(make_shared<CTestSinkState>()))));
+
+    hub.Start();
+    BOOST_CHECK(!hub.HasSubscribers(EVENT_TOPIC_BLOCK));
+    auto spBlock = Subscribe(hub, EVENT_TOPIC_BLOCK);
+    auto spAll   = Subscribe(hub, EVENT_TOPIC_ALL);
+    BOOST_CHECK(hub.HasSubscribers(EVENT_TOPIC_BLOCK) && hub.HasSubscribers(EVENT_TOPIC_CDP));
+
+    hub.Publish(EVENT_TOPIC_BLOCK, "{\"event\":\"block_connected\"}");
+    hub.Publish(EVENT_TOPIC_TX, "{\"event\":\"tx_accepted\"}");
+    BOOST_CHECK(WaitFor([&]() { return CountLines(spAll->GetText()) == 2; }));
+    BOOST_CHECK_EQUAL(spAll->GetText(), "{\"event\":\"block_connected\"}\n{\"event\":\"tx_accepted\"}\n");
+    BOOST_CHECK_EQUAL(spBlock->GetText(), "{\"event\":\"block_connected\"}\n");
+
+    // the closed subscriber is released by the dispatch thread
+    spAll->fClosed = true;
+    BOOST_CHECK(WaitFor([&]() { return spAll->fReleased.load(); }));
+    BOOST_CHECK(hub.GetSubscriberCount() == 1);
+    BOOST_CHECK(!hub.HasSubscribers(EVENT_TOPIC_TX));
+
+    for (size_t i = 1; i < MAX_RPC_EVENT_SUBSCRIBERS; i++)
+        Subscribe(hub, EVENT_TOPIC_TX);
+    BOOST_CHECK(!hub.Subscribe(EVENT_TOPIC_TX, unique_ptr<CRPCEventSink>(new CTestSink(make_shared<CTestSinkState>()))));
+
+    CRPCEventHub::Stats stats = hub.GetStats();
+    BOOST_CHECK(stats.published == 2 && stats.delivered == 3 && stats.dropped == 0);
+
+    hub.Stop();
+    BOOST_CHECK(spBlock->fReleased);
+    BOOST_CHECK(hub.GetSubscriberCount() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(eventhub_slow_subscriber_test)
+{
+    CRPCEventHub hub;
+    hub.Start();
+    auto spSlow = Subscribe(hub, EVENT_TOPIC_DEX);
+    auto spFast = Subscribe(hub, EVENT_TOPIC_DEX);
+
+    // the slow subscriber does not take the events, its queue is bounded
+    spSlow->unsentSize = MAX_RPC_EVENT_UNSENT_SIZE;
+    const size_t count = MAX_RPC_EVENT_QUEUE_SIZE + 100;
+    for (size_t i = 0; i < count; i++)
+        hub.Publish(EVENT_TOPIC_DEX, strprintf("{\"n\":%u}", i));
+
+    BOOST_CHECK(WaitFor([&]() { return CountLines(spFast->GetText()) == count; }));
+    BOOST_CHECK(spSlow->GetText().empty());
+    BOOST_CHECK(hub.GetStats().dropped == 100);
+
+    // the slow subscriber is told the dropped count, then receives the newest events
+    spSlow->unsentSize = 0;
+    BOOST_CHECK(WaitFor([&]() { return CountLines(spSlow->GetText()) == MAX_RPC_EVENT_QUEUE_SIZE + 1; }));
+    string text = spSlow->GetText();
+    BOOST_CHECK(text.compare(0, 33, "{\"event\":\"dropped\",\"count\":100}\n{") == 0);
+    BOOST_CHECK(text.find("{\"n\":100}\n") != string::npos && text.find("{\"n\":99}\n") == string::npos);
+    hub.Stop();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,214 @@
+// Copyright (c) 2017-2019 The GreenVenturesChain Core developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "p2p/headerssync.h"
+
+#include <map>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "main.h"
+
+using namespace std;
+
+// the signer of the test header is given by its nonce
+static const uint32_t NONCE_SIGNER_VERIFIED = 1;
+static const uint32_t NONCE_SIGNER_UNKNOWN  = 2;
+static const uint32_t NONCE_SIGNER_INVALID  = 3;
+
+class CTestHeadersContext : public CHeadersContext {
+public:
+    map<uint256, pair<int32_t, uint32_t>> blocks;  // the block index, hash -> height and time
+    uint32_t signerChecks = 0;
+
+    bool GetPrevBlock(const uint256 &hash, int32_t &height, uint32_t &time, CValidationState &state) override {
+        auto it = blocks.find(hash);
+        if (it == blocks.end())
+            return state.Invalid(false, REJECT_INVALID, "headers-not-connecting");
+
+        height = it->second.first;
+        time   = it->second.second;
+        return true;
+    }
+
+    bool HaveBlock(const uint256 &hash) override { return blocks.count(hash) > 0; }
+
+    HeaderSignerStatus CheckSigner(const CBlockHeader &header) override {
+        signerChecks++;
+        if (header.GetNonce() == NONCE_SIGNER_UNKNOWN)
+            return HEADER_SIGNER_UNKNOWN;
+        if (header.GetNonce() == NONCE_SIGNER_INVALID)
+            return HEADER_SIGNER_INVALID;
+        return HEADER_SIGNER_VERIFIED;
+    }
+
+    int64_t GetAdjustedTime() override { return 4000000000LL; }
+};
+
+static CBlockHeader MakeHeader(const uint256 &prevHash, int32_t height, uint32_t prevTime, uint32_t nonce,
+                               uint32_t delay = 0) {
+    CBlockHeader header;
+    header.SetVersion(CBlockHeader::CURRENT_VERSION);
+    header.SetPrevBlockHash(prevHash);
+    header.SetHeight(height);
+    header.SetTime(prevTime + ::GetBlockInterval(height) + delay);
+    header.SetNonce(nonce);
+    return header;
+}
+
+// count headers after the prev header, the one at signerHeight is signed by the given signer
+static vector<CBlockHeader> MakeHeaders(const CBlockHeader &prev, int32_t count, uint32_t delay = 0,
+                                        int32_t signerHeight = -1, uint32_t signerNonce = NONCE_SIGNER_VERIFIED) {
+    vector<CBlockHeader> headers;
+    uint256 prevHash  = prev.GetHash();
+    int32_t height    = prev.GetHeight();
+    uint32_t prevTime = prev.GetTime();
+    for (int32_t n = 0; n < count; n++) {
+        height++;
+        uint32_t nonce = height == signerHeight ? signerNonce : NONCE_SIGNER_VERIFIED;
+        headers.push_back(MakeHeader(prevHash, height, prevTime, nonce, delay));
+        prevHash = headers.back().GetHash();
+        prevTime = headers.back().GetTime();
+    }
+    return headers;
+}
+
+static CBlockHeader MakeGenesis(CTestHeadersContext &context) {
+    CBlockHeader genesis;
+    genesis.SetVersion(CBlockHeader::CURRENT_VERSION);
+    genesis.SetTime(1000000);
+    context.blocks[genesis.GetHash()] = make_pair(0, genesis.GetTime());
+    return genesis;
+}
+
+BOOST_AUTO_TEST_SUITE(headerssync_tests)
+
+BOOST_AUTO_TEST_CASE(headerssync_accept_test)
+{
+    CHeadersSync sync;
+    CTestHeadersContext context;
+    CBlockHeader genesis = MakeGenesis(context);
+    vector<CBlockHeader> headers = MakeHeaders(genesis, 10);
+
+    CValidationState state;
+    size_t acceptedCount = 0;
+    BOOST_CHECK(sync.AcceptHeaders(headers, context, state, acceptedCount));
+    BOOST_CHECK(acceptedCount == 10 && context.signerChecks == 10);
+    BOOST_CHECK(sync.GetBestHeight() == 10 && sync.GetBestHash() == headers.back().GetHash());
+    BOOST_CHECK(sync.HasHeader(headers[4].GetHash()) && sync.GetHeight(headers[4].GetHash()) == 5);
+    BOOST_CHECK(sync.GetHeight(genesis.GetHash()) == -1);
+
+    vector<uint256> hashes;
+    sync.GetHashes(3, 5, hashes);
+    BOOST_CHECK(hashes.size() == 3 && hashes[0] == headers[2].GetHash() && hashes[2] == headers[4].GetHash());
+
+    // the headers of the header chain are not verified again
+    BOOST_CHECK(sync.AcceptHeaders(vector<CBlockHeader>(headers.begin() + 5, headers.end()), context, state,
+                                   acceptedCount));
+    BOOST_CHECK(acceptedCount == 5 && context.signerChecks == 10);
+
+    vector<CBlockHeader> moreHeaders = MakeHeaders(headers.back(), 5);
+    BOOST_CHECK(sync.AcceptHeaders(moreHeaders, context, state, acceptedCount));
+    BOOST_CHECK(acceptedCount == 5 && sync.GetBestHeight() == 15);
+
+    sync.Prune(12);
+    BOOST_CHECK(!sync.HasHeader(headers.back().GetHash()) && sync.HasHeader(moreHeaders.back().GetHash()));
+    hashes.clear();
+    sync.GetHashes(1, 15, hashes);
+    BOOST_CHECK(hashes.size() == 3 && hashes.front() == moreHeaders[2].GetHash());
+}
+
+BOOST_AUTO_TEST_CASE(headerssync_invalid_test)
+{
+    CHeadersSync sync;
+    CTestHeadersContext context;
+    CBlockHeader genesis = MakeGenesis(context);
+    vector<CBlockHeader> headers = MakeHeaders(genesis, 10);
+    int32_t nDoS = 0;
+    size_t acceptedCount = 0;
+
+    // not connecting to the header chain or the block index
+    CValidationState state;
+    BOOST_CHECK(!sync.AcceptHeaders(vector<CBlockHeader>(headers.begin() + 1, headers.end()), context, state,
+                                    acceptedCount));
+    BOOST_CHECK(state.GetRejectReason() == "headers-not-connecting");
+
+    vector<CBlockHeader> badHeaders = headers;
+    std::swap(badHeaders[3], badHeaders[4]);
+    state = CValidationState();
+    BOOST_CHECK(!sync.AcceptHeaders(badHeaders, context, state, acceptedCount));
+    BOOST_CHECK(state.IsInvalid(nDoS) && nDoS == 100 && state.GetRejectReason() == "headers-non-continuous");
+
+    badHeaders = MakeHeaders(genesis, 10, 0, 6, NONCE_SIGNER_INVALID);
+    state = CValidationState();
+    BOOST_CHECK(!sync.AcceptHeaders(badHeaders, context, state, acceptedCount));
+    BOOST_CHECK(state.IsInvalid(nDoS) && nDoS == 100 && state.GetRejectReason() == "bad-block-signature");
+
+    badHeaders = {MakeHeader(genesis.GetHash(), 1, genesis.GetTime() - ::GetBlockInterval(1), NONCE_SIGNER_VERIFIED)};
+    state = CValidationState();
+    BOOST_CHECK(!sync.AcceptHeaders(badHeaders, context, state, acceptedCount));
+    BOOST_CHECK(state.GetRejectReason() == "time-too-early");
+
+    badHeaders = {MakeHeader(genesis.GetHash(), 2, genesis.GetTime(), NONCE_SIGNER_VERIFIED)};
+    state = CValidationState();
+    BOOST_CHECK(!sync.AcceptHeaders(badHeaders, context, state, acceptedCount));
+    BOOST_CHECK(state.GetRejectReason() == "incorrect-height");
+    BOOST_CHECK(sync.GetBestHeight() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(headerssync_unknown_signer_test)
+{
+    CHeadersSync sync;
+    CTestHeadersContext context;
+    CBlockHeader genesis = MakeGenesis(context);
+
+    // the headers from the unknown signer on are dropped without the peer punished
+    vector<CBlockHeader> headers = MakeHeaders(genesis, 10, 0, 6, NONCE_SIGNER_UNKNOWN);
+    CValidationState state;
+    size_t acceptedCount = 0;
+    BOOST_CHECK(sync.AcceptHeaders(headers, context, state, acceptedCount));
+    BOOST_CHECK(acceptedCount == 5 && sync.GetBestHeight() == 5);
+    BOOST_CHECK(sync.GetBestHash() == headers[4].GetHash() && !sync.HasHeader(headers[5].GetHash()));
+
+    // requested again after the signer is known
+    vector<CBlockHeader> moreHeaders = MakeHeaders(headers[4], 5);
+    BOOST_CHECK(sync.AcceptHeaders(moreHeaders, context, state, acceptedCount));
+    BOOST_CHECK(acceptedCount == 5 && sync.GetBestHeight() == 10);
+
+    headers = MakeHeaders(moreHeaders.back(), 3, 0, 11, NONCE_SIGNER_UNKNOWN);
+    BOOST_CHECK(sync.AcceptHeaders(headers, context, state, acceptedCount));
+    BOOST_CHECK(acceptedCount == 0 && sync.GetBestHeight() == 10);
+}
+
+BOOST_AUTO_TEST_CASE(headerssync_fork_test)
+{
+    CHeadersSync sync;
+    CTestHeadersContext context;
+    CBlockHeader genesis = MakeGenesis(context);
+    vector<CBlockHeader> headers = MakeHeaders(genesis, 10);
+    CValidationState state;
+    size_t acceptedCount = 0;
+    BOOST_CHECK(sync.AcceptHeaders(headers, context, state, acceptedCount));
+
+    // the shorter fork is not kept
+    vector<CBlockHeader> shortFork = MakeHeaders(headers[2], 5, 1);
+    BOOST_CHECK(sync.AcceptHeaders(shortFork, context, state, acceptedCount));
+    BOOST_CHECK(acceptedCount == 5 && sync.GetBestHash() == headers.back().GetHash());
+    BOOST_CHECK(!sync.HasHeader(shortFork.back().GetHash()));
+
+    // the longer fork replaces the headers after the fork point
+    vector<CBlockHeader> longFork = MakeHeaders(headers[2], 10, 1);
+    BOOST_CHECK(sync.AcceptHeaders(longFork, context, state, acceptedCount));
+    BOOST_CHECK(sync.GetBestHeight() == 13 && sync.GetBestHash() == longFork.back().GetHash());
+    BOOST_CHECK(sync.HasHeader(headers[2].GetHash()) && !sync.HasHeader(headers[3].GetHash()));
+    BOOST_CHECK(sync.GetHeight(longFork[0].GetHash()) == 4);
+}
+
+BOOST_AUTO_TEST_CASE(headerssync_download_window_test)
+{
+    BOOST_CHECK(CHeadersSync::GetPeerDownloadWindow(0) == MIN_BLOCKS_IN_TRANSIT_PER_PEER);
+    BOOST_CHECK(CHeadersSync::GetPeerDownloadWindow(10) == 10 * BLOCK_DOWNLOAD_TARGET_TIME);
+    BOOST_CHECK(CHeadersSync::GetPeerDownloadWindow(1000) == MAX_BLOCKS_IN_TRANSIT_PER_PEER);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,126 @@
+// Copyright (c) 2017-2019 The GreenVenturesChain Core developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "rpc/core/jsonwriter.h"
+
+#include <string>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "commons/json/json_spirit_writer_template.h"
+#include "commons/util/util.h"
+
+using namespace std;
+using namespace json_spirit;
+
+BOOST_AUTO_TEST_SUITE(jsonwriter_tests)
+
+static Object MakeOrder(uint32_t n) {
+    Object obj;
+    obj.push_back(Pair("order_id",      strprintf("%064x", n)));
+    obj.push_back(Pair("order_type",    "LIMIT_PRICE"));
+    obj.push_back(Pair("height",        (int32_t)n));
+    obj.push_back(Pair("amount",        (uint64_t)n * 100000000));
+    obj.push_back(Pair("balance",       (int64_t)n - 500));
+    obj.push_back(Pair("price",         n / 3.0));
+    obj.push_back(Pair("is_public",     n % 2 == 0));
+    obj.push_back(Pair("memo",          Value::null));
+    return obj;
+}
+
+BOOST_AUTO_TEST_CASE(jsonwriter_value_test)
+{
+    Object obj;
+    obj.push_back(Pair("text",      "a\"b\\c\nd\te\x01\x7f"));
+    obj.push_back(Pair("empty_obj", Object()));
+    obj.push_back(Pair("empty_arr", Array()));
+    obj.push_back(Pair("min",       std::numeric_limits<int64_t>::min()));
+    obj.push_back(Pair("max",       std::numeric_limits<uint64_t>::max()));
+    obj.push_back(Pair("real",      -0.5));
+    Array orders;
+    for (uint32_t n = 0; n < 3; n++)
+        orders.push_back(MakeOrder(n));
+    obj.push_back(Pair("orders",    orders));
+
+    CJsonWriter writer;
+    writer.Write(Value(obj));
+    BOOST_CHECK(writer.IsComplete());
+    BOOST_CHECK_EQUAL(writer.GetBuffer(), write_string(Value(obj), false));
+
+    // the same text written by the members
+    CJsonWriter memberWriter;
+    memberWriter.BeginObject();
+    memberWriter.Member("text", "a\"b\\c\nd\te\x01\x7f");
+    memberWriter.Key("empty_obj").BeginObject().EndObject();
+    memberWriter.Key("empty_arr").BeginArray().EndArray();
+    memberWriter.Member("min", std::numeric_limits<int64_t>::min());
+    memberWriter.Member("max", std::numeric_limits<uint64_t>::max());
+    memberWriter.Member("real", -0.5);
+    memberWriter.Key("orders").BeginArray();
+    for (uint32_t n = 0; n < 3; n++)
+        memberWriter.Write(MakeOrder(n));
+    memberWriter.EndArray();
+    BOOST_CHECK(!memberWriter.IsComplete());
+    memberWriter.EndObject();
+    BOOST_CHECK(memberWriter.IsComplete());
+    BOOST_CHECK_EQUAL(memberWriter.GetBuffer(), writer.GetBuffer());
+
+    const char data[] = {0x00, 0x1f, (char)0xab, (char)0xff};
+    CJsonWriter hexWriter;
+    hexWriter.WriteHex(data, data + sizeof(data));
+    BOOST_CHECK_EQUAL(hexWriter.GetBuffer(), write_string(Value(HexStr(data, data + sizeof(data))), false));
+}
+
+BOOST_AUTO_TEST_CASE(jsonwriter_chunk_test)
+{
+    const size_t chunkSize = 256;
+    vector<string> chunks;
+    CJsonWriter writer(chunkSize, [&chunks](string &&chunk) { chunks.push_back(std::move(chunk)); });
+
+    Array orders;
+    writer.BeginArray();
+    for (uint32_t n = 0; n < 100; n++) {
+        orders.push_back(MakeOrder(n));
+        writer.Write(orders.back());
+        // the buffer is bounded by the chunk size and the size of one value
+        BOOST_CHECK(writer.GetBuffer().size() < chunkSize);
+    }
+    writer.EndArray();
+    BOOST_CHECK(writer.IsFlushed());
+    writer.Flush();
+    BOOST_CHECK(writer.GetBuffer().empty());
+
+    string text;
+    for (size_t i = 0; i < chunks.size(); i++) {
+        // only the last chunk of the final flush is smaller than the chunk size
+        BOOST_CHECK(chunks[i].size() >= chunkSize || i + 1 == chunks.size());
+        text += chunks[i];
+    }
+    BOOST_CHECK_EQUAL(text, write_string(Value(orders), false));
+    BOOST_CHECK_EQUAL(writer.GetSize(), text.size());
+}
+
+BOOST_AUTO_TEST_CASE(jsonwriter_end_all_test)
+{
+    // the value written in part, e.g. the handler failed in the middle of the order
+    CJsonWriter writer;
+    writer.BeginObject().Member("count", (int64_t)2);
+    writer.Key("orders").BeginArray();
+    writer.Write(MakeOrder(1));
+    writer.BeginObject().Key("order_id");
+    BOOST_CHECK(!writer.IsComplete());
+    writer.EndAll();
+    BOOST_CHECK(writer.IsComplete());
+
+    Object partialOrder;
+    partialOrder.push_back(Pair("order_id", Value::null));
+    Array orders;
+    orders.push_back(MakeOrder(1));
+    orders.push_back(partialOrder);
+    Object obj;
+    obj.push_back(Pair("count", (int64_t)2));
+    obj.push_back(Pair("orders", orders));
+    BOOST_CHECK_EQUAL(writer.GetBuffer(), write_string(Value(obj), false));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,100 @@
+// Copyright (c) 2017-2019 The GreenVenturesChain Core developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "vm/luavm/luavmrunenv.h"
+#include "main.h"
+#include "tx/contracttx.h"
+
+#include <string>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+// the contracts run without mylib, so they do not depend on the accounts
+static const vector<string> kTestContracts = {
+    "local t = {}\n"
+    "for i = 1, 200 do t[i] = 'item_' .. i .. '_' .. contract[1] end\n"
+    "gValue = #table.concat(t, ',')\n",
+
+    "local t = {}\n"
+    "for i = 1, 20000 do t[i % 500 + 1] = {i, 'v' .. i, string.rep('z', i % 64)} end\n"
+    "local s = ''\n"
+    "for i = 1, 300 do s = s .. tostring(i) end\n",
+};
+
+// run the contract and return the burned fuel
+static uint64_t RunContract(const string &code, bool useVmCache) {
+    CCacheWrapper cw(pCdMan);
+    CLuaContractInvokeTx tx;
+    CAccount txAccount, appAccount;
+    CUniversalContract contract(code, "");
+    string arguments = "01";
+
+    CLuaVMContext context;
+    context.p_cw              = &cw;
+    context.height            = SysCfg().GetVer3ForkHeight();
+    context.p_base_tx         = &tx;
+    context.fuel_limit        = MAX_BLOCK_RUN_STEP;
+    context.p_tx_user_account = &txAccount;
+    context.p_app_account     = &appAccount;
+    context.p_contract        = &contract;
+    context.p_arguments       = &arguments;
+    context.use_vm_cache      = useVmCache;
+
+    CLuaVMRunEnv vmRunEnv;
+    uint64_t runStep = 0;
+    auto pExecErr = vmRunEnv.ExecuteContract(&context, runStep);
+    BOOST_CHECK_MESSAGE(!pExecErr, (pExecErr ? *pExecErr : string()));
+    return runStep;
+}
+
+BOOST_AUTO_TEST_SUITE(luavm_tests)
+
+BOOST_AUTO_TEST_CASE(luavm_code_cache_fuel_test)
+{
+    for (const auto &code : kTestContracts) {
+        uint64_t fuel = RunContract(code, false);
+        BOOST_CHECK(fuel > 0);
+
+        uint64_t hits = luaCodeCache.GetStats().hits;
+        BOOST_CHECK_EQUAL(RunContract(code, true), fuel);  // parsed and cached
+        BOOST_CHECK_EQUAL(RunContract(code, true), fuel);  // loaded from cache
+        BOOST_CHECK_EQUAL(luaCodeCache.GetStats().hits, hits + 1);
+
+        // the consensus execution parses the cached code
+        BOOST_CHECK_EQUAL(RunContract(code, false), fuel);
+        BOOST_CHECK_EQUAL(luaCodeCache.GetStats().hits, hits + 1);
+    }
+}
+
+// wait for the worker thread to prepare the states
+static bool WaitPreparedStates(uint32_t count) {
+    for (int i = 0; i < 500 && luaStatePool.GetStats().prepared < count; i++)
+        MilliSleep(10);
+    return luaStatePool.GetStats().prepared >= count;
+}
+
+BOOST_AUTO_TEST_CASE(luavm_state_pool_fuel_test)
+{
+    uint32_t poolSize = luaStatePool.GetMaxSize();
+    luaStatePool.Start(2);
+
+    for (const auto &code : kTestContracts) {
+        uint64_t fuel = RunContract(code, false);
+
+        // the prepared state after the other contracts burns the same fuel as the new state
+        for (const auto &otherCode : kTestContracts) {
+            BOOST_CHECK(WaitPreparedStates(2));
+            uint64_t acquired = luaStatePool.GetStats().acquired;
+            RunContract(otherCode, true);
+            BOOST_CHECK_EQUAL(RunContract(code, true), fuel);
+            BOOST_CHECK_EQUAL(luaStatePool.GetStats().acquired, acquired + 2);
+        }
+    }
+
+    luaStatePool.Start(poolSize);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
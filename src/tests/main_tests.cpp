@@ -4,7 +4,25 @@
 
 #include "main.h"
 
+#include <memory>
 #include <boost/test/unit_test.hpp>
+#include "tx/blockrewardtx.h"
+#include "tx/cointransfertx.h"
+#include "tx/txmempool.h"
+
+using namespace std;
+
+class CTestRejectListener : public CChainEventListener {
+public:
+    vector<string> rejectReasons;
+
+protected:
+    void SyncTransaction(const uint256 &hash, CBaseTx *pBaseTx, const CBlock *pBlock) override {}
+    void RejectTransaction(const uint256 &hash, CBaseTx *pBaseTx, const CValidationState &state) override {
+        rejectReasons.push_back(state.GetRejectReason());
+    }
+    void ForceLiquidateCdps(const uint256 &txid, const vector<CUserCDP> &cdps, uint64_t bcoinMedianPrice) override {}
+};
 
 BOOST_AUTO_TEST_SUITE(main_tests)
 
@@ -35,4 +53,28 @@ BOOST_AUTO_TEST_CASE(subsidy_limit_test)
 // 	}
 }
 
+BOOST_AUTO_TEST_CASE(reject_transaction_test)
+{
+    CTestRejectListener listener;
+    RegisterChainEventListener(&listener);
+
+    LOCK(cs_main);
+    CTxMemPool pool;
+    CBaseCoinTransferTx tx(CRegID(1, 2), CRegID(1, 3), 10, 1, 10000, "");
+    pool.memPoolTxs[tx.GetHash()] = CTxMemPoolEntry(&tx, 0, 10);
+
+    // the duplicate is not published
+    CValidationState state;
+    BOOST_CHECK(!AcceptToMemoryPool(pool, state, &tx, false));
+    BOOST_CHECK(state.IsInvalid() && state.GetRejectCode() == REJECT_DUPLICATE);
+    BOOST_CHECK(listener.rejectReasons.empty());
+
+    CBlockRewardTx rewardTx(CRegID(1, 1).GetRegIdRaw(), 0, 10);
+    CValidationState rewardState;
+    BOOST_CHECK(!AcceptToMemoryPool(pool, rewardState, &rewardTx, false));
+    BOOST_CHECK(listener.rejectReasons == vector<string>({"tx-coinbase-to-mempool"}));
+
+    UnregisterChainEventListener(&listener);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
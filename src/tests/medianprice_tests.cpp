@@ -0,0 +1,101 @@
+// Copyright (c) 2017-2019 The GreenVenturesChain Core developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "persistence/pricefeeddb.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+// the median of the sorted prices before the ring buffer
+static uint64_t ComputeSortedMedian(const BlockUserPriceMap &blockUserPrices, int32_t beginHeight, int32_t endHeight) {
+    vector<uint64_t> prices;
+    for (auto it = blockUserPrices.upper_bound(beginHeight); it != blockUserPrices.end() && it->first <= endHeight; it++) {
+        for (const auto &userPrice : it->second)
+            prices.push_back(userPrice.second);
+    }
+    if (prices.empty())
+        return 0;
+
+    sort(prices.begin(), prices.end());
+    size_t size = prices.size();
+    return (size % 2 == 0) ? (prices[size / 2 - 1] + prices[size / 2]) / 2 : prices[size / 2];
+}
+
+static uint64_t MakePrice(uint32_t n) { return 100000000 + (n * 7919) % 1000 * 10000; }
+
+BOOST_AUTO_TEST_SUITE(medianprice_tests)
+
+BOOST_AUTO_TEST_CASE(medianprice_set_test)
+{
+    CMedianPriceSet prices;
+    BOOST_CHECK(prices.GetMedian() == 0);
+    prices.Insert(30);
+    BOOST_CHECK(prices.GetMedian() == 30);
+    prices.Insert(10);
+    BOOST_CHECK(prices.GetMedian() == 20);
+    prices.Insert(10);
+    prices.Insert(50);
+    prices.Insert(40);
+    BOOST_CHECK(prices.Size() == 5 && prices.GetMedian() == 30);
+
+    BOOST_CHECK(!prices.Erase(20));
+    BOOST_CHECK(prices.Erase(10));
+    BOOST_CHECK(prices.GetMedian() == 35);
+    BOOST_CHECK(prices.Erase(50) && prices.Erase(40));
+    BOOST_CHECK(prices.GetMedian() == 20);
+    BOOST_CHECK(prices.Erase(10) && prices.Erase(30));
+    BOOST_CHECK(prices.Size() == 0 && prices.GetMedian() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(medianprice_window_test)
+{
+    CBlockPriceWindow window;
+    BlockUserPriceMap blockUserPrices;
+    for (int32_t height = 1; height <= 40; height++) {
+        for (uint32_t n = 0; n < 5; n++) {
+            CRegID regId(1, n);
+            uint64_t price = MakePrice(height * 5 + n);
+            BOOST_CHECK(window.AddUserPrice(height, regId, price));
+            blockUserPrices[height][regId] = price;
+        }
+        BOOST_CHECK(!window.AddUserPrice(height, CRegID(1, 0), 1));
+        BOOST_CHECK(window.ExistUserPrice(height, CRegID(1, 0)));
+
+        int32_t beginHeight = std::max<int32_t>(height - PRICE_POINT_CACHE_BLOCK_COUNT, 0);
+        BOOST_CHECK(window.ComputeMedianPrice(beginHeight, height, {}) ==
+                    ComputeSortedMedian(blockUserPrices, beginHeight, height));
+    }
+    // the blocks out of the ring buffer are dropped
+    BOOST_CHECK(!window.ExistUserPrice(40 - PRICE_POINT_WINDOW_SLOT_COUNT, CRegID(1, 0)));
+    BOOST_CHECK(window.GetEvictedHeight() == 40 - PRICE_POINT_WINDOW_SLOT_COUNT);
+
+    // the blocks changed by the upper caches, the empty one is deleted
+    BlockUserPriceMap changedBlocks;
+    changedBlocks[38] = {};
+    changedBlocks[41] = {{CRegID(1, 0), 1}, {CRegID(1, 1), 2}};
+    changedBlocks[40] = {{CRegID(1, 0), 3}};
+    BlockUserPriceMap changedUserPrices = blockUserPrices;
+    for (const auto &item : changedBlocks)
+        changedUserPrices[item.first] = item.second;
+    BOOST_CHECK(window.ComputeMedianPrice(30, 41, changedBlocks) == ComputeSortedMedian(changedUserPrices, 30, 41));
+    // the window is restored after the changed blocks are computed
+    BOOST_CHECK(window.ComputeMedianPrice(29, 40, {}) == ComputeSortedMedian(blockUserPrices, 29, 40));
+
+    window.DeleteBlock(40);
+    blockUserPrices.erase(40);
+    BOOST_CHECK(!window.ExistUserPrice(40, CRegID(1, 0)));
+    BOOST_CHECK(window.ComputeMedianPrice(28, 39, {}) == ComputeSortedMedian(blockUserPrices, 28, 39));
+
+    BlockUserPriceMap windowUserPrices;
+    window.GetBlockUserPrices(windowUserPrices);
+    BOOST_CHECK(windowUserPrices.size() == PRICE_POINT_WINDOW_SLOT_COUNT - 1);
+    BOOST_CHECK(windowUserPrices.begin()->first == 40 - PRICE_POINT_WINDOW_SLOT_COUNT + 1);
+    BOOST_CHECK(windowUserPrices.rbegin()->second == blockUserPrices[39]);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
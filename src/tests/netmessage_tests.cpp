@@ -0,0 +1,122 @@
+// Copyright (c) 2017-2019 The GreenVenturesChain Core developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "p2p/netmessage.h"
+
+#include <algorithm>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "crypto/hash.h"
+
+using namespace std;
+
+static CDataStream MakePayload(size_t size) {
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    for (size_t i = 0; i < size; i++)
+        ss << (uint8_t)(i * 31);
+    return ss;
+}
+
+// parse the framed message by the receiving side in chunks of nChunk bytes
+static bool ParseMessage(const CSerializeData &data, uint32_t nChunk, CNetMessage &msg) {
+    const char *pch = data.data();
+    uint32_t nBytes = data.size();
+    while (nBytes > 0) {
+        int32_t handled = msg.in_data ? msg.readData(pch, min(nChunk, nBytes)) : msg.readHeader(pch, min(nChunk, nBytes));
+        if (handled < 0)
+            return false;
+        pch += handled;
+        nBytes -= handled;
+    }
+    return msg.complete();
+}
+
+BOOST_AUTO_TEST_SUITE(netmessage_tests)
+
+BOOST_AUTO_TEST_CASE(netmessage_shared_framing_test)
+{
+    CDataStream payload = MakePayload(1000);
+    CSharedMessage spMessage = MakeSharedMessage("tx", payload);
+    BOOST_CHECK_EQUAL(spMessage->size(), CMessageHeader::HEADER_SIZE + payload.size());
+
+    for (uint32_t nChunk : {1, 7, 24, 100, 0x10000}) {
+        CNetMessage msg(SER_NETWORK, PROTOCOL_VERSION);
+        BOOST_CHECK(ParseMessage(*spMessage, nChunk, msg));
+        BOOST_CHECK(msg.hdr.IsValid());
+        BOOST_CHECK_EQUAL(msg.hdr.GetCommand(), "tx");
+        BOOST_CHECK_EQUAL(msg.hdr.nMessageSize, payload.size());
+        BOOST_CHECK(msg.vRecv.str() == payload.str());
+
+        uint256 hash       = Hash(msg.vRecv.begin(), msg.vRecv.end());
+        uint32_t nChecksum = 0;
+        memcpy(&nChecksum, &hash, sizeof(nChecksum));
+        BOOST_CHECK_EQUAL(nChecksum, msg.hdr.nChecksum);
+        recvBufferPool.Release(msg.vRecv);
+    }
+
+    // the empty payload
+    CSharedMessage spEmpty = MakeSharedMessage("verack", CDataStream(SER_NETWORK, PROTOCOL_VERSION));
+    CNetMessage msg(SER_NETWORK, PROTOCOL_VERSION);
+    BOOST_CHECK(ParseMessage(*spEmpty, 24, msg));
+    BOOST_CHECK_EQUAL(msg.hdr.GetCommand(), "verack");
+    BOOST_CHECK_EQUAL(msg.hdr.nMessageSize, 0U);
+}
+
+BOOST_AUTO_TEST_CASE(netmessage_recv_buffer_pool_test)
+{
+    CRecvBufferPool pool;
+    CDataStream stream(SER_NETWORK, PROTOCOL_VERSION);
+    pool.Acquire(stream, 5000);
+    BOOST_CHECK_EQUAL(stream.size(), 5000U);
+    const char *pBuffer = &stream[0];
+    stream[0] = 0x55;
+
+    pool.Release(stream);
+    BOOST_CHECK(stream.empty());
+    BOOST_CHECK_EQUAL(pool.GetPooledCount(), 1U);
+
+    // the pooled buffer is reused by the message of its size class, the bytes of the last message are kept
+    CDataStream other(SER_NETWORK, PROTOCOL_VERSION);
+    pool.Acquire(other, 6000);
+    BOOST_CHECK_EQUAL(other.size(), 6000U);
+    BOOST_CHECK(&other[0] == pBuffer && other[0] == 0x55);
+    BOOST_CHECK_EQUAL(pool.GetPooledCount(), 0U);
+
+    // and by the message of the size class below, not by the smaller ones
+    pool.Release(other);
+    CDataStream small(SER_NETWORK, PROTOCOL_VERSION);
+    pool.Acquire(small, 300);
+    BOOST_CHECK(&small[0] != pBuffer);
+    BOOST_CHECK_EQUAL(pool.GetPooledCount(), 1U);
+    pool.Acquire(stream, 3000);
+    BOOST_CHECK(&stream[0] == pBuffer);
+    BOOST_CHECK_EQUAL(pool.GetPooledCount(), 0U);
+
+    // the buffers beyond the limit of the size class are freed
+    vector<CDataStream> streams(20, CDataStream(SER_NETWORK, PROTOCOL_VERSION));
+    for (auto &item : streams)
+        pool.Acquire(item, 5000);
+    for (auto &item : streams)
+        pool.Release(item);
+    BOOST_CHECK_EQUAL(pool.GetPooledCount(), 16U);
+
+    // the message larger than the size classes is not pooled
+    CDataStream huge(SER_NETWORK, PROTOCOL_VERSION);
+    pool.Acquire(huge, 8 * 1024 * 1024);
+    BOOST_CHECK_EQUAL(huge.size(), 8U * 1024 * 1024);
+    pool.Release(huge);
+    BOOST_CHECK_EQUAL(pool.GetPooledCount(), 16U);
+}
+
+BOOST_AUTO_TEST_CASE(netmessage_shared_version_test)
+{
+    // the payload is serialized at the given version
+    CSharedMessage spMessage = MakeSharedMessage("ping", (uint64_t)1, INIT_PROTO_VERSION);
+    CNetMessage msg(SER_NETWORK, PROTOCOL_VERSION);
+    BOOST_CHECK(ParseMessage(*spMessage, 24, msg));
+    BOOST_CHECK_EQUAL(msg.hdr.GetCommand(), "ping");
+    BOOST_CHECK_EQUAL(msg.hdr.nMessageSize, sizeof(uint64_t));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
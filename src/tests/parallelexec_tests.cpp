@@ -0,0 +1,292 @@
+// Copyright (c) 2017-2019 The GreenVenturesChain Core developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "parallelexec.h"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <boost/test/unit_test.hpp>
+#include "crypto/sha256.h"
+#include "persistence/dbaccess.h"
+
+using namespace std;
+
+struct FParallelExecTests {
+    FParallelExecTests() {
+        root_dir = "/tmp/coin_unit_test";
+        if (boost::filesystem::exists(root_dir))
+            BOOST_CHECK(boost::filesystem::is_directory(root_dir));
+        else
+            BOOST_CHECK_NO_THROW(boost::filesystem::create_directory(root_dir));
+
+        db_dir = root_dir / "parallelexec_tests";
+        BOOST_CHECK_NO_THROW(boost::filesystem::remove_all(db_dir));
+        BOOST_CHECK_NO_THROW(boost::filesystem::create_directory(db_dir));
+        pool.Start(4);
+    }
+    ~FParallelExecTests() {
+        pool.Stop();
+        BOOST_CHECK_NO_THROW(boost::filesystem::remove_all(db_dir));
+    }
+
+    boost::filesystem::path root_dir;
+    boost::filesystem::path db_dir;
+    CParallelTaskPool pool;
+};
+
+typedef CCompositeKVCache<dbk::REGID_KEYID, string, uint64_t> CTestBalanceCache;
+
+// the cache wrapper of the test, the balances of the accounts
+class CTestCacheWrapper {
+public:
+    CTestBalanceCache balanceCache;
+
+    CTestCacheWrapper(CDBAccess *pDbAccess) : balanceCache(pDbAccess) {}
+    CTestCacheWrapper(CTestCacheWrapper *pBase) : balanceCache(&pBase->balanceCache) {}
+
+    void SetDbAccessLog(CDbAccessLog *pDbAccessLog) { balanceCache.SetDbAccessLog(pDbAccessLog); }
+    void SetDbOpLogMap(CDBOpLogMap *pDbOpLogMap) { balanceCache.SetDbOpLogMap(pDbOpLogMap); }
+    void Flush() { balanceCache.Flush(); }
+};
+
+struct CTestTx {
+    string from;
+    string to;
+    uint64_t amount;
+    bool parallel;   // eligible for parallel execution
+    bool listAll;    // pay the amount to every account, reads the whole prefix
+};
+
+static uint64_t GetBalance(CTestCacheWrapper &cw, const string &account) {
+    uint64_t balance = 0;
+    cw.balanceCache.GetData(account, balance);
+    return balance;
+}
+
+static bool ExecuteTestTx(const CTestTx &tx, CTestCacheWrapper &cw) {
+    if (tx.listAll) {
+        map<string, uint64_t> balances;
+        cw.balanceCache.GetAllElements(balances);
+        uint64_t total = tx.amount * balances.size();
+        uint64_t fromBalance = GetBalance(cw, tx.from);
+        if (fromBalance < total)
+            return false;
+
+        cw.balanceCache.SetData(tx.from, fromBalance - total);
+        for (const auto &item : balances)
+            cw.balanceCache.SetData(item.first, GetBalance(cw, item.first) + tx.amount);
+        return true;
+    }
+
+    uint64_t fromBalance = GetBalance(cw, tx.from);
+    if (fromBalance < tx.amount)
+        return false;
+
+    cw.balanceCache.SetData(tx.from, fromBalance - tx.amount);
+    cw.balanceCache.SetData(tx.to, GetBalance(cw, tx.to) + tx.amount);
+    return true;
+}
+
+static uint256 GetStateDigest(CTestCacheWrapper &cw, map<string, uint64_t> &balances) {
+    cw.balanceCache.GetAllElements(balances);
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    ss << balances;
+    string data = ss.str();
+
+    uint256 digest;
+    CSHA256().Write((const unsigned char *)data.data(), data.size()).Finalize(digest.begin());
+    return digest;
+}
+
+static string SerializeUndoLogs(const vector<CDBOpLogMap> &undoLogs) {
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    ss << undoLogs;
+    return ss.str();
+}
+
+BOOST_FIXTURE_TEST_SUITE(parallelexec_tests, FParallelExecTests)
+
+BOOST_AUTO_TEST_CASE(parallelexec_task_pool_test)
+{
+    vector<std::atomic<uint32_t>> counts(1000);
+    for (int32_t round = 0; round < 3; round++)
+        pool.Run(counts.size(), [&](size_t index) { counts[index]++; });
+
+    for (const auto &count : counts)
+        BOOST_CHECK(count == 3);
+    BOOST_CHECK(pool.GetThreadCount() == 4);
+
+    // the exception of the task is thrown to the caller, and the pool can run the next batch
+    BOOST_CHECK_THROW(pool.Run(counts.size(), [&](size_t index) {
+        if (index == 500)
+            throw runtime_error("task failed");
+    }), runtime_error);
+    pool.Run(counts.size(), [&](size_t index) { counts[index]++; });
+    for (const auto &count : counts)
+        BOOST_CHECK(count == 4);
+}
+
+// the state and the undo logs of the parallel execution must be the same as the serial execution
+BOOST_AUTO_TEST_CASE(parallelexec_differential_test)
+{
+    CDBAccess dbAccess(db_dir, DBNameType::ACCOUNT, false, true);
+    {
+        CTestBalanceCache initCache(&dbAccess);
+        for (int32_t i = 0; i < 50; i++)
+            initCache.SetData(strprintf("account-%d", i), 1000);
+        initCache.Flush();
+    }
+    CTestCacheWrapper dbCw(&dbAccess);
+
+    vector<CTestTx> txs;
+    for (int32_t i = 0; i < 400; i++) {
+        CTestTx tx;
+        tx.from     = strprintf("account-%d", (i * 7) % 50);
+        tx.to       = strprintf("account-%d", (i * 13 + 5) % 60);  // some of the receivers are new accounts
+        tx.amount   = 10 + i % 30;
+        tx.parallel = i % 11 != 0;
+        tx.listAll  = i % 97 == 50;
+        if (tx.listAll)
+            tx.amount = 1;
+        txs.push_back(tx);
+    }
+
+    // serial execution
+    CTestCacheWrapper serialCw(&dbCw);
+    vector<CDBOpLogMap> serialUndoLogs(txs.size());
+    for (size_t i = 0; i < txs.size(); i++) {
+        serialCw.SetDbOpLogMap(&serialUndoLogs[i]);
+        BOOST_CHECK(ExecuteTestTx(txs[i], serialCw));
+        serialCw.SetDbOpLogMap(nullptr);
+    }
+
+    // parallel execution
+    CTestCacheWrapper parallelCw(&dbCw);
+    vector<CDBOpLogMap> parallelUndoLogs;
+    vector<size_t> commitOrder;
+    CParallelExecStats stats;
+    size_t failedIndex = 0;
+    bool executed = ExecuteTxsInParallel<CTestCacheWrapper>(pool, parallelCw, txs.size(),
+        [&](size_t index) { return txs[index].parallel; },
+        [&](size_t index, CTestCacheWrapper &txCw) { return ExecuteTestTx(txs[index], txCw); },
+        [&](size_t index, CDBOpLogMap &undoLogs) {
+            commitOrder.push_back(index);
+            parallelUndoLogs.push_back(undoLogs);
+            return true;
+        },
+        failedIndex, stats);
+    BOOST_CHECK(executed);
+
+    for (size_t i = 0; i < commitOrder.size(); i++)
+        BOOST_CHECK(commitOrder[i] == i);
+    BOOST_CHECK(commitOrder.size() == txs.size());
+    BOOST_CHECK(stats.reexecutedCount > 0);
+    BOOST_CHECK(stats.serialCount > 0);
+    BOOST_CHECK(stats.parallelCount + stats.serialCount == txs.size());
+
+    map<string, uint64_t> serialBalances, parallelBalances;
+    BOOST_CHECK(GetStateDigest(serialCw, serialBalances) == GetStateDigest(parallelCw, parallelBalances));
+    BOOST_CHECK(serialBalances == parallelBalances);
+    BOOST_CHECK(serialBalances.size() > 50);
+    BOOST_CHECK(SerializeUndoLogs(serialUndoLogs) == SerializeUndoLogs(parallelUndoLogs));
+}
+
+// the failed tx is the same as the serial execution, even the optimistic execution of it succeeded
+BOOST_AUTO_TEST_CASE(parallelexec_failed_tx_test)
+{
+    CDBAccess dbAccess(db_dir, DBNameType::ACCOUNT, false, true);
+    CTestCacheWrapper dbCw(&dbAccess);
+    dbCw.balanceCache.SetData("account-a", 100);
+
+    // the 3rd tx fails after the balance is spent by the 2nd tx
+    vector<CTestTx> txs = {
+        {"account-a", "account-b", 10, true, false},
+        {"account-a", "account-c", 80, true, false},
+        {"account-a", "account-d", 20, true, false},
+        {"account-b", "account-d", 5, true, false},
+    };
+
+    CTestCacheWrapper cw(&dbCw);
+    CParallelExecStats stats;
+    size_t committedCount = 0;
+    size_t failedIndex    = 0;
+    bool executed = ExecuteTxsInParallel<CTestCacheWrapper>(pool, cw, txs.size(),
+        [&](size_t index) { return txs[index].parallel; },
+        [&](size_t index, CTestCacheWrapper &txCw) { return ExecuteTestTx(txs[index], txCw); },
+        [&](size_t index, CDBOpLogMap &undoLogs) { committedCount++; return true; },
+        failedIndex, stats);
+
+    BOOST_CHECK(!executed);
+    BOOST_CHECK(failedIndex == 2);
+    BOOST_CHECK(committedCount == 2);
+    BOOST_CHECK(GetBalance(cw, "account-a") == 10);
+    BOOST_CHECK(GetBalance(cw, "account-d") == 0);
+}
+
+// the exception of the parallel execution fails the batch, which is run serially
+BOOST_AUTO_TEST_CASE(parallelexec_exception_test)
+{
+    CDBAccess dbAccess(db_dir, DBNameType::ACCOUNT, false, true);
+    CTestCacheWrapper dbCw(&dbAccess);
+    dbCw.balanceCache.SetData("account-a", 100);
+
+    vector<CTestTx> txs = {
+        {"account-a", "account-b", 10, true, false},
+        {"account-a", "account-c", 20, true, false},
+        {"account-b", "account-d", 5, true, false},
+    };
+
+    CTestCacheWrapper cw(&dbCw);
+    CParallelExecStats stats;
+    std::atomic<bool> fThrown(false);
+    size_t committedCount = 0;
+    size_t failedIndex    = 0;
+    bool executed = ExecuteTxsInParallel<CTestCacheWrapper>(pool, cw, txs.size(),
+        [&](size_t index) { return txs[index].parallel; },
+        [&](size_t index, CTestCacheWrapper &txCw) {
+            if (index == 1 && !fThrown.exchange(true))
+                throw runtime_error("parallel execution failed");
+            return ExecuteTestTx(txs[index], txCw);
+        },
+        [&](size_t index, CDBOpLogMap &undoLogs) { committedCount++; return true; },
+        failedIndex, stats);
+
+    BOOST_CHECK(executed);
+    BOOST_CHECK(fThrown);
+    BOOST_CHECK(committedCount == txs.size());
+    BOOST_CHECK(stats.parallelCount == 0 && stats.reexecutedCount == 0);
+    BOOST_CHECK(GetBalance(cw, "account-a") == 70);
+    BOOST_CHECK(GetBalance(cw, "account-d") == 5);
+
+    // the exception not derived from std::exception fails the batch as well
+    CTestCacheWrapper cw3(&dbCw);
+    fThrown = false;
+    committedCount = 0;
+    executed = ExecuteTxsInParallel<CTestCacheWrapper>(pool, cw3, txs.size(),
+        [&](size_t index) { return txs[index].parallel; },
+        [&](size_t index, CTestCacheWrapper &txCw) {
+            if (index == 1 && !fThrown.exchange(true))
+                throw 1;
+            return ExecuteTestTx(txs[index], txCw);
+        },
+        [&](size_t index, CDBOpLogMap &undoLogs) { committedCount++; return true; },
+        failedIndex, stats);
+
+    BOOST_CHECK(executed);
+    BOOST_CHECK(fThrown);
+    BOOST_CHECK(committedCount == txs.size());
+    BOOST_CHECK(GetBalance(cw3, "account-a") == 70);
+    BOOST_CHECK(GetBalance(cw3, "account-d") == 5);
+
+    // the exception of the serial execution is thrown to the caller
+    CTestCacheWrapper cw2(&dbCw);
+    BOOST_CHECK_THROW(ExecuteTxsInParallel<CTestCacheWrapper>(pool, cw2, txs.size(),
+        [&](size_t index) { return txs[index].parallel; },
+        [&](size_t index, CTestCacheWrapper &txCw) -> bool { throw runtime_error("execution failed"); },
+        [&](size_t index, CDBOpLogMap &undoLogs) { return true; },
+        failedIndex, stats), runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,58 @@
+// Copyright (c) 2017-2019 The GreenVenturesChain Core developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "sigcache.h"
+#include "commons/arith_uint256.h"
+
+#include <vector>
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(sigcache_tests)
+
+static void MakeEntry(uint32_t n, uint256 &sigHash, vector<unsigned char> &sig, CPubKey &pubKey) {
+    sigHash = ArithToUint256(arith_uint256(n));
+    sig.assign(72, (unsigned char)(n & 0xFF));
+    vector<unsigned char> pubKeyData(33, (unsigned char)(n >> 8));
+    pubKeyData[0] = 0x02;
+    pubKey = CPubKey(pubKeyData.begin(), pubKeyData.end());
+}
+
+BOOST_AUTO_TEST_CASE(sigcache_bounded_test)
+{
+    CSignatureCache cache;
+    // 2 entries per generation of each shard
+    cache.SetMaxMemory(CSignatureCache::ENTRY_MEMORY_SIZE * CSignatureCache::SHARD_COUNT * 4);
+    const uint64_t maxSize = cache.GetStats().max_size;
+    BOOST_CHECK(maxSize == CSignatureCache::SHARD_COUNT * 4);
+
+    uint256 sigHash;
+    vector<unsigned char> sig;
+    CPubKey pubKey;
+    MakeEntry(1, sigHash, sig, pubKey);
+    BOOST_CHECK(!cache.Get(sigHash, sig, pubKey));
+    cache.Set(sigHash, sig, pubKey);
+    BOOST_CHECK(cache.Get(sigHash, sig, pubKey));
+
+    for (uint32_t n = 2; n < 10000; n++) {
+        MakeEntry(n, sigHash, sig, pubKey);
+        cache.Set(sigHash, sig, pubKey);
+        BOOST_CHECK(cache.Get(sigHash, sig, pubKey));
+    }
+
+    CSignatureCache::Stats stats = cache.GetStats();
+    BOOST_CHECK(stats.size <= maxSize);
+    BOOST_CHECK(stats.inserts == 9999);
+    BOOST_CHECK(stats.evictions == stats.inserts - stats.size);
+    BOOST_CHECK(stats.hits == 9999 && stats.misses == 1);
+
+    // disabled
+    cache.SetMaxMemory(0);
+    BOOST_CHECK(cache.GetStats().size == 0);
+    cache.Set(sigHash, sig, pubKey);
+    BOOST_CHECK(!cache.Get(sigHash, sig, pubKey));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
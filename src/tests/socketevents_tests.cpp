@@ -0,0 +1,151 @@
+// Copyright (c) 2017-2019 The GreenVenturesChain Core developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "p2p/socketevents.h"
+
+#include <set>
+#include <thread>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "commons/util/util.h"
+
+using namespace std;
+
+struct FSocketEventsTests {
+    ~FSocketEventsTests() { CloseSockets(); }
+
+    bool OpenSockets(size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            int fds[2];
+            if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+                return false;
+            localSockets.push_back(fds[0]);
+            remoteSockets.push_back(fds[1]);
+        }
+        return true;
+    }
+
+    void CloseSockets() {
+        for (auto hSocket : localSockets)
+            close(hSocket);
+        for (auto hSocket : remoteSockets)
+            close(hSocket);
+        localSockets.clear();
+        remoteSockets.clear();
+    }
+
+    // the sockets wanted by select, every socket is polled for receiving
+    vector<CSocketEvents::CReadySocket> GetWanted() const {
+        vector<CSocketEvents::CReadySocket> wanted;
+        for (auto hSocket : localSockets)
+            wanted.push_back({(SOCKET)hSocket, CSocketEvents::EVENT_RECV | CSocketEvents::EVENT_ERROR});
+        return wanted;
+    }
+
+    static set<SOCKET> GetRecvReady(const vector<CSocketEvents::CReadySocket> &ready) {
+        set<SOCKET> sockets;
+        for (const auto &socket : ready) {
+            if (socket.events & CSocketEvents::EVENT_RECV)
+                sockets.insert(socket.hSocket);
+        }
+        return sockets;
+    }
+
+    static void Drain(int hSocket) {
+        char buf[256];
+        while (recv(hSocket, buf, sizeof(buf), MSG_DONTWAIT) > 0) {}
+    }
+
+    vector<int> localSockets;
+    vector<int> remoteSockets;
+};
+
+BOOST_FIXTURE_TEST_SUITE(socketevents_tests, FSocketEventsTests)
+
+BOOST_AUTO_TEST_CASE(socketevents_ready_test)
+{
+    BOOST_CHECK(OpenSockets(16));
+    for (bool fUseEpoll : {true, false}) {
+        CSocketEvents events;
+        events.Open(fUseEpoll);
+        for (auto hSocket : localSockets)
+            events.AddSocket(hSocket);
+
+        // the initial send events of the edge-triggered sockets
+        vector<CSocketEvents::CReadySocket> ready;
+        events.Wait(GetWanted(), 0, ready);
+        BOOST_CHECK(GetRecvReady(ready).empty());
+
+        BOOST_CHECK(send(remoteSockets[3], "x", 1, 0) == 1);
+        BOOST_CHECK(send(remoteSockets[11], "y", 1, 0) == 1);
+        BOOST_CHECK(events.Wait(GetWanted(), 1000, ready) >= 2);
+        BOOST_CHECK(GetRecvReady(ready) == set<SOCKET>({(SOCKET)localSockets[3], (SOCKET)localSockets[11]}));
+
+        Drain(localSockets[3]);
+        Drain(localSockets[11]);
+    }
+}
+
+// the edge-triggered socket is reported once until new data arrives
+BOOST_AUTO_TEST_CASE(socketevents_edge_triggered_test)
+{
+    BOOST_CHECK(OpenSockets(2));
+    CSocketEvents events;
+    events.Open(true);
+    if (!events.IsEpoll())
+        return;
+
+    BOOST_CHECK(events.AddSocket(localSockets[0]));
+    vector<CSocketEvents::CReadySocket> ready;
+    events.Wait({}, 0, ready);
+
+    BOOST_CHECK(send(remoteSockets[0], "x", 1, 0) == 1);
+    events.Wait({}, 1000, ready);
+    BOOST_CHECK(GetRecvReady(ready).count(localSockets[0]) == 1);
+
+    // not drained, no new edge
+    events.Wait({}, 0, ready);
+    BOOST_CHECK(GetRecvReady(ready).empty());
+
+    BOOST_CHECK(send(remoteSockets[0], "y", 1, 0) == 1);
+    events.Wait({}, 1000, ready);
+    BOOST_CHECK(GetRecvReady(ready).count(localSockets[0]) == 1);
+}
+
+BOOST_AUTO_TEST_CASE(socketevents_wakeup_test)
+{
+    for (bool fUseEpoll : {true, false}) {
+        CSocketEvents events;
+        events.Open(fUseEpoll);
+
+        int64_t beginTime = GetTimeMillis();
+        std::thread waker([&]() {
+            MilliSleep(20);
+            events.Wakeup();
+        });
+        vector<CSocketEvents::CReadySocket> ready;
+        BOOST_CHECK(events.Wait({}, 5000, ready) == 0);
+        waker.join();
+        BOOST_CHECK(GetTimeMillis() - beginTime < 2000);
+
+        // the wakeup is drained by the wait
+        beginTime = GetTimeMillis();
+        events.Wait({}, 50, ready);
+        BOOST_CHECK(GetTimeMillis() - beginTime >= 40);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(socketevents_supported_test)
+{
+    CSocketEvents events;
+    events.Open(false);
+    BOOST_CHECK(events.IsSocketSupported(FD_SETSIZE - 1));
+    BOOST_CHECK(!events.IsSocketSupported(FD_SETSIZE));
+
+    events.Open(true);
+    if (events.IsEpoll())
+        BOOST_CHECK(events.IsSocketSupported(FD_SETSIZE));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -191,8 +191,7 @@ bool CCdpForceLiquidator::Execute() {
         return true;
     }
 
-    // 2. get all CDPs to be force settled
-    CdpRatioSortedCache::Map cdpMap;
+    // 2. get the CDPs to be force settled
     uint64_t forceLiquidateRatio = 0;
     // TODO: get cdp CDP_FORCE_LIQUIDATE_RATIO
     if (!cw.sysParamCache.GetCdpParam(cdpCoinPair, CdpParamType::CDP_FORCE_LIQUIDATE_RATIO, forceLiquidateRatio)) {
@@ -201,42 +200,28 @@ bool CCdpForceLiquidator::Execute() {
                 READ_SYS_PARAM_FAIL, "read-force-liquidate-ratio-error");
     }
 
-    // TODO: get liquidating cdp map
-    cw.cdpCache.GetCdpListByCollateralRatio(cdpCoinPair, forceLiquidateRatio, bcoinMedianPrice, cdpMap);
-
-    LogPrint(BCLog::CDP, "%s(), tx_cord=%d-%d, globalCollateralRatioFloor: %llu, bcoinMedianPrice: %llu, "
-            "forceLiquidateRatio: %llu, cdpMap: %llu\n", __func__, context.height, context.index,
-            globalCollateralRatioFloor, bcoinMedianPrice, forceLiquidateRatio, cdpMap.size());
-
-    // 3. force settle each cdp
-    if (cdpMap.size() == 0) {
-        return true;
-    }
-
-    {
-        // TODO: remove me.
-        LogPrint(BCLog::CDP, "%s(), have %llu cdps to force settle, in detail:\n",
-                    __func__, cdpMap.size());
-        for (const auto &cdpKey : cdpMap) {
-            LogPrint(BCLog::CDP, "%s\n", cdpKey.second.ToString());
-        }
-    }
-
     NET_TYPE netType = SysCfg().NetworkID();
     if (netType == TEST_NET && context.height < 1800000  && assetSymbol == SYMB::GVC && scoinSymbol == SYMB::WUSD) {
         // soft fork to compat old data of testnet
         // TODO: remove me if reset testnet.
+        CdpRatioSortedCache::Map cdpMap;
+        cw.cdpCache.GetCdpListByCollateralRatio(cdpCoinPair, forceLiquidateRatio, bcoinMedianPrice, cdpMap);
+        if (cdpMap.size() == 0) {
+            return true;
+        }
         return ForceLiquidateCDPCompat(bcoinMedianPrice, fcoinMedianPrice, cdpMap);
     }
 
+    // 3. force settle each cdp, from the lowest collateral ratio, only the settled ones are read
     int32_t count             = 0;
     uint64_t totalCloseoutScoins = 0;
     uint64_t totalSelloutBcoins  = 0;
     uint64_t totalInflateFcoins  = 0;
-    for (auto &cdpPair : cdpMap) {
-        auto &cdp = cdpPair.second;
-        if (count + 1 > FORCE_SETTLE_CDP_MAX_COUNT_PER_BLOCK)
-            break;
+    vector<CUserCDP> liquidatedCdps;
+    auto pCdpIt = cw.cdpCache.CreateCdpRatioIterator(cdpCoinPair, forceLiquidateRatio, bcoinMedianPrice);
+    for (pCdpIt->First(); pCdpIt->IsValid() && count < FORCE_SETTLE_CDP_MAX_COUNT_PER_BLOCK; pCdpIt->Next()) {
+        // copied, the cdp is erased from the cache below
+        CUserCDP cdp = pCdpIt->GetValue();
 
         // Suppose we have 120 (owed scoins' amount), 30, 50 three cdps, but current risk reserve scoins is 100,
         // then skip the 120 cdp and settle the 30 and 50 cdp.
@@ -321,8 +306,13 @@ bool CCdpForceLiquidator::Execute() {
         }
 
         totalCloseoutScoins += cdp.total_owed_scoins;
+        liquidatedCdps.push_back(cdp);
     }
 
+    LogPrint(BCLog::CDP, "%s(), tx_cord=%d-%d, globalCollateralRatioFloor: %llu, bcoinMedianPrice: %llu, "
+            "forceLiquidateRatio: %llu, settled cdps: %d\n", __func__, context.height, context.index,
+            globalCollateralRatioFloor, bcoinMedianPrice, forceLiquidateRatio, count);
+
     if (count > 0) {
         receipts.emplace_back(fcoinGenesisAccount.regid, nullId, scoinSymbol, totalCloseoutScoins,
                                 ReceiptCode::CDP_TOTAL_CLOSEOUT_SCOIN_FROM_RESERVE);
@@ -332,6 +322,8 @@ bool CCdpForceLiquidator::Execute() {
 
         receipts.emplace_back(nullId, fcoinGenesisAccount.regid, SYMB::WGRT, totalInflateFcoins,
                                 ReceiptCode::CDP_TOTAL_INFLATE_FCOIN_TO_RESERVE);
+
+        ForceLiquidateCdps(tx.GetHash(), liquidatedCdps, bcoinMedianPrice);
     }
 
     return true;
@@ -392,6 +384,7 @@ bool CCdpForceLiquidator::ForceLiquidateCDPCompat(uint64_t bcoinMedianPrice, uin
 
     uint64_t currRiskReserveScoins = fcoinGenesisAccount.GetToken(SYMB::WUSD).free_amount;
     uint32_t orderIndex            = 0;
+    vector<CUserCDP> liquidatedCdps;
     for (auto &cdp : cdpSet) {
         if (++cdpIndex > FORCE_SETTLE_CDP_MAX_COUNT_PER_BLOCK)
             break;
@@ -486,6 +479,7 @@ bool CCdpForceLiquidator::ForceLiquidateCDPCompat(uint64_t bcoinMedianPrice, uin
         // d) minus scoins from the risk reserve pool to repay CDP scoins
         currRiskReserveScoins -= cdp.total_owed_scoins;
         totalCloseoutScoins += cdp.total_owed_scoins;
+        liquidatedCdps.push_back(cdp);
     }
 
     // 4. operate fcoin genesis account
@@ -503,6 +497,9 @@ bool CCdpForceLiquidator::ForceLiquidateCDPCompat(uint64_t bcoinMedianPrice, uin
     receipts.emplace_back(nullId, fcoinGenesisAccount.regid, SYMB::WGRT, totalInflateFcoins,
                             ReceiptCode::CDP_TOTAL_INFLATE_FCOIN_TO_RESERVE);
 
+    if (!liquidatedCdps.empty())
+        ForceLiquidateCdps(txid, liquidatedCdps, bcoinMedianPrice);
+
     return true;
 }
 
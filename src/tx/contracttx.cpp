@@ -250,6 +250,7 @@ bool CLuaContractInvokeTx::ExecuteTx(CTxExecuteContext &context) {
     luaContext.p_app_account     = &desAccount;
     luaContext.p_contract        = &contract;
     luaContext.p_arguments       = &arguments;
+    luaContext.use_vm_cache      = context.transaction_status == transaction_status_type::validating;
 
     int64_t llTime = GetTimeMillis();
     auto pExecErr  = vmRunEnv.ExecuteContract(&luaContext, nRunStep);
@@ -544,6 +545,7 @@ bool CUniversalContractInvokeTx::ExecuteTx(CTxExecuteContext &context) {
     luaContext.p_app_account     = &desAccount;
     luaContext.p_contract        = &contract;
     luaContext.p_arguments       = &arguments;
+    luaContext.use_vm_cache      = context.transaction_status == transaction_status_type::validating;
 
     int64_t llTime = GetTimeMillis();
     auto pExecErr  = vmRunEnv.ExecuteContract(&luaContext, nRunStep);
@@ -172,6 +172,8 @@ public:
     bool IsPriceMedianTx() { return nTxType == PRICE_MEDIAN_TX; }
     bool IsPriceFeedTx() { return nTxType == PRICE_FEED_TX; }
     bool IsCoinRewardTx() { return nTxType == UCOIN_REWARD_TX; }
+    // the tx accesses the state only through the cache wrapper of context, it can be executed in parallel
+    bool IsParallelExecutable() { return nTxType == BCOIN_TRANSFER_TX || nTxType == UCOIN_TRANSFER_TX; }
 
     const string& GetTxTypeName() const { return ::GetTxTypeName(nTxType); }
 
@@ -10,6 +10,8 @@
 #include "tx/tx.h"
 #include "miner/miner.h"
 
+#include <algorithm>
+
 using namespace std;
 
 CTxMemPoolEntry::CTxMemPoolEntry() {
@@ -37,6 +39,16 @@ CTxMemPoolEntry::CTxMemPoolEntry(const CTxMemPoolEntry &other) {
     this->height = other.height;
 }
 
+// the tx object is estimated by its serialized size, the key and the nodes of indexes are added
+static uint64_t GetEntryMemoryUsage(const CTxMemPoolEntry &entry) {
+    return entry.GetTxSize() + sizeof(CTxMemPoolEntry) + sizeof(TxPriority) + 2 * sizeof(uint256) + 6 * sizeof(void *);
+}
+
+// the fuel is unknown before execution, so the admission and the eviction use the fee per KB without fuel
+static double GetEntryFeePerKb(const CTxMemPoolEntry &entry) {
+    return double(std::get<1>(entry.GetFees())) / entry.GetTxSize() * 1000.0;
+}
+
 CTxMemPool::CTxMemPool() {
     // Sanity checks off by default for performance, because otherwise
     // accepting transactions becomes O(N^2) where N is the number
@@ -48,27 +60,193 @@ void CTxMemPool::Remove(CBaseTx *pBaseTx, list<std::shared_ptr<CBaseTx> > &remov
     // Remove transaction from memory pool
     LOCK(cs);
     uint256 txid = pBaseTx->GetHash();
-    if (memPoolTxs.count(txid)) {
-        removed.push_front(std::shared_ptr<CBaseTx>(memPoolTxs[txid].GetTransaction()));
-        memPoolTxs.erase(txid);
+    auto iterTx  = memPoolTxs.find(txid);
+    if (iterTx != memPoolTxs.end()) {
+        removed.push_front(std::shared_ptr<CBaseTx>(iterTx->second.GetTransaction()));
+        EraseEntry(iterTx);
         EraseTransaction(txid);
     }
 }
 
+void CTxMemPool::RemoveConfirmed(const CBlock &block) {
+    LOCK(cs);
+    for (const auto &pTx : block.vptx) {
+        auto iterTx = memPoolTxs.find(pTx->GetHash());
+        if (iterTx != memPoolTxs.end())
+            EraseEntry(iterTx);
+    }
+}
+
+map<uint256, CTxMemPoolEntry>::iterator CTxMemPool::EraseEntry(map<uint256, CTxMemPoolEntry>::iterator iterTx) {
+    EraseTxPriority(iterTx->first);
+    entriesMemoryUsage -= GetEntryMemoryUsage(iterTx->second);
+    return memPoolTxs.erase(iterTx);
+}
+
+void CTxMemPool::AddTxPriority(const CTxMemPoolEntry &entry) {
+    auto pBaseTx  = entry.GetTransaction();
+    auto fee      = std::get<1>(entry.GetFees());
+    auto feePerKb = double(fee - pBaseTx->GetFuel(priorityHeight, priorityFuelRate)) / entry.GetTxSize() * 1000.0;
+
+    EraseTxPriority(pBaseTx->GetHash());
+    mapTxPriorities[pBaseTx->GetHash()] = txPriorities.emplace(entry.GetPriority(), feePerKb, pBaseTx).first;
+}
+
+void CTxMemPool::EraseTxPriority(const uint256 &txid) {
+    auto it = mapTxPriorities.find(txid);
+    if (it != mapTxPriorities.end()) {
+        txPriorities.erase(it->second);
+        mapTxPriorities.erase(it);
+    }
+}
+
+void CTxMemPool::RebuildTxPriorities(int32_t height, uint32_t fuelRate) {
+    priorityHeight   = height;
+    priorityFuelRate = fuelRate;
+
+    txPriorities.clear();
+    mapTxPriorities.clear();
+    for (const auto &item : memPoolTxs)
+        AddTxPriority(item.second);
+}
+
+const set<TxPriority>& CTxMemPool::GetTxPriorities(int32_t height, uint32_t fuelRate) {
+    AssertLockHeld(cs);
+    if (fuelRate != priorityFuelRate || GetFeatureForkVersion(height) != GetFeatureForkVersion(priorityHeight))
+        RebuildTxPriorities(height, fuelRate);
+
+    return txPriorities;
+}
+
 bool CTxMemPool::AddUnchecked(const uint256 &txid, const CTxMemPoolEntry &entry, CValidationState &state) {
     // Add to memory pool without checking anything.
     // Used by main.cpp AcceptToMemoryPool(), which DOES
     // all the appropriate checks.
     LOCK(cs);
     {
+        double minFee = GetMinFeePerKb();
+        if (minFee > 0 && entry.GetPriority() <= TRANSACTION_PRIORITY_CEILING) {
+            double feePerKb = GetEntryFeePerKb(entry);
+            if (feePerKb < minFee)
+                return state.DoS(0, ERRORMSG("AddUnchecked() : txid: %s fee per KB %.0f < mempool min fee %.0f",
+                                 txid.GetHex(), feePerKb, minFee), REJECT_INSUFFICIENTFEE, "mempool-min-fee-not-met");
+        }
+
         if (!CheckTxInMemPool(txid, entry, state))
             return false;
 
-        memPoolTxs.insert(make_pair(txid, entry));
+        auto ret = memPoolTxs.insert(make_pair(txid, entry));
+        if (ret.second) {
+            entriesMemoryUsage += GetEntryMemoryUsage(ret.first->second);
+            AddTxPriority(ret.first->second);
+        }
+
+        if (GetMemoryUsage() > maxMemory) {
+            TrimToSize(maxMemory * MEMPOOL_TRIM_RATIO);
+            if (!memPoolTxs.count(txid))
+                return state.DoS(0, ERRORMSG("AddUnchecked() : txid: %s evicted, mempool is full", txid.GetHex()),
+                                 REJECT_INSUFFICIENTFEE, "mempool-full");
+        }
     }
     return true;
 }
 
+void CTxMemPool::SetMaxMemory(uint64_t maxMemoryIn) {
+    LOCK(cs);
+    maxMemory = maxMemoryIn;
+    if (GetMemoryUsage() > maxMemory)
+        TrimToSize(maxMemory * MEMPOOL_TRIM_RATIO);
+}
+
+double CTxMemPool::GetMinFeePerKb() {
+    LOCK(cs);
+    if (minFeePerKb <= 0)
+        return 0;
+
+    int64_t nNow = GetTime();
+    if (nNow > minFeeUpdateTime) {
+        minFeePerKb *= pow(0.5, double(nNow - minFeeUpdateTime) / MEMPOOL_MIN_FEE_HALFLIFE);
+        minFeeUpdateTime = nNow;
+        // less than one sawi per KB
+        if (minFeePerKb < 1.0)
+            minFeePerKb = 0;
+    }
+    return minFeePerKb;
+}
+
+void CTxMemPool::TrimToSize(uint64_t sizeLimit) {
+    AssertLockHeld(cs);
+    int64_t nStart = GetTimeMicros();
+
+    // pick the txs with the lowest fee per KB until the rest fits in the limit, the price feed and
+    // price median txs are never evicted
+    vector<pair<double, uint256>> candidates;
+    for (const auto &item : memPoolTxs) {
+        if (item.second.GetPriority() <= TRANSACTION_PRIORITY_CEILING)
+            candidates.emplace_back(GetEntryFeePerKb(item.second), item.first);
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    set<uint256> evictedTxids;
+    double maxEvictedFeePerKb = 0;
+    uint64_t usage            = GetMemoryUsage();
+    for (auto it = candidates.begin(); it != candidates.end() && usage > sizeLimit; ++it) {
+        const uint256 &txid = it->second;
+        usage -= std::min(usage, GetEntryMemoryUsage(memPoolTxs.at(txid)));
+        auto itLog = mapTxAccessLogs.find(txid);
+        if (itLog != mapTxAccessLogs.end())
+            usage -= std::min(usage, itLog->second->memoryUsage);
+
+        evictedTxids.insert(txid);
+        maxEvictedFeePerKb = std::max(maxEvictedFeePerKb, it->first);
+    }
+    if (evictedTxids.empty())
+        return;
+
+    // the descendants, i.e. the later txs which read the writes of the evicted txs, are evicted too,
+    // the writes of the rest are replayed by the rescan without execution
+    set<string> evictedKeys;
+    set<dbk::PrefixType> evictedPrefixes;
+    uint32_t descendantCount = 0;
+    for (const auto &txLog : txAccessLogs) {
+        bool fEvict = evictedTxids.count(txLog.txid) > 0;
+        if (!fEvict && txLog.spAccessLog->HasReadAny(evictedKeys, evictedPrefixes)) {
+            fEvict = true;
+            descendantCount++;
+        }
+        if (!fEvict)
+            continue;
+
+        txLog.spAccessLog->GetWriteKeys(evictedKeys, evictedPrefixes);
+        auto iterTx = memPoolTxs.find(txLog.txid);
+        if (iterTx != memPoolTxs.end()) {
+            EraseEntry(iterTx);
+            EraseTransaction(txLog.txid);
+            evictedCount++;
+        }
+    }
+
+    if (maxEvictedFeePerKb > GetMinFeePerKb()) {
+        minFeePerKb      = maxEvictedFeePerKb;
+        minFeeUpdateTime = GetTime();
+    }
+
+    // the rest txs do not read the evicted writes, so the cache is rebuilt by replaying their writes
+    // without execution, unless the tip or fuel rate is changed since the last scan
+    CBlockIndex *pTip = chainActive.Tip();
+    if (fFullRescan || connectedTipHash != pTip->GetBlockHash() || GetElementForBurn(pTip) != scanFuelRate) {
+        ReScanMemPoolTx();
+    } else {
+        IncrementalRescan();
+        dirtyKeys.clear();
+        dirtyPrefixes.clear();
+    }
+
+    LogPrint(BCLog::INFO, "Mempool trimmed: %u txs evicted, %u descendants, %u txs left, memory %u, min fee per KB %.0f, %.2fms\n",
+             evictedTxids.size(), descendantCount, memPoolTxs.size(), GetMemoryUsage(), minFeePerKb,
+             (GetTimeMicros() - nStart) * 0.001);
+}
+
 void CTxMemPool::QueryHash(vector<uint256> &txids) {
     LOCK(cs);
 
@@ -81,6 +259,21 @@ void CTxMemPool::QueryHash(vector<uint256> &txids) {
 
 bool CTxMemPool::CheckTxInMemPool(const uint256 &txid, const CTxMemPoolEntry &memPoolEntry, CValidationState &state,
                                   bool bExecute) {
+    if (!CheckTxValid(txid, memPoolEntry, state))
+        return false;
+
+    if (bExecute) {
+        auto spAccessLog = std::make_shared<CDbAccessLog>();
+        if (!ExecuteTx(txid, memPoolEntry, state, *spAccessLog))
+            return false;
+
+        AddTxAccessLog(txid, spAccessLog);
+    }
+
+    return true;
+}
+
+bool CTxMemPool::CheckTxValid(const uint256 &txid, const CTxMemPoolEntry &memPoolEntry, CValidationState &state) {
     // is it within valid height
     static int validHeight = SysCfg().GetTxCacheHeight();
     if (!memPoolEntry.GetTransaction()->IsValidHeight(chainActive.Height(), validHeight))
@@ -89,22 +282,26 @@ bool CTxMemPool::CheckTxInMemPool(const uint256 &txid, const CTxMemPoolEntry &me
 
     // is it already confirmed in block
     if (cw->txCache.HasTx(txid))
-        return state.Invalid(ERRORMSG("CheckTxInMemPool() : txid: %s has been confirmed", txid.GetHex()), REJECT_INVALID,
+        return state.Invalid(ERRORMSG("CheckTxInMemPool() : txid: %s has been confirmed", txid.GetHex()), REJECT_DUPLICATE,
                              "tx-duplicate-confirmed");
 
+    return true;
+}
+
+bool CTxMemPool::ExecuteTx(const uint256 &txid, const CTxMemPoolEntry &memPoolEntry, CValidationState &state,
+                           CDbAccessLog &accessLog) {
     auto spCW = std::make_shared<CCacheWrapper>(cw.get());
+    spCW->SetDbAccessLog(&accessLog);
 
-    if (bExecute) {
-        CBlockIndex *pTip =  chainActive.Tip();
-        uint32_t fuelRate  = GetElementForBurn(pTip);
-        uint32_t blockTime = pTip->GetBlockTime();
-        uint32_t prevBlockTime = pTip->pprev != nullptr ? pTip->pprev->GetBlockTime() : pTip->GetBlockTime();
-        CTxExecuteContext context(chainActive.Height(), 0, fuelRate, blockTime, prevBlockTime, spCW.get(), &state, transaction_status_type::validating);
-        if (!memPoolEntry.GetTransaction()->ExecuteTx(context)) {
-            pCdMan->pLogCache->SetExecuteFail(chainActive.Height(), memPoolEntry.GetTransaction()->GetHash(),
-                                              state.GetRejectCode(), state.GetRejectReason());
-            return false;
-        }
+    CBlockIndex *pTip =  chainActive.Tip();
+    uint32_t fuelRate  = GetElementForBurn(pTip);
+    uint32_t blockTime = pTip->GetBlockTime();
+    uint32_t prevBlockTime = pTip->pprev != nullptr ? pTip->pprev->GetBlockTime() : pTip->GetBlockTime();
+    CTxExecuteContext context(chainActive.Height(), 0, fuelRate, blockTime, prevBlockTime, spCW.get(), &state, transaction_status_type::validating);
+    if (!memPoolEntry.GetTransaction()->ExecuteTx(context)) {
+        pCdMan->pLogCache->SetExecuteFail(chainActive.Height(), memPoolEntry.GetTransaction()->GetHash(),
+                                          state.GetRejectCode(), state.GetRejectReason());
+        return false;
     }
 
     spCW->Flush();
@@ -112,31 +309,206 @@ bool CTxMemPool::CheckTxInMemPool(const uint256 &txid, const CTxMemPoolEntry &me
     return true;
 }
 
+void CTxMemPool::AddTxAccessLog(const uint256 &txid, const std::shared_ptr<CDbAccessLog> &spAccessLog) {
+    auto it = mapTxAccessLogs.find(txid);
+    if (it != mapTxAccessLogs.end()) {
+        // the tx was removed and accepted again
+        AddDirtyKeys(*it->second->spAccessLog);
+        EraseTxAccessLog(it->second);
+    }
+    mapTxAccessLogs[txid] = txAccessLogs.emplace(txAccessLogs.end(), txid, spAccessLog, chainActive.Height());
+    accessLogsMemoryUsage += mapTxAccessLogs[txid]->memoryUsage;
+}
+
+list<CTxMemPoolAccessLog>::iterator CTxMemPool::EraseTxAccessLog(list<CTxMemPoolAccessLog>::iterator it) {
+    accessLogsMemoryUsage -= it->memoryUsage;
+    mapTxAccessLogs.erase(it->txid);
+    return txAccessLogs.erase(it);
+}
+
+void CTxMemPool::ResetTxAccessLogs() {
+    txAccessLogs.clear();
+    mapTxAccessLogs.clear();
+    accessLogsMemoryUsage = 0;
+    dirtyKeys.clear();
+    dirtyPrefixes.clear();
+}
+
+void CTxMemPool::AddDirtyKeys(const CDbAccessLog &accessLog) {
+    accessLog.GetWriteKeys(dirtyKeys, dirtyPrefixes);
+}
+
 void CTxMemPool::SetMemPoolCache() {
     cw.reset(new CCacheWrapper(pCdMan));
+    fFullRescan = true;
+}
+
+void CTxMemPool::BlockConnected(const uint256 &prevBlockHash, const uint256 &blockHash,
+                                const CDbAccessLog &blockAccessLog) {
+    LOCK(cs);
+    if (prevBlockHash != connectedTipHash)
+        fFullRescan = true;  // the tip was changed without the writes
+
+    if (!fFullRescan)
+        AddDirtyKeys(blockAccessLog);
+
+    connectedTipHash = blockHash;
 }
 
 void CTxMemPool::ReScanMemPoolTx() {
+    LOCK(cs);
+    int64_t nStart = GetTimeMicros();
+
+    CBlockIndex *pTip = chainActive.Tip();
+    uint32_t fuelRate = GetElementForBurn(pTip);
+    bool fIncremental = !fFullRescan && connectedTipHash == pTip->GetBlockHash() && fuelRate == scanFuelRate;
+
+    // the priorities of the added or re-executed txs are computed with the fee for the next block
+    if (fuelRate != priorityFuelRate || GetFeatureForkVersion(pTip->height + 1) != GetFeatureForkVersion(priorityHeight)) {
+        priorityHeight   = pTip->height + 1;
+        priorityFuelRate = fuelRate;
+    }
+
+    uint32_t executedCount = fIncremental ? IncrementalRescan() : FullRescan();
+
+    dirtyKeys.clear();
+    dirtyPrefixes.clear();
+    connectedTipHash = pTip->GetBlockHash();
+    scanFuelRate     = fuelRate;
+    fFullRescan      = false;
+
+    if (SysCfg().IsBenchmark())
+        LogPrint(BCLog::INFO, "- Rescan mempool%s: %u txs, %u executed, %.2fms\n", fIncremental ? "" : " (full)",
+                 memPoolTxs.size(), executedCount, (GetTimeMicros() - nStart) * 0.001);
+}
+
+uint32_t CTxMemPool::FullRescan() {
     cw.reset(new CCacheWrapper(pCdMan));
+    ResetTxAccessLogs();
 
-    LOCK(cs);
     CValidationState state;
     for (map<uint256, CTxMemPoolEntry>::iterator iterTx = memPoolTxs.begin(); iterTx != memPoolTxs.end();) {
         if (!CheckTxInMemPool(iterTx->first, iterTx->second, state, true)) {
             uint256 txid = iterTx->first;
-            iterTx       = memPoolTxs.erase(iterTx++);
+            iterTx       = EraseEntry(iterTx);
             EraseTransaction(txid);
             continue;
         }
         ++iterTx;
     }
+
+    // the run steps of txs are changed by the execution
+    RebuildTxPriorities(priorityHeight, priorityFuelRate);
+    return memPoolTxs.size();
+}
+
+// replay the writes of tx onto the cache, return false if any of the caches can not be replayed
+static bool ReplayTxWrites(const UndoDataFuncMap &undoDataFuncMap, const CDbAccessLog &accessLog) {
+    const auto &mapWriteLogs = accessLog.GetWriteLogs().GetMap();
+    for (const auto &item : mapWriteLogs) {
+        if (!undoDataFuncMap.count(dbk::ParseKeyPrefixType(item.first)))
+            return false;
+    }
+    for (const auto &item : mapWriteLogs) {
+        // the keys written by one flush are unique, so the order of the logs does not matter
+        undoDataFuncMap.at(dbk::ParseKeyPrefixType(item.first))(item.second);
+    }
+    return true;
+}
+
+/**
+ * The writes of tx can be replayed at other height if its execution depends on the height only by the
+ * feature fork version. The transfer from a registered account is such one, and the sender with pubkey
+ * uid might be registered with the regid of height. Others, e.g. the dex, cdp and contract txs, use the
+ * height and block time of the context, which are not in the access log.
+ */
+static bool IsReplayableAtHeight(const CBaseTx &tx, int32_t logHeight, int32_t height) {
+    if (logHeight == height)
+        return true;
+
+    if (GetFeatureForkVersion(logHeight) != GetFeatureForkVersion(height))
+        return false;
+
+    return (tx.nTxType == BCOIN_TRANSFER_TX || tx.nTxType == UCOIN_TRANSFER_TX) && !tx.txUid.is<CPubKey>();
+}
+
+uint32_t CTxMemPool::IncrementalRescan() {
+    // the reads of the new cache fall through to the global cache, only the writes of mempool txs are kept
+    cw.reset(new CCacheWrapper(pCdMan));
+    UndoDataFuncMap undoDataFuncMap = cw->GetUndoDataFuncMap();
+
+    uint32_t executedCount = 0;
+    CValidationState state;
+    for (auto it = txAccessLogs.begin(); it != txAccessLogs.end();) {
+        auto iterTx = memPoolTxs.find(it->txid);
+        bool fValid = iterTx != memPoolTxs.end() && CheckTxValid(iterTx->first, iterTx->second, state);
+        if (fValid) {
+            // the price feed tx writes the price point memory cache, which is not logged
+            const auto &pBaseTx = iterTx->second.GetTransaction();
+            bool fExecute = pBaseTx->IsPriceFeedTx() ||
+                            !IsReplayableAtHeight(*pBaseTx, it->height, chainActive.Height()) ||
+                            it->spAccessLog->HasReadAny(dirtyKeys, dirtyPrefixes) ||
+                            !ReplayTxWrites(undoDataFuncMap, *it->spAccessLog);
+            if (fExecute) {
+                // the later txs read the old writes must be re-executed too
+                AddDirtyKeys(*it->spAccessLog);
+
+                auto spAccessLog = std::make_shared<CDbAccessLog>();
+                fValid = ExecuteTx(iterTx->first, iterTx->second, state, *spAccessLog);
+                if (fValid) {
+                    AddDirtyKeys(*spAccessLog);
+                    accessLogsMemoryUsage -= it->memoryUsage;
+                    it->spAccessLog = spAccessLog;
+                    it->memoryUsage = spAccessLog->GetMemoryUsage();
+                    it->height      = chainActive.Height();
+                    accessLogsMemoryUsage += it->memoryUsage;
+                    AddTxPriority(iterTx->second);
+                }
+                executedCount++;
+            }
+        } else {
+            AddDirtyKeys(*it->spAccessLog);
+        }
+
+        if (!fValid) {
+            if (iterTx != memPoolTxs.end()) {
+                EraseEntry(iterTx);
+                EraseTransaction(it->txid);
+            }
+            it = EraseTxAccessLog(it);
+            continue;
+        }
+        ++it;
+    }
+
+    // the txs added without access log
+    for (auto iterTx = memPoolTxs.begin(); iterTx != memPoolTxs.end();) {
+        if (!mapTxAccessLogs.count(iterTx->first)) {
+            executedCount++;
+            if (!CheckTxInMemPool(iterTx->first, iterTx->second, state, true)) {
+                uint256 txid = iterTx->first;
+                iterTx       = EraseEntry(iterTx);
+                EraseTransaction(txid);
+                continue;
+            }
+            AddTxPriority(iterTx->second);
+        }
+        ++iterTx;
+    }
+
+    return executedCount;
 }
 
 void CTxMemPool::Clear() {
     LOCK(cs);
 
     memPoolTxs.clear();
+    entriesMemoryUsage = 0;
+    txPriorities.clear();
+    mapTxPriorities.clear();
     cw.reset(new CCacheWrapper(pCdMan));
+    ResetTxAccessLogs();
+    fFullRescan = true;
 }
 
 uint64_t CTxMemPool::Size() {
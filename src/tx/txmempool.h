@@ -10,17 +10,27 @@
 #include "entities/account.h"
 #include "persistence/cachewrapper.h"
 #include "sync.h"
+#include "tx/tx.h"
 
+#include <cmath>
 #include <list>
 #include <map>
 #include <memory>
+#include <set>
 
 using namespace std;
 
 class CValidationState;
 class CBaseTx;
+class CBlock;
 class uint256;
 
+static const int64_t DEFAULT_MAX_MEMPOOL_SIZE = 300;  // MiB
+// the mempool is trimmed to the ratio of -maxmempool when it is full, so the cache is not rebuilt on every insert
+static const double MEMPOOL_TRIM_RATIO = 0.9;
+// the half life in seconds of the min fee per KB raised by the eviction
+static const int64_t MEMPOOL_MIN_FEE_HALFLIFE = 60 * 60 * 12;
+
 /*
  * CTxMemPool stores these:
  */
@@ -49,6 +59,39 @@ public:
     inline uint32_t GetHeight() const { return height; }
 };
 
+struct TxPriority {
+    double priority;
+    double feePerKb;
+    std::shared_ptr<CBaseTx> baseTx;
+
+    TxPriority(const double priorityIn, const double feePerKbIn, const std::shared_ptr<CBaseTx> &baseTxIn)
+        : priority(priorityIn), feePerKb(feePerKbIn), baseTx(baseTxIn) {}
+
+    // compare the exact values, the tolerance bands are not transitive, which breaks the ordering of set
+    bool operator<(const TxPriority &other) const {
+        if (this->priority != other.priority)
+            return this->priority < other.priority;
+
+        if (this->feePerKb != other.feePerKb)
+            return this->feePerKb < other.feePerKb;
+
+        return this->baseTx->GetHash() < other.baseTx->GetHash();
+    }
+};
+
+/*
+ * The db access log of the tx executed in mempool
+ */
+struct CTxMemPoolAccessLog {
+    uint256 txid;
+    std::shared_ptr<CDbAccessLog> spAccessLog;
+    uint64_t memoryUsage;
+    int32_t height;  // the tip height of the execution, the context of execution is not logged
+
+    CTxMemPoolAccessLog(const uint256 &txidIn, const std::shared_ptr<CDbAccessLog> &spAccessLogIn, int32_t heightIn)
+        : txid(txidIn), spAccessLog(spAccessLogIn), memoryUsage(spAccessLogIn->GetMemoryUsage()), height(heightIn) {}
+};
+
 /*
  * CTxMemPool stores valid-according-to-the-current-best-chain
  * transactions that may be included in the next block.
@@ -70,21 +113,74 @@ public:
 
 public:
     void SetSanityCheck(bool fSanityCheckIn) { fSanityCheck = fSanityCheckIn; }
+    void SetMaxMemory(uint64_t maxMemoryIn);
     bool AddUnchecked(const uint256 &txid, const CTxMemPoolEntry &entry, CValidationState &state);
     void Remove(CBaseTx *pBaseTx, list<std::shared_ptr<CBaseTx> > &removed, bool fRecursive = false);
     void QueryHash(vector<uint256> &txids);
     bool CheckTxInMemPool(const uint256 &txid, const CTxMemPoolEntry &entry, CValidationState &state,
                           bool bExecute = true);
+    // remove the txs confirmed by the connected block
+    void RemoveConfirmed(const CBlock &block);
+    // the txs ordered by priority and fee per KB, the ordering is kept incrementally on insert and remove,
+    // it is rebuilt only when the fuel rate or fork version of height is changed
+    const set<TxPriority>& GetTxPriorities(int32_t height, uint32_t fuelRate);
     void SetMemPoolCache();
+    // called after the block is connected, blockAccessLog holds the writes of the block
+    void BlockConnected(const uint256 &prevBlockHash, const uint256 &blockHash, const CDbAccessLog &blockAccessLog);
     void ReScanMemPoolTx();
     void Clear();
 
     uint64_t Size();
+    // the estimated memory of the txs and their access logs
+    uint64_t GetMemoryUsage() const { return entriesMemoryUsage + accessLogsMemoryUsage; }
+    uint64_t GetMaxMemory() const { return maxMemory; }
+    uint64_t GetEvictedCount() const { return evictedCount; }
+    // the txs with the fee per KB below it are rejected, it is raised by the eviction and decays over time
+    double GetMinFeePerKb();
     bool Exists(const uint256 txid);
     std::shared_ptr<CBaseTx> Lookup(const uint256 txid) const;
 
+private:
+    void AddTxPriority(const CTxMemPoolEntry &entry);
+    void EraseTxPriority(const uint256 &txid);
+    void RebuildTxPriorities(int32_t height, uint32_t fuelRate);
+    map<uint256, CTxMemPoolEntry>::iterator EraseEntry(map<uint256, CTxMemPoolEntry>::iterator iterTx);
+    list<CTxMemPoolAccessLog>::iterator EraseTxAccessLog(list<CTxMemPoolAccessLog>::iterator it);
+    void TrimToSize(uint64_t sizeLimit);
+    bool CheckTxValid(const uint256 &txid, const CTxMemPoolEntry &entry, CValidationState &state);
+    bool ExecuteTx(const uint256 &txid, const CTxMemPoolEntry &entry, CValidationState &state,
+                   CDbAccessLog &accessLog);
+    void AddTxAccessLog(const uint256 &txid, const std::shared_ptr<CDbAccessLog> &spAccessLog);
+    void ResetTxAccessLogs();
+    void AddDirtyKeys(const CDbAccessLog &accessLog);
+    uint32_t FullRescan();
+    uint32_t IncrementalRescan();
+
 private:
     bool fSanityCheck; // Normally false, true if -checkmempool or -regtest
+
+    // the access logs of txs in the execution order, the writes of them are replayed onto the new cache
+    // after the tip changed, only the txs which read the keys changed since last scan are re-executed.
+    list<CTxMemPoolAccessLog> txAccessLogs;
+    map<uint256, list<CTxMemPoolAccessLog>::iterator> mapTxAccessLogs;
+    // the keys written by the blocks connected since last scan, and by the txs left the mempool
+    set<string> dirtyKeys;
+    set<dbk::PrefixType> dirtyPrefixes;
+    uint256 connectedTipHash;   // the tip after the last connected block or the last scan
+    uint32_t scanFuelRate = 0;  // the fuel rate of last scan
+    bool fFullRescan      = true;
+
+    set<TxPriority> txPriorities;
+    map<uint256, set<TxPriority>::iterator> mapTxPriorities;
+    int32_t priorityHeight    = 0;  // the height and fuel rate to compute the fee per KB
+    uint32_t priorityFuelRate = 0;
+
+    uint64_t maxMemory             = DEFAULT_MAX_MEMPOOL_SIZE << 20;
+    uint64_t entriesMemoryUsage    = 0;
+    uint64_t accessLogsMemoryUsage = 0;
+    uint64_t evictedCount          = 0;
+    double minFeePerKb             = 0;
+    int64_t minFeeUpdateTime       = 0;
 };
 
 
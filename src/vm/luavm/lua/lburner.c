@@ -109,7 +109,8 @@ static OpFuelInfo g_opFuelList[OP_TOTAL_COUNT] = {
 
 #define IsBurnerStarted(L) (L->burnerState.isStarted != 0)
 
-#define IsBurnerRuning(L) (L->burnerState.isStarted != 0 && L->burnerState.error == 0)
+#define IsBurnerRuning(L) (L->burnerState.isStarted != 0 && L->burnerState.isPaused == 0 && \
+                           L->burnerState.error == 0)
 
 #define TraceBurning(L, caption, format, ...) \
     if (L->burnerState.tracer != NULL) {\
@@ -141,6 +142,7 @@ LUA_API int lua_StartBurner(lua_State *L, void* pContext, unsigned long long fue
 
     L->burnerState.pContext         = pContext;
     L->burnerState.isStarted        = 1;
+    L->burnerState.isPaused         = 0;
     L->burnerState.error            = 0;
     L->burnerState.fuelLimit        = fuelLimit;
     L->burnerState.version          = version;
@@ -156,6 +158,19 @@ LUA_API int lua_StartBurner(lua_State *L, void* pContext, unsigned long long fue
     return 1;
 }
 
+LUA_API void lua_StopBurner(lua_State *L) {
+    L->burnerState.pContext         = NULL;
+    L->burnerState.isStarted        = 0;
+    L->burnerState.isPaused         = 0;
+    L->burnerState.tracer           = NULL;
+}
+
+LUA_API void lua_PauseBurner(lua_State *L, int paused) {
+    if (IsBurnerStarted(L)) {
+        L->burnerState.isPaused = paused;
+    }
+}
+
 lua_burner_state *lua_GetBurnerState(lua_State *L) {
     if (IsBurnerStarted(L)) {
         return &L->burnerState;
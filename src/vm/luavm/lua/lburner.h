@@ -14,6 +14,7 @@ typedef void (*lua_burner_trace_cb) (lua_State *L, const char* caption, const ch
 struct lua_burner_state {
     void*               pContext;           /** context pointer */
     int                 isStarted;          /** 0 is stoped, otherwise is started */
+    int                 isPaused;           /** 0 is running, otherwise nothing is burned */
     int                 error;              /** 0 is ok, otherwise has error */
     int                 version;            /** burner version */
     unsigned long long  fuelLimit;          /** max fuel can be burned */
@@ -39,8 +40,18 @@ typedef struct lua_burner_state lua_burner_state;
  */
 int lua_StartBurner(lua_State *L, void* pContext, unsigned long long  fuelLimit, int version);
 
+/**
+ * stop the started burner, so that the lua state can be started again with a new burner
+ */
+LUA_API void lua_StopBurner(lua_State *L);
+
 lua_burner_state* lua_GetBurnerState(lua_State *L);
 
+/**
+ * pause or resume the started burner, nothing is burned while paused, the burned fuel is kept
+ */
+LUA_API void lua_PauseBurner(lua_State *L, int paused);
+
 /**
  * burn memory
  * burned out if return 0, otherwise is burned ok.
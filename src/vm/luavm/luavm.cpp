@@ -11,6 +11,8 @@
 #include <string.h>
 
 #include <openssl/des.h>
+#include <limits>
+#include <map>
 #include <vector>
 #include "crypto/hash.h"
 #include "entities/key.h"
@@ -127,6 +129,70 @@ static int luaopen_array(lua_State *L){
 
 #endif
 
+CLuaCodeCache luaCodeCache;
+
+void CLuaCodeCache::SetMaxMemory(uint64_t maxBytes) {
+    std::lock_guard<std::mutex> lock(mtx);
+    maxMemory = maxBytes;
+    EvictOverflow();
+}
+
+string CLuaCodeCache::MakeKey(const string &code, int burnVersion) {
+    uint256 codeHash = Hash(code.begin(), code.end());
+    return string((const char *)codeHash.begin(), codeHash.size()) + "/" + std::to_string(burnVersion);
+}
+
+std::shared_ptr<const CLuaCodeCache::Entry> CLuaCodeCache::Get(const string &key) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = entryMap.find(key);
+    if (it == entryMap.end()) {
+        misses++;
+        return nullptr;
+    }
+
+    entries.splice(entries.begin(), entries, it->second);
+    hits++;
+    return it->second->second;
+}
+
+void CLuaCodeCache::Put(const string &key, const std::shared_ptr<const Entry> &spEntry) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (spEntry->GetMemorySize() > maxMemory)
+        return;
+
+    auto it = entryMap.find(key);
+    if (it != entryMap.end()) {
+        memory -= it->second->second->GetMemorySize();
+        entries.erase(it->second);
+        entryMap.erase(it);
+    }
+    entries.emplace_front(key, spEntry);
+    entryMap[key] = entries.begin();
+    memory += spEntry->GetMemorySize();
+    EvictOverflow();
+}
+
+CLuaCodeCache::Stats CLuaCodeCache::GetStats() {
+    std::lock_guard<std::mutex> lock(mtx);
+    Stats stats;
+    stats.max_memory = maxMemory;
+    stats.memory     = memory;
+    stats.count      = entries.size();
+    stats.hits       = hits;
+    stats.misses     = misses;
+    stats.evictions  = evictions;
+    return stats;
+}
+
+void CLuaCodeCache::EvictOverflow() {
+    while (memory > maxMemory && !entries.empty()) {
+        memory -= entries.back().second->GetMemorySize();
+        entryMap.erase(entries.back().first);
+        entries.pop_back();
+        evictions++;
+    }
+}
+
 CLuaVM::CLuaVM(const std::string &codeIn, const std::string &argumentsIn):
     code(codeIn), arguments(argumentsIn) {
     assert(code.size() <= MAX_CONTRACT_CODE_SIZE);
@@ -168,6 +234,174 @@ void vm_openlibs(lua_State *L) {
     }
 }
 
+static bool OpenContractLibs(lua_State *L) {
+    vm_openlibs(L);
+    if (!InitLuaLibsEx(L))
+        return false;
+
+    luaL_requiref(L, "mylib", luaopen_mylib, 1);
+    return true;
+}
+
+CLuaStatePool luaStatePool;
+
+static std::mutex csInitBurnerStates;
+static std::map<int, lua_burner_state> initBurnerStates;
+
+// get the burner state after initializing a new state, it only depends on the burner version
+static bool GetInitBurnerState(int burnVersion, lua_burner_state &burnerState) {
+    std::lock_guard<std::mutex> lock(csInitBurnerStates);
+    auto it = initBurnerStates.find(burnVersion);
+    if (it == initBurnerStates.end()) {
+        std::unique_ptr<lua_State, decltype(&lua_close)> lua_state_ptr(luaL_newstate(), &lua_close);
+        if (!lua_state_ptr)
+            return false;
+
+        lua_State *L = lua_state_ptr.get();
+        if (!lua_StartBurner(L, nullptr, std::numeric_limits<uint64_t>::max(), burnVersion) ||
+            !OpenContractLibs(L))
+            return false;
+
+        it = initBurnerStates.emplace(burnVersion, *lua_GetBurnerState(L)).first;
+    }
+    burnerState = it->second;
+    return true;
+}
+
+void CLuaStatePool::Start(uint32_t maxSizeIn) {
+    Stop();
+    if (maxSizeIn == 0)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        maxSize = maxSizeIn;
+        running = true;
+    }
+    worker = std::thread(&CLuaStatePool::WorkerLoop, this);
+
+    LogPrint(BCLog::INFO, "Prepare %u lua states for mempool execution\n", maxSizeIn);
+}
+
+void CLuaStatePool::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        running = false;
+        cond.notify_all();
+    }
+    if (worker.joinable())
+        worker.join();
+
+    std::lock_guard<std::mutex> lock(mtx);
+    for (auto L : preparedStates)
+        lua_close(L);
+    for (auto L : usedStates)
+        lua_close(L);
+    preparedStates.clear();
+    usedStates.clear();
+    maxSize = 0;
+}
+
+void CLuaStatePool::WorkerLoop() {
+    RenameThread("coin-luastates");
+
+    std::unique_lock<std::mutex> lock(mtx);
+    while (running) {
+        if (!usedStates.empty()) {
+            std::vector<lua_State *> states;
+            states.swap(usedStates);
+            lock.unlock();
+            for (auto L : states)
+                lua_close(L);
+            lock.lock();
+            continue;
+        }
+
+        if (preparedStates.size() < maxSize) {
+            lock.unlock();
+            // the same as the new state of execution, with the mylib on stack
+            lua_State *L = luaL_newstate();
+            if (L != nullptr && !OpenContractLibs(L)) {
+                lua_close(L);
+                L = nullptr;
+            }
+            lock.lock();
+            if (L != nullptr) {
+                preparedStates.push_back(L);
+                created++;
+                continue;
+            }
+        }
+        cond.wait(lock);
+    }
+}
+
+lua_State *CLuaStatePool::Acquire(void *pContext, uint64_t fuelLimit, int burnVersion) {
+    lua_State *L = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!running)
+            return nullptr;
+
+        if (preparedStates.empty()) {
+            missed++;
+            return nullptr;
+        }
+        L = preparedStates.back();
+        preparedStates.pop_back();
+        acquired++;
+        cond.notify_all();
+    }
+
+    lua_burner_state initBurnerState;
+    if (!GetInitBurnerState(burnVersion, initBurnerState)) {
+        Release(L);
+        return nullptr;
+    }
+
+    lua_StartBurner(L, pContext, fuelLimit, burnVersion);
+    lua_burner_state *burnerState = lua_GetBurnerState(L);
+    burnerState->fuel         = initBurnerState.fuel;
+    burnerState->fuelRefund   = initBurnerState.fuelRefund;
+    burnerState->allocMemSize = initBurnerState.allocMemSize;
+    burnerState->fuelStep     = initBurnerState.fuelStep;
+    burnerState->fuelOperator = initBurnerState.fuelOperator;
+    burnerState->fuelStore    = initBurnerState.fuelStore;
+    burnerState->fuelAccount  = initBurnerState.fuelAccount;
+    burnerState->fuelFunction = initBurnerState.fuelFunction;
+    if (lua_IsBurnedOut(L)) {
+        // let the new state be burned out by initializing to get the same error
+        Release(L);
+        return nullptr;
+    }
+    return L;
+}
+
+void CLuaStatePool::Release(lua_State *L) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (running) {
+            usedStates.push_back(L);
+            cond.notify_all();
+            return;
+        }
+    }
+    lua_close(L);
+}
+
+CLuaStatePool::Stats CLuaStatePool::GetStats() {
+    std::lock_guard<std::mutex> lock(mtx);
+    Stats stats;
+    stats.max_size  = maxSize;
+    stats.prepared  = preparedStates.size();
+    stats.created   = created;
+    stats.acquired  = acquired;
+    stats.missed    = missed;
+    return stats;
+}
+
+static void ReleasePooledLuaState(lua_State *L) { luaStatePool.Release(L); }
+
 tuple<bool, string> CLuaVM::CheckScriptSyntax(const char *filePath) {
 
     std::unique_ptr<lua_State, decltype(&lua_close)> lua_state_ptr(luaL_newstate(), &lua_close);
@@ -239,35 +473,88 @@ static std::string GetLuaError(lua_State *L, int status, std::string prefix) {
     return ret;
 }
 
+static int LuaDumpWriter(lua_State *L, const void *p, size_t size, void *ud) {
+    ((string *)ud)->append((const char *)p, size);
+    return 0;
+}
+
+/**
+ * Load the contract code as a function on top of the stack.
+ * A cache hit burns the memory recorded when the code was parsed in a new state, but the gc steps of
+ * parsing are not replayed, so the fuel of a hit may differ from parsing when the gc runs at other
+ * points of the contract. Only the execution of mempool uses the code cache, the consensus execution
+ * always parses the code.
+ */
+static int LoadContractCode(lua_State *L, const string &code, bool fUseCodeCache) {
+    if (!fUseCodeCache)
+        return luaL_loadbuffer(L, code.c_str(), code.size(), "line");
+
+    lua_burner_state *burnerState = lua_GetBurnerState(L);
+    string cacheKey = CLuaCodeCache::MakeKey(code, burnerState->version);
+    auto spEntry = luaCodeCache.Get(cacheKey);
+    if (spEntry) {
+        // burn the memory of parsing, fall back to parse if burned out to get the same error
+        burnerState->allocMemSize += spEntry->parse_alloc_size;
+        if (!lua_IsBurnedOut(L)) {
+            lua_PauseBurner(L, 1);
+            int luaStatus = luaL_loadbufferx(L, spEntry->bytecode.data(), spEntry->bytecode.size(), "line", "b");
+            lua_PauseBurner(L, 0);
+            if (luaStatus == LUA_OK)
+                return LUA_OK;
+
+            lua_pop(L, 1);
+        }
+        burnerState->allocMemSize -= spEntry->parse_alloc_size;
+    }
+
+    uint64_t allocMemSize = burnerState->allocMemSize;
+    int luaStatus = luaL_loadbuffer(L, code.c_str(), code.size(), "line");
+    if (luaStatus == LUA_OK) {
+        auto spEntry = std::make_shared<CLuaCodeCache::Entry>();
+        spEntry->parse_alloc_size = burnerState->allocMemSize - allocMemSize;
+        lua_PauseBurner(L, 1);
+        lua_dump(L, LuaDumpWriter, &spEntry->bytecode, 0);
+        lua_PauseBurner(L, 0);
+        luaCodeCache.Put(cacheKey, spEntry);
+    }
+    return luaStatus;
+}
+
 tuple<uint64_t, string> CLuaVM::Run(uint64_t fuelLimit, CLuaVMRunEnv *pVmRunEnv) {
     if (NULL == pVmRunEnv) {
         return std::make_tuple(-1, string("pVmRunEnv == NULL"));
     }
 
     // 1.创建Lua运行环境
-    std::unique_ptr<lua_State, decltype(&lua_close)> lua_state_ptr(luaL_newstate(), &lua_close);
-    if (!lua_state_ptr) {
-        LogPrint(BCLog::LUAVM, "CLuaVM::Run luaL_newstate() failed\n");
-        return std::make_tuple(-1, string("CLuaVM::Run luaL_newstate() failed\n"));
-    }
-    lua_State *lua_state = lua_state_ptr.get();
+    // The burner version is the feature fork version of the block height of the execution context.
+    // Only the execution of mempool uses the state prepared by the pool, the consensus execution always
+    // creates new state.
+    int burnVersion   = pVmRunEnv->GetBurnVersion();
+    bool fUseVmCache  = pVmRunEnv->GetContext().use_vm_cache;
+    typedef std::unique_ptr<lua_State, void (*)(lua_State *)> LuaStatePtr;
+    LuaStatePtr lua_state_ptr(nullptr, &lua_close);
+    if (fUseVmCache)
+        lua_state_ptr = LuaStatePtr(luaStatePool.Acquire(pVmRunEnv, fuelLimit, burnVersion), &ReleasePooledLuaState);
 
-    //TODO: should get burner version from the block height
-    if (!lua_StartBurner(lua_state, pVmRunEnv, fuelLimit, pVmRunEnv->GetBurnVersion())) {
-        LogPrint(BCLog::LUAVM, "CLuaVM::Run lua_StartBurner() failed\n");
-        return std::make_tuple(-1, string("CLuaVM::Run lua_StartBurner() failed\n"));
-    }
+    if (!lua_state_ptr) {
+        lua_state_ptr = LuaStatePtr(luaL_newstate(), &lua_close);
+        if (!lua_state_ptr) {
+            LogPrint(BCLog::LUAVM, "CLuaVM::Run luaL_newstate() failed\n");
+            return std::make_tuple(-1, string("CLuaVM::Run luaL_newstate() failed\n"));
+        }
 
-    //打开需要的库
-    vm_openlibs(lua_state);
+        if (!lua_StartBurner(lua_state_ptr.get(), pVmRunEnv, fuelLimit, burnVersion)) {
+            LogPrint(BCLog::LUAVM, "CLuaVM::Run lua_StartBurner() failed\n");
+            return std::make_tuple(-1, string("CLuaVM::Run lua_StartBurner() failed\n"));
+        }
 
-    if (!InitLuaLibsEx(lua_state)) {
-        LogPrint(BCLog::LUAVM, "InitLuaLibsEx error\n");
-        return std::make_tuple(-1, string("InitLuaLibsEx error\n"));
+        //打开需要的库, 3.注册自定义模块
+        if (!OpenContractLibs(lua_state_ptr.get())) {
+            LogPrint(BCLog::LUAVM, "InitLuaLibsEx error\n");
+            return std::make_tuple(-1, string("InitLuaLibsEx error\n"));
+        }
     }
-
-    // 3.注册自定义模块
-    luaL_requiref(lua_state, "mylib", luaopen_mylib, 1);
+    lua_State *lua_state = lua_state_ptr.get();
 
     // 4.往lua脚本传递合约内容
     lua_newtable(lua_state);  //新建一个表,压入栈顶
@@ -287,7 +574,7 @@ tuple<uint64_t, string> CLuaVM::Run(uint64_t fuelLimit, CLuaVMRunEnv *pVmRunEnv)
 
     // 5. Load the contract script
     std::string strError;
-    int luaStatus = luaL_loadbuffer(lua_state, code.c_str(), code.size(), "line");
+    int luaStatus = LoadContractCode(lua_state, code, fUseVmCache);
     if (luaStatus == LUA_OK) {
         luaStatus = lua_pcallk(lua_state, 0, 0, 0, 0, NULL, BURN_VER_STEP_V1);
         if (luaStatus != LUA_OK) {
@@ -8,14 +8,133 @@
 
 #include "main.h"
 
+#include <condition_variable>
 #include <cstdio>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 using namespace std;
 
 class CLuaVMRunEnv;
+struct lua_State;
+
+static const int64_t DEFAULT_LUA_CODE_CACHE_SIZE = 16;  // MiB
+
+/**
+ * LRU cache of the compiled contract chunks, to avoid lexing and parsing the same contract code on
+ * every invocation. The entry is keyed by the hash of contract code and the burner version, so the
+ * contracts deployed with the same code share the entry, and a redeployed contract just misses.
+ * The memory allocated by the original parsing is recorded and burned again on cache hit, so the
+ * burned fuel does not depend on the cache.
+ */
+class CLuaCodeCache {
+public:
+    struct Entry {
+        string bytecode;                // dumped chunk
+        uint64_t parse_alloc_size = 0;  // memory allocated and burned by parsing the code
+
+        uint64_t GetMemorySize() const { return bytecode.size() + sizeof(Entry); }
+    };
+
+    struct Stats {
+        uint64_t max_memory = 0;
+        uint64_t memory     = 0;
+        uint64_t count      = 0;
+        uint64_t hits       = 0;
+        uint64_t misses     = 0;
+        uint64_t evictions  = 0;
+    };
+
+public:
+    // set the memory budget in bytes, 0 disables the cache
+    void SetMaxMemory(uint64_t maxBytes);
+
+    // the key of the code loaded by the burner version
+    static string MakeKey(const string &code, int burnVersion);
+
+    // return nullptr if not found
+    std::shared_ptr<const Entry> Get(const string &key);
+    void Put(const string &key, const std::shared_ptr<const Entry> &spEntry);
+
+    Stats GetStats();
+
+private:
+    void EvictOverflow();
+
+private:
+    typedef std::list<std::pair<string, std::shared_ptr<const Entry>>> EntryList;
+
+    std::mutex mtx;
+    EntryList entries;  // the most recently used is at front
+    std::unordered_map<string, EntryList::iterator> entryMap;
+    uint64_t maxMemory  = DEFAULT_LUA_CODE_CACHE_SIZE << 20;
+    uint64_t memory     = 0;
+    uint64_t hits       = 0;
+    uint64_t misses     = 0;
+    uint64_t evictions  = 0;
+};
+
+extern CLuaCodeCache luaCodeCache;
+
+static const int32_t DEFAULT_LUA_STATE_POOL_SIZE = 2;
+
+/**
+ * Pool of the new lua states with the opened libs, prepared by a worker thread in advance, so the
+ * mempool execution does not wait for creating the state and opening the libs. Every state runs one
+ * contract and is closed by the worker thread, since the string table, the stack, the table sizes
+ * and the gc progress left by a contract change the memory burned by the next one.
+ * The fuel burned by initializing a new state is recorded once per burner version and is burned
+ * again when a prepared state is acquired.
+ */
+class CLuaStatePool {
+public:
+    struct Stats {
+        uint32_t max_size   = 0;
+        uint32_t prepared   = 0;
+        uint64_t created    = 0;
+        uint64_t acquired   = 0;
+        uint64_t missed     = 0;
+    };
+
+public:
+    CLuaStatePool() {}
+    ~CLuaStatePool() { Stop(); }
+
+    // start the worker thread to keep maxSizeIn states prepared, 0 disables the pool
+    void Start(uint32_t maxSizeIn);
+    void Stop();
+
+    uint32_t GetMaxSize() const { return maxSize; }
+
+    // return the prepared state with started burner, nullptr if no state is prepared
+    lua_State *Acquire(void *pContext, uint64_t fuelLimit, int burnVersion);
+    // close the state by the worker thread
+    void Release(lua_State *L);
+
+    Stats GetStats();
+
+private:
+    void WorkerLoop();
+
+private:
+    std::thread worker;
+    std::mutex mtx;
+    std::condition_variable cond;
+    std::vector<lua_State *> preparedStates;
+    std::vector<lua_State *> usedStates;
+    uint32_t maxSize    = 0;
+    bool running        = false;
+    uint64_t created    = 0;
+    uint64_t acquired   = 0;
+    uint64_t missed     = 0;
+};
+
+extern CLuaStatePool luaStatePool;
 
 class CLuaVM {
 public:
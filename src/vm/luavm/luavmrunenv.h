@@ -38,6 +38,7 @@ public:
     CAccount* p_app_account        = nullptr;
     CUniversalContract* p_contract = nullptr;
     string* p_arguments            = nullptr;
+    bool use_vm_cache              = false;  // the code cache and the pooled states, never in consensus
 };
 
 struct AssetTransfer {
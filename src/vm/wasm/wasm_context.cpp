@@ -100,14 +100,15 @@ namespace wasm {
         inline_transactions.push_back(t);
     }
 
-    std::vector <uint8_t> wasm_context::get_code(const uint64_t& account) {
+    std::vector <uint8_t> wasm_context::get_code(const uint64_t& account, uint256& code_hash) {
 
         vector <uint8_t>   code;
         CUniversalContract contract;
         CAccount contract_account ;
         if(database.accountCache.GetAccount(CNickID(account), contract_account)
             && database.contractCache.GetContract(contract_account.regid, contract)) {
-            code = vector <uint8_t>(contract.code.begin(), contract.code.end());
+            code      = vector <uint8_t>(contract.code.begin(), contract.code.end());
+            code_hash = contract.GetCodeHash();
         }
         return code;
     }
@@ -174,9 +175,10 @@ namespace wasm {
                 (*native)(*this);
             } else {
 
-                vector <uint8_t> code = get_code(_receiver);
+                uint256 code_hash;
+                vector <uint8_t> code = get_code(_receiver, code_hash);
                 if (code.size() > 0) {
-                    wasmif.execute(code, this);
+                    wasmif.execute(code_hash, code, this);
                 }
             }
         }  catch (wasm_chain::exception &e) {
@@ -42,7 +42,7 @@ namespace wasm {
         void                  execute(inline_transaction_trace &trace);
         void                  execute_one(inline_transaction_trace &trace);
         bool                  has_permission_from_inline_transaction(const permission &p);
-        std::vector <uint8_t> get_code(const uint64_t& account);
+        std::vector <uint8_t> get_code(const uint64_t& account, uint256& code_hash);
 // Console methods:
     public:
         void                      reset_console();
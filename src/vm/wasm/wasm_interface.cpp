@@ -10,6 +10,7 @@
 #include "wasm/wasm_constants.hpp"
 #include "wasm/wasm_runtime.hpp"
 #include "wasm/wasm_interface.hpp"
+#include "wasm/wasm_module_cache.hpp"
 #include "wasm/wasm_variant.hpp"
 
 #include "wasm/exception/exceptions.hpp"
@@ -37,11 +38,6 @@ namespace wasm {
     using backend_validate_t = backend<wasm::wasm_context_interface, vm::interpreter>;
     using rhf_t              = eosio::vm::registered_host_functions<wasm_context_interface>;
 
-    std::optional<std::map <code_version_t, std::shared_ptr<wasm_instantiated_module_interface>>>& get_wasm_instantiation_cache(){
-        static std::optional<std::map <code_version_t, std::shared_ptr<wasm_instantiated_module_interface>>> wasm_instantiation_cache;
-        return wasm_instantiation_cache;
-    }
-
     std::shared_ptr <wasm_runtime_interface>& get_runtime_interface(){
         static std::shared_ptr <wasm_runtime_interface> runtime_interface;
         return runtime_interface;
@@ -55,30 +51,23 @@ namespace wasm {
         get_runtime_interface()->immediately_exit_currently_running_module();
     }
 
-    std::shared_ptr <wasm_instantiated_module_interface> get_instantiated_backend(const vector <uint8_t> &code) {
-
-        try {
-            if(!get_wasm_instantiation_cache().has_value()){
-                 get_wasm_instantiation_cache() = std::map <code_version_t, std::shared_ptr<wasm_instantiated_module_interface>>{};
-            }
-
-            auto code_id = Hash(code.begin(), code.end());
-            auto it = get_wasm_instantiation_cache()->find(code_id);
-            if (it == get_wasm_instantiation_cache()->end()) {
-                get_wasm_instantiation_cache().value()[code_id] = get_runtime_interface()->instantiate_module((const char*)code.data(), code.size());
-                return get_wasm_instantiation_cache().value()[code_id];
-            }
-            return it->second;
-        } catch (...) {
-            throw;
-        }
-
+    std::shared_ptr <wasm_instantiated_module_interface> get_instantiated_backend(const code_version_t &code_hash,
+                                                                                  const vector <uint8_t> &code) {
+        // the code hash of contract might not be computed yet, the null hash must not be cached
+        const uint256 hash = code_hash.IsNull() ? Hash(code.begin(), code.end()) : code_hash;
+        return get_wasm_module_cache().get_or_instantiate(hash, [&]() {
+            return get_runtime_interface()->instantiate_module((const char*)code.data(), code.size());
+        });
     }
 
     void wasm_interface::execute(const vector <uint8_t> &code, wasm_context_interface *pWasmContext) {
+        execute(Hash(code.begin(), code.end()), code, pWasmContext);
+    }
+
+    void wasm_interface::execute(const uint256 &code_hash, const vector <uint8_t> &code, wasm_context_interface *pWasmContext) {
 
         pWasmContext->pause_billing_timer();
-        auto pInstantiated_module = get_instantiated_backend(code);
+        auto pInstantiated_module = get_instantiated_backend(code_hash, code);
         pWasmContext->resume_billing_timer();
 
         //system_clock::time_point start = system_clock::now();
@@ -89,6 +78,10 @@ namespace wasm {
 
     }
 
+    void wasm_interface::load(const uint256 &code_hash, const vector <uint8_t> &code) {
+        get_instantiated_backend(code_hash, code);
+    }
+
     void wasm_interface::validate(const vector <uint8_t> &code) {
 
         try {
@@ -106,6 +99,10 @@ namespace wasm {
 
     void wasm_interface::initialize(vm_type vm) {
 
+        // the cached modules refer to the runtime, it must not be replaced
+        if (get_runtime_interface())
+            return;
+
         if (vm == wasm::vm_type::eos_vm)
             get_runtime_interface() = std::make_shared<wasm::wasm_vm_runtime<vm::interpreter>>();
         else if (vm == wasm::vm_type::eos_vm_jit)
@@ -1008,5 +1005,5 @@ namespace wasm {
 
 extern  void wasm_code_cache_free() {
      //free heap before shut down
-     wasm::get_wasm_instantiation_cache().reset();
+     wasm::get_wasm_module_cache().clear();
 }
@@ -24,6 +24,9 @@ namespace wasm {
     public:
         void initialize(vm_type vm);
         void execute(const vector <uint8_t>& code, wasm_context_interface *pWasmContext);
+        void execute(const uint256& code_hash, const vector <uint8_t>& code, wasm_context_interface *pWasmContext);
+        // instantiate the module to cache
+        void load(const uint256& code_hash, const vector <uint8_t>& code);
         void validate(const vector <uint8_t>& code);
         void exit();
 
@@ -0,0 +1,206 @@
+// Copyright (c) 2017-2019 The GreenVenturesChain Core developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "wasm/wasm_module_cache.hpp"
+#include "wasm/wasm_interface.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <limits>
+
+#include "commons/util/util.h"
+#include "entities/contract.h"
+#include "logging.h"
+#include "persistence/contractdb.h"
+
+namespace wasm {
+
+    wasm_module_cache& get_wasm_module_cache() {
+        static wasm_module_cache module_cache;
+        return module_cache;
+    }
+
+    void wasm_module_cache::set_max_memory(uint64_t max_bytes) {
+        std::lock_guard<std::mutex> lock(mtx);
+        max_memory = max_bytes;
+        evict_overflow();
+    }
+
+    wasm_module_cache::module_ptr wasm_module_cache::get_or_instantiate(const uint256 &code_hash,
+                                                                        const instantiate_func &instantiate) {
+        assert(!code_hash.IsNull());
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            auto it = entry_map.find(code_hash);
+            if (it != entry_map.end()) {
+                entries.splice(entries.begin(), entries, it->second);
+                it->second->use_count++;
+                hits++;
+                return it->second->module;
+            }
+            misses++;
+        }
+
+        // instantiate without lock, the exception is thrown to caller
+        auto start  = std::chrono::steady_clock::now();
+        auto module = instantiate();
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+        entry e;
+        e.code_hash = code_hash;
+        e.module    = module;
+        e.memory    = module->get_memory_size() + sizeof(entry);
+        e.use_count = 1;
+
+        std::lock_guard<std::mutex> lock(mtx);
+        instantiation_time_us += elapsed.count();
+        put(std::move(e));
+        return module;
+    }
+
+    bool wasm_module_cache::contains(const uint256 &code_hash) {
+        assert(!code_hash.IsNull());
+        std::lock_guard<std::mutex> lock(mtx);
+        return entry_map.count(code_hash) > 0;
+    }
+
+    std::vector<uint256> wasm_module_cache::get_most_used(size_t count) {
+        std::vector<std::pair<uint64_t, uint256>> used;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            for (const auto &e : entries)
+                used.emplace_back(e.use_count, e.code_hash);
+        }
+        std::stable_sort(used.begin(), used.end(),
+                         [](const auto &a, const auto &b) { return a.first > b.first; });
+
+        std::vector<uint256> code_hashes;
+        for (size_t i = 0; i < used.size() && i < count; i++)
+            code_hashes.push_back(used[i].second);
+        return code_hashes;
+    }
+
+    void wasm_module_cache::clear() {
+        std::lock_guard<std::mutex> lock(mtx);
+        entry_map.clear();
+        entries.clear();
+        memory = 0;
+    }
+
+    wasm_module_cache::stats wasm_module_cache::get_stats() {
+        std::lock_guard<std::mutex> lock(mtx);
+        stats s;
+        s.max_memory            = max_memory;
+        s.memory                = memory;
+        s.count                 = entries.size();
+        s.hits                  = hits;
+        s.misses                = misses;
+        s.evictions             = evictions;
+        s.instantiation_time_us = instantiation_time_us;
+        return s;
+    }
+
+    void wasm_module_cache::put(entry &&e) {
+        if (e.memory > max_memory)
+            return;
+
+        // the module might be instantiated by other thread at the same time
+        auto it = entry_map.find(e.code_hash);
+        if (it != entry_map.end()) {
+            memory -= it->second->memory;
+            entries.erase(it->second);
+            entry_map.erase(it);
+        }
+
+        memory += e.memory;
+        entries.push_front(std::move(e));
+        entry_map[entries.front().code_hash] = entries.begin();
+        evict_overflow();
+    }
+
+    void wasm_module_cache::evict_overflow() {
+        while (memory > max_memory && !entries.empty()) {
+            memory -= entries.back().memory;
+            entry_map.erase(entries.back().code_hash);
+            entries.pop_back();
+            evictions++;
+        }
+    }
+
+    static boost::filesystem::path get_wasm_module_cache_file() { return GetDataDir() / "wasm_cache.dat"; }
+
+    bool wasm_module_cache_dump() {
+        std::vector<uint256> code_hashes = get_wasm_module_cache().get_most_used(std::numeric_limits<size_t>::max());
+
+        auto path = get_wasm_module_cache_file();
+        FILE *file = fopen(path.string().c_str(), "wb");
+        CAutoFile fileout = CAutoFile(file, SER_DISK, CLIENT_VERSION);
+        if (!fileout)
+            return ERRORMSG("%s : Failed to open file %s", __func__, path.string());
+
+        try {
+            fileout << code_hashes;
+        } catch (std::exception &e) {
+            return ERRORMSG("%s : Serialize or I/O error - %s", __func__, e.what());
+        }
+        FileCommit(fileout);
+        return true;
+    }
+
+    uint32_t wasm_module_cache_prewarm(CContractDBCache &contractCache, uint32_t count) {
+        std::vector<uint256> code_hashes;
+        {
+            auto path = get_wasm_module_cache_file();
+            FILE *file = fopen(path.string().c_str(), "rb");
+            CAutoFile filein = CAutoFile(file, SER_DISK, CLIENT_VERSION);
+            if (!filein)
+                return 0;
+
+            try {
+                filein >> code_hashes;
+            } catch (std::exception &e) {
+                LogPrint(BCLog::ERROR, "%s : Deserialize or I/O error - %s\n", __func__, e.what());
+                return 0;
+            }
+        }
+        if (code_hashes.size() > count)
+            code_hashes.resize(count);
+        if (code_hashes.empty())
+            return 0;
+
+        map<CRegIDKey, CUniversalContract> contracts;
+        if (!contractCache.GetContracts(contracts))
+            return 0;
+
+        std::unordered_map<uint256, const CUniversalContract *, CUint256Hasher> hash_contracts;
+        for (const auto &item : contracts) {
+            if (item.second.vm_type == VMType::WASM_VM)
+                hash_contracts.emplace(item.second.GetCodeHash(), &item.second);
+        }
+
+        wasm_interface wasmif;
+        wasmif.initialize(wasm::vm_type::eos_vm_jit);
+
+        uint32_t instantiated = 0;
+        for (const auto &code_hash : code_hashes) {
+            if (code_hash.IsNull())
+                continue;
+
+            auto it = hash_contracts.find(code_hash);
+            if (it == hash_contracts.end())
+                continue;
+
+            try {
+                vector<uint8_t> code(it->second->code.begin(), it->second->code.end());
+                wasmif.load(code_hash, code);
+                instantiated++;
+            } catch (...) {
+                LogPrint(BCLog::ERROR, "%s : Failed to instantiate wasm module %s\n", __func__, code_hash.ToString());
+            }
+        }
+        return instantiated;
+    }
+
+} //wasm
@@ -0,0 +1,93 @@
+// Copyright (c) 2017-2019 The GreenVenturesChain Core developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <stdint.h>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "commons/uint256.h"
+
+static const int64_t DEFAULT_WASM_MODULE_CACHE_SIZE    = 256; // MiB
+static const int64_t DEFAULT_WASM_MODULE_CACHE_PREWARM = 0;   // count of modules instantiated at startup
+
+class CContractDBCache;
+
+namespace wasm {
+
+    class wasm_instantiated_module_interface;
+
+    /**
+     * LRU cache of the instantiated wasm modules keyed by the code hash of contract, the memory of the
+     * module is measured by the allocator of the instantiated module.
+     */
+    class wasm_module_cache {
+
+    public:
+        using module_ptr       = std::shared_ptr<wasm_instantiated_module_interface>;
+        using instantiate_func = std::function<module_ptr()>;
+
+        struct stats {
+            uint64_t max_memory            = 0;
+            uint64_t memory                = 0;
+            uint64_t count                 = 0;
+            uint64_t hits                  = 0;
+            uint64_t misses                = 0;
+            uint64_t evictions             = 0;
+            uint64_t instantiation_time_us = 0;
+        };
+
+    public:
+        void set_max_memory(uint64_t max_bytes);
+
+        // return the cached module, the module is instantiated and cached if not found, the code hash
+        // must not be null
+        module_ptr get_or_instantiate(const uint256 &code_hash, const instantiate_func &instantiate);
+
+        bool contains(const uint256 &code_hash);
+
+        // the code hashes of the most used modules, the most used at first
+        std::vector<uint256> get_most_used(size_t count);
+
+        void  clear();
+        stats get_stats();
+
+    private:
+        struct entry {
+            uint256    code_hash;
+            module_ptr module;
+            uint64_t   memory    = 0;
+            uint64_t   use_count = 0;
+        };
+        using entry_list = std::list<entry>;
+
+        void put(entry &&e);
+        void evict_overflow();
+
+    private:
+        std::mutex mtx;
+        entry_list entries;  // the most recently used at front
+        std::unordered_map<uint256, entry_list::iterator, CUint256Hasher> entry_map;
+        uint64_t max_memory            = DEFAULT_WASM_MODULE_CACHE_SIZE << 20;
+        uint64_t memory                = 0;
+        uint64_t hits                  = 0;
+        uint64_t misses                = 0;
+        uint64_t evictions             = 0;
+        uint64_t instantiation_time_us = 0;
+    };
+
+    wasm_module_cache& get_wasm_module_cache();
+
+    // save the code hashes of the most used modules, to be prewarmed at next startup
+    bool wasm_module_cache_dump();
+
+    // instantiate the most used modules of last run, return the count of instantiated modules
+    uint32_t wasm_module_cache_prewarm(CContractDBCache &contractCache, uint32_t count);
+
+} //wasm
@@ -62,6 +62,11 @@ namespace wasm {
             _runtime->_bkend = nullptr;
         }
 
+        size_t get_memory_size() override {
+            const auto &allocator = _instantiated_module->get_module().allocator;
+            return allocator._offset + (allocator.is_jit ? allocator._code_size : 0) + sizeof(backend_t);
+        }
+
     private:
         wasm_vm_runtime <Impl> *    _runtime;
         std::shared_ptr <backend_t> _instantiated_module;
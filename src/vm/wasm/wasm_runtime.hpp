@@ -8,6 +8,8 @@ namespace wasm {
     class wasm_instantiated_module_interface {
        public:
           virtual void apply(wasm_context_interface* context) = 0;
+          // the memory allocated by the module, including the executable code of jit
+          virtual size_t get_memory_size() = 0;
           virtual ~wasm_instantiated_module_interface();
     };
 